@@ -19,6 +19,7 @@ extern "C"__declspec(dllimport) void setWebCLChannelHost(content::GpuChannelHost
 #include "content/common/gpu/client/command_buffer_proxy_impl.h"
 #include "content/common/gpu/client/gpu_video_encode_accelerator_host.h"
 #include "content/common/gpu/gpu_messages.h"
+#include "content/common/gpu/opencl_info.h"
 #include "gpu/command_buffer/common/mailbox.h"
 #include "ipc/ipc_sync_message_filter.h"
 #include "url/gurl.h"
@@ -33,6 +34,87 @@ extern "C"__declspec(dllimport) void setWebCLChannelHost(content::GpuChannelHost
 using base::AutoLock;
 using base::MessageLoopProxy;
 
+namespace {
+
+// Buffer reads and writes at least this large are staged through the
+// channel's shared memory transfer buffer instead of being serialized into
+// the IPC message.
+const size_t kCLTransferBufferThreshold = 64 * 1024;
+
+// Bounds for the transfer buffer. Larger transfers are split into chunks.
+const size_t kCLTransferBufferMinSize = 1024 * 1024;
+const size_t kCLTransferBufferMaxSize = 64 * 1024 * 1024;
+
+// The OpenCL command batch is sent once it holds this many commands or this
+// many bytes of argument data.
+const size_t kCLCommandBatchMaxCommands = 256;
+const size_t kCLCommandBatchMaxBytes = 64 * 1024;
+
+// Message ids follow declaration order, and gpu_messages.h keeps the OpenCL
+// messages together.
+bool IsOpenCLMessage(uint32 type) {
+  return type >= OpenCLChannelMsg_CommandBatch::ID &&
+         type <= OpenCLChannelMsg_EnqueueReleaseGLObjects::ID;
+}
+
+// Fills in the pitches a rect transfer left at zero, as OpenCL does.
+void ResolveCLRectPitches(const size_t* region,
+                          size_t* row_pitch,
+                          size_t* slice_pitch) {
+  if (!*row_pitch)
+    *row_pitch = region[0];
+  if (!*slice_pitch)
+    *slice_pitch = region[1] * *row_pitch;
+}
+
+// Copies the rows of |box|, at (|x|, |y|, |z|) within a rect transfer,
+// between the caller's memory |host| and |staging|, where they are packed
+// back to back. |pack| copies into |staging|.
+void CopyCLRectRows(bool pack,
+                    unsigned char* staging,
+                    unsigned char* host,
+                    const size_t* host_origin,
+                    size_t x,
+                    size_t y,
+                    size_t z,
+                    const size_t* box,
+                    size_t host_row_pitch,
+                    size_t host_slice_pitch) {
+  for (size_t k = 0; k < box[2]; ++k) {
+    for (size_t j = 0; j < box[1]; ++j) {
+      unsigned char* row = host +
+          (host_origin[2] + z + k) * host_slice_pitch +
+          (host_origin[1] + y + j) * host_row_pitch +
+          host_origin[0] + x;
+      unsigned char* packed = staging + (k * box[1] + j) * box[0];
+      if (pack)
+        memcpy(packed, row, box[0]);
+      else
+        memcpy(row, packed, box[0]);
+    }
+  }
+}
+
+// Adapt the OpenCL style callbacks handed to CallclSetEventCallback and
+// CallclFinishAsync to the status carried by
+// OpenCLChannelMsg_EventCallbackFired.
+void RunCLEventCallback(
+    void (CL_CALLBACK *pfn_event_notify)(cl_event, cl_int, void*),
+    cl_event clevent,
+    void* user_data,
+    cl_int status) {
+  pfn_event_notify(clevent, status, user_data);
+}
+
+void RunCLFinishCallback(
+    void (CL_CALLBACK *pfn_notify)(cl_int, void*),
+    void* user_data,
+    cl_int status) {
+  pfn_notify(status, user_data);
+}
+
+}  // namespace
+
 #define WEBCL_SET_FUNC(func) setWebCL##func(content::Call##func);
 
 namespace content {
@@ -73,7 +155,10 @@ GpuChannelHost::GpuChannelHost(GpuChannelHostFactory* factory,
     : factory_(factory),
       client_id_(client_id),
       gpu_host_id_(gpu_host_id),
-      gpu_info_(gpu_info) {
+      gpu_info_(gpu_info),
+      cl_transfer_buffer_id_(-1),
+      cl_transfer_buffer_size_(0),
+      cl_batch_bytes_(0) {
   next_transfer_buffer_id_.GetNext();
   next_gpu_memory_buffer_id_.GetNext();
   
@@ -125,6 +210,7 @@ GpuChannelHost::GpuChannelHost(GpuChannelHostFactory* factory,
   WEBCL_SET_FUNC(clReleaseKernel                  )
   WEBCL_SET_FUNC(clSetKernelArg                   )
   WEBCL_SET_FUNC(clSetKernelArg_vector)
+  WEBCL_SET_FUNC(clSetKernelArgs                  )
   WEBCL_SET_FUNC(clGetKernelInfo                  )
   WEBCL_SET_FUNC(clGetKernelArgInfo               )
   WEBCL_SET_FUNC(clGetKernelWorkGroupInfo         )
@@ -138,11 +224,12 @@ GpuChannelHost::GpuChannelHost(GpuChannelHostFactory* factory,
   WEBCL_SET_FUNC(clGetEventProfilingInfo          )
   WEBCL_SET_FUNC(clFlush                          )
   WEBCL_SET_FUNC(clFinish                         )
+  WEBCL_SET_FUNC(clFinishAsync                    )
   WEBCL_SET_FUNC(clEnqueueReadBuffer              )
-  //WEBCL_SET_FUNC(clEnqueueReadBufferRect          )
+  WEBCL_SET_FUNC(clEnqueueReadBufferRect          )
   WEBCL_SET_FUNC(clEnqueueWriteBuffer             )
-  //WEBCL_SET_FUNC(clEnqueueWriteBufferRect         )
-  //WEBCL_SET_FUNC(clEnqueueFillBuffer              )
+  WEBCL_SET_FUNC(clEnqueueWriteBufferRect         )
+  WEBCL_SET_FUNC(clEnqueueFillBuffer              )
   //WEBCL_SET_FUNC(clEnqueueCopyBuffer              )
   //WEBCL_SET_FUNC(clEnqueueCopyBufferRect          )
   //WEBCL_SET_FUNC(clEnqueueReadImage               )
@@ -151,9 +238,9 @@ GpuChannelHost::GpuChannelHost(GpuChannelHostFactory* factory,
   //WEBCL_SET_FUNC(clEnqueueCopyImage               )
   //WEBCL_SET_FUNC(clEnqueueCopyImageToBuffer       )
   //WEBCL_SET_FUNC(clEnqueueCopyBufferToImage       )
-  //WEBCL_SET_FUNC(clEnqueueMapBuffer               )
+  WEBCL_SET_FUNC(clEnqueueMapBuffer               )
   //WEBCL_SET_FUNC(clEnqueueMapImage                )
-  //WEBCL_SET_FUNC(clEnqueueUnmapMemObject          )
+  WEBCL_SET_FUNC(clEnqueueUnmapMemObject          )
   //WEBCL_SET_FUNC(clEnqueueMigrateMemObjects       )
   WEBCL_SET_FUNC(clEnqueueNDRangeKernel           )
   //WEBCL_SET_FUNC(clEnqueueTask                    )
@@ -195,10 +282,29 @@ bool GpuChannelHost::Send(IPC::Message* msg) {
   // Callee takes ownership of message, regardless of whether Send is
   // successful. See IPC::Sender.
   scoped_ptr<IPC::Message> message(msg);
+
+  // Queued OpenCL commands were issued before |msg| and must reach the GPU
+  // process ahead of it.
+  if (!FlushCLCommandBatch())
+    return false;
+  return SendUnbatched(message.release());
+}
+
+bool GpuChannelHost::SendUnbatched(IPC::Message* msg) {
+  scoped_ptr<IPC::Message> message(msg);
   // The GPU process never sends synchronous IPCs so clear the unblock flag to
   // preserve order.
   message->set_unblock(false);
 
+  // Covers the round trip of synchronous OpenCL calls, see
+  // GpuChannel::HandleOpenCLMessage.
+  bool trace_opencl = IsOpenCLMessage(message->type());
+  if (trace_opencl) {
+    TRACE_EVENT_BEGIN2("gpu", "GpuChannelHost::SendOpenCLMessage",
+                       "line", IPC_MESSAGE_ID_LINE(message->type()),
+                       "size", message->size());
+  }
+
   // Currently we need to choose between two different mechanisms for sending.
   // On the main thread we use the regular channel Send() method, on another
   // thread we use SyncMessageFilter. We also have to be careful interpreting
@@ -207,15 +313,18 @@ bool GpuChannelHost::Send(IPC::Message* msg) {
   //
   // TODO: Can we just always use sync_filter_ since we setup the channel
   //       without a main listener?
+  bool result = false;
   if (factory_->IsMainThread()) {
     // http://crbug.com/125264
     base::ThreadRestrictions::ScopedAllowWait allow_wait;
-    return channel_->Send(message.release());
+    result = channel_->Send(message.release());
   } else if (base::MessageLoop::current()) {
-    return sync_filter_->Send(message.release());
+    result = sync_filter_->Send(message.release());
   }
 
-  return false;
+  if (trace_opencl)
+    TRACE_EVENT_END0("gpu", "GpuChannelHost::SendOpenCLMessage");
+  return result;
 }
 
 CommandBufferProxyImpl* GpuChannelHost::CreateViewCommandBuffer(
@@ -549,6 +658,20 @@ void GpuChannelHost::MessageFilter::OnChannelError() {
   }
 
   listeners_.clear();
+
+  // No OpenCL callback can fire anymore; fail the pending ones.
+  CLCallbackMap cl_callbacks;
+  {
+    AutoLock lock(lock_);
+    cl_callbacks.swap(cl_callbacks_);
+  }
+  for (CLCallbackMap::iterator it = cl_callbacks.begin();
+       it != cl_callbacks.end();
+       ++it) {
+    it->second.loop->PostTask(
+        FROM_HERE,
+        base::Bind(it->second.callback, CL_SEND_IPC_MESSAGE_FAILURE));
+  }
 }
 
 bool GpuChannelHost::MessageFilter::IsLost() const {
@@ -576,6 +699,22 @@ size_t GpuChannelHost::MessageFilter::GetMailboxNames(
   return request;
 }
 
+void GpuChannelHost::MessageFilter::AddCLCallback(
+    int32 callback_id,
+    const base::Callback<void(cl_int)>& callback,
+    scoped_refptr<MessageLoopProxy> loop) {
+  AutoLock lock(lock_);
+  DCHECK(cl_callbacks_.find(callback_id) == cl_callbacks_.end());
+  CLCallbackInfo& info = cl_callbacks_[callback_id];
+  info.callback = callback;
+  info.loop = loop;
+}
+
+void GpuChannelHost::MessageFilter::RemoveCLCallback(int32 callback_id) {
+  AutoLock lock(lock_);
+  cl_callbacks_.erase(callback_id);
+}
+
 bool GpuChannelHost::MessageFilter::OnControlMessageReceived(
     const IPC::Message& message) {
   bool handled = true;
@@ -583,6 +722,8 @@ bool GpuChannelHost::MessageFilter::OnControlMessageReceived(
   IPC_BEGIN_MESSAGE_MAP(GpuChannelHost::MessageFilter, message)
   IPC_MESSAGE_HANDLER(GpuChannelMsg_GenerateMailboxNamesReply,
                       OnGenerateMailboxNamesReply)
+  IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EventCallbackFired,
+                      OnCLEventCallbackFired)
   IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
 
@@ -601,6 +742,20 @@ void GpuChannelHost::MessageFilter::OnGenerateMailboxNamesReply(
                             names.end());
 }
 
+void GpuChannelHost::MessageFilter::OnCLEventCallbackFired(
+    int32 callback_id, cl_int status) {
+  CLCallbackInfo info;
+  {
+    AutoLock lock(lock_);
+    CLCallbackMap::iterator it = cl_callbacks_.find(callback_id);
+    if (it == cl_callbacks_.end())
+      return;
+    info = it->second;
+    cl_callbacks_.erase(it);
+  }
+  info.loop->PostTask(FROM_HERE, base::Bind(info.callback, status));
+}
+
 // Adding the implement of OpenCL API calling.
 
 cl_int GpuChannelHost::CallclGetPlatformIDs(
@@ -769,6 +924,12 @@ cl_int GpuChannelHost::CallclReleaseDevice(cl_device_id device) {
   cl_int errcode_ret;
   cl_point point_device = (cl_point) device;
 
+  // A released sub-device's handle may be reused for a different one.
+  {
+    AutoLock lock(cl_info_lock_);
+    cl_device_info_.erase(point_device);
+  }
+
   // Send a Sync IPC Message and wait for the results.
   if (!Send(new OpenCLChannelMsg_ReleaseDevice(
            point_device,
@@ -917,36 +1078,20 @@ cl_command_queue GpuChannelHost::CallclCreateCommandQueue(
     cl_device_id device,
     cl_command_queue_properties properties,
     cl_int *errcode_ret) {
-  // Sending a Sync IPC Message, to call a clCreateCommandQueue API
-  // in other process, and getting the results of the API.
-  cl_int errcode_ret_inter;
-  cl_point point_context = (cl_point) context;
-  cl_point point_device = (cl_point) device;
-  cl_point point_command_queue_ret;
-  std::vector<bool> return_variable_null_status;
-
-  return_variable_null_status.resize(1);
-  return_variable_null_status[0] = false;
-
-  // The Sync Message can't get value back by NULL ptr, so if a
-  // return back ptr is NULL, we must instead it using another
-  // no-NULL ptr.
-  if (NULL == errcode_ret) {
-    errcode_ret = &errcode_ret_inter;
-    return_variable_null_status[0] = true;
-  }
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_CreateCommandQueue(
-           point_context,
-           point_device,
-           properties,
-           return_variable_null_status,
-           errcode_ret,
-           &point_command_queue_ret))) {
-    return NULL;
-  }
-  return (cl_command_queue) point_command_queue_ret;
+  // Queue the clCreateCommandQueue call under an id picked here, so the
+  // caller does not wait for the GPU process. A failure is reported by the
+  // next synchronization point.
+  cl_point point_command_queue = AllocateCLHandleId();
+  OpenCLCommand command(OpenCLCommand::CREATE_COMMAND_QUEUE);
+  command.handles.push_back(point_command_queue);
+  command.handles.push_back((cl_point) context);
+  command.handles.push_back((cl_point) device);
+  command.sizes.push_back(properties);
+  AppendCLCommand(command, false);
+
+  if (errcode_ret != NULL)
+    *errcode_ret = CL_SUCCESS;
+  return (cl_command_queue) point_command_queue;
 }
 
 cl_int GpuChannelHost::CallclRetainCommandQueue(
@@ -987,16 +1132,37 @@ cl_mem GpuChannelHost::CallclCreateBuffer(
     size_t size,
     void *host_ptr,
     cl_int *errcode_ret) {
-  // Sending a Sync IPC Message, to call a clCreateBuffer API
-  // in other process, and getting the results of the API.
+  // Buffers without host memory are queued under an id picked here, so the
+  // caller does not wait for the GPU process. A failure is reported by the
+  // next synchronization point.
+  if (host_ptr == NULL) {
+    cl_point point_memobj = AllocateCLHandleId();
+    OpenCLCommand command(OpenCLCommand::CREATE_BUFFER);
+    command.handles.push_back(point_memobj);
+    command.handles.push_back((cl_point) context);
+    command.sizes.push_back((size_t) flags);
+    command.sizes.push_back(size);
+    AppendCLCommand(command, false);
+
+    if (errcode_ret != NULL)
+      *errcode_ret = CL_SUCCESS;
+    return (cl_mem) point_memobj;
+  }
+
+  // The GPU process cannot see |host_ptr|. The initial contents are staged
+  // in shared memory and copied into the buffer by the creation call itself,
+  // so CL_MEM_USE_HOST_PTR degrades to CL_MEM_COPY_HOST_PTR.
+  if (!(flags & (CL_MEM_COPY_HOST_PTR | CL_MEM_USE_HOST_PTR)) || !size) {
+    if (errcode_ret != NULL)
+      *errcode_ret = CL_INVALID_HOST_PTR;
+    return NULL;
+  }
+  flags = (flags & ~CL_MEM_USE_HOST_PTR) | CL_MEM_COPY_HOST_PTR;
+
   cl_int errcode_ret_inter;
   cl_point point_context = (cl_point) context;
-  cl_point point_host_ptr = (cl_point) host_ptr;
-  cl_point point_memobj_ret;
-  std::vector<bool> return_variable_null_status;
-
-  return_variable_null_status.resize(1);
-  return_variable_null_status[0] = false;
+  cl_point point_memobj_ret = 0;
+  std::vector<bool> return_variable_null_status(1, false);
 
   // The Sync Message can't get value back by NULL ptr, so if a
   // return back ptr is NULL, we must instead it using another
@@ -1006,15 +1172,46 @@ cl_mem GpuChannelHost::CallclCreateBuffer(
     return_variable_null_status[0] = true;
   }
 
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_CreateBuffer(
-           point_context,
-           flags,
-           size,
-           point_host_ptr,
-		   return_variable_null_status,
-           errcode_ret,
-           &point_memobj_ret))) {
+  if (size <= kCLTransferBufferMaxSize) {
+    AutoLock lock(cl_transfer_lock_);
+    if (EnsureCLTransferBuffer(size)) {
+      memcpy(cl_transfer_buffer_->memory(), host_ptr, size);
+      if (!Send(new OpenCLChannelMsg_CreateBuffer(
+              point_context, flags, size, cl_transfer_buffer_id_,
+              return_variable_null_status, errcode_ret, &point_memobj_ret))) {
+        *errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
+        return NULL;
+      }
+      return (cl_mem) point_memobj_ret;
+    }
+  }
+
+  // Contents larger than the transfer buffer get shared memory of their own
+  // for the duration of the call.
+  scoped_ptr<base::SharedMemory> shm = factory_->AllocateSharedMemory(size);
+  if (!shm || !shm->Map(size)) {
+    *errcode_ret = CL_OUT_OF_HOST_MEMORY;
+    return NULL;
+  }
+  base::SharedMemoryHandle handle = ShareToGpuProcess(shm->handle());
+  if (!base::SharedMemory::IsHandleValid(handle)) {
+    *errcode_ret = CL_OUT_OF_HOST_MEMORY;
+    return NULL;
+  }
+  memcpy(shm->memory(), host_ptr, size);
+
+  int32 transfer_buffer_id = ReserveTransferBufferId();
+  if (!Send(new OpenCLChannelMsg_RegisterTransferBuffer(
+          transfer_buffer_id, handle, size))) {
+    *errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
+    return NULL;
+  }
+  bool sent = Send(new OpenCLChannelMsg_CreateBuffer(
+      point_context, flags, size, transfer_buffer_id,
+      return_variable_null_status, errcode_ret, &point_memobj_ret));
+  Send(new OpenCLChannelMsg_DestroyTransferBuffer(transfer_buffer_id));
+  if (!sent) {
+    *errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
     return NULL;
   }
   return (cl_mem) point_memobj_ret;
@@ -1122,18 +1319,12 @@ cl_int GpuChannelHost::CallclRetainMemObject(cl_mem memobj) {
 }
 
 cl_int GpuChannelHost::CallclReleaseMemObject(cl_mem memobj) {
-  // Sending a Sync IPC Message, to call a clReleaseMemObject API
-  // in other process, and getting the results of the API.
-  cl_int errcode_ret;
-  cl_point point_memobj = (cl_point) memobj;
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_ReleaseMemObject(
-           point_memobj,
-           &errcode_ret))) {
-      return CL_SEND_IPC_MESSAGE_FAILURE;
-  }
-  return errcode_ret;
+  // Queue the clReleaseMemObject call; a failure is reported by the next
+  // synchronization point.
+  OpenCLCommand command(OpenCLCommand::RELEASE_MEM_OBJECT);
+  command.handles.push_back((cl_point) memobj);
+  AppendCLCommand(command, false);
+  return CL_SUCCESS;
 }
 
 cl_int GpuChannelHost::CallclGetSupportedImageFormats(
@@ -1216,36 +1407,21 @@ cl_sampler GpuChannelHost::CallclCreateSampler(
     cl_addressing_mode addressing_mode,
     cl_filter_mode filter_mode,
     cl_int *errcode_ret) {
-  // Sending a Sync IPC Message, to call a clCreateSampler API
-  // in other process, and getting the results of the API.
-  cl_int errcode_ret_inter;
-  cl_point point_context = (cl_point) context;
-  cl_point point_sampler_ret;
-  std::vector<bool> return_variable_null_status;
-
-  return_variable_null_status.resize(1);
-  return_variable_null_status[0] = false;
-
-  // The Sync Message can't get value back by NULL ptr, so if a
-  // return back ptr is NULL, we must instead it using another
-  // no-NULL ptr.
-  if (NULL == errcode_ret) {
-    errcode_ret = &errcode_ret_inter;
-    return_variable_null_status[0] = true;
-  }
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_CreateSampler(
-           point_context,
-           normalized_coords,
-           addressing_mode,
-           filter_mode,
-		   return_variable_null_status,
-           errcode_ret,
-           &point_sampler_ret))) {
-    return NULL;
-  }
-  return (cl_sampler) point_sampler_ret;
+  // Queue the clCreateSampler call under an id picked here, so the caller
+  // does not wait for the GPU process. A failure is reported by the next
+  // synchronization point.
+  cl_point point_sampler = AllocateCLHandleId();
+  OpenCLCommand command(OpenCLCommand::CREATE_SAMPLER);
+  command.handles.push_back(point_sampler);
+  command.handles.push_back((cl_point) context);
+  command.sizes.push_back(normalized_coords);
+  command.sizes.push_back(addressing_mode);
+  command.sizes.push_back(filter_mode);
+  AppendCLCommand(command, false);
+
+  if (errcode_ret != NULL)
+    *errcode_ret = CL_SUCCESS;
+  return (cl_sampler) point_sampler;
 }
 
 cl_int GpuChannelHost::CallclRetainSampler(cl_sampler sampler)
@@ -1624,35 +1800,19 @@ cl_kernel GpuChannelHost::CallclCreateKernel(
     cl_program program,
     const char *kernel_name,
     cl_int *errcode_ret) {
-  // Sending a Sync IPC Message, to call a clCreateKernel API
-  // in other process, and getting the results of the API.
-  cl_int errcode_ret_inter = 0xFFFFFFF;
-  cl_point point_kernel_ret;
-  cl_point point_program = (cl_point) program;
-  std::string str_kernel_name(kernel_name);
-  std::vector<bool> return_variable_null_status;
-
-  return_variable_null_status.resize(1);
-  return_variable_null_status[0] = false;
+  // Queue the clCreateKernel call under an id picked here, so the caller
+  // does not wait for the GPU process. A failure is reported by the next
+  // synchronization point.
+  cl_point point_kernel = AllocateCLHandleId();
+  OpenCLCommand command(OpenCLCommand::CREATE_KERNEL);
+  command.handles.push_back(point_kernel);
+  command.handles.push_back((cl_point) program);
+  command.data.assign(kernel_name, kernel_name + strlen(kernel_name));
+  AppendCLCommand(command, false);
 
-  // The Sync Message can't get value back by NULL ptr, so if a
-  // return back ptr is NULL, we must instead it using another
-  // no-NULL ptr.
-  if (NULL == errcode_ret) {
-    errcode_ret = &errcode_ret_inter;
-    return_variable_null_status[0] = true;
-  }
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_CreateKernel(
-           point_program,
-           str_kernel_name,
-		   return_variable_null_status,
-           errcode_ret,
-           &point_kernel_ret))) {
-    return NULL;
-  }
-  return (cl_kernel) point_kernel_ret;
+  if (errcode_ret != NULL)
+    *errcode_ret = CL_SUCCESS;
+  return (cl_kernel) point_kernel;
 }
 
 cl_int GpuChannelHost::CallclCreateKernelsInProgram(
@@ -1713,18 +1873,12 @@ cl_int GpuChannelHost::CallclRetainKernel(cl_kernel kernel) {
 }
 
 cl_int GpuChannelHost::CallclReleaseKernel(cl_kernel kernel) {
-  // Sending a Sync IPC Message, to call a clReleaseKernel
-  // API in other process, and getting the results of the API.
-  cl_int errcode_ret;
-  cl_point point_kernel = (cl_point) kernel;
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_ReleaseKernel(
-           point_kernel,
-           &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
-  }
-  return errcode_ret;
+  // Queue the clReleaseKernel call; a failure is reported by the next
+  // synchronization point.
+  OpenCLCommand command(OpenCLCommand::RELEASE_KERNEL);
+  command.handles.push_back((cl_point) kernel);
+  AppendCLCommand(command, false);
+  return CL_SUCCESS;
 }
 
 cl_int GpuChannelHost::CallclSetKernelArg(
@@ -1732,46 +1886,55 @@ cl_int GpuChannelHost::CallclSetKernelArg(
     cl_uint arg_index,
     size_t arg_size,
     const void *arg_value) {
-  // Sending a Sync IPC Message, to call a clSetKernelArg API
-  // in other process, and getting the results of the API.
-  cl_int errcode_ret;
-  cl_point point_kernel = (cl_point) kernel;
-  cl_point point_arg_value = (cl_point) arg_value;
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_SetKernelArg(
-           point_kernel,
-           arg_index,
-           arg_size,
-           point_arg_value,
-           &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
-  }
-  return errcode_ret;
+  // Queue the clSetKernelArg call; a failure is reported by the next
+  // synchronization point.
+  OpenCLCommand command(OpenCLCommand::SET_KERNEL_ARG);
+  command.handles.push_back((cl_point) kernel);
+  command.handles.push_back((cl_point) arg_value);
+  command.sizes.push_back(arg_index);
+  command.sizes.push_back(arg_size);
+  AppendCLCommand(command, false);
+  return CL_SUCCESS;
 }
 cl_int GpuChannelHost::CallclSetKernelArg_vector(
     cl_kernel kernel,
     cl_uint arg_index,
     size_t arg_size,
     const void *arg_value) {
-  // Sending a Sync IPC Message, to call a clSetKernelArg API
-  // in other process, and getting the results of the API.
-  cl_int errcode_ret;
-  cl_point point_kernel = (cl_point) kernel;
-  cl_point point_arg_value = (cl_point) arg_value;
-  std::vector<unsigned char> data;
-  data.resize(arg_size);
-  memcpy(&data[0], arg_value, arg_size);
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_SetKernelArg_vector(
-           point_kernel,
-           arg_index,
-           data,
-           &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
-  }
-  return errcode_ret;
+  // Queue the clSetKernelArg call; a failure is reported by the next
+  // synchronization point.
+  OpenCLCommand command(OpenCLCommand::SET_KERNEL_ARG_VECTOR);
+  command.handles.push_back((cl_point) kernel);
+  command.sizes.push_back(arg_index);
+  command.data.assign((const unsigned char*) arg_value,
+                      (const unsigned char*) arg_value + arg_size);
+  AppendCLCommand(command, false);
+  return CL_SUCCESS;
+}
+
+cl_int GpuChannelHost::CallclSetKernelArgs(
+    cl_kernel kernel,
+    cl_uint num_args,
+    const cl_uint* arg_indices,
+    const size_t* arg_sizes,
+    const void* arg_values) {
+  if (num_args == 0)
+    return CL_SUCCESS;
+
+  // Queue all the clSetKernelArg calls as one command; a failure is
+  // reported by the next synchronization point.
+  OpenCLCommand command(OpenCLCommand::SET_KERNEL_ARGS);
+  command.handles.push_back((cl_point) kernel);
+  size_t total_size = 0;
+  for (cl_uint index = 0; index < num_args; ++index) {
+    command.sizes.push_back(arg_indices[index]);
+    command.sizes.push_back(arg_sizes[index]);
+    total_size += arg_sizes[index];
+  }
+  command.data.assign((const unsigned char*) arg_values,
+                      (const unsigned char*) arg_values + total_size);
+  AppendCLCommand(command, false);
+  return CL_SUCCESS;
 }
 
 cl_int GpuChannelHost::CallclWaitForEvents(
@@ -1845,18 +2008,12 @@ cl_int GpuChannelHost::CallclRetainEvent(cl_event clevent) {
 }
 
 cl_int GpuChannelHost::CallclReleaseEvent(cl_event clevent) {
-  // Sending a Sync IPC Message, to call a clReleaseEvent
-  // API in other process, and getting the results of the API.
-  cl_int errcode_ret;
-  cl_point point_event = (cl_point) clevent;
-  
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_ReleaseEvent(
-           point_event,
-           &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
-  }
-  return errcode_ret;
+  // Queue the clReleaseEvent call; a failure is reported by the next
+  // synchronization point.
+  OpenCLCommand command(OpenCLCommand::RELEASE_EVENT);
+  command.handles.push_back((cl_point) clevent);
+  AppendCLCommand(command, false);
+  return CL_SUCCESS;
 }
 
 cl_int GpuChannelHost::CallclSetUserEventStatus(
@@ -1884,31 +2041,48 @@ cl_int GpuChannelHost::CallclSetEventCallback(
     void *user_data) {
   // Sending a Sync IPC Message, to call a clSetEventCallback
   // API in other process, and getting the results of the API.
+  // |pfn_event_notify| stays in this process and runs on the calling
+  // thread once OpenCLChannelMsg_EventCallbackFired arrives.
   cl_int errcode_ret;
   cl_point point_event = (cl_point) clevent;
-  cl_point point_pfn_notify = (cl_point) pfn_event_notify;
-  cl_point point_user_data = (cl_point) user_data;
+  int32 callback_id = next_cl_callback_id_.GetNext() + 1;
+
+  // The callback may fire before the reply arrives, so register it first.
+  channel_filter_->AddCLCallback(
+      callback_id,
+      base::Bind(&RunCLEventCallback, pfn_event_notify, clevent, user_data),
+      MessageLoopProxy::current());
 
   // Send a Sync IPC Message and wait for the results.
   if (!Send(new OpenCLChannelMsg_SetEventCallback(
            point_event,
            command_exec_callback_type,
-           point_pfn_notify,
-           point_user_data,
+           callback_id,
            &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
+    errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
   }
+  if (errcode_ret != CL_SUCCESS)
+    channel_filter_->RemoveCLCallback(callback_id);
   return errcode_ret;
 }
 
 cl_int GpuChannelHost::CallclFlush(cl_command_queue command_queue) {
-  // Sending a Sync IPC Message, to call a clFlush
+  // Queue the clFlush call behind everything already batched and send the
+  // batch. A failure is reported by the next synchronization point.
+  OpenCLCommand command(OpenCLCommand::FLUSH);
+  command.handles.push_back((cl_point) command_queue);
+  AppendCLCommand(command, true);
+  return CL_SUCCESS;
+}
+
+cl_int GpuChannelHost::CallclFinish(cl_command_queue command_queue) {
+  // Sending a Sync IPC Message, to call a clFinish
   // API in other process, and getting the results of the API.
   cl_int errcode_ret;
   cl_point point_command_queue = (cl_point) command_queue;
- 
+
   // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_Flush(
+  if (!Send(new OpenCLChannelMsg_Finish(
            point_command_queue,
            &errcode_ret))) {
     return CL_SEND_IPC_MESSAGE_FAILURE;
@@ -1916,19 +2090,28 @@ cl_int GpuChannelHost::CallclFlush(cl_command_queue command_queue) {
   return errcode_ret;
 }
 
-cl_int GpuChannelHost::CallclFinish(cl_command_queue command_queue) {
-  // Sending a Sync IPC Message, to call a clFinish
-  // API in other process, and getting the results of the API.
-  cl_int errcode_ret;
+cl_int GpuChannelHost::CallclFinishAsync(
+    cl_command_queue command_queue,
+    void (CL_CALLBACK *pfn_notify)(cl_int, void*),
+    void* user_data) {
+  // Unlike CallclFinish this does not wait for the GPU process. Errors,
+  // including the ones deferred by the command batch, are passed to
+  // |pfn_notify|.
   cl_point point_command_queue = (cl_point) command_queue;
+  int32 callback_id = next_cl_callback_id_.GetNext() + 1;
 
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_Finish(
+  channel_filter_->AddCLCallback(
+      callback_id,
+      base::Bind(&RunCLFinishCallback, pfn_notify, user_data),
+      MessageLoopProxy::current());
+
+  if (!Send(new OpenCLChannelMsg_FinishAsync(
            point_command_queue,
-           &errcode_ret))) {
+           callback_id))) {
+    channel_filter_->RemoveCLCallback(callback_id);
     return CL_SEND_IPC_MESSAGE_FAILURE;
   }
-  return errcode_ret;
+  return CL_SUCCESS;
 }
 
 cl_int GpuChannelHost::CallclGetPlatformInfo(
@@ -1942,6 +2125,12 @@ cl_int GpuChannelHost::CallclGetPlatformInfo(
   cl_int errcode_ret;
   cl_point point_platform = (cl_point) platform;
   std::string string_ret;
+
+  // Platform parameters never change, answer them from the cache.
+  if (GetCachedCLInfo(false, point_platform, param_name, param_value_size,
+                      param_value, param_value_size_ret, &errcode_ret))
+    return errcode_ret;
+
   size_t param_value_size_ret_inter = (size_t) -1;
   std::vector<bool> return_variable_null_status;
 
@@ -1998,6 +2187,11 @@ cl_int GpuChannelHost::CallclGetDeviceInfo(
   std::vector<intptr_t> intptr_t_list_ret;  
   std::vector<bool> return_variable_null_status;
 
+  // Most device parameters never change, answer them from the cache.
+  if (GetCachedCLInfo(true, point_device, param_name, param_value_size,
+                      param_value, param_value_size_ret, &errcode_ret))
+    return errcode_ret;
+
   return_variable_null_status.resize(2);
   return_variable_null_status[0] = return_variable_null_status[1] = false;
 
@@ -3529,6 +3723,16 @@ cl_int GpuChannelHost::CallclEnqueueReadBuffer(
   for (cl_uint index = 0; event_wait_list && index < num_events_in_wait_list; ++index)
     point_list.push_back((cl_point) event_wait_list[index]);
 
+  if (size >= kCLTransferBufferThreshold) {
+    AutoLock lock(cl_transfer_lock_);
+    if (EnsureCLTransferBuffer(std::min(size, kCLTransferBufferMaxSize))) {
+      return EnqueueCLTransfer(false, command_queue, buffer, offset, size,
+                               static_cast<unsigned char*>(ptr),
+                               num_events_in_wait_list, event_wait_list,
+                               clevent);
+    }
+  }
+
   size_t_list.clear();
   size_t_list.push_back(offset);
   size_t_list.push_back(size);
@@ -3551,36 +3755,338 @@ cl_int GpuChannelHost::CallclEnqueueReadBuffer(
   return errcode_ret;
 }
 
-cl_int GpuChannelHost::CallclEnqueueReadBufferRect(cl_command_queue command_queue, cl_mem buffer,cl_bool blocking_read, const size_t *buffer_origin,
-  const size_t *host_origin, const size_t *region,size_t buffer_row_pitch, size_t buffer_slice_pitch,
-  size_t host_row_pitch, size_t host_slice_pitch,void *ptr, cl_uint num_events_in_wait_list,const cl_event *event_wait_list, cl_event * clevent)
-{
-  // Sending a Sync IPC Message, to call a clCreateSubDevices API
-  // in other process, and getting the results of the API.	
-  cl_point point_out_val = (size_t) -1;
-  cl_int errcode_ret;
-  std::vector<cl_point> point_in_list;
-  std::vector<size_t> size_t_list;
-  cl_point point_ptr;
+void GpuChannelHost::AppendCLCommand(const OpenCLCommand& command,
+                                     bool flush) {
+  {
+    AutoLock lock(cl_batch_lock_);
+    cl_batch_.push_back(command);
+    cl_batch_bytes_ += command.data.size();
+    flush = flush || cl_batch_.size() >= kCLCommandBatchMaxCommands ||
+            cl_batch_bytes_ >= kCLCommandBatchMaxBytes;
+  }
+  if (flush)
+    FlushCLCommandBatch();
+}
+
+uint32 GpuChannelHost::AllocateCLHandleId() {
+  // Odd ids never collide with the aligned pointers the OpenCL runtime in
+  // the GPU process hands out, see GpuChannel::ResolveCLHandle.
+  return ((cl_point) next_cl_handle_id_.GetNext() << 1) | 1;
+}
+
+bool GpuChannelHost::GetCachedCLInfo(bool device,
+                                     cl_point object,
+                                     cl_uint param_name,
+                                     size_t param_value_size,
+                                     void* param_value,
+                                     size_t* param_value_size_ret,
+                                     cl_int* errcode_ret) {
+  if (device ? !IsImmutableCLDeviceInfo(param_name)
+             : !IsImmutableCLPlatformInfo(param_name))
+    return false;
 
-  point_in_list.clear();
-  for (cl_uint index = 0; index < num_events_in_wait_list; ++index)
-    point_in_list.push_back((cl_point) event_wait_list[index]);
+  CLInfoCache& cache = device ? cl_device_info_ : cl_platform_info_;
+  CLInfoValueMap values;
+  {
+    AutoLock lock(cl_info_lock_);
+    CLInfoCache::const_iterator it = cache.find(object);
+    if (it != cache.end())
+      values = it->second;
+  }
+
+  if (values.empty()) {
+    std::vector<cl_uint> param_names;
+    if (device) {
+      param_names.assign(kImmutableCLDeviceInfo,
+                         kImmutableCLDeviceInfo +
+                             arraysize(kImmutableCLDeviceInfo));
+    } else {
+      param_names.assign(kImmutableCLPlatformInfo,
+                         kImmutableCLPlatformInfo +
+                             arraysize(kImmutableCLPlatformInfo));
+    }
+
+    std::vector<std::vector<unsigned char>> param_values;
+    std::vector<cl_int> errcodes;
+    IPC::Message* msg;
+    if (device) {
+      msg = new OpenCLChannelMsg_GetDeviceInfoList(
+          object, param_names, &param_values, &errcodes);
+    } else {
+      msg = new OpenCLChannelMsg_GetPlatformInfoList(
+          object, param_names, &param_values, &errcodes);
+    }
+    if (!Send(msg)) {
+      *errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
+      return true;
+    }
+    if (param_values.size() != param_names.size() ||
+        errcodes.size() != param_names.size())
+      return false;
+
+    for (size_t i = 0; i < param_names.size(); ++i) {
+      CLInfoValue& entry = values[param_names[i]];
+      entry.errcode = errcodes[i];
+      entry.value.swap(param_values[i]);
+      if (device && IsSizeTCLDeviceInfo(param_names[i]))
+        NarrowCLSizeTInfo(&entry.value);
+    }
+
+    AutoLock lock(cl_info_lock_);
+    cache[object] = values;
+  }
+
+  CLInfoValueMap::const_iterator it = values.find(param_name);
+  if (it == values.end())
+    return false;
+
+  const CLInfoValue& entry = it->second;
+  if (CL_SUCCESS != entry.errcode) {
+    *errcode_ret = entry.errcode;
+    return true;
+  }
+  if (param_value) {
+    if (param_value_size < entry.value.size()) {
+      *errcode_ret = CL_INVALID_VALUE;
+      return true;
+    }
+    if (!entry.value.empty())
+      memcpy(param_value, &entry.value[0], entry.value.size());
+  }
+  if (param_value_size_ret)
+    *param_value_size_ret = entry.value.size();
+  *errcode_ret = CL_SUCCESS;
+  return true;
+}
+
+bool GpuChannelHost::FlushCLCommandBatch() {
+  AutoLock lock(cl_batch_lock_);
+  if (cl_batch_.empty())
+    return true;
+
+  IPC::Message* msg = new OpenCLChannelMsg_CommandBatch(cl_batch_);
+  cl_batch_.clear();
+  cl_batch_bytes_ = 0;
+  return SendUnbatched(msg);
+}
+
+bool GpuChannelHost::EnsureCLTransferBuffer(size_t size) {
+  cl_transfer_lock_.AssertAcquired();
+  if (cl_transfer_buffer_ && cl_transfer_buffer_size_ >= size)
+    return true;
+
+  size_t new_size = std::max(cl_transfer_buffer_size_,
+                             kCLTransferBufferMinSize);
+  while (new_size < size)
+    new_size *= 2;
+  new_size = std::min(new_size, kCLTransferBufferMaxSize);
+
+  scoped_ptr<base::SharedMemory> shm =
+      factory_->AllocateSharedMemory(new_size);
+  if (!shm || !shm->Map(new_size))
+    return false;
+
+  base::SharedMemoryHandle handle = ShareToGpuProcess(shm->handle());
+  if (!base::SharedMemory::IsHandleValid(handle))
+    return false;
+
+  int32 id = ReserveTransferBufferId();
+  if (!Send(new OpenCLChannelMsg_RegisterTransferBuffer(id, handle, new_size)))
+    return false;
+
+  if (cl_transfer_buffer_)
+    Send(new OpenCLChannelMsg_DestroyTransferBuffer(cl_transfer_buffer_id_));
+
+  cl_transfer_buffer_ = shm.Pass();
+  cl_transfer_buffer_id_ = id;
+  cl_transfer_buffer_size_ = new_size;
+  return true;
+}
+
+cl_int GpuChannelHost::EnqueueCLTransfer(
+    bool write,
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    size_t offset,
+    size_t size,
+    unsigned char* ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* clevent) {
+  cl_transfer_lock_.AssertAcquired();
+  unsigned char* staging =
+      static_cast<unsigned char*>(cl_transfer_buffer_->memory());
+  std::vector<cl_point> point_list;
+  std::vector<size_t> size_t_list(3);
+  cl_point clevent_ret = 0;
+  cl_int errcode_ret = CL_SUCCESS;
+
+  for (size_t done = 0; done < size;) {
+    size_t chunk = std::min(size - done, cl_transfer_buffer_size_);
+    bool want_event = clevent != NULL && done + chunk == size;
+
+    // Only the first chunk waits on the caller's events. Every chunk is
+    // blocking on the GPU side, so the rest are ordered behind it.
+    cl_uint num_events = done ? 0 : num_events_in_wait_list;
+    point_list.clear();
+    point_list.push_back((cl_point) command_queue);
+    point_list.push_back((cl_point) buffer);
+    for (cl_uint index = 0; event_wait_list && index < num_events; ++index)
+      point_list.push_back((cl_point) event_wait_list[index]);
+
+    size_t_list[0] = offset + done;
+    size_t_list[1] = chunk;
+    size_t_list[2] = 0;
+
+    if (write) {
+      memcpy(staging, ptr + done, chunk);
+      if (!Send(new OpenCLChannelMsg_EnqueueWriteBufferShm(
+              point_list, size_t_list, cl_transfer_buffer_id_, num_events,
+              want_event, &clevent_ret, &errcode_ret))) {
+        return CL_SEND_IPC_MESSAGE_FAILURE;
+      }
+    } else {
+      if (!Send(new OpenCLChannelMsg_EnqueueReadBufferShm(
+              point_list, size_t_list, cl_transfer_buffer_id_, num_events,
+              want_event, &clevent_ret, &errcode_ret))) {
+        return CL_SEND_IPC_MESSAGE_FAILURE;
+      }
+    }
+    if (CL_SUCCESS != errcode_ret)
+      return errcode_ret;
+
+    if (!write)
+      memcpy(ptr + done, staging, chunk);
+    done += chunk;
+  }
 
   if (clevent != NULL)
-    point_out_val = 0;
+    *clevent = (cl_event) clevent_ret;
 
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_EnqueueReadBufferRect(point_in_list, blocking_read, size_t_list, point_ptr, num_events_in_wait_list, &point_out_val, &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
+  return errcode_ret;
+}
+
+cl_int GpuChannelHost::EnqueueCLRectTransfer(
+    bool write,
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    const size_t* buffer_origin,
+    const size_t* host_origin,
+    const size_t* region,
+    size_t buffer_row_pitch,
+    size_t buffer_slice_pitch,
+    size_t host_row_pitch,
+    size_t host_slice_pitch,
+    unsigned char* ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* clevent) {
+  cl_transfer_lock_.AssertAcquired();
+  unsigned char* staging =
+      static_cast<unsigned char*>(cl_transfer_buffer_->memory());
+  std::vector<cl_point> point_list;
+  std::vector<size_t> size_t_list(9);
+  cl_point clevent_ret = 0;
+  cl_int errcode_ret = CL_SUCCESS;
+
+  // Split the region into boxes that fit the transfer buffer: whole slices
+  // if one fits, else whole rows, else pieces of a row.
+  const size_t capacity = cl_transfer_buffer_size_;
+  size_t step[3];
+  step[0] = std::min(region[0], capacity);
+  step[1] = step[0] < region[0] ?
+      1 : std::min(region[1], capacity / region[0]);
+  step[2] = step[0] < region[0] || step[1] < region[1] ?
+      1 : std::min(region[2], capacity / (region[0] * region[1]));
+
+  bool first = true;
+  for (size_t z = 0; z < region[2]; z += step[2]) {
+    for (size_t y = 0; y < region[1]; y += step[1]) {
+      for (size_t x = 0; x < region[0]; x += step[0]) {
+        size_t box[3] = { std::min(step[0], region[0] - x),
+                          std::min(step[1], region[1] - y),
+                          std::min(step[2], region[2] - z) };
+        bool last = x + box[0] == region[0] && y + box[1] == region[1] &&
+                    z + box[2] == region[2];
+        bool want_event = clevent != NULL && last;
+
+        // As in EnqueueCLTransfer, only the first box waits on the
+        // caller's events.
+        cl_uint num_events = first ? num_events_in_wait_list : 0;
+        point_list.clear();
+        point_list.push_back((cl_point) command_queue);
+        point_list.push_back((cl_point) buffer);
+        for (cl_uint index = 0; event_wait_list && index < num_events; ++index)
+          point_list.push_back((cl_point) event_wait_list[index]);
+
+        size_t_list[0] = buffer_origin[0] + x;
+        size_t_list[1] = buffer_origin[1] + y;
+        size_t_list[2] = buffer_origin[2] + z;
+        size_t_list[3] = box[0];
+        size_t_list[4] = box[1];
+        size_t_list[5] = box[2];
+        size_t_list[6] = buffer_row_pitch;
+        size_t_list[7] = buffer_slice_pitch;
+        size_t_list[8] = 0;
+
+        if (write) {
+          CopyCLRectRows(true, staging, ptr, host_origin, x, y, z, box,
+                         host_row_pitch, host_slice_pitch);
+          if (!Send(new OpenCLChannelMsg_EnqueueWriteBufferRect(
+                  point_list, size_t_list, cl_transfer_buffer_id_,
+                  num_events, want_event, &clevent_ret, &errcode_ret))) {
+            return CL_SEND_IPC_MESSAGE_FAILURE;
+          }
+        } else {
+          if (!Send(new OpenCLChannelMsg_EnqueueReadBufferRect(
+                  point_list, size_t_list, cl_transfer_buffer_id_,
+                  num_events, want_event, &clevent_ret, &errcode_ret))) {
+            return CL_SEND_IPC_MESSAGE_FAILURE;
+          }
+        }
+        if (CL_SUCCESS != errcode_ret)
+          return errcode_ret;
+
+        if (!write) {
+          CopyCLRectRows(false, staging, ptr, host_origin, x, y, z, box,
+                         host_row_pitch, host_slice_pitch);
+        }
+        first = false;
+      }
+    }
   }
 
   if (clevent != NULL)
-    *clevent = (cl_event) point_out_val;
+    *clevent = (cl_event) clevent_ret;
 
   return errcode_ret;
 }
 
+cl_int GpuChannelHost::CallclEnqueueReadBufferRect(cl_command_queue command_queue, cl_mem buffer,cl_bool blocking_read, const size_t *buffer_origin,
+  const size_t *host_origin, const size_t *region,size_t buffer_row_pitch, size_t buffer_slice_pitch,
+  size_t host_row_pitch, size_t host_slice_pitch,void *ptr, cl_uint num_events_in_wait_list,const cl_event *event_wait_list, cl_event * clevent)
+{
+  // The region travels through the transfer buffer; the rest of the buffer
+  // stays in the GPU process. The read is always blocking.
+  if (!buffer_origin || !host_origin || !region || !ptr ||
+      !region[0] || !region[1] || !region[2])
+    return CL_INVALID_VALUE;
+
+  ResolveCLRectPitches(region, &buffer_row_pitch, &buffer_slice_pitch);
+  ResolveCLRectPitches(region, &host_row_pitch, &host_slice_pitch);
+
+  AutoLock lock(cl_transfer_lock_);
+  if (!EnsureCLTransferBuffer(std::min(region[0] * region[1] * region[2],
+                                       kCLTransferBufferMaxSize)))
+    return CL_OUT_OF_HOST_MEMORY;
+  return EnqueueCLRectTransfer(false, command_queue, buffer, buffer_origin,
+                               host_origin, region, buffer_row_pitch,
+                               buffer_slice_pitch, host_row_pitch,
+                               host_slice_pitch, (unsigned char*) ptr,
+                               num_events_in_wait_list, event_wait_list,
+                               clevent);
+}
+
 cl_int GpuChannelHost::CallclEnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer,cl_bool blocking_write, size_t offset, size_t size,
   const void *ptr, cl_uint num_events_in_wait_list,const cl_event *event_wait_list, cl_event * clevent)
 {
@@ -3599,6 +4105,16 @@ cl_int GpuChannelHost::CallclEnqueueWriteBuffer(cl_command_queue command_queue,
   for (cl_uint index = 0; event_wait_list && index < num_events_in_wait_list; ++index)
     point_list.push_back((cl_point) event_wait_list[index]);
 
+  if (size >= kCLTransferBufferThreshold) {
+    AutoLock lock(cl_transfer_lock_);
+    if (EnsureCLTransferBuffer(std::min(size, kCLTransferBufferMaxSize))) {
+      return EnqueueCLTransfer(true, command_queue, buffer, offset, size,
+                               (unsigned char*) ptr,
+                               num_events_in_wait_list, event_wait_list,
+                               clevent);
+    }
+  }
+
   size_t_list.clear();
   size_t_list.push_back(offset);
   size_t_list.push_back(size);
@@ -3628,54 +4144,60 @@ cl_int GpuChannelHost::CallclEnqueueWriteBufferRect(cl_command_queue command_que
   const size_t *host_origin,const size_t *region, size_t buffer_row_pitch,size_t buffer_slice_pitch, size_t host_row_pitch,size_t host_slice_pitch, const void *ptr,
   cl_uint num_events_in_wait_list,const cl_event *event_wait_list, cl_event * clevent)
 {
-  cl_point point_out_val = (size_t) -1;
-  cl_int errcode_ret;
-  std::vector<cl_point> point_in_list;
-  std::vector<size_t> size_t_list;
-  cl_point point_ptr;
-
-  point_in_list.clear();
-  for (cl_uint index = 0; index < num_events_in_wait_list; ++index)
-    point_in_list.push_back((cl_point) event_wait_list[index]);
-
-  if (clevent != NULL)
-    point_out_val = 0;
-
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_EnqueueWriteBufferRect(point_in_list, blocking_write, size_t_list, point_ptr, num_events_in_wait_list, &point_out_val, &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
-  }
-
-  if (clevent != NULL)
-    *clevent = (cl_event) point_out_val;
-
-  return errcode_ret;
+  // Only the bytes of the region are copied to the GPU process, so patching
+  // a small part of a large buffer costs the size of the patch. The write
+  // is always blocking.
+  if (!buffer_origin || !host_origin || !region || !ptr ||
+      !region[0] || !region[1] || !region[2])
+    return CL_INVALID_VALUE;
+
+  ResolveCLRectPitches(region, &buffer_row_pitch, &buffer_slice_pitch);
+  ResolveCLRectPitches(region, &host_row_pitch, &host_slice_pitch);
+
+  AutoLock lock(cl_transfer_lock_);
+  if (!EnsureCLTransferBuffer(std::min(region[0] * region[1] * region[2],
+                                       kCLTransferBufferMaxSize)))
+    return CL_OUT_OF_HOST_MEMORY;
+  return EnqueueCLRectTransfer(true, command_queue, buffer, buffer_origin,
+                               host_origin, region, buffer_row_pitch,
+                               buffer_slice_pitch, host_row_pitch,
+                               host_slice_pitch, (unsigned char*) ptr,
+                               num_events_in_wait_list, event_wait_list,
+                               clevent);
 }
 
 cl_int GpuChannelHost::CallclEnqueueFillBuffer(cl_command_queue command_queue,cl_mem buffer, const void *pattern,size_t pattern_size, size_t offset, size_t size,
   cl_uint num_events_in_wait_list,const cl_event *event_wait_list, cl_event * clevent)
 {
-  cl_point point_out_val = (size_t) -1;
+  // Sending a Sync IPC Message, to call a clEnqueueFillBuffer API
+  // in other process, and getting the results of the API. Only the pattern
+  // crosses the channel.
   cl_int errcode_ret;
-  std::vector<cl_point> point_in_list;
-  std::vector<size_t> size_t_list;
-  cl_point point_pattren = (cl_point) pattern;
   std::vector<cl_point> point_list;
+  std::vector<unsigned char> pattern_list;
+  std::vector<size_t> size_t_list;
+  cl_point clevent_ret;
 
-  point_in_list.clear();
-  for (cl_uint index = 0; index < num_events_in_wait_list; ++index)
-    point_in_list.push_back((cl_point) event_wait_list[index]);
+  if (!pattern || !pattern_size)
+    return CL_INVALID_VALUE;
 
-  if (clevent != NULL)
-    point_out_val = 0;
+  point_list.push_back((cl_point) command_queue);
+  point_list.push_back((cl_point) buffer);
+  for (cl_uint index = 0; event_wait_list && index < num_events_in_wait_list; ++index)
+    point_list.push_back((cl_point) event_wait_list[index]);
+
+  pattern_list.assign((const unsigned char*) pattern,
+                      (const unsigned char*) pattern + pattern_size);
+  size_t_list.push_back(offset);
+  size_t_list.push_back(size);
 
   // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_EnqueueFillBuffer(point_list, point_pattren, size_t_list, num_events_in_wait_list, point_in_list, &point_out_val, &errcode_ret))) {
+  if (!Send(new OpenCLChannelMsg_EnqueueFillBuffer(point_list, pattern_list, size_t_list, num_events_in_wait_list, clevent != NULL, &clevent_ret, &errcode_ret))) {
     return CL_SEND_IPC_MESSAGE_FAILURE;
   }
 
   if (clevent != NULL)
-    *clevent = (cl_event) point_out_val;
+    *clevent = (cl_event) clevent_ret;
 
   return errcode_ret;
 }
@@ -3901,24 +4423,88 @@ cl_int GpuChannelHost::CallclEnqueueCopyBufferToImage(cl_command_queue command_q
 void * GpuChannelHost::CallclEnqueueMapBuffer(cl_command_queue command_queue, cl_mem buffer,cl_bool blocking_map, cl_map_flags map_flags,size_t offset, size_t size, 
   cl_uint num_events_in_wait_list,const cl_event *event_wait_list, cl_event * clevent,cl_int *errcode_ret)
 {
-  cl_point point_out_val = (size_t) -1;
-  std::vector<cl_point> point_in_list;
+  // The mapping is a shared memory region of |size| bytes registered as a
+  // transfer buffer. Unless the caller is going to overwrite it, the region
+  // is read into it before returning, so mapping is always blocking.
+  cl_int errcode = CL_SUCCESS;
   std::vector<cl_point> point_list;
   std::vector<size_t> size_t_list;
-  cl_point point_ptr_ret;
+  cl_point clevent_ret = 0;
+  if (errcode_ret)
+    *errcode_ret = CL_SUCCESS;
 
-  point_in_list.clear();
-  for (cl_uint index = 0; index < num_events_in_wait_list; ++index)
-    point_in_list.push_back((cl_point) event_wait_list[index]);
+  if (!size) {
+    if (errcode_ret)
+      *errcode_ret = CL_INVALID_VALUE;
+    return NULL;
+  }
 
-  if (clevent != NULL)
-    point_out_val = 0;
+  linked_ptr<CLMapping> mapping(new CLMapping);
+  mapping->shared_memory = factory_->AllocateSharedMemory(size);
+  if (!mapping->shared_memory || !mapping->shared_memory->Map(size)) {
+    if (errcode_ret)
+      *errcode_ret = CL_MAP_FAILURE;
+    return NULL;
+  }
+  base::SharedMemoryHandle handle =
+      ShareToGpuProcess(mapping->shared_memory->handle());
+  if (!base::SharedMemory::IsHandleValid(handle)) {
+    if (errcode_ret)
+      *errcode_ret = CL_MAP_FAILURE;
+    return NULL;
+  }
+  mapping->transfer_buffer_id = ReserveTransferBufferId();
+  mapping->buffer = buffer;
+  mapping->offset = offset;
+  mapping->size = size;
+  mapping->map_flags = map_flags;
+  if (!Send(new OpenCLChannelMsg_RegisterTransferBuffer(
+          mapping->transfer_buffer_id, handle, size))) {
+    if (errcode_ret)
+      *errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
+    return NULL;
+  }
 
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_EnqueueMapBuffer(point_list, blocking_map, map_flags, size_t_list, &point_out_val, errcode_ret, &point_ptr_ret))) {
+  if (map_flags & CL_MAP_WRITE_INVALIDATE_REGION) {
+    // Nothing to read, but the caller's events are still honoured.
+    if (clevent) {
+      errcode = CallclEnqueueMarkerWithWaitList(
+          command_queue, num_events_in_wait_list, event_wait_list, clevent);
+      if (CL_SUCCESS == errcode)
+        errcode = CallclWaitForEvents(1, clevent);
+    } else if (num_events_in_wait_list) {
+      errcode = CallclWaitForEvents(num_events_in_wait_list, event_wait_list);
+    }
+  } else {
+    point_list.push_back((cl_point) command_queue);
+    point_list.push_back((cl_point) buffer);
+    for (cl_uint index = 0; event_wait_list && index < num_events_in_wait_list; ++index)
+      point_list.push_back((cl_point) event_wait_list[index]);
+    size_t_list.push_back(offset);
+    size_t_list.push_back(size);
+    size_t_list.push_back(0);
+    if (!Send(new OpenCLChannelMsg_EnqueueReadBufferShm(
+            point_list, size_t_list, mapping->transfer_buffer_id,
+            num_events_in_wait_list, clevent != NULL, &clevent_ret,
+            &errcode))) {
+      errcode = CL_SEND_IPC_MESSAGE_FAILURE;
+    }
+    if (CL_SUCCESS == errcode && clevent != NULL)
+      *clevent = (cl_event) clevent_ret;
+  }
+
+  if (CL_SUCCESS != errcode) {
+    Send(new OpenCLChannelMsg_DestroyTransferBuffer(
+        mapping->transfer_buffer_id));
+    if (errcode_ret)
+      *errcode_ret = errcode;
     return NULL;
   }
-  return (void*) point_ptr_ret;
+
+  void* mapped_ptr = mapping->shared_memory->memory();
+  AutoLock lock(cl_mappings_lock_);
+  cl_mappings_[mapped_ptr] = mapping;
+  return mapped_ptr;
 }
 
 void * GpuChannelHost::CallclEnqueueMapImage(cl_command_queue command_queue, cl_mem image,cl_bool blocking_map, cl_map_flags map_flags,const size_t *origin, const size_t *region,
@@ -3947,28 +4533,46 @@ void * GpuChannelHost::CallclEnqueueMapImage(cl_command_queue command_queue, cl_
 cl_int GpuChannelHost::CallclEnqueueUnmapMemObject(cl_command_queue command_queue,cl_mem memobj, void *mapped_ptr,cl_uint num_events_in_wait_list,
   const cl_event *event_wait_list, cl_event * clevent)
 {
-  cl_point point_out_val = (size_t) -1;
-  cl_int errcode_ret;
-  std::vector<cl_point> point_in_list;
-  cl_point point_command_queue = (cl_point) command_queue;
-  cl_point point_memobj = (cl_point) memobj;
-  cl_point point_mapped_ptr = (cl_point) mapped_ptr;
-
-  point_in_list.clear();
-  for (cl_uint index = 0; index < num_events_in_wait_list; ++index)
-    point_in_list.push_back((cl_point) event_wait_list[index]);
-
-  if (clevent != NULL)
-    point_out_val = 0;
+  // Writes a region mapped for writing back from its shared memory, then
+  // releases the mapping. Read-only mappings never touch the buffer.
+  cl_int errcode_ret = CL_SUCCESS;
+  std::vector<cl_point> point_list;
+  std::vector<size_t> size_t_list;
+  cl_point clevent_ret = 0;
 
-  // Send a Sync IPC Message and wait for the results.
-  if (!Send(new OpenCLChannelMsg_EnqueueUnmapMemObject(point_command_queue, point_memobj, point_mapped_ptr, num_events_in_wait_list, point_in_list, &point_out_val, &errcode_ret))) {
-    return CL_SEND_IPC_MESSAGE_FAILURE;
+  linked_ptr<CLMapping> mapping;
+  {
+    AutoLock lock(cl_mappings_lock_);
+    CLMappingMap::iterator it = cl_mappings_.find(mapped_ptr);
+    if (it == cl_mappings_.end() || it->second->buffer != memobj)
+      return CL_INVALID_VALUE;
+    mapping = it->second;
+    cl_mappings_.erase(it);
+  }
+
+  if (mapping->map_flags & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION)) {
+    point_list.push_back((cl_point) command_queue);
+    point_list.push_back((cl_point) memobj);
+    for (cl_uint index = 0; event_wait_list && index < num_events_in_wait_list; ++index)
+      point_list.push_back((cl_point) event_wait_list[index]);
+    size_t_list.push_back(mapping->offset);
+    size_t_list.push_back(mapping->size);
+    size_t_list.push_back(0);
+    if (!Send(new OpenCLChannelMsg_EnqueueWriteBufferShm(
+            point_list, size_t_list, mapping->transfer_buffer_id,
+            num_events_in_wait_list, clevent != NULL, &clevent_ret,
+            &errcode_ret))) {
+      errcode_ret = CL_SEND_IPC_MESSAGE_FAILURE;
+    }
+    if (CL_SUCCESS == errcode_ret && clevent != NULL)
+      *clevent = (cl_event) clevent_ret;
+  } else if (clevent) {
+    errcode_ret = CallclEnqueueMarkerWithWaitList(
+        command_queue, num_events_in_wait_list, event_wait_list, clevent);
   }
 
-  if (clevent != NULL)
-    *clevent = (cl_event) point_out_val;
-
+  Send(new OpenCLChannelMsg_DestroyTransferBuffer(
+      mapping->transfer_buffer_id));
   return errcode_ret;
 }
 
@@ -4021,6 +4625,20 @@ cl_int GpuChannelHost::CallclEnqueueNDRangeKernel(cl_command_queue command_queue
   for (cl_uint index = 0; index < num_events_in_wait_list; ++index)
     event_list.push_back((cl_point) event_wait_list[index]);
 
+  // Without an event to hand back there is nothing to wait for: queue the
+  // launch and send it along with the kernel arguments batched before it.
+  if (clevent == NULL) {
+    OpenCLCommand command(OpenCLCommand::ENQUEUE_ND_RANGE_KERNEL);
+    command.handles = point_list;
+    command.handles.insert(command.handles.end(),
+                           event_list.begin(), event_list.end());
+    command.sizes.push_back(work_dim);
+    command.sizes.insert(command.sizes.end(),
+                         size_t_list.begin(), size_t_list.end());
+    AppendCLCommand(command, true);
+    return CL_SUCCESS;
+  }
+
   // Send a Sync IPC Message and wait for the results.
   if (!Send(new OpenCLChannelMsg_EnqueueNDRangeKernel(point_list, work_dim, size_t_list, event_list, (cl_point*)&event_ret, &errcode_ret))) {
     return CL_SEND_IPC_MESSAGE_FAILURE;
@@ -4686,6 +5304,21 @@ cl_int CallclSetKernelArg_vector(
       arg_value);
 }
 
+cl_int CallclSetKernelArgs(
+  GpuChannelHost* channel_host_,
+  cl_kernel kernel,
+  cl_uint num_args,
+  const cl_uint* arg_indices,
+  const size_t* arg_sizes,
+  const void* arg_values){
+    return channel_host_ ->CallclSetKernelArgs(
+      kernel,
+      num_args,
+      arg_indices,
+      arg_sizes,
+      arg_values);
+}
+
 cl_int CallclGetKernelInfo(
   GpuChannelHost* channel_host_,
   cl_kernel kernel,
@@ -4821,6 +5454,17 @@ cl_int CallclFinish(GpuChannelHost* channel_host_, cl_command_queue command_queu
   return channel_host_ ->CallclFinish(command_queue);
 }
 
+cl_int CallclFinishAsync(
+  GpuChannelHost* channel_host_,
+  cl_command_queue command_queue,
+  void (CL_CALLBACK *pfn_notify)(cl_int, void*),
+  void* user_data) {
+    return channel_host_->CallclFinishAsync(
+      command_queue,
+      pfn_notify,
+      user_data);
+}
+
 cl_int CallclEnqueueReadBuffer(
   GpuChannelHost* channel_host_, 
   cl_command_queue command_queue,
@@ -5,18 +5,23 @@
 #ifndef CONTENT_COMMON_GPU_CLIENT_GPU_CHANNEL_HOST_H_
 #define CONTENT_COMMON_GPU_CLIENT_GPU_CHANNEL_HOST_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
 #include "base/atomic_sequence_num.h"
+#include "base/callback.h"
 #include "base/containers/hash_tables.h"
+#include "base/memory/linked_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/shared_memory.h"
 #include "base/memory/weak_ptr.h"
 #include "base/process/process.h"
 #include "base/synchronization/lock.h"
 #include "content/common/content_export.h"
 #include "content/common/gpu/gpu_process_launch_causes.h"
+#include "content/common/gpu/opencl_command.h"
 #include "content/common/message_router.h"
 #include "gpu/config/gpu_info.h"
 #include "ipc/ipc_channel_handle.h"
@@ -221,12 +226,21 @@ class GpuChannelHost : public IPC::Sender,
     // for sending the GpuChannelMsg_GenerateMailboxNamesAsync message.
     size_t GetMailboxNames(size_t num, std::vector<gpu::Mailbox>* names);
 
+    // Registers |callback| to run on |loop| when OpenCLChannelMsg_
+    // EventCallbackFired arrives for |callback_id|. Each callback runs once;
+    // if the channel is lost first, it runs with CL_SEND_IPC_MESSAGE_FAILURE.
+    void AddCLCallback(int32 callback_id,
+                       const base::Callback<void(cl_int)>& callback,
+                       scoped_refptr<base::MessageLoopProxy> loop);
+    void RemoveCLCallback(int32 callback_id);
+
    private:
     virtual ~MessageFilter();
     bool OnControlMessageReceived(const IPC::Message& msg);
 
     // Message handlers.
     void OnGenerateMailboxNamesReply(const std::vector<gpu::Mailbox>& names);
+    void OnCLEventCallbackFired(int32 callback_id, cl_int status);
 
     // Threading notes: |listeners_| is only accessed on the IO thread. Every
     // other field is protected by |lock_|.
@@ -244,6 +258,14 @@ class GpuChannelHost : public IPC::Sender,
 
     // Number of pending mailbox requested from the GPU process.
     size_t requested_mailboxes_;
+
+    // Pending OpenCL event and finish callbacks, by callback id.
+    struct CLCallbackInfo {
+      base::Callback<void(cl_int)> callback;
+      scoped_refptr<base::MessageLoopProxy> loop;
+    };
+    typedef base::hash_map<int32, CLCallbackInfo> CLCallbackMap;
+    CLCallbackMap cl_callbacks_;
   };
 
   // Threading notes: all fields are constant during the lifetime of |this|
@@ -275,6 +297,117 @@ class GpuChannelHost : public IPC::Sender,
   typedef base::hash_map<int, CommandBufferProxyImpl*> ProxyMap;
   ProxyMap proxies_;
 
+  // Sends |msg| without flushing the OpenCL command batch first.
+  bool SendUnbatched(IPC::Message* msg);
+
+  // Queues an OpenCL call whose only result is an error code. The batch is
+  // sent when |flush| is set, when it grows large, or ahead of any other
+  // message. Errors come back from the next synchronization point.
+  void AppendCLCommand(const OpenCLCommand& command, bool flush);
+
+  // Sends the queued OpenCL commands, if any.
+  bool FlushCLCommandBatch();
+
+  // Returns a new id for an OpenCL object created through the command batch.
+  // The GPU process maps it to the real object.
+  uint32 AllocateCLHandleId();
+
+  // Makes sure the OpenCL transfer buffer holds at least |size| bytes,
+  // replacing it with a larger one if needed. |cl_transfer_lock_| must be
+  // held.
+  bool EnsureCLTransferBuffer(size_t size);
+
+  // Runs clEnqueueReadBuffer/clEnqueueWriteBuffer through the transfer
+  // buffer, one blocking call per buffer-sized chunk. |cl_transfer_lock_|
+  // must be held.
+  cl_int EnqueueCLTransfer(bool write,
+                           cl_command_queue command_queue,
+                           cl_mem buffer,
+                           size_t offset,
+                           size_t size,
+                           unsigned char* ptr,
+                           cl_uint num_events_in_wait_list,
+                           const cl_event* event_wait_list,
+                           cl_event* clevent);
+
+  // Runs clEnqueueReadBufferRect/clEnqueueWriteBufferRect through the
+  // transfer buffer. Only the rows of |region| are staged, packed back to
+  // back, in as many blocking calls as the transfer buffer needs. Pitches
+  // must not be zero. |cl_transfer_lock_| must be held.
+  cl_int EnqueueCLRectTransfer(bool write,
+                               cl_command_queue command_queue,
+                               cl_mem buffer,
+                               const size_t* buffer_origin,
+                               const size_t* host_origin,
+                               const size_t* region,
+                               size_t buffer_row_pitch,
+                               size_t buffer_slice_pitch,
+                               size_t host_row_pitch,
+                               size_t host_slice_pitch,
+                               unsigned char* ptr,
+                               cl_uint num_events_in_wait_list,
+                               const cl_event* event_wait_list,
+                               cl_event* clevent);
+
+  // Protects the OpenCL transfer buffer, which is shared by every caller of
+  // CallclEnqueueReadBuffer/CallclEnqueueWriteBuffer on this channel.
+  base::Lock cl_transfer_lock_;
+  scoped_ptr<base::SharedMemory> cl_transfer_buffer_;
+  int32 cl_transfer_buffer_id_;
+  size_t cl_transfer_buffer_size_;
+
+  // Protects the OpenCL command batch. Held while the batch is sent so that
+  // messages from other threads cannot overtake it.
+  base::Lock cl_batch_lock_;
+  std::vector<OpenCLCommand> cl_batch_;
+  size_t cl_batch_bytes_;
+
+  // A region mapped by CallclEnqueueMapBuffer. The mapped pointer is
+  // shared memory the GPU process reads the region into at map time and
+  // writes back from at unmap time, if it was mapped for writing.
+  struct CLMapping {
+    scoped_ptr<base::SharedMemory> shared_memory;
+    int32 transfer_buffer_id;
+    cl_mem buffer;
+    size_t offset;
+    size_t size;
+    cl_map_flags map_flags;
+  };
+  typedef std::map<void*, linked_ptr<CLMapping> > CLMappingMap;
+  base::Lock cl_mappings_lock_;
+  CLMappingMap cl_mappings_;
+
+  // OpenCL handle ids are allocated in sequence.
+  base::AtomicSequenceNumber next_cl_handle_id_;
+
+  // Ids matching OpenCLChannelMsg_EventCallbackFired to its callback.
+  base::AtomicSequenceNumber next_cl_callback_id_;
+
+  // Answers a query for an immutable device or platform parameter, see
+  // content/common/gpu/opencl_info.h. The first query for an object fetches
+  // all of its immutable parameters in one round trip. Returns false if
+  // |param_name| is not cached, in which case the caller asks the GPU
+  // process as usual.
+  bool GetCachedCLInfo(bool device,
+                       cl_point object,
+                       cl_uint param_name,
+                       size_t param_value_size,
+                       void* param_value,
+                       size_t* param_value_size_ret,
+                       cl_int* errcode_ret);
+
+  struct CLInfoValue {
+    cl_int errcode;
+    std::vector<unsigned char> value;
+  };
+  typedef std::map<cl_uint, CLInfoValue> CLInfoValueMap;
+  typedef base::hash_map<cl_point, CLInfoValueMap> CLInfoCache;
+
+  // Protects the device and platform info caches.
+  base::Lock cl_info_lock_;
+  CLInfoCache cl_device_info_;
+  CLInfoCache cl_platform_info_;
+
 
 
 
@@ -531,6 +664,15 @@ class GpuChannelHost : public IPC::Sender,
       size_t,
       const void*);
 
+  // Sets |num_args| arguments of |kernel| in one batched command.
+  // |arg_values| holds the values back to back, |arg_sizes[i]| bytes each.
+  cl_int CallclSetKernelArgs(
+      cl_kernel,
+      cl_uint,
+      const cl_uint*,
+      const size_t*,
+      const void*);
+
   cl_int CallclGetKernelInfo(
       cl_kernel,
       cl_kernel_info,
@@ -595,6 +737,14 @@ class GpuChannelHost : public IPC::Sender,
 
   cl_int CallclFinish (cl_command_queue);
 
+  // Returns at once; |pfn_notify| runs on the calling thread's message loop
+  // when everything queued on |command_queue| has completed, with CL_SUCCESS
+  // or the error that stopped it.
+  cl_int CallclFinishAsync(
+      cl_command_queue,
+      void (CL_CALLBACK*)(cl_int, void*),
+      void*);
+
   cl_int CallclEnqueueReadBuffer(
       cl_command_queue,
       cl_mem,
@@ -1192,6 +1342,14 @@ cl_int CallclSetKernelArg_vector(
     size_t,
     const void*);
 
+cl_int CallclSetKernelArgs(
+    GpuChannelHost*,
+    cl_kernel,
+    cl_uint,
+    const cl_uint*,
+    const size_t*,
+    const void*);
+
 cl_int CallclGetKernelInfo(
     GpuChannelHost*,
     cl_kernel,
@@ -1266,6 +1424,12 @@ cl_int CallclFlush(GpuChannelHost*, cl_command_queue);
 
 cl_int CallclFinish (GpuChannelHost*, cl_command_queue);
 
+cl_int CallclFinishAsync(
+    GpuChannelHost*,
+    cl_command_queue,
+    void (CL_CALLBACK*)(cl_int, void*),
+    void*);
+
 cl_int CallclEnqueueReadBuffer(
     GpuChannelHost*, 
     cl_command_queue,
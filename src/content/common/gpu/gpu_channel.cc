@@ -9,6 +9,7 @@
 #include "content/common/gpu/gpu_channel.h"
 #include "third_party/angle_dx11/include/sv_cl_gl.h"
 
+#include <limits>
 #include <queue>
 #include <vector>
 
@@ -21,6 +22,8 @@
 #include "base/timer/timer.h"
 #include "content/common/gpu/gpu_channel_manager.h"
 #include "content/common/gpu/gpu_messages.h"
+#include "content/common/gpu/opencl_info.h"
+#include "content/common/gpu/opencl_program_cache.h"
 #include "content/common/gpu/media/gpu_video_encode_accelerator.h"
 #include "content/common/gpu/sync_point_manager.h"
 #include "content/public/common/content_switches.h"
@@ -64,6 +67,35 @@ const int64 kMaxPreemptTimeMs = kVsyncIntervalMs;
 // below this threshold.
 const int64 kStopPreemptThresholdMs = kVsyncIntervalMs;
 
+// Most memory the buffers released by a page may keep allocated on the device
+// while waiting to be reused.
+const size_t kCLBufferPoolMaxIdleBytes = 64 * 1024 * 1024;
+
+// Queries every parameter in |param_names| of |object| through |get_info|,
+// which is clGetPlatformInfo or clGetDeviceInfo.
+template <typename Object, typename GetInfo>
+void GetCLInfoList(GetInfo get_info,
+                   Object object,
+                   const std::vector<cl_uint>& param_names,
+                   std::vector<std::vector<unsigned char>>* param_values,
+                   std::vector<cl_int>* errcodes) {
+  param_values->resize(param_names.size());
+  errcodes->resize(param_names.size());
+
+  for (size_t i = 0; i < param_names.size(); ++i) {
+    size_t size = 0;
+    cl_int errcode = get_info(object, param_names[i], 0, NULL, &size);
+    std::vector<unsigned char>& value = (*param_values)[i];
+    if (CL_SUCCESS == errcode && size) {
+      value.resize(size);
+      errcode = get_info(object, param_names[i], size, &value[0], NULL);
+    }
+    if (CL_SUCCESS != errcode)
+      value.clear();
+    (*errcodes)[i] = errcode;
+  }
+}
+
 }  // anonymous namespace
 
 // This filter does three things:
@@ -432,6 +464,119 @@ class GpuChannelMessageFilter : public IPC::ChannelProxy::MessageFilter {
   crypto::HMAC hmac_;
 };
 
+// Runs on the IO thread and hands OpenCL messages straight to the channel's
+// OpenCL thread, so they neither wait behind nor delay the GL command buffer
+// messages queued for the main thread. Must be added ahead of
+// GpuChannelMessageFilter, which counts every message it lets through
+// towards preemption. Also sends the messages that originate from OpenCL
+// event callbacks, which run on threads owned by the OpenCL runtime.
+class OpenCLMessageFilter : public IPC::ChannelProxy::MessageFilter {
+ public:
+  // |gpu_channel| owns the OpenCL thread and stops it before going away,
+  // after which tasks posted to |cl_message_loop| are dropped. A NULL
+  // |cl_message_loop| leaves the OpenCL messages to the main thread.
+  OpenCLMessageFilter(GpuChannel* gpu_channel,
+                      scoped_refptr<base::MessageLoopProxy> cl_message_loop,
+                      scoped_refptr<base::MessageLoopProxy> io_message_loop)
+      : gpu_channel_(gpu_channel),
+        cl_message_loop_(cl_message_loop),
+        io_message_loop_(io_message_loop),
+        channel_(NULL) {
+  }
+
+  virtual void OnFilterAdded(IPC::Channel* channel) OVERRIDE {
+    DCHECK(!channel_);
+    channel_ = channel;
+  }
+
+  virtual void OnFilterRemoved() OVERRIDE {
+    DCHECK(channel_);
+    channel_ = NULL;
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    if (!cl_message_loop_.get() ||
+        !GpuChannel::IsOpenCLMessage(message.type()) ||
+        GpuChannel::IsOpenCLGLInteropMessage(message.type()))
+      return false;
+
+    cl_message_loop_->PostTask(FROM_HERE, base::Bind(
+        &GpuChannel::HandleOpenCLMessage,
+        base::Unretained(gpu_channel_),
+        base::Owned(new IPC::Message(message))));
+    return true;
+  }
+
+  // Can be called on any thread. The message is dropped if the channel has
+  // gone away by the time it reaches the IO thread.
+  void Send(IPC::Message* message) {
+    io_message_loop_->PostTask(FROM_HERE, base::Bind(
+        &OpenCLMessageFilter::SendOnIOThread,
+        this,
+        base::Passed(make_scoped_ptr(message))));
+  }
+
+ protected:
+  virtual ~OpenCLMessageFilter() {}
+
+ private:
+  void SendOnIOThread(scoped_ptr<IPC::Message> message) {
+    if (channel_)
+      channel_->Send(message.release());
+  }
+
+  GpuChannel* gpu_channel_;
+  scoped_refptr<base::MessageLoopProxy> cl_message_loop_;
+  scoped_refptr<base::MessageLoopProxy> io_message_loop_;
+  IPC::Channel* channel_;
+};
+
+namespace {
+
+// Runs on the OpenCL thread, see GpuChannel::PauseOpenCLThread.
+void ParkOpenCLThread(base::WaitableEvent* paused,
+                      base::WaitableEvent* resume) {
+  paused->Signal();
+  resume->Wait();
+}
+
+// Computes the size of |region| with its rows packed back to back, as in
+// the transfer buffer of a rect read or write. Returns false for an empty
+// or overflowing region.
+bool PackedCLRectSize(const size_t* region, size_t* size) {
+  size_t packed = 1;
+  for (int i = 0; i < 3; ++i) {
+    if (!region[i] || packed > std::numeric_limits<size_t>::max() / region[i])
+      return false;
+    packed *= region[i];
+  }
+  *size = packed;
+  return true;
+}
+
+// Owned by the OpenCL runtime between clSetEventCallback and the callback.
+struct CLEventCallbackData {
+  scoped_refptr<OpenCLMessageFilter> filter;
+  int32 callback_id;
+  // Set for the markers OnCallclFinishAsync creates, which nobody else
+  // holds a reference to.
+  bool release_event;
+};
+
+// Called by the OpenCL runtime on a thread of its own.
+void CL_CALLBACK OnCLEventCallback(cl_event event,
+                                   cl_int event_command_exec_status,
+                                   void* user_data) {
+  scoped_ptr<CLEventCallbackData> data(
+      static_cast<CLEventCallbackData*>(user_data));
+  data->filter->Send(new OpenCLChannelMsg_EventCallbackFired(
+      data->callback_id, event_command_exec_status));
+  if (data->release_event)
+    clReleaseEvent(event);
+}
+
+}  // anonymous namespace
+
 GpuChannel::GpuChannel(GpuChannelManager* gpu_channel_manager,
                        GpuWatchdog* watchdog,
                        gfx::GLShareGroup* share_group,
@@ -444,6 +589,10 @@ GpuChannel::GpuChannel(GpuChannelManager* gpu_channel_manager,
       share_group_(share_group ? share_group : new gfx::GLShareGroup),
       mailbox_manager_(mailbox ? mailbox : new gpu::gles2::MailboxManager),
       image_manager_(new gpu::gles2::ImageManager),
+      cl_deferred_error_(CL_SUCCESS),
+      cl_buffer_pool_(kCLBufferPoolMaxIdleBytes),
+      cl_thread_paused_(false, false),
+      cl_thread_resume_(false, false),
       watchdog_(watchdog),
       software_(software),
       handle_messages_scheduled_(false),
@@ -481,6 +630,19 @@ bool GpuChannel::Init(base::MessageLoopProxy* io_message_loop,
   base::WeakPtr<GpuChannel>* weak_ptr(new base::WeakPtr<GpuChannel>(
       weak_factory_.GetWeakPtr()));
 
+  cl_thread_.reset(new base::Thread("OpenCLThread"));
+  scoped_refptr<base::MessageLoopProxy> cl_message_loop;
+  if (cl_thread_->Start()) {
+    cl_message_loop = cl_thread_->message_loop_proxy();
+  } else {
+    // OpenCL messages fall back to the main thread.
+    cl_thread_.reset();
+  }
+  cl_filter_ = new OpenCLMessageFilter(this, cl_message_loop, io_message_loop);
+  channel_->AddFilter(cl_filter_.get());
+  cl_memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&GpuChannel::OnCLMemoryPressure, base::Unretained(this))));
+
   filter_ = new GpuChannelMessageFilter(
       mailbox_manager_->private_key(),
       weak_ptr,
@@ -740,6 +902,9 @@ void GpuChannel::SetPreemptByFlag(
 }
 
 GpuChannel::~GpuChannel() {
+  // Runs or drops the OpenCL messages still queued; none can reach this
+  // channel afterwards.
+  cl_thread_.reset();
   if (preempting_flag_.get())
     preempting_flag_->Reset();
 }
@@ -750,6 +915,17 @@ void GpuChannel::OnDestroy() {
 }
 
 bool GpuChannel::OnControlMessageReceived(const IPC::Message& msg) {
+  // Only reached for OpenCL messages if the OpenCL thread failed to start.
+  if (IsOpenCLMessage(msg.type()) && !IsOpenCLGLInteropMessage(msg.type()))
+    return OnOpenCLMessageReceived(msg);
+
+  // GL interop calls need the GL context of this thread. Park the OpenCL
+  // thread meanwhile, so that the OpenCL messages sent before have run and
+  // none run concurrently.
+  bool cl_gl_interop = IsOpenCLGLInteropMessage(msg.type());
+  if (cl_gl_interop)
+    PauseOpenCLThread();
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(GpuChannel, msg)
     IPC_MESSAGE_HANDLER(GpuChannelMsg_CreateOffscreenCommandBuffer,
@@ -760,7 +936,60 @@ bool GpuChannel::OnControlMessageReceived(const IPC::Message& msg) {
     IPC_MESSAGE_HANDLER(GpuChannelMsg_DestroyVideoEncoder,
                         OnDestroyVideoEncoder)
 
+    // OpenCL GL interop, see IsOpenCLGLInteropMessage.
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateContext,
+                                    OnCallclCreateContext)
+	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateFromGLBuffer, OnCallclCreateFromGLBuffer);
+	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateFromGLTexture, OnCallclCreateFromGLTexture);
+	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueAcquireGLObjects, OnCallclEnqueueAcquireGLObjects);
+	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueReleaseGLObjects, OnCallclEnqueueReleaseGLObjects);
+
+
+
+
+#if defined(OS_ANDROID)
+    IPC_MESSAGE_HANDLER(GpuChannelMsg_RegisterStreamTextureProxy,
+                        OnRegisterStreamTextureProxy)
+    IPC_MESSAGE_HANDLER(GpuChannelMsg_EstablishStreamTexture,
+                        OnEstablishStreamTexture)
+    IPC_MESSAGE_HANDLER(GpuChannelMsg_SetStreamTextureSize,
+                        OnSetStreamTextureSize)
+#endif
+    IPC_MESSAGE_HANDLER(
+        GpuChannelMsg_CollectRenderingStatsForSurface,
+        OnCollectRenderingStatsForSurface)
+    IPC_MESSAGE_UNHANDLED(handled = false)
+  IPC_END_MESSAGE_MAP()
+
+  if (cl_gl_interop)
+    ResumeOpenCLThread();
+
+  DCHECK(handled) << msg.type();
+  return handled;
+}
+
+// static
+bool GpuChannel::IsOpenCLMessage(uint32 type) {
+  // Message ids follow declaration order, and gpu_messages.h keeps the
+  // OpenCL messages together, see the note there.
+  return type >= OpenCLChannelMsg_CommandBatch::ID &&
+         type <= OpenCLChannelMsg_EnqueueReleaseGLObjects::ID;
+}
+
+// static
+bool GpuChannel::IsOpenCLGLInteropMessage(uint32 type) {
+  // clCreateContext creates a context sharing with the GL one.
+  return type == OpenCLChannelMsg_CreateContext::ID ||
+         (type >= OpenCLChannelMsg_CreateFromGLBuffer::ID &&
+          type <= OpenCLChannelMsg_EnqueueReleaseGLObjects::ID);
+}
+
+bool GpuChannel::OnOpenCLMessageReceived(const IPC::Message& msg) {
+  bool handled = true;
+  IPC_BEGIN_MESSAGE_MAP(GpuChannel, msg)
     // Adding OpenCL API calling handle.
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CommandBatch,
+                                    OnCallclCommandBatch)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetPlatformIDs,
                                     OnCallclGetPlatformIDs)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetDeviceIDs,
@@ -771,8 +1000,6 @@ bool GpuChannel::OnControlMessageReceived(const IPC::Message& msg) {
                                     OnCallclRetainDevice)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_ReleaseDevice,
                                     OnCallclReleaseDevice)
-    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateContext,
-                                    OnCallclCreateContext)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateContextFromType,
                                     OnCallclCreateContextFromType)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_RetainContext,
@@ -847,6 +1074,8 @@ bool GpuChannel::OnControlMessageReceived(const IPC::Message& msg) {
                                     OnCallclSetUserEventStatus)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_SetEventCallback,
                                     OnCallclSetEventCallback)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_FinishAsync,
+                                    OnCallclFinishAsync)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_Flush,
                                     OnCallclFlush)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_Finish,
@@ -855,6 +1084,10 @@ bool GpuChannel::OnControlMessageReceived(const IPC::Message& msg) {
                                     OnCallclGetPlatformInfo_string)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetDeviceInfo_cl_uint,
                                     OnCallclGetDeviceInfo_cl_uint)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetPlatformInfoList,
+                                    OnCallclGetPlatformInfoList)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetDeviceInfoList,
+                                    OnCallclGetDeviceInfoList)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetDeviceInfo_size_t_list,
                                     OnCallclGetDeviceInfo_size_t_list)
     IPC_MESSAGE_HANDLER(OpenCLChannelMsg_GetDeviceInfo_size_t,
@@ -949,31 +1182,72 @@ bool GpuChannel::OnControlMessageReceived(const IPC::Message& msg) {
                                     OnCallclEnqueueWriteBuffer)
 	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueReadBuffer,
                                     OnCallclEnqueueReadBuffer)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_RegisterTransferBuffer,
+                                    OnRegisterCLTransferBuffer)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_DestroyTransferBuffer,
+                                    OnDestroyCLTransferBuffer)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueWriteBufferShm,
+                                    OnCallclEnqueueWriteBufferShm)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueReadBufferShm,
+                                    OnCallclEnqueueReadBufferShm)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueReadBufferRect,
+                                    OnCallclEnqueueReadBufferRect)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueWriteBufferRect,
+                                    OnCallclEnqueueWriteBufferRect)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueFillBuffer,
+                                    OnCallclEnqueueFillBuffer)
+    IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueMarkerWithWaitList,
+                                    OnCallclEnqueueMarkerWithWaitList)
 	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueNDRangeKernel, OnCallclEnqueueNDRangeKernel);
+    IPC_MESSAGE_UNHANDLED(handled = false)
+  IPC_END_MESSAGE_MAP()
+  DCHECK(handled) << msg.type();
+  return handled;
+}
 
-	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateFromGLBuffer, OnCallclCreateFromGLBuffer);
-	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_CreateFromGLTexture, OnCallclCreateFromGLTexture);
-	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueAcquireGLObjects, OnCallclEnqueueAcquireGLObjects);
-	IPC_MESSAGE_HANDLER(OpenCLChannelMsg_EnqueueReleaseGLObjects, OnCallclEnqueueReleaseGLObjects);
+void GpuChannel::HandleOpenCLMessage(IPC::Message* message) {
+  // Message ids are their line in gpu_messages.h. Together with the matching
+  // GpuChannelHost::SendOpenCLMessage event in the renderer this separates
+  // the time spent in the OpenCL runtime from the channel overhead.
+  TRACE_EVENT2("gpu", "GpuChannel::HandleOpenCLMessage",
+               "line", IPC_MESSAGE_ID_LINE(message->type()),
+               "size", message->size());
+  if (!OnOpenCLMessageReceived(*message) && message->is_sync()) {
+    // Respond to sync messages even if they were not handled.
+    IPC::Message* reply = IPC::SyncMessage::GenerateReply(message);
+    reply->set_reply_error();
+    Send(reply);
+  }
+}
 
+void GpuChannel::PauseOpenCLThread() {
+  if (!cl_thread_)
+    return;
+  cl_thread_->message_loop()->PostTask(FROM_HERE, base::Bind(
+      &ParkOpenCLThread, &cl_thread_paused_, &cl_thread_resume_));
+  cl_thread_paused_.Wait();
+}
 
+void GpuChannel::ResumeOpenCLThread() {
+  if (!cl_thread_)
+    return;
+  cl_thread_resume_.Signal();
+}
 
+void GpuChannel::OnCLMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  // |cl_thread_| is stopped before the pool goes away.
+  if (cl_thread_) {
+    cl_thread_->message_loop()->PostTask(
+        FROM_HERE,
+        base::Bind(&GpuChannel::TrimCLBufferPool, base::Unretained(this)));
+  } else {
+    TrimCLBufferPool();
+  }
+}
 
-#if defined(OS_ANDROID)
-    IPC_MESSAGE_HANDLER(GpuChannelMsg_RegisterStreamTextureProxy,
-                        OnRegisterStreamTextureProxy)
-    IPC_MESSAGE_HANDLER(GpuChannelMsg_EstablishStreamTexture,
-                        OnEstablishStreamTexture)
-    IPC_MESSAGE_HANDLER(GpuChannelMsg_SetStreamTextureSize,
-                        OnSetStreamTextureSize)
-#endif
-    IPC_MESSAGE_HANDLER(
-        GpuChannelMsg_CollectRenderingStatsForSurface,
-        OnCollectRenderingStatsForSurface)
-    IPC_MESSAGE_UNHANDLED(handled = false)
-  IPC_END_MESSAGE_MAP()
-  DCHECK(handled) << msg.type();
-  return handled;
+void GpuChannel::TrimCLBufferPool() {
+  cl_buffer_pool_.Trim(0);
 }
 
 void GpuChannel::HandleMessage() {
@@ -1521,6 +1795,8 @@ void GpuChannel::OnCallclCreateContext(
 	}
 
   *errcode_ret = sv_createSharedCLContext(platform, &context_ret);
+  if (CL_SUCCESS == *errcode_ret)
+    cl_buffer_pool_.RetainContext(context_ret);
 
   if (!property_list.empty())
     delete[] properties;
@@ -1567,6 +1843,8 @@ void GpuChannel::OnCallclCreateContextFromType(
                     pfn_notify,
                     user_data,
                     errcode_ret_inter);
+  if (context_ret)
+    cl_buffer_pool_.RetainContext(context_ret);
 
   if (!property_list.empty())
     delete[] properties;
@@ -1585,6 +1863,8 @@ void GpuChannel::OnCallclRetainContext (
 
   // Call the OpenCL API.
   *errcode_ret = clRetainContext(context);
+  if (CL_SUCCESS == *errcode_ret)
+    cl_buffer_pool_.RetainContext(context);
 }
 
 void GpuChannel::OnCallclReleaseContext (
@@ -1597,6 +1877,11 @@ void GpuChannel::OnCallclReleaseContext (
 
   // Call the OpenCL API.
   *errcode_ret = clReleaseContext(context);
+
+  // Idle pooled buffers hold references to their context, which would
+  // otherwise outlive the page's last release.
+  if (CL_SUCCESS == *errcode_ret)
+    cl_buffer_pool_.ReleaseContext(context);
 }
 
 void GpuChannel::OnCallclCreateCommandQueue(
@@ -1623,6 +1908,8 @@ void GpuChannel::OnCallclCreateCommandQueue(
                           device,
                           properties,
                           errcode_ret_inter);
+  if (command_queue_ret)
+    cl_buffer_pool_.AddQueue(context, command_queue_ret);
 
   // Dump the results of OpenCL API calling.
   *point_command_queue_ret = (cl_point) command_queue_ret;
@@ -1633,7 +1920,7 @@ void GpuChannel::OnCallclRetainCommandQueue(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clRetainCommandQueue OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
 
   // Call the OpenCL API.
   *errcode_ret = clRetainCommandQueue(command_queue);
@@ -1644,17 +1931,25 @@ void GpuChannel::OnCallclReleaseCommandQueue(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clReleaseCommandQueue OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
+
+  cl_uint ref_count = 0;
+  clGetCommandQueueInfo(command_queue, CL_QUEUE_REFERENCE_COUNT, sizeof(ref_count), &ref_count, NULL);
+  if (1 == ref_count)
+    cl_buffer_pool_.RemoveQueue(command_queue);
 
   // Call the OpenCL API.
   *errcode_ret = clReleaseCommandQueue(command_queue);
+  if (CL_SUCCESS == *errcode_ret && 1 == ref_count &&
+      IsClientCLHandle(point_command_queue))
+    cl_client_handles_.erase(point_command_queue);
 }
 
 void GpuChannel::OnCallclCreateBuffer(
     const cl_point& point_context,
     const cl_mem_flags& flags,
     const size_t& size,
-    const cl_point& point_host_ptr,
+    const int32& transfer_buffer_id,
     const std::vector<bool>& return_variable_null_status,
     cl_int* errcode_ret,
     cl_point* point_memobj_ret) {
@@ -1663,12 +1958,36 @@ void GpuChannel::OnCallclCreateBuffer(
   cl_context context = (cl_context) point_context;
   cl_mem memobj_ret;
   cl_int* errcode_ret_inter = errcode_ret;
-  void* host_ptr = (void*) point_host_ptr;
+  *point_memobj_ret = 0;
+
+  // The initial contents are copied out of the transfer buffer before the
+  // reply lets the renderer reuse it. The buffer cannot keep using renderer
+  // memory, so CL_MEM_USE_HOST_PTR is refused.
+  void* host_ptr = NULL;
+  if (transfer_buffer_id >= 0) {
+    host_ptr = GetCLTransferMemory(transfer_buffer_id, 0, size);
+    if (!host_ptr || !(flags & CL_MEM_COPY_HOST_PTR) ||
+        (flags & CL_MEM_USE_HOST_PTR)) {
+      *errcode_ret = CL_INVALID_HOST_PTR;
+      return;
+    }
+  }
 
   // If the caller wishes to pass a NULL.
   if (return_variable_null_status[0])
     errcode_ret_inter = NULL;
 
+  // Reuse a buffer the page released earlier if one matches.
+  bool poolable = OpenCLBufferPool::CanPool(flags, host_ptr);
+  if (poolable) {
+    memobj_ret = cl_buffer_pool_.Acquire(context, flags, size);
+    if (memobj_ret) {
+      *errcode_ret = CL_SUCCESS;
+      *point_memobj_ret = (cl_point) memobj_ret;
+      return;
+    }
+  }
+
   // Call the OpenCL API.
   memobj_ret = clCreateBuffer(
                    context,
@@ -1676,6 +1995,8 @@ void GpuChannel::OnCallclCreateBuffer(
                    size,
                    host_ptr,
                    errcode_ret_inter);
+  if (poolable && memobj_ret)
+    cl_buffer_pool_.Track(memobj_ret, context, flags, size);
 
   // Dump the results of OpenCL API calling.
   *point_memobj_ret = (cl_point) memobj_ret;
@@ -1691,7 +2012,7 @@ void GpuChannel::OnCallclCreateSubBuffer(
     cl_point* point_memobj_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubBuffer OpenCL API calling.
-  cl_mem buffer = (cl_mem) point_buffer;
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_buffer);
   cl_mem memobj_ret;
   cl_int* errcode_ret_inter = errcode_ret;
   void* buffer_create_info = (void*) point_buffer_create_info;
@@ -1756,7 +2077,7 @@ void GpuChannel::OnCallclRetainMemObject(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clRetainMemObject OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
 
   // Call the OpenCL API.
   *errcode_ret = clRetainMemObject(memobj);
@@ -1767,10 +2088,19 @@ void GpuChannel::OnCallclReleaseMemObject(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clReleaseMemObject OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
 
-  // Call the OpenCL API.
-  *errcode_ret = clReleaseMemObject(memobj);
+  cl_uint ref_count = 0;
+  clGetMemObjectInfo(memobj, CL_MEM_REFERENCE_COUNT, sizeof(ref_count), &ref_count, NULL);
+
+  // The last reference of a pooled buffer keeps it alive for reuse once the
+  // commands queued so far are done with it.
+  if (1 == ref_count && cl_buffer_pool_.Recycle(memobj))
+    *errcode_ret = CL_SUCCESS;
+  else
+    *errcode_ret = clReleaseMemObject(memobj);
+  if (CL_SUCCESS == *errcode_ret && 1 == ref_count)
+    cl_client_handles_.erase(point_memobj);
 }
 
 void GpuChannel::OnCallclGetSupportedImageFormats(
@@ -1826,7 +2156,7 @@ void GpuChannel::OnCallclSetMemObjectDestructorCallback(
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clSetMemObjectDestructorCallback
   // OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
   void (CL_CALLBACK* pfn_notify)(cl_mem, void* ) =
     (void (CL_CALLBACK*)(cl_mem, void* )) point_pfn_notify;
   void* user_data = (void*) point_user_data;
@@ -1873,7 +2203,7 @@ void GpuChannel::OnCallclRetainSampler(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clRetainSampler OpenCL API calling.
-  cl_sampler sampler = (cl_sampler) point_sampler;
+  cl_sampler sampler = (cl_sampler) ResolveCLHandle(point_sampler);
 
   // Call the OpenCL API.
   *errcode_ret = clRetainSampler(sampler);
@@ -1884,10 +2214,16 @@ void GpuChannel::OnCallclReleaseSampler(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clReleaseSampler OpenCL API calling.
-  cl_sampler sampler = (cl_sampler) point_sampler;
+  cl_sampler sampler = (cl_sampler) ResolveCLHandle(point_sampler);
+
+  cl_uint ref_count = 0;
+  if (IsClientCLHandle(point_sampler))
+    clGetSamplerInfo(sampler, CL_SAMPLER_REFERENCE_COUNT, sizeof(ref_count), &ref_count, NULL);
 
   // Call the OpenCL API.
   *errcode_ret = clReleaseSampler(sampler);
+  if (CL_SUCCESS == *errcode_ret && 1 == ref_count)
+    cl_client_handles_.erase(point_sampler);
 }
 
 void GpuChannel::OnCallclCreateProgramWithSource(
@@ -1940,6 +2276,21 @@ void GpuChannel::OnCallclCreateProgramWithSource(
     delete[] lengths;
   }
 
+  // Keep the source around for the program binary cache.
+  if (program_ret) {
+    std::string& source = cl_program_sources_[(cl_point) program_ret];
+    source.clear();
+    for (cl_uint index = 0; index < count && index < string_list.size();
+         ++index) {
+      const std::string& string = string_list[index];
+      size_t length = index < length_list.size() ? length_list[index] : 0;
+      if (length == 0 || length > string.size())
+        source.append(string.c_str());
+      else
+        source.append(string, 0, length);
+    }
+  }
+
   // Dump the results of OpenCL API calling.
   *point_program_ret = (cl_point) program_ret;
 }
@@ -2001,6 +2352,7 @@ void GpuChannel::OnCallclCreateProgramWithBinary(
     delete[] lengths;
     delete[] binary_status;
   }
+  cl_program_sources_.erase((cl_point) program_ret);
   *point_out_val = (cl_point) program_ret;
 }
 
@@ -2043,6 +2395,7 @@ void GpuChannel::OnCallclCreateProgramWithBuiltInKernels(
     delete[] device_list;
 
   // Dump the results of OpenCL API calling.
+  cl_program_sources_.erase((cl_point) program_ret);
   *point_progrem_ret = (cl_point) program_ret;
 }
 
@@ -2051,7 +2404,7 @@ void GpuChannel::OnCallclRetainProgram(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clRetainProgram OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
 
   // Call the OpenCL API.
   *errcode_ret = clRetainProgram(program);
@@ -2062,10 +2415,29 @@ void GpuChannel::OnCallclReleaseProgram(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clReleaseProgram OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
+  CLProgramAliasMap::iterator alias = cl_program_aliases_.find(point_program);
+  cl_uint ref_count = 0;
+  if (alias != cl_program_aliases_.end() ||
+      cl_program_sources_.count(point_program)) {
+    clGetProgramInfo(program, CL_PROGRAM_REFERENCE_COUNT, sizeof(ref_count),
+                     &ref_count, NULL);
+  }
 
   // Call the OpenCL API.
   *errcode_ret = clReleaseProgram(program);
+
+  // Once the renderer drops its last reference, let go of the source program
+  // kept alive behind a cached binary and forget the source.
+  if (CL_SUCCESS == *errcode_ret && 1 == ref_count) {
+    if (alias != cl_program_aliases_.end()) {
+      clReleaseProgram((cl_program) point_program);
+      cl_program_aliases_.erase(alias);
+    }
+    cl_program_sources_.erase(point_program);
+    cl_program_options_.erase(point_program);
+    DropCLArgInfoProgram(point_program);
+  }
 }
 
 void GpuChannel::OnCallclBuildProgram(
@@ -2077,6 +2449,9 @@ void GpuChannel::OnCallclBuildProgram(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clBuildProgram OpenCL API calling.
+  // A rebuild starts over from the source program.
+  DropCLProgramAlias(point_program);
+  DropCLArgInfoProgram(point_program);
   cl_program program = (cl_program) point_program;
   cl_device_id* device_list = NULL;
   void (CL_CALLBACK* pfn_notify)(cl_program, void*) =
@@ -2090,19 +2465,250 @@ void GpuChannel::OnCallclBuildProgram(
       device_list[index] = (cl_device_id) point_device_list[index];
   }
 
-  // Call the OpenCL API.
-  *errcode_ret = clBuildProgram(
-                     program,
-                     num_devices,
-                     device_list,
-                     "" == str_options ? NULL : str_options.c_str(),
-                     pfn_notify,
-                     user_data);
+  // Programs created from source go through the binary cache, unless the
+  // caller wants a build notification.
+  CLProgramSourceMap::const_iterator source =
+      cl_program_sources_.find(point_program);
+  bool cacheable = source != cl_program_sources_.end() && !pfn_notify;
+  if (source != cl_program_sources_.end())
+    cl_program_options_[point_program] = str_options;
+
+  if (cacheable && BuildCLProgramFromCache(point_program, source->second,
+                                           num_devices, device_list,
+                                           str_options)) {
+    *errcode_ret = CL_SUCCESS;
+  } else {
+    // Call the OpenCL API.
+    *errcode_ret = clBuildProgram(
+                       program,
+                       num_devices,
+                       device_list,
+                       "" == str_options ? NULL : str_options.c_str(),
+                       pfn_notify,
+                       user_data);
+    if (cacheable && CL_SUCCESS == *errcode_ret)
+      StoreCLProgramBinaries(program, source->second, str_options);
+  }
 
   if (num_devices)
     delete[] device_list;
 }
 
+bool GpuChannel::BuildCLProgramFromCache(cl_point point_program,
+                                         const std::string& source,
+                                         cl_uint num_devices,
+                                         const cl_device_id* device_list,
+                                         const std::string& options) {
+  cl_program program = (cl_program) point_program;
+  cl_context context = NULL;
+  if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_CONTEXT,
+                                     sizeof(context), &context, NULL))
+    return false;
+
+  std::vector<cl_device_id> devices(device_list, device_list + num_devices);
+  if (devices.empty()) {
+    cl_uint count = 0;
+    if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES,
+                                       sizeof(count), &count, NULL) ||
+        count == 0)
+      return false;
+    devices.resize(count);
+    if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_DEVICES,
+                                       count * sizeof(cl_device_id),
+                                       &devices[0], NULL))
+      return false;
+  }
+
+  // Every device needs a cached binary.
+  OpenCLProgramCache* cache = OpenCLProgramCache::GetInstance();
+  std::vector<std::string> keys(devices.size());
+  std::vector<std::string> binaries(devices.size());
+  std::vector<size_t> lengths(devices.size());
+  std::vector<const unsigned char*> pointers(devices.size());
+  for (size_t index = 0; index < devices.size(); ++index) {
+    keys[index] = OpenCLProgramCache::ComputeKey(source, options,
+                                                 devices[index]);
+    if (!cache->Load(keys[index], &binaries[index]))
+      return false;
+    lengths[index] = binaries[index].size();
+    pointers[index] =
+        reinterpret_cast<const unsigned char*>(binaries[index].data());
+  }
+
+  std::vector<cl_int> binary_status(devices.size());
+  cl_int errcode = CL_SUCCESS;
+  cl_program cached = clCreateProgramWithBinary(
+      context, (cl_uint) devices.size(), &devices[0], &lengths[0],
+      &pointers[0], &binary_status[0], &errcode);
+  if (CL_SUCCESS == errcode) {
+    errcode = clBuildProgram(cached, (cl_uint) devices.size(), &devices[0],
+                             options.empty() ? NULL : options.c_str(),
+                             NULL, NULL);
+  }
+  if (CL_SUCCESS != errcode) {
+    // The driver no longer accepts these binaries; build from source and
+    // let the fresh binaries replace them.
+    if (cached)
+      clReleaseProgram(cached);
+    for (size_t index = 0; index < keys.size(); ++index)
+      cache->Remove(keys[index]);
+    return false;
+  }
+
+  cl_program_aliases_[point_program] = (cl_point) cached;
+  return true;
+}
+
+void GpuChannel::StoreCLProgramBinaries(cl_program program,
+                                        const std::string& source,
+                                        const std::string& options) {
+  cl_uint count = 0;
+  if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES,
+                                     sizeof(count), &count, NULL) ||
+      count == 0)
+    return;
+
+  std::vector<cl_device_id> devices(count);
+  std::vector<size_t> sizes(count);
+  if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_DEVICES,
+                                     count * sizeof(cl_device_id),
+                                     &devices[0], NULL) ||
+      CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES,
+                                     count * sizeof(size_t), &sizes[0], NULL))
+    return;
+
+  // Devices the program was not built for report an empty binary.
+  std::vector<std::vector<unsigned char> > binaries(count);
+  std::vector<unsigned char*> pointers(count);
+  for (cl_uint index = 0; index < count; ++index) {
+    binaries[index].resize(sizes[index]);
+    pointers[index] = sizes[index] ? &binaries[index][0] : NULL;
+  }
+  if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_BINARIES,
+                                     count * sizeof(unsigned char*),
+                                     &pointers[0], NULL))
+    return;
+
+  OpenCLProgramCache* cache = OpenCLProgramCache::GetInstance();
+  for (cl_uint index = 0; index < count; ++index) {
+    if (binaries[index].empty())
+      continue;
+    cache->Store(OpenCLProgramCache::ComputeKey(source, options,
+                                                devices[index]),
+                 std::string(binaries[index].begin(), binaries[index].end()));
+  }
+}
+
+void GpuChannel::DropCLProgramAlias(cl_point point_program) {
+  CLProgramAliasMap::iterator alias = cl_program_aliases_.find(point_program);
+  if (alias == cl_program_aliases_.end())
+    return;
+  clReleaseProgram((cl_program) alias->second);
+  cl_program_aliases_.erase(alias);
+}
+
+cl_point GpuChannel::ResolveCLProgram(cl_point point_program) {
+  if (cl_program_aliases_.empty())
+    return point_program;
+  CLProgramAliasMap::const_iterator alias =
+      cl_program_aliases_.find(point_program);
+  return alias == cl_program_aliases_.end() ? point_program : alias->second;
+}
+
+cl_int GpuChannel::GetCLKernelArgInfo(cl_kernel kernel,
+                                      cl_uint arg_index,
+                                      cl_kernel_arg_info param_name,
+                                      size_t param_value_size,
+                                      void* param_value,
+                                      size_t* param_value_size_ret) {
+  cl_int errcode = clGetKernelArgInfo(kernel, arg_index, param_name,
+                                      param_value_size, param_value,
+                                      param_value_size_ret);
+  if (CL_KERNEL_ARG_INFO_NOT_AVAILABLE != errcode)
+    return errcode;
+  cl_kernel twin = GetCLArgInfoKernel(kernel);
+  if (!twin)
+    return errcode;
+  return clGetKernelArgInfo(twin, arg_index, param_name, param_value_size,
+                            param_value, param_value_size_ret);
+}
+
+cl_kernel GpuChannel::GetCLArgInfoKernel(cl_kernel kernel) {
+  CLKernelAliasMap::const_iterator twin =
+      cl_arg_info_kernels_.find((cl_point) kernel);
+  if (twin != cl_arg_info_kernels_.end())
+    return (cl_kernel) twin->second;
+
+  // Find the source program the page created, behind a cached binary or not.
+  cl_program program = NULL;
+  if (CL_SUCCESS != clGetKernelInfo(kernel, CL_KERNEL_PROGRAM,
+                                    sizeof(program), &program, NULL))
+    return NULL;
+  cl_point point_program = (cl_point) program;
+  for (CLProgramAliasMap::const_iterator alias = cl_program_aliases_.begin();
+       alias != cl_program_aliases_.end(); ++alias) {
+    if (alias->second == (cl_point) program) {
+      point_program = alias->first;
+      break;
+    }
+  }
+  CLProgramSourceMap::const_iterator source =
+      cl_program_sources_.find(point_program);
+  if (source == cl_program_sources_.end())
+    return NULL;
+
+  CLProgramAliasMap::const_iterator arg_info_program =
+      cl_arg_info_programs_.find(point_program);
+  if (arg_info_program == cl_arg_info_programs_.end()) {
+    cl_context context = NULL;
+    if (CL_SUCCESS != clGetProgramInfo(program, CL_PROGRAM_CONTEXT,
+                                       sizeof(context), &context, NULL))
+      return NULL;
+    const char* text = source->second.c_str();
+    cl_int errcode = CL_SUCCESS;
+    cl_program built = clCreateProgramWithSource(context, 1, &text, NULL,
+                                                 &errcode);
+    if (CL_SUCCESS != errcode)
+      return NULL;
+    std::string options = cl_program_options_[point_program];
+    options += " -cl-kernel-arg-info";
+    if (CL_SUCCESS != clBuildProgram(built, 0, NULL, options.c_str(),
+                                     NULL, NULL)) {
+      clReleaseProgram(built);
+      return NULL;
+    }
+    arg_info_program = cl_arg_info_programs_.insert(
+        std::make_pair(point_program, (cl_point) built)).first;
+  }
+
+  size_t name_size = 0;
+  if (CL_SUCCESS != clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, 0, NULL,
+                                    &name_size) ||
+      name_size == 0)
+    return NULL;
+  std::vector<char> name(name_size);
+  if (CL_SUCCESS != clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME,
+                                    name_size, &name[0], NULL))
+    return NULL;
+  cl_int errcode = CL_SUCCESS;
+  cl_kernel created = clCreateKernel((cl_program) arg_info_program->second,
+                                     &name[0], &errcode);
+  if (CL_SUCCESS != errcode)
+    return NULL;
+  cl_arg_info_kernels_[(cl_point) kernel] = (cl_point) created;
+  return created;
+}
+
+void GpuChannel::DropCLArgInfoProgram(cl_point point_program) {
+  // Kernels made from it keep it alive until they are dropped themselves.
+  CLProgramAliasMap::iterator program =
+      cl_arg_info_programs_.find(point_program);
+  if (program == cl_arg_info_programs_.end())
+    return;
+  clReleaseProgram((cl_program) program->second);
+  cl_arg_info_programs_.erase(program);
+}
+
 void GpuChannel::OnCallclCompileProgram(
     const std::vector<cl_point>& point_parameter_list,
     const std::vector<cl_uint>& num_list,
@@ -2112,7 +2718,7 @@ void GpuChannel::OnCallclCompileProgram(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCompileProgram OpenCL API calling.
-  cl_program program = (cl_program) point_parameter_list[0];
+  cl_program program = (cl_program) ResolveCLProgram(point_parameter_list[0]);
   void (CL_CALLBACK* pfn_notify)(cl_program, void*) =
       (void (CL_CALLBACK*)(cl_program, void*)) point_parameter_list[1];
   void* user_data = (void*) point_parameter_list[2];
@@ -2132,7 +2738,7 @@ void GpuChannel::OnCallclCompileProgram(
   if (num_input_headers > 0) {
     input_headers = new cl_program[num_input_headers];
     for (cl_uint index = 0; index < num_input_headers; ++index) {
-      input_headers[index] = (cl_program) point_input_header_list[index];
+      input_headers[index] = (cl_program) ResolveCLProgram(point_input_header_list[index]);
       header_include_names[index] =
           options_header_include_name_list[index + 1].c_str();
     }
@@ -2185,7 +2791,7 @@ void GpuChannel::OnCallclLinkProgram(
   if (num_input_programs > 0) {
     input_programs = new cl_program[num_input_programs];
     for (cl_uint index = 0; index < num_input_programs; ++index)
-      input_programs[index] = (cl_program) point_input_program_list[index];
+      input_programs[index] = (cl_program) ResolveCLProgram(point_input_program_list[index]);
   }
 
   // Call the OpenCL API.
@@ -2201,6 +2807,7 @@ void GpuChannel::OnCallclLinkProgram(
                     errcode_ret_inter);
 
   // Dump the results of OpenCL API calling.
+  cl_program_sources_.erase((cl_point) program_ret);
   *point_program_ret = (cl_point) program_ret;
 }
 
@@ -2223,7 +2830,7 @@ void GpuChannel::OnCallclCreateKernel(
     cl_point* point_kernel_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateKernel OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   cl_kernel kernel_ret;
   cl_int* errcode_ret_inter = errcode_ret;
 
@@ -2250,7 +2857,7 @@ void GpuChannel::OnCallclCreateKernelsInProgram(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateKernelsInProgram OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   cl_kernel* kernels = NULL;
   cl_uint *num_kernels_ret_inter = num_kernels_ret;
 
@@ -2281,7 +2888,7 @@ void GpuChannel::OnCallclRetainKernel(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clRetainKernel OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
 
   // Call the OpenCL API.
   *errcode_ret = clRetainKernel(kernel);
@@ -2292,10 +2899,23 @@ void GpuChannel::OnCallclReleaseKernel(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clReleaseKernel OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
+
+  cl_uint ref_count = 0;
+  clGetKernelInfo(kernel, CL_KERNEL_REFERENCE_COUNT, sizeof(ref_count), &ref_count, NULL);
 
   // Call the OpenCL API.
   *errcode_ret = clReleaseKernel(kernel);
+  if (CL_SUCCESS == *errcode_ret && 1 == ref_count) {
+    if (IsClientCLHandle(point_kernel))
+      cl_client_handles_.erase(point_kernel);
+    CLKernelAliasMap::iterator twin =
+        cl_arg_info_kernels_.find((cl_point) kernel);
+    if (twin != cl_arg_info_kernels_.end()) {
+      clReleaseKernel((cl_kernel) twin->second);
+      cl_arg_info_kernels_.erase(twin);
+    }
+  }
 }
 
 void GpuChannel::OnCallclSetKernelArg(
@@ -2307,8 +2927,8 @@ void GpuChannel::OnCallclSetKernelArg(
 {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clSetKernelArg OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
-  const void* arg_value = (void*) point_arg_value;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
+  const void* arg_value = (void*) ResolveCLHandle(point_arg_value);
  
   // Call the OpenCL API.
   *errcode_ret = clSetKernelArg(
@@ -2323,7 +2943,7 @@ void GpuChannel::OnCallclSetKernelArg_vector(
     const cl_uint& arg_index,
     const std::vector<unsigned char>& data,
     cl_int* errcode_ret) {
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   *errcode_ret = clSetKernelArg(
                      kernel,
                      arg_index,
@@ -2351,6 +2971,7 @@ void GpuChannel::OnCallclWaitForEvents(
   *errcode_ret = clWaitForEvents(
                           num_events,
                           events);
+  ReportDeferredCLError(errcode_ret);
 
   if (num_events)
     delete[] events;
@@ -2415,22 +3036,60 @@ void GpuChannel::OnCallclSetUserEventStatus(
 void GpuChannel::OnCallclSetEventCallback(
     const cl_point& point_event,
     const cl_int& command_exec_callback_type,
-    const cl_point& point_pfn_notify,
-    const cl_point& point_user_data,
+    const int32& callback_id,
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clSetEventCallback OpenCL API calling.
+  // The renderer is told through OpenCLChannelMsg_EventCallbackFired when
+  // the callback runs.
   cl_event clevent = (cl_event) point_event;
-  void (CL_CALLBACK *pfn_event_notify)(cl_event, cl_int,void *) =
-    (void (CL_CALLBACK *)(cl_event, cl_int,void *)) point_pfn_notify;
-  void* user_data = (void*) point_user_data;
+  CLEventCallbackData* data = new CLEventCallbackData;
+  data->filter = cl_filter_;
+  data->callback_id = callback_id;
+  data->release_event = false;
 
   // Call the OpenCL API.
   *errcode_ret = clSetEventCallback(
                           clevent,
                           command_exec_callback_type,
-                          pfn_event_notify,
-                          user_data);
+                          &OnCLEventCallback,
+                          data);
+  if (*errcode_ret != CL_SUCCESS)
+    delete data;
+}
+
+void GpuChannel::OnCallclFinishAsync(
+    const cl_point& point_command_queue,
+    const int32& callback_id) {
+  // Waits for the command queue without blocking the OpenCL thread: the
+  // completion of a marker placed behind everything queued so far is
+  // reported to the renderer from the marker's event callback.
+  cl_command_queue command_queue =
+      (cl_command_queue) ResolveCLHandle(point_command_queue);
+
+  cl_int errcode = CL_SUCCESS;
+  ReportDeferredCLError(&errcode);
+  cl_event marker = NULL;
+  if (errcode == CL_SUCCESS)
+    errcode = clEnqueueMarkerWithWaitList(command_queue, 0, NULL, &marker);
+  if (errcode == CL_SUCCESS)
+    errcode = clFlush(command_queue);
+  if (errcode == CL_SUCCESS) {
+    CLEventCallbackData* data = new CLEventCallbackData;
+    data->filter = cl_filter_;
+    data->callback_id = callback_id;
+    data->release_event = true;
+    errcode = clSetEventCallback(marker, CL_COMPLETE, &OnCLEventCallback,
+                                 data);
+    if (errcode == CL_SUCCESS)
+      return;
+    delete data;
+  }
+
+  if (marker)
+    clReleaseEvent(marker);
+  cl_filter_->Send(new OpenCLChannelMsg_EventCallbackFired(callback_id,
+                                                           errcode));
 }
 
 void GpuChannel::OnCallclFlush(
@@ -2438,7 +3097,7 @@ void GpuChannel::OnCallclFlush(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clFlush OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
 
   // Call the OpenCL API.
   *errcode_ret = clFlush(command_queue);
@@ -2449,10 +3108,11 @@ void GpuChannel::OnCallclFinish(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clFinish OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
 
   // Call the OpenCL API.
   *errcode_ret = clFinish(command_queue);
+  ReportDeferredCLError(errcode_ret);
 }
 
 void GpuChannel::OnCallclGetPlatformInfo_string(
@@ -2495,6 +3155,29 @@ void GpuChannel::OnCallclGetPlatformInfo_string(
   }
 }
 
+void GpuChannel::OnCallclGetPlatformInfoList(
+    const cl_point& point_platform,
+    const std::vector<cl_uint>& param_names,
+    std::vector<std::vector<unsigned char>>* param_values,
+    std::vector<cl_int>* errcodes) {
+  GetCLInfoList(clGetPlatformInfo, (cl_platform_id) point_platform,
+                param_names, param_values, errcodes);
+}
+
+void GpuChannel::OnCallclGetDeviceInfoList(
+    const cl_point& point_device,
+    const std::vector<cl_uint>& param_names,
+    std::vector<std::vector<unsigned char>>* param_values,
+    std::vector<cl_int>* errcodes) {
+  GetCLInfoList(clGetDeviceInfo, (cl_device_id) point_device,
+                param_names, param_values, errcodes);
+
+  for (size_t i = 0; i < param_names.size(); ++i) {
+    if (CL_SUCCESS == (*errcodes)[i] && IsSizeTCLDeviceInfo(param_names[i]))
+      WidenCLSizeTInfo(&(*param_values)[i]);
+  }
+}
+
 void GpuChannel::OnCallclGetDeviceInfo_cl_uint(
     const cl_point& point_device,
     const cl_device_info& param_name,
@@ -2862,7 +3545,7 @@ void GpuChannel::OnCallclGetCommandQueueInfo_cl_point(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clGetDeviceIDs OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* cl_point_ret_inter = cl_point_ret;
 
@@ -2893,7 +3576,7 @@ void GpuChannel::OnCallclGetCommandQueueInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
 
@@ -2924,7 +3607,7 @@ void GpuChannel::OnCallclGetCommandQueueInfo_cl_ulong(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_ulong* cl_ulong_ret_inter = cl_ulong_ret;
  
@@ -2955,7 +3638,7 @@ void GpuChannel::OnCallclGetMemObjectInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clGetDeviceIDs OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
   
@@ -2986,7 +3669,7 @@ void GpuChannel::OnCallclGetMemObjectInfo_cl_ulong(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_ulong* cl_ulong_ret_inter = cl_ulong_ret;
 
@@ -3017,7 +3700,7 @@ void GpuChannel::OnCallclGetMemObjectInfo_size_t(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   size_t* size_t_ret_inter = size_t_ret;
 
@@ -3048,7 +3731,7 @@ void GpuChannel::OnCallclGetMemObjectInfo_cl_point(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem memobj = (cl_mem) point_memobj;
+  cl_mem memobj = (cl_mem) ResolveCLHandle(point_memobj);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* cl_point_ret_inter = cl_point_ret;
 
@@ -3079,7 +3762,7 @@ void GpuChannel::OnCallclGetImageInfo_cl_image_format(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem image = (cl_mem) point_image;
+  cl_mem image = (cl_mem) ResolveCLHandle(point_image);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_image_format image_format_ret;
   cl_image_format *image_format_ret_inter = &image_format_ret;
@@ -3117,7 +3800,7 @@ void GpuChannel::OnCallclGetImageInfo_size_t(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem image = (cl_mem) point_image;
+  cl_mem image = (cl_mem) ResolveCLHandle(point_image);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   size_t* size_t_ret_inter = size_t_ret;
 
@@ -3148,7 +3831,7 @@ void GpuChannel::OnCallclGetImageInfo_cl_point(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem image = (cl_mem) point_image;
+  cl_mem image = (cl_mem) ResolveCLHandle(point_image);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* cl_point_ret_inter = cl_point_ret;
 
@@ -3179,7 +3862,7 @@ void GpuChannel::OnCallclGetImageInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_mem image = (cl_mem) point_image;
+  cl_mem image = (cl_mem) ResolveCLHandle(point_image);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
 
@@ -3210,7 +3893,7 @@ void GpuChannel::OnCallclGetSamplerInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_sampler sampler = (cl_sampler) point_sampler;
+  cl_sampler sampler = (cl_sampler) ResolveCLHandle(point_sampler);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
 
@@ -3241,7 +3924,7 @@ void GpuChannel::OnCallclGetSamplerInfo_cl_point(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_sampler sampler = (cl_sampler) point_sampler;
+  cl_sampler sampler = (cl_sampler) ResolveCLHandle(point_sampler);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* cl_point_ret_inter = cl_point_ret;
 
@@ -3272,7 +3955,7 @@ void GpuChannel::OnCallclGetProgramInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
 
@@ -3303,7 +3986,7 @@ void GpuChannel::OnCallclGetProgramInfo_cl_point(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* cl_point_ret_inter = cl_point_ret;
 
@@ -3334,7 +4017,7 @@ void GpuChannel::OnCallclGetProgramInfo_cl_point_list(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* param_value = NULL;
   cl_point c;
@@ -3375,7 +4058,9 @@ void GpuChannel::OnCallclGetProgramInfo_string(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  // A cached binary program has no source; ask the original for it.
+  cl_program program = (cl_program) (CL_PROGRAM_SOURCE == param_name ?
+      point_program : ResolveCLProgram(point_program));
   size_t *param_value_size_ret_inter = param_value_size_ret;
   char* param_value = NULL;
   char c;
@@ -3415,7 +4100,7 @@ void GpuChannel::OnCallclGetProgramInfo_size_t_list(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   size_t* param_value = NULL;
   size_t c;
@@ -3456,7 +4141,7 @@ void GpuChannel::OnCallclGetProgramInfo_string_list(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   char **param_value = new char*[param_value_size/sizeof(char*)];
   std::string c;
@@ -3495,7 +4180,7 @@ void GpuChannel::OnCallclGetProgramInfo_size_t(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   size_t *size_t_ret_inter = size_t_ret;
 
@@ -3527,7 +4212,7 @@ void GpuChannel::OnCallclGetProgramBuildInfo_cl_int(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   cl_device_id device = (cl_device_id) point_device;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_int* cl_int_ret_inter = cl_int_ret;
@@ -3561,7 +4246,7 @@ void GpuChannel::OnCallclGetProgramBuildInfo_string(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   cl_device_id device = (cl_device_id) point_device;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   char* param_value = NULL;
@@ -3604,7 +4289,7 @@ void GpuChannel::OnCallclGetProgramBuildInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_program program = (cl_program) point_program;
+  cl_program program = (cl_program) ResolveCLProgram(point_program);
   cl_device_id device = (cl_device_id) point_device;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
@@ -3637,7 +4322,7 @@ void GpuChannel::OnCallclGetKernelInfo_string(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   char* param_value = NULL;
   char c;
@@ -3677,7 +4362,7 @@ void GpuChannel::OnCallclGetKernelInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
 
@@ -3708,7 +4393,7 @@ void GpuChannel::OnCallclGetKernelInfo_cl_point(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_point* cl_point_ret_inter = cl_point_ret;
 
@@ -3740,7 +4425,7 @@ void GpuChannel::OnCallclGetKernelArgInfo_cl_uint(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_uint arg_indx = (cl_uint) cl_uint_arg_indx;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_uint* cl_uint_ret_inter = cl_uint_ret;
@@ -3754,7 +4439,7 @@ void GpuChannel::OnCallclGetKernelArgInfo_cl_uint(
     cl_uint_ret_inter = NULL;
 
   // Call the OpenCL API.
-  *errcode_ret = clGetKernelArgInfo(
+  *errcode_ret = GetCLKernelArgInfo(
                      kernel,
                      arg_indx,
                      param_name,
@@ -3774,7 +4459,7 @@ void GpuChannel::OnCallclGetKernelArgInfo_string(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_uint arg_indx = (cl_uint) cl_uint_arg_indx;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   char* param_value = NULL;
@@ -3791,7 +4476,7 @@ void GpuChannel::OnCallclGetKernelArgInfo_string(
     param_value = &c;
 
   // Call the OpenCL API.
-  *errcode_ret = clGetKernelArgInfo(
+  *errcode_ret = GetCLKernelArgInfo(
                      kernel,
                      arg_indx,
                      param_name,
@@ -3817,7 +4502,7 @@ void GpuChannel::OnCallclGetKernelArgInfo_cl_ulong(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_uint arg_indx = (cl_uint) cl_uint_arg_indx;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_ulong* cl_ulong_ret_inter = cl_ulong_ret;
@@ -3831,7 +4516,7 @@ void GpuChannel::OnCallclGetKernelArgInfo_cl_ulong(
     cl_ulong_ret_inter = NULL;
 
   // Call the OpenCL API.
-  *errcode_ret = clGetKernelArgInfo(
+  *errcode_ret = GetCLKernelArgInfo(
                      kernel,
                      arg_indx,
                      param_name,
@@ -3851,7 +4536,7 @@ void GpuChannel::OnCallclGetKernelWorkGroupInfo_size_t_list(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_device_id device = (cl_device_id) point_device;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   size_t* param_value = NULL;
@@ -3895,7 +4580,7 @@ void GpuChannel::OnCallclGetKernelWorkGroupInfo_size_t(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_device_id device = (cl_device_id) point_device;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   size_t* size_t_ret_inter = size_t_ret;
@@ -3929,7 +4614,7 @@ void GpuChannel::OnCallclGetKernelWorkGroupInfo_cl_ulong(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clCreateSubDevices OpenCL API calling.
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_device_id device = (cl_device_id) point_device;
   size_t *param_value_size_ret_inter = param_value_size_ret;
   cl_ulong* cl_ulong_ret_inter = cl_ulong_ret;
@@ -4086,8 +4771,8 @@ void GpuChannel::OnCallclEnqueueReadBuffer(
   cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clEnqueueReadBuffer OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_list[0];
-  cl_mem buffer = (cl_mem) point_list[1];
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_list[0]);
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_list[1]);
   size_t offset = size_t_list[0];
   size_t size = size_t_list[1];
   cl_event *event_wait_list = NULL;
@@ -4110,6 +4795,8 @@ void GpuChannel::OnCallclEnqueueReadBuffer(
 
   // Call the OpenCL API.
   *errcode_ret = clEnqueueReadBuffer(command_queue, buffer, blocking_read, offset, size, &(*ptr_list)[0]/*ptr*/, num_events_in_wait_list, event_wait_list, &clevent);
+  if (blocking_read)
+    ReportDeferredCLError(errcode_ret);
 
   if (num_events_in_wait_list > 0 && point_list.size() > 2)
     delete[] event_wait_list;
@@ -4125,21 +4812,22 @@ void GpuChannel::OnCallclEnqueueReadBuffer(
   *clevent_ret = (cl_point) clevent;
 }
 
-void GpuChannel::OnCallclEnqueueReadBufferRect (std::vector<cl_point>, cl_bool, std::vector<size_t>, cl_point, cl_uint, cl_point* point_out_val, cl_int* errcode_ret)
-{
+void GpuChannel::OnCallclEnqueueReadBufferRect(
+  const std::vector<cl_point>& point_list,
+  const std::vector<size_t>& size_t_list,
+  const int32& transfer_buffer_id,
+  const cl_uint& num_events_in_wait_list,
+  const bool& want_event,
+  cl_point* clevent_ret,
+  cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clEnqueueReadBufferRect OpenCL API calling.
-  cl_event event_ret = NULL;
-  cl_event* event_ret_inter = NULL;
-  cl_event *event_wait_list = NULL;
-  cl_uint num_events_in_wait_list = 0;
-
-  if (num_events_in_wait_list > 0)
-    delete[] event_wait_list;
-
-  if ((size_t) -1 != *point_out_val)
-    *point_out_val = (cl_point) event_ret;
+  // Only the region moves: its rows land packed in the transfer buffer.
+  EnqueueCLRectTransfer(false, point_list, size_t_list, transfer_buffer_id,
+                        num_events_in_wait_list, want_event, clevent_ret,
+                        errcode_ret);
 }
+
 void GpuChannel::OnCallclEnqueueWriteBuffer(
   const std::vector<cl_point>& point_list,
   const cl_bool& blocking_write,
@@ -4150,8 +4838,8 @@ void GpuChannel::OnCallclEnqueueWriteBuffer(
   cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process
   // and return the results of clEnqueueReadBuffer OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_list[0];
-  cl_mem buffer = (cl_mem) point_list[1];
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_list[0]);
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_list[1]);
   size_t offset = size_t_list[0];
   size_t size = size_t_list[1];
   cl_event *event_wait_list = NULL;
@@ -4184,32 +4872,386 @@ void GpuChannel::OnCallclEnqueueWriteBuffer(
 
   *clevent_ret = (cl_point) clevent;
 }
-void GpuChannel::OnCallclEnqueueWriteBufferRect (std::vector<cl_point>, cl_bool, std::vector<size_t>, cl_point, cl_uint, cl_point* point_out_val, cl_int* errcode_ret)
-{
-  cl_event event_ret = NULL;
-  cl_event* event_ret_inter = NULL;
-  cl_event *event_wait_list = NULL;
-  cl_uint num_events_in_wait_list = 0;
+void GpuChannel::OnCallclCommandBatch(
+    const std::vector<OpenCLCommand>& commands) {
+  // Run OpenCL calls the renderer queued without waiting for their results.
+  // Malformed commands fail with CL_INVALID_VALUE.
+  const std::vector<bool> return_variable_null_status(1, false);
+  for (size_t i = 0; i < commands.size(); ++i) {
+    const OpenCLCommand& command = commands[i];
+    const std::vector<cl_point>& handles = command.handles;
+    const std::vector<size_t>& sizes = command.sizes;
+    cl_int errcode_ret = CL_INVALID_VALUE;
+    TRACE_EVENT2("gpu", "GpuChannel::RunOpenCLCommand",
+                 "op", command.op, "size", command.data.size());
+
+    switch (command.op) {
+      case OpenCLCommand::SET_KERNEL_ARG:
+        if (handles.size() == 2 && sizes.size() == 2)
+          OnCallclSetKernelArg(handles[0], sizes[0], sizes[1], handles[1],
+                               &errcode_ret);
+        break;
+      case OpenCLCommand::SET_KERNEL_ARG_VECTOR:
+        if (handles.size() == 1 && sizes.size() == 1 && !command.data.empty())
+          OnCallclSetKernelArg_vector(handles[0], sizes[0], command.data,
+                                      &errcode_ret);
+        break;
+      case OpenCLCommand::SET_KERNEL_ARGS: {
+        if (handles.size() != 1 || sizes.empty() || sizes.size() % 2)
+          break;
+        cl_kernel kernel = (cl_kernel) ResolveCLHandle(handles[0]);
+        size_t offset = 0;
+        for (size_t index = 0; index < sizes.size(); index += 2) {
+          size_t arg_size = sizes[index + 1];
+          if (arg_size > command.data.size() - offset) {
+            errcode_ret = CL_INVALID_ARG_SIZE;
+            break;
+          }
+          errcode_ret = clSetKernelArg(
+              kernel, (cl_uint) sizes[index], arg_size,
+              arg_size ? &command.data[offset] : NULL);
+          if (CL_SUCCESS != errcode_ret)
+            break;
+          offset += arg_size;
+        }
+        break;
+      }
+      case OpenCLCommand::ENQUEUE_ND_RANGE_KERNEL: {
+        cl_uint work_dim = sizes.empty() ? 0 : sizes[0];
+        if (handles.size() < 2 || work_dim < 1 || work_dim > 3 ||
+            sizes.size() != 1 + 3 * work_dim)
+          break;
+        const size_t* global_work_offset = &sizes[1];
+        const size_t* global_work_size = &sizes[1 + work_dim];
+        const size_t* local_work_size = &sizes[1 + 2 * work_dim];
+        std::vector<cl_event> event_wait_list;
+        for (size_t index = 2; index < handles.size(); ++index)
+          event_wait_list.push_back((cl_event) handles[index]);
+
+        errcode_ret = clEnqueueNDRangeKernel(
+            (cl_command_queue) ResolveCLHandle(handles[0]), (cl_kernel) ResolveCLHandle(handles[1]), work_dim,
+            global_work_offset[0] == (cl_uint) -1 ? NULL : global_work_offset,
+            global_work_size,
+            local_work_size[0] == (cl_uint) -1 ? NULL : local_work_size,
+            (cl_uint) event_wait_list.size(),
+            event_wait_list.empty() ? NULL : &event_wait_list[0],
+            NULL);
+        break;
+      }
+      case OpenCLCommand::CREATE_COMMAND_QUEUE:
+        if (handles.size() == 3 && sizes.size() == 1) {
+          cl_point command_queue = 0;
+          OnCallclCreateCommandQueue(handles[1], handles[2], sizes[0],
+                                     return_variable_null_status,
+                                     &errcode_ret, &command_queue);
+          AddClientCLHandle(handles[0], command_queue);
+        }
+        break;
+      case OpenCLCommand::CREATE_BUFFER:
+        if (handles.size() == 2 && sizes.size() == 2) {
+          cl_point memobj = 0;
+          OnCallclCreateBuffer(handles[1], sizes[0], sizes[1], -1,
+                               return_variable_null_status,
+                               &errcode_ret, &memobj);
+          AddClientCLHandle(handles[0], memobj);
+        }
+        break;
+      case OpenCLCommand::CREATE_SAMPLER:
+        if (handles.size() == 2 && sizes.size() == 3) {
+          cl_point sampler = 0;
+          OnCallclCreateSampler(handles[1], sizes[0], sizes[1], sizes[2],
+                                return_variable_null_status,
+                                &errcode_ret, &sampler);
+          AddClientCLHandle(handles[0], sampler);
+        }
+        break;
+      case OpenCLCommand::CREATE_KERNEL:
+        if (handles.size() == 2) {
+          cl_point kernel = 0;
+          std::string kernel_name(command.data.begin(), command.data.end());
+          OnCallclCreateKernel(handles[1], kernel_name,
+                               return_variable_null_status,
+                               &errcode_ret, &kernel);
+          AddClientCLHandle(handles[0], kernel);
+        }
+        break;
+      case OpenCLCommand::FLUSH:
+        if (handles.size() == 1)
+          OnCallclFlush(handles[0], &errcode_ret);
+        break;
+      case OpenCLCommand::RELEASE_MEM_OBJECT:
+        if (handles.size() == 1)
+          OnCallclReleaseMemObject(handles[0], &errcode_ret);
+        break;
+      case OpenCLCommand::RELEASE_KERNEL:
+        if (handles.size() == 1)
+          OnCallclReleaseKernel(handles[0], &errcode_ret);
+        break;
+      case OpenCLCommand::RELEASE_EVENT:
+        if (handles.size() == 1)
+          OnCallclReleaseEvent(handles[0], &errcode_ret);
+        break;
+    }
 
-  if (num_events_in_wait_list > 0)
-    delete[] event_wait_list;
+    if (CL_SUCCESS != errcode_ret && CL_SUCCESS == cl_deferred_error_)
+      cl_deferred_error_ = errcode_ret;
+  }
+}
 
-  if ((size_t) -1 != *point_out_val)
-    *point_out_val = (cl_point) event_ret;
+bool GpuChannel::IsClientCLHandle(cl_point point) {
+  // Objects returned by the OpenCL runtime are aligned pointers, so odd
+  // values are free for the renderer to use as ids.
+  return (point & 1) != 0;
 }
-void GpuChannel::OnCallclEnqueueFillBuffer (std::vector<cl_point>, cl_point, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point* point_out_val, cl_int* errcode_ret)
-{
-  cl_event event_ret = NULL;
-  cl_event* event_ret_inter = NULL;
-  cl_event *event_wait_list = NULL;
-  cl_uint num_events_in_wait_list = 0;
 
-  if (num_events_in_wait_list > 0)
-    delete[] event_wait_list;
+cl_point GpuChannel::ResolveCLHandle(cl_point point) {
+  if (!IsClientCLHandle(point))
+    return point;
+  CLHandleMap::const_iterator it = cl_client_handles_.find(point);
+  return it == cl_client_handles_.end() ? 0 : it->second;
+}
 
-  if ((size_t) -1 != *point_out_val)
-    *point_out_val = (cl_point) event_ret;
+void GpuChannel::AddClientCLHandle(cl_point id, cl_point point) {
+  // A failed creation maps |id| to NULL so later calls report an invalid
+  // object instead of touching whatever |id| happens to point at.
+  if (IsClientCLHandle(id))
+    cl_client_handles_[id] = point;
 }
+
+void GpuChannel::ReportDeferredCLError(cl_int* errcode_ret) {
+  if (CL_SUCCESS != *errcode_ret)
+    return;
+  *errcode_ret = cl_deferred_error_;
+  cl_deferred_error_ = CL_SUCCESS;
+}
+
+void GpuChannel::OnRegisterCLTransferBuffer(
+    int32 id,
+    base::SharedMemoryHandle transfer_buffer,
+    uint32 size) {
+  scoped_ptr<CLTransferBuffer> buffer(new CLTransferBuffer);
+  buffer->shared_memory.reset(new base::SharedMemory(transfer_buffer, false));
+  buffer->size = size;
+  if (!buffer->shared_memory->Map(size)) {
+    DLOG(ERROR) << "Failed to map OpenCL transfer buffer " << id;
+    return;
+  }
+
+  if (cl_transfer_buffers_.Lookup(id))
+    cl_transfer_buffers_.Remove(id);
+  cl_transfer_buffers_.AddWithID(buffer.release(), id);
+}
+
+void GpuChannel::OnDestroyCLTransferBuffer(int32 id) {
+  if (cl_transfer_buffers_.Lookup(id))
+    cl_transfer_buffers_.Remove(id);
+}
+
+unsigned char* GpuChannel::GetCLTransferMemory(
+    int32 id, size_t offset, size_t size) {
+  CLTransferBuffer* buffer = cl_transfer_buffers_.Lookup(id);
+  if (!buffer || offset > buffer->size || size > buffer->size - offset)
+    return NULL;
+  return static_cast<unsigned char*>(buffer->shared_memory->memory()) + offset;
+}
+
+void GpuChannel::OnCallclEnqueueReadBufferShm(
+  const std::vector<cl_point>& point_list,
+  const std::vector<size_t>& size_t_list,
+  const int32& transfer_buffer_id,
+  const cl_uint& num_events_in_wait_list,
+  const bool& want_event,
+  cl_point* clevent_ret,
+  cl_int* errcode_ret) {
+  // Receiving and responding the Sync IPC Message from another process
+  // and return the results of clEnqueueReadBuffer OpenCL API calling.
+  // The data lands directly in the renderer's transfer buffer, so the read
+  // has to finish before the reply goes out.
+  cl_event clevent = NULL;
+  *clevent_ret = 0;
+
+  unsigned char* ptr = NULL;
+  if (point_list.size() >= 2 && size_t_list.size() >= 3)
+    ptr = GetCLTransferMemory(transfer_buffer_id, size_t_list[2],
+                              size_t_list[1]);
+  if (!ptr) {
+    *errcode_ret = CL_INVALID_VALUE;
+    return;
+  }
+
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_list[0]);
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_list[1]);
+  std::vector<cl_event> event_wait_list;
+  for (cl_uint index = 0;
+       index < num_events_in_wait_list && 2 + index < point_list.size();
+       ++index)
+    event_wait_list.push_back((cl_event) point_list[2 + index]);
+
+  // Call the OpenCL API.
+  *errcode_ret = clEnqueueReadBuffer(
+      command_queue, buffer, CL_TRUE, size_t_list[0], size_t_list[1], ptr,
+      (cl_uint) event_wait_list.size(),
+      event_wait_list.empty() ? NULL : &event_wait_list[0],
+      want_event ? &clevent : NULL);
+  ReportDeferredCLError(errcode_ret);
+
+  *clevent_ret = (cl_point) clevent;
+}
+
+void GpuChannel::OnCallclEnqueueWriteBufferShm(
+  const std::vector<cl_point>& point_list,
+  const std::vector<size_t>& size_t_list,
+  const int32& transfer_buffer_id,
+  const cl_uint& num_events_in_wait_list,
+  const bool& want_event,
+  cl_point* clevent_ret,
+  cl_int* errcode_ret) {
+  // Receiving and responding the Sync IPC Message from another process
+  // and return the results of clEnqueueWriteBuffer OpenCL API calling.
+  // The renderer reuses the transfer buffer as soon as the reply arrives,
+  // so the write has to consume it first.
+  cl_event clevent = NULL;
+  *clevent_ret = 0;
+
+  unsigned char* ptr = NULL;
+  if (point_list.size() >= 2 && size_t_list.size() >= 3)
+    ptr = GetCLTransferMemory(transfer_buffer_id, size_t_list[2],
+                              size_t_list[1]);
+  if (!ptr) {
+    *errcode_ret = CL_INVALID_VALUE;
+    return;
+  }
+
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_list[0]);
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_list[1]);
+  std::vector<cl_event> event_wait_list;
+  for (cl_uint index = 0;
+       index < num_events_in_wait_list && 2 + index < point_list.size();
+       ++index)
+    event_wait_list.push_back((cl_event) point_list[2 + index]);
+
+  // Call the OpenCL API.
+  *errcode_ret = clEnqueueWriteBuffer(
+      command_queue, buffer, CL_TRUE, size_t_list[0], size_t_list[1], ptr,
+      (cl_uint) event_wait_list.size(),
+      event_wait_list.empty() ? NULL : &event_wait_list[0],
+      want_event ? &clevent : NULL);
+
+  *clevent_ret = (cl_point) clevent;
+}
+
+void GpuChannel::OnCallclEnqueueWriteBufferRect(
+  const std::vector<cl_point>& point_list,
+  const std::vector<size_t>& size_t_list,
+  const int32& transfer_buffer_id,
+  const cl_uint& num_events_in_wait_list,
+  const bool& want_event,
+  cl_point* clevent_ret,
+  cl_int* errcode_ret) {
+  // Receiving and responding the Sync IPC Message from another process
+  // and return the results of clEnqueueWriteBufferRect OpenCL API calling.
+  EnqueueCLRectTransfer(true, point_list, size_t_list, transfer_buffer_id,
+                        num_events_in_wait_list, want_event, clevent_ret,
+                        errcode_ret);
+}
+
+void GpuChannel::EnqueueCLRectTransfer(
+    bool write,
+    const std::vector<cl_point>& point_list,
+    const std::vector<size_t>& size_t_list,
+    int32 transfer_buffer_id,
+    cl_uint num_events_in_wait_list,
+    bool want_event,
+    cl_point* clevent_ret,
+    cl_int* errcode_ret) {
+  // The renderer reuses the transfer buffer as soon as the reply arrives,
+  // so the transfer is always blocking.
+  cl_event clevent = NULL;
+  *clevent_ret = 0;
+
+  unsigned char* ptr = NULL;
+  size_t packed_size = 0;
+  if (point_list.size() >= 2 && size_t_list.size() >= 9 &&
+      PackedCLRectSize(&size_t_list[3], &packed_size)) {
+    ptr = GetCLTransferMemory(transfer_buffer_id, size_t_list[8],
+                              packed_size);
+  }
+  if (!ptr) {
+    *errcode_ret = CL_INVALID_VALUE;
+    return;
+  }
+
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_list[0]);
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_list[1]);
+  std::vector<cl_event> event_wait_list;
+  for (cl_uint index = 0;
+       index < num_events_in_wait_list && 2 + index < point_list.size();
+       ++index)
+    event_wait_list.push_back((cl_event) point_list[2 + index]);
+
+  const size_t* buffer_origin = &size_t_list[0];
+  const size_t* region = &size_t_list[3];
+  const size_t host_origin[3] = { 0, 0, 0 };
+  size_t host_row_pitch = region[0];
+  size_t host_slice_pitch = region[0] * region[1];
+
+  // Call the OpenCL API.
+  if (write) {
+    *errcode_ret = clEnqueueWriteBufferRect(
+        command_queue, buffer, CL_TRUE, buffer_origin, host_origin, region,
+        size_t_list[6], size_t_list[7], host_row_pitch, host_slice_pitch,
+        ptr, (cl_uint) event_wait_list.size(),
+        event_wait_list.empty() ? NULL : &event_wait_list[0],
+        want_event ? &clevent : NULL);
+  } else {
+    *errcode_ret = clEnqueueReadBufferRect(
+        command_queue, buffer, CL_TRUE, buffer_origin, host_origin, region,
+        size_t_list[6], size_t_list[7], host_row_pitch, host_slice_pitch,
+        ptr, (cl_uint) event_wait_list.size(),
+        event_wait_list.empty() ? NULL : &event_wait_list[0],
+        want_event ? &clevent : NULL);
+    ReportDeferredCLError(errcode_ret);
+  }
+
+  *clevent_ret = (cl_point) clevent;
+}
+
+void GpuChannel::OnCallclEnqueueFillBuffer(
+  const std::vector<cl_point>& point_list,
+  const std::vector<unsigned char>& pattern,
+  const std::vector<size_t>& size_t_list,
+  const cl_uint& num_events_in_wait_list,
+  const bool& want_event,
+  cl_point* clevent_ret,
+  cl_int* errcode_ret) {
+  // Receiving and responding the Sync IPC Message from another process
+  // and return the results of clEnqueueFillBuffer OpenCL API calling.
+  cl_event clevent = NULL;
+  *clevent_ret = 0;
+
+  if (point_list.size() < 2 || size_t_list.size() < 2 || pattern.empty()) {
+    *errcode_ret = CL_INVALID_VALUE;
+    return;
+  }
+
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_list[0]);
+  cl_mem buffer = (cl_mem) ResolveCLHandle(point_list[1]);
+  std::vector<cl_event> event_wait_list;
+  for (cl_uint index = 0;
+       index < num_events_in_wait_list && 2 + index < point_list.size();
+       ++index)
+    event_wait_list.push_back((cl_event) point_list[2 + index]);
+
+  // Call the OpenCL API.
+  *errcode_ret = clEnqueueFillBuffer(
+      command_queue, buffer, &pattern[0], pattern.size(),
+      size_t_list[0], size_t_list[1], (cl_uint) event_wait_list.size(),
+      event_wait_list.empty() ? NULL : &event_wait_list[0],
+      want_event ? &clevent : NULL);
+
+  *clevent_ret = (cl_point) clevent;
+}
+
 void GpuChannel::OnCallclEnqueueCopyBuffer (std::vector<cl_point>, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point* point_out_val, cl_int* errcode_ret)
 {
   cl_event event_ret = NULL;
@@ -4314,19 +5356,6 @@ void GpuChannel::OnCallclEnqueueCopyBufferToImage (std::vector<cl_point>, size_t
   if ((size_t) -1 != *point_out_val)
     *point_out_val = (cl_point) event_ret;
 }
-void GpuChannel::OnCallclEnqueueMapBuffer (std::vector<cl_point>, cl_bool, cl_map_flags, std::vector<size_t>, cl_point* point_out_val, cl_int* errcode_ret, cl_point*)
-{
-  cl_event event_ret = NULL;
-  cl_event* event_ret_inter = NULL;
-  cl_event *event_wait_list = NULL;
-  cl_uint num_events_in_wait_list = 0;
-
-  if (num_events_in_wait_list > 0)
-    delete[] event_wait_list;
-
-  if ((size_t) -1 != *point_out_val)
-    *point_out_val = (cl_point) event_ret;
-}
 void GpuChannel::OnCallclEnqueueMapImage (std::vector<cl_point>, cl_bool, cl_map_flags, std::vector<size_t>, cl_uint, cl_point* point_out_val, cl_int* errcode_ret, cl_point*)
 {
   cl_event event_ret = NULL;
@@ -4340,19 +5369,6 @@ void GpuChannel::OnCallclEnqueueMapImage (std::vector<cl_point>, cl_bool, cl_map
   if ((size_t) -1 != *point_out_val)
     *point_out_val = (cl_point) event_ret;
 }
-void GpuChannel::OnCallclEnqueueUnmapMemObject (cl_point, cl_point, cl_point, cl_uint, std::vector<cl_point>, cl_point* point_out_val, cl_int* errcode_ret)
-{
-  cl_event event_ret = NULL;
-  cl_event* event_ret_inter = NULL;
-  cl_event *event_wait_list = NULL;
-  cl_uint num_events_in_wait_list = 0;
-
-  if (num_events_in_wait_list > 0)
-    delete[] event_wait_list;
-
-  if ((size_t) -1 != *point_out_val)
-    *point_out_val = (cl_point) event_ret;
-}
 void GpuChannel::OnCallclEnqueueMigrateMemObjects (cl_point, std::vector<cl_uint>, std::vector<cl_point>, cl_mem_migration_flags, std::vector<cl_point>, cl_point* point_out_val, cl_int* errcode_ret)
 {
   // Receiving and responding the Sync IPC Message from another process and
@@ -4376,8 +5392,8 @@ void GpuChannel::OnCallclEnqueueNDRangeKernel (const std::vector<cl_point>& cmdq
 {
   // Receiving and responding the Sync IPC Message from another process and
   // return the results of clEnqueueNDRangeKernel OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) cmdqueue_kernel[0];
-  cl_kernel kernel = (cl_kernel)cmdqueue_kernel[1];
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(cmdqueue_kernel[0]);
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(cmdqueue_kernel[1]);
   const size_t *global_work_offset = size_t_list[0]==(cl_uint)-1 ? NULL : &size_t_list[0];
   const size_t *global_work_size = &size_t_list[1*work_dim];
   const size_t *local_work_size = size_t_list[2*work_dim]==(cl_uint)-1 ? NULL : &size_t_list[2*work_dim];
@@ -4405,8 +5421,8 @@ void GpuChannel::OnCallclEnqueueTask (cl_point point_command_queue, cl_point poi
 {
   // Receiving and responding the Sync IPC Message from another process and
   // return the results of clEnqueueNativeKernel OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
-  cl_kernel kernel = (cl_kernel) point_kernel;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
+  cl_kernel kernel = (cl_kernel) ResolveCLHandle(point_kernel);
   cl_event event_ret;
   cl_event* event_ret_inter = NULL;
   cl_event *event_wait_list = NULL;
@@ -4434,7 +5450,7 @@ void GpuChannel::OnCallclEnqueueNativeKernel (std::vector<cl_point> point_in_lis
 {
   // Receiving and responding the Sync IPC Message from another process and
   // return the results of clEnqueueNativeKernel OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_in_list[0];
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_in_list[0]);
   void (CL_CALLBACK* user_func)(void*) = (void (CL_CALLBACK*)(void*)) point_in_list[1];
   void* args = (void*) point_in_list[2];
   cl_event event_ret;
@@ -4449,7 +5465,7 @@ void GpuChannel::OnCallclEnqueueNativeKernel (std::vector<cl_point> point_in_lis
   {
     mem_list = new cl_mem[num_mem_objects];
     for (cl_uint index = 0; index < num_mem_objects; ++index)
-      mem_list[index] = (cl_mem) point_mem_list[index];
+      mem_list[index] = (cl_mem) ResolveCLHandle(point_mem_list[index]);
   }
 
   if (num_events_in_wait_list > 0)
@@ -4478,7 +5494,7 @@ void GpuChannel::OnCallclEnqueueMarkerWithWaitList (cl_point point_in_val, cl_ui
 {
   // Receiving and responding the Sync IPC Message from another process and
   // return the results of clEnqueueMarkerWithWaitList OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_in_val;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_in_val);
   cl_event event_ret;
   cl_event* event_ret_inter = NULL;
   cl_event *event_wait_list = NULL;
@@ -4510,7 +5526,7 @@ void GpuChannel::OnCallclEnqueueBarrierWithWaitList(
     cl_int* errcode_ret) {
   // Receiving and responding the Sync IPC Message from another process and
   // return the results of clEnqueueBarrierWithWaitList OpenCL API calling.
-  cl_command_queue command_queue = (cl_command_queue) point_command_queue;
+  cl_command_queue command_queue = (cl_command_queue) ResolveCLHandle(point_command_queue);
   cl_event event_ret;
   cl_event* event_ret_inter = NULL;
   cl_event *event_wait_list = NULL;
@@ -4581,7 +5597,9 @@ void GpuChannel::OnCallclEnqueueBarrierWithWaitList(
   {
 	  this->current_stub_->sv_flush();
 	  TRACE_EVENT0("GpuChannel", "OnCallclEnqueueAcquireGLObjects");
-	  *func_ret = sv_clEnqueueAcquireGLObjects((cl_command_queue)cmdqueue,
+	  for (size_t index = 0; index < mem_objects.size(); ++index)
+		  mem_objects[index] = ResolveCLHandle(mem_objects[index]);
+	  *func_ret = sv_clEnqueueAcquireGLObjects((cl_command_queue) ResolveCLHandle(cmdqueue),
 		  mem_objects.size(), mem_objects.size() ? (cl_mem*)&mem_objects[0] : NULL,
 		  event_wait_list.size(), event_wait_list.size() ? (cl_event*)&event_wait_list[0] : NULL,
 		  (cl_event*)event_ret);
@@ -4597,7 +5615,9 @@ void GpuChannel::OnCallclEnqueueBarrierWithWaitList(
   {
 	  this->current_stub_->sv_flush();
 	  TRACE_EVENT0("GpuChannel", "OnCallclEnqueueReleaseGLObjects");
-	  *func_ret = sv_clEnqueueReleaseGLObjects((cl_command_queue)cmdqueue,
+	  for (size_t index = 0; index < mem_objects.size(); ++index)
+		  mem_objects[index] = ResolveCLHandle(mem_objects[index]);
+	  *func_ret = sv_clEnqueueReleaseGLObjects((cl_command_queue) ResolveCLHandle(cmdqueue),
 		  mem_objects.size(), mem_objects.size() ? (cl_mem*)&mem_objects[0] : NULL,
 		  event_wait_list.size(), event_wait_list.size() ? (cl_event*)&event_wait_list[0] : NULL,
 		  (cl_event*)event_ret);
@@ -8,15 +8,22 @@
 #include <deque>
 #include <string>
 
+#include "base/containers/hash_tables.h"
 #include "base/id_map.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
+#include "base/memory/shared_memory.h"
 #include "base/memory/weak_ptr.h"
 #include "base/process/process.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/thread.h"
 #include "build/build_config.h"
 #include "content/common/gpu/gpu_command_buffer_stub.h"
 #include "content/common/gpu/gpu_memory_manager.h"
+#include "content/common/gpu/opencl_buffer_pool.h"
+#include "content/common/gpu/opencl_command.h"
 #include "content/common/message_router.h"
 #include "ipc/ipc_sync_channel.h"
 #include "ui/gfx/native_widget_types.h"
@@ -58,6 +65,7 @@ namespace content {
 class GpuChannelManager;
 class GpuChannelMessageFilter;
 struct GpuRenderingStats;
+class OpenCLMessageFilter;
 class GpuVideoEncodeAccelerator;
 class GpuWatchdog;
 
@@ -175,11 +183,31 @@ class GpuChannel : public IPC::Listener,
  private:
   friend class base::RefCountedThreadSafe<GpuChannel>;
   friend class GpuChannelMessageFilter;
+  friend class OpenCLMessageFilter;
 
   void OnDestroy();
 
   bool OnControlMessageReceived(const IPC::Message& msg);
 
+  // OpenCL messages are handled on |cl_thread_| so that blocking OpenCL
+  // calls do not hold up GL command buffers. The GL interop messages among
+  // them need the GL context and stay on the main thread. Replies are sent
+  // from |cl_thread_|; IPC::ChannelProxy::Send hands them to the IO thread.
+  static bool IsOpenCLMessage(uint32 type);
+  static bool IsOpenCLGLInteropMessage(uint32 type);
+  bool OnOpenCLMessageReceived(const IPC::Message& msg);
+  void HandleOpenCLMessage(IPC::Message* message);
+
+  // Parks |cl_thread_| once the OpenCL messages queued ahead have run, so
+  // that a GL interop message can use OpenCL state from the main thread.
+  void PauseOpenCLThread();
+  void ResumeOpenCLThread();
+
+  // Drops the idle buffers of |cl_buffer_pool_| on memory pressure.
+  void OnCLMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+  void TrimCLBufferPool();
+
   void HandleMessage();
 
   // Message handlers.
@@ -256,6 +284,56 @@ class GpuChannel : public IPC::Listener,
   typedef IDMap<GpuVideoEncodeAccelerator, IDMapOwnPointer> EncoderMap;
   EncoderMap video_encoders_;
 
+  // Shared memory the renderer stages large OpenCL buffer transfers in.
+  struct CLTransferBuffer {
+    scoped_ptr<base::SharedMemory> shared_memory;
+    size_t size;
+  };
+  typedef IDMap<CLTransferBuffer, IDMapOwnPointer> CLTransferBufferMap;
+  CLTransferBufferMap cl_transfer_buffers_;
+
+  // First error raised by a batched OpenCL command since the last
+  // synchronization point, see OnCallclCommandBatch.
+  cl_int cl_deferred_error_;
+
+  // Maps ids the renderer picked for objects it created through the command
+  // batch to the objects the OpenCL runtime returned.
+  typedef base::hash_map<cl_point, cl_point> CLHandleMap;
+  CLHandleMap cl_client_handles_;
+
+  // Sources of programs created with clCreateProgramWithSource, used to key
+  // the program binary cache.
+  typedef base::hash_map<cl_point, std::string> CLProgramSourceMap;
+  CLProgramSourceMap cl_program_sources_;
+
+  // Programs rebuilt from cached binaries. The renderer keeps using the
+  // handle of the source program, which is resolved to the cached one.
+  typedef base::hash_map<cl_point, cl_point> CLProgramAliasMap;
+  CLProgramAliasMap cl_program_aliases_;
+
+  // Build options of the programs in |cl_program_sources_|.
+  CLProgramSourceMap cl_program_options_;
+
+  // Kernel argument info is only reported for programs built from source
+  // with -cl-kernel-arg-info, which cached binaries and page builds are not.
+  // Such queries are answered from a program built from the same source with
+  // that option, kept per source program, and a kernel of the same name in
+  // it, kept per kernel of the page.
+  CLProgramAliasMap cl_arg_info_programs_;
+  typedef base::hash_map<cl_point, cl_point> CLKernelAliasMap;
+  CLKernelAliasMap cl_arg_info_kernels_;
+
+  // Buffers released by the page, kept for reuse by later clCreateBuffer
+  // calls. Only touched by the OpenCL message handlers.
+  OpenCLBufferPool cl_buffer_pool_;
+  scoped_ptr<base::MemoryPressureListener> cl_memory_pressure_listener_;
+
+  // Thread running the OpenCL message handlers, fed by |cl_filter_|.
+  scoped_ptr<base::Thread> cl_thread_;
+  scoped_refptr<OpenCLMessageFilter> cl_filter_;
+  base::WaitableEvent cl_thread_paused_;
+  base::WaitableEvent cl_thread_resume_;
+
   bool log_messages_;  // True if we should log sent and received messages.
   gpu::gles2::DisallowedFeatures disallowed_features_;
   GpuWatchdog* watchdog_;
@@ -356,7 +434,7 @@ class GpuChannel : public IPC::Listener,
       const cl_point&,
       const cl_mem_flags&,
       const size_t&,
-      const cl_point&,
+      const int32&,
       const std::vector<bool>&,
       cl_int*,
       cl_point*);
@@ -546,10 +624,13 @@ class GpuChannel : public IPC::Listener,
   void OnCallclSetEventCallback(
       const cl_point&,
       const cl_int&,
-      const cl_point&,
-      const cl_point&,
+      const int32&,
       cl_int*);
 
+  void OnCallclFinishAsync(
+      const cl_point&,
+      const int32&);
+
   void OnCallclFlush(
       const cl_point&,
       cl_int*);
@@ -567,6 +648,18 @@ class GpuChannel : public IPC::Listener,
       size_t*,
       cl_int*);
 
+  void OnCallclGetPlatformInfoList(
+      const cl_point&,
+      const std::vector<cl_uint>&,
+      std::vector<std::vector<unsigned char>>*,
+      std::vector<cl_int>*);
+
+  void OnCallclGetDeviceInfoList(
+      const cl_point&,
+      const std::vector<cl_uint>&,
+      std::vector<std::vector<unsigned char>>*,
+      std::vector<cl_int>*);
+
   void OnCallclGetDeviceInfo_cl_uint(
       const cl_point&,
       const cl_device_info&,
@@ -1008,6 +1101,111 @@ class GpuChannel : public IPC::Listener,
     cl_point*,
     cl_int*);
 
+  void OnCallclCommandBatch(const std::vector<OpenCLCommand>& commands);
+
+  // Client handle ids are odd; everything else is passed through unchanged.
+  // ResolveCLHandle returns NULL for an id that was never created.
+  static bool IsClientCLHandle(cl_point point);
+  cl_point ResolveCLHandle(cl_point point);
+  void AddClientCLHandle(cl_point id, cl_point point);
+
+  // Creates and builds a program from cached binaries in place of
+  // |point_program|. Returns false if any device misses the cache.
+  bool BuildCLProgramFromCache(cl_point point_program,
+                               const std::string& source,
+                               cl_uint num_devices,
+                               const cl_device_id* device_list,
+                               const std::string& options);
+  // Stores the binaries of a freshly built |program| in the cache.
+  void StoreCLProgramBinaries(cl_program program,
+                              const std::string& source,
+                              const std::string& options);
+  void DropCLProgramAlias(cl_point point_program);
+  cl_point ResolveCLProgram(cl_point point_program);
+
+  // clGetKernelArgInfo, falling back to the kernel's twin in a program built
+  // with -cl-kernel-arg-info when |kernel| has no argument info.
+  cl_int GetCLKernelArgInfo(cl_kernel kernel,
+                            cl_uint arg_index,
+                            cl_kernel_arg_info param_name,
+                            size_t param_value_size,
+                            void* param_value,
+                            size_t* param_value_size_ret);
+  // Returns the twin of |kernel| with argument info, or NULL.
+  cl_kernel GetCLArgInfoKernel(cl_kernel kernel);
+  void DropCLArgInfoProgram(cl_point point_program);
+
+  // Replaces a successful |errcode_ret| with the pending deferred error, if
+  // any, and clears it. Called at synchronization points.
+  void ReportDeferredCLError(cl_int* errcode_ret);
+
+  void OnRegisterCLTransferBuffer(
+      int32 id,
+      base::SharedMemoryHandle transfer_buffer,
+      uint32 size);
+
+  void OnDestroyCLTransferBuffer(int32 id);
+
+  // Returns |size| bytes at |offset| of transfer buffer |id|, or NULL if the
+  // range is not inside a registered buffer.
+  unsigned char* GetCLTransferMemory(int32 id, size_t offset, size_t size);
+
+  void OnCallclEnqueueReadBufferShm(
+      const std::vector<cl_point>&,
+      const std::vector<size_t>&,
+      const int32&,
+      const cl_uint&,
+      const bool&,
+      cl_point*,
+      cl_int*);
+
+  void OnCallclEnqueueWriteBufferShm(
+      const std::vector<cl_point>&,
+      const std::vector<size_t>&,
+      const int32&,
+      const cl_uint&,
+      const bool&,
+      cl_point*,
+      cl_int*);
+
+  void OnCallclEnqueueReadBufferRect(
+      const std::vector<cl_point>&,
+      const std::vector<size_t>&,
+      const int32&,
+      const cl_uint&,
+      const bool&,
+      cl_point*,
+      cl_int*);
+
+  void OnCallclEnqueueWriteBufferRect(
+      const std::vector<cl_point>&,
+      const std::vector<size_t>&,
+      const int32&,
+      const cl_uint&,
+      const bool&,
+      cl_point*,
+      cl_int*);
+
+  // Shared by the two handlers above.
+  void EnqueueCLRectTransfer(
+      bool write,
+      const std::vector<cl_point>& point_list,
+      const std::vector<size_t>& size_t_list,
+      int32 transfer_buffer_id,
+      cl_uint num_events_in_wait_list,
+      bool want_event,
+      cl_point* clevent_ret,
+      cl_int* errcode_ret);
+
+  void OnCallclEnqueueFillBuffer(
+      const std::vector<cl_point>&,
+      const std::vector<unsigned char>&,
+      const std::vector<size_t>&,
+      const cl_uint&,
+      const bool&,
+      cl_point*,
+      cl_int*);
+
   void OnCallclEnqueueNDRangeKernel(
     const std::vector<cl_point>&,
     cl_int,
@@ -1016,9 +1214,6 @@ class GpuChannel : public IPC::Listener,
     cl_point*,
     cl_int*);
 
-  void OnCallclEnqueueReadBufferRect             (std::vector<cl_point>, cl_bool, std::vector<size_t>, cl_point, cl_uint, cl_point*, cl_int*);
-  void OnCallclEnqueueWriteBufferRect            (std::vector<cl_point>, cl_bool, std::vector<size_t>, cl_point, cl_uint, cl_point*, cl_int*);
-  void OnCallclEnqueueFillBuffer                 (std::vector<cl_point>, cl_point, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueCopyBuffer                 (std::vector<cl_point>, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueCopyBufferRect             (std::vector<cl_point>, std::vector<size_t>, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueReadImage                  (std::vector<cl_point>, cl_bool, std::vector<size_t>, cl_point, cl_uint, cl_point*, cl_int*);
@@ -1027,9 +1222,7 @@ class GpuChannel : public IPC::Listener,
   void OnCallclEnqueueCopyImage                  (std::vector<cl_point>, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueCopyImageToBuffer          (std::vector<cl_point>, std::vector<size_t>, size_t, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueCopyBufferToImage          (std::vector<cl_point>, size_t, std::vector<size_t>, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
-  void OnCallclEnqueueMapBuffer                  (std::vector<cl_point>, cl_bool, cl_map_flags, std::vector<size_t>, cl_point*, cl_int*, cl_point*);
   void OnCallclEnqueueMapImage                   (std::vector<cl_point>, cl_bool, cl_map_flags, std::vector<size_t>, cl_uint, cl_point*, cl_int*, cl_point*);
-  void OnCallclEnqueueUnmapMemObject             (cl_point, cl_point, cl_point, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueMigrateMemObjects          (cl_point, std::vector<cl_uint>, std::vector<cl_point>, cl_mem_migration_flags, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueTask                       (cl_point, cl_point, cl_uint, std::vector<cl_point>, cl_point*, cl_int*);
   void OnCallclEnqueueNativeKernel               (std::vector<cl_point>, size_t, std::vector<cl_uint>, cl_point, std::vector<cl_point>, cl_point*, cl_int*);
@@ -13,6 +13,7 @@
 #include "content/common/gpu/gpu_memory_uma_stats.h"
 #include "content/common/gpu/gpu_process_launch_causes.h"
 #include "content/common/gpu/gpu_rendering_stats.h"
+#include "content/common/gpu/opencl_command.h"
 #include "content/public/common/common_param_traits.h"
 #include "content/public/common/gpu_memory_stats.h"
 #include "gpu/command_buffer/common/command_buffer.h"
@@ -190,6 +191,13 @@ IPC_STRUCT_TRAITS_BEGIN(content::GPUMemoryUmaStats)
   IPC_STRUCT_TRAITS_MEMBER(bytes_limit)
 IPC_STRUCT_TRAITS_END()
 
+IPC_STRUCT_TRAITS_BEGIN(content::OpenCLCommand)
+  IPC_STRUCT_TRAITS_MEMBER(op)
+  IPC_STRUCT_TRAITS_MEMBER(handles)
+  IPC_STRUCT_TRAITS_MEMBER(sizes)
+  IPC_STRUCT_TRAITS_MEMBER(data)
+IPC_STRUCT_TRAITS_END()
+
 IPC_STRUCT_TRAITS_BEGIN(gpu::MemoryAllocation)
   IPC_STRUCT_TRAITS_MEMBER(bytes_limit_when_visible)
   IPC_STRUCT_TRAITS_MEMBER(priority_cutoff_when_visible)
@@ -787,6 +795,16 @@ IPC_MESSAGE_ROUTED1(AcceleratedVideoEncoderHostMsg_NotifyError,
 // OpenCL Channel Messages
 // These are messages from a renderer process to the OpenCL/GPU process.
 // Calling OpenCL API from a renderer process, then run in OpenCL/GPU process.
+// GpuChannel tells them apart by message id, which follows declaration
+// order: keep every OpenCL message between OpenCLChannelMsg_CommandBatch and
+// the GL interop messages at the end, and nothing else in between. See
+// GpuChannel::IsOpenCLMessage.
+
+// Run a batch of OpenCL calls that only report an error code. There is no
+// reply; the first failure is returned by the next OpenCLChannelMsg_Finish,
+// OpenCLChannelMsg_WaitForEvents or blocking buffer read.
+IPC_MESSAGE_CONTROL1(OpenCLChannelMsg_CommandBatch,
+                     std::vector<content::OpenCLCommand>)
 
 // Call and respond OpenCL API clGetPlatformIDs using Sync IPC Message
 IPC_SYNC_MESSAGE_CONTROL2_3(OpenCLChannelMsg_GetPlatformIDs,
@@ -875,12 +893,14 @@ IPC_SYNC_MESSAGE_CONTROL1_1(OpenCLChannelMsg_ReleaseCommandQueue,
                             cl_point,
                             cl_int)
 
-// Call and respond OpenCL API clCreateBuffer using Sync IPC Message
+// Call and respond OpenCL API clCreateBuffer using Sync IPC Message.
+// CL_MEM_COPY_HOST_PTR buffers take their initial contents from the start of
+// a transfer buffer, the id of which is -1 for the others.
 IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_CreateBuffer,
                             cl_point,
                             cl_mem_flags,
                             size_t,
-                            cl_point,
+                            int32 /* transfer buffer id */,
                             std::vector<bool>,
                             cl_int,
                             cl_point)
@@ -1101,14 +1121,29 @@ IPC_SYNC_MESSAGE_CONTROL2_1(OpenCLChannelMsg_SetUserEventStatus,
                             cl_int,
                             cl_int)
 
-// Call and respond OpenCL API clSetEventCallback using Sync IPC Message
-IPC_SYNC_MESSAGE_CONTROL4_1(OpenCLChannelMsg_SetEventCallback,
-                            cl_point,
-                            cl_int,
-                            cl_point,
-                            cl_point,
+// Registers a clSetEventCallback on an event. The renderer's function
+// pointer cannot cross the process boundary, so it picks a callback id and
+// the GPU process answers with OpenCLChannelMsg_EventCallbackFired.
+IPC_SYNC_MESSAGE_CONTROL3_1(OpenCLChannelMsg_SetEventCallback,
+                            cl_point /* event */,
+                            cl_int /* command_exec_callback_type */,
+                            int32 /* callback_id */,
                             cl_int)
 
+// Non-blocking clFinish: the GPU process enqueues a marker behind
+// everything queued on the command queue and sends
+// OpenCLChannelMsg_EventCallbackFired once it completes.
+IPC_MESSAGE_CONTROL2(OpenCLChannelMsg_FinishAsync,
+                     cl_point /* command_queue */,
+                     int32 /* callback_id */)
+
+// Sent from the GPU process when the event registered under |callback_id|
+// reaches the requested status, or with an error code if registering the
+// callback failed.
+IPC_MESSAGE_CONTROL2(OpenCLChannelMsg_EventCallbackFired,
+                     int32 /* callback_id */,
+                     cl_int /* event_command_exec_status */)
+
 // Call and respond OpenCL API clFlush using Sync IPC Message
 IPC_SYNC_MESSAGE_CONTROL1_1(OpenCLChannelMsg_Flush,
                             cl_point,
@@ -1129,13 +1164,17 @@ IPC_SYNC_MESSAGE_CONTROL4_3(OpenCLChannelMsg_EnqueueReadBuffer,
                             cl_point,
                             cl_int)
 
-// Call and respond OpenCL API clEnqueueReadBufferRect using Sync IPC Message
+// Call and respond OpenCL API clEnqueueReadBufferRect using Sync IPC Message,
+// reading into a registered transfer buffer with the rows of the region
+// packed back to back. The size_t list carries {buffer_origin[3],
+// region[3], buffer_row_pitch, buffer_slice_pitch, transfer buffer offset};
+// the read is always blocking.
 IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueReadBufferRect,
                             std::vector<cl_point>,
-                            cl_bool,
                             std::vector<size_t>,
-                            cl_point,
+                            int32 /* transfer buffer id */,
                             cl_uint,
+                            bool /* return an event */,
                             cl_point,
                             cl_int)
 
@@ -1149,24 +1188,61 @@ IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueWriteBuffer,
                             cl_point,
                             cl_int)
 
-// Call and respond OpenCL API clEnqueueWriteBufferRect
-// using Sync IPC Message
-IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueWriteBufferRect,
+// Register a shared memory region the renderer stages large
+// clEnqueueReadBuffer/clEnqueueWriteBuffer payloads in.
+IPC_MESSAGE_CONTROL3(OpenCLChannelMsg_RegisterTransferBuffer,
+                     int32 /* id */,
+                     base::SharedMemoryHandle /* transfer_buffer */,
+                     uint32 /* size */)
+
+// Unmap and forget a transfer buffer registered above.
+IPC_MESSAGE_CONTROL1(OpenCLChannelMsg_DestroyTransferBuffer,
+                     int32 /* id */)
+
+// Call and respond OpenCL API clEnqueueReadBuffer using Sync IPC Message,
+// reading into a registered transfer buffer. The size_t list carries
+// {offset, size, transfer buffer offset}; the read is always blocking.
+IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueReadBufferShm,
                             std::vector<cl_point>,
-                            cl_bool,
                             std::vector<size_t>,
-                            cl_point,
+                            int32 /* transfer buffer id */,
                             cl_uint,
+                            bool /* return an event */,
                             cl_point,
                             cl_int)
 
-// Call and respond OpenCL API clEnqueueFillBuffer using Sync IPC Message
-IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueFillBuffer,
+// Call and respond OpenCL API clEnqueueWriteBuffer using Sync IPC Message,
+// writing from a registered transfer buffer. The size_t list carries
+// {offset, size, transfer buffer offset}; the write is always blocking.
+IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueWriteBufferShm,
                             std::vector<cl_point>,
+                            std::vector<size_t>,
+                            int32 /* transfer buffer id */,
+                            cl_uint,
+                            bool /* return an event */,
                             cl_point,
+                            cl_int)
+
+// Call and respond OpenCL API clEnqueueWriteBufferRect using Sync IPC
+// Message, writing from a registered transfer buffer laid out as for
+// OpenCLChannelMsg_EnqueueReadBufferRect; the write is always blocking.
+IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueWriteBufferRect,
+                            std::vector<cl_point>,
                             std::vector<size_t>,
+                            int32 /* transfer buffer id */,
                             cl_uint,
+                            bool /* return an event */,
+                            cl_point,
+                            cl_int)
+
+// Call and respond OpenCL API clEnqueueFillBuffer using Sync IPC Message.
+// The size_t list carries {offset, size}.
+IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueFillBuffer,
                             std::vector<cl_point>,
+                            std::vector<unsigned char> /* pattern */,
+                            std::vector<size_t>,
+                            cl_uint,
+                            bool /* return an event */,
                             cl_point,
                             cl_int)
 
@@ -1250,16 +1326,6 @@ IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueCopyBufferToImage,
                             cl_point,
                             cl_int)
 
-// Call and respond OpenCL API clEnqueueMapBuffer using Sync IPC Message
-IPC_SYNC_MESSAGE_CONTROL4_3(OpenCLChannelMsg_EnqueueMapBuffer,
-                            std::vector<cl_point>,
-                            cl_bool,
-                            cl_map_flags,
-                            std::vector<size_t>,
-                            cl_point,
-                            cl_int,
-                            cl_point)
-
 // Call and respond OpenCL API clEnqueueMapImage using Sync IPC Message
 IPC_SYNC_MESSAGE_CONTROL5_3(OpenCLChannelMsg_EnqueueMapImage,
                             std::vector<cl_point>,
@@ -1271,16 +1337,6 @@ IPC_SYNC_MESSAGE_CONTROL5_3(OpenCLChannelMsg_EnqueueMapImage,
                             cl_int,
                             cl_point)
 
-// Call and respond OpenCL API clUnmapMemObject using Sync IPC Message
-IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueUnmapMemObject,
-                            cl_point,
-                            cl_point,
-                            cl_point,
-                            cl_uint,
-                            std::vector<cl_point>,
-                            cl_point,
-                            cl_int)
-
 // Call and respond OpenCL API clEnqueueMigrateMemObjects
 // using Sync IPC Message
 IPC_SYNC_MESSAGE_CONTROL5_2(OpenCLChannelMsg_EnqueueMigrateMemObjects,
@@ -1348,6 +1404,24 @@ IPC_SYNC_MESSAGE_CONTROL4_3(OpenCLChannelMsg_GetPlatformInfo_string,
                             size_t,
                             cl_int)
 
+// Call clGetPlatformInfo for every parameter in the list at once. Each
+// value holds the raw result, or is empty when the matching error code is
+// not CL_SUCCESS.
+IPC_SYNC_MESSAGE_CONTROL2_2(OpenCLChannelMsg_GetPlatformInfoList,
+                            cl_point,
+                            std::vector<cl_uint>,
+                            std::vector<std::vector<unsigned char>>,
+                            std::vector<cl_int>)
+
+// Call clGetDeviceInfo for every parameter in the list at once, see
+// content/common/gpu/opencl_info.h. Values are laid out as for
+// OpenCLChannelMsg_GetPlatformInfoList, with size_t fields sent as uint64.
+IPC_SYNC_MESSAGE_CONTROL2_2(OpenCLChannelMsg_GetDeviceInfoList,
+                            cl_point,
+                            std::vector<cl_uint>,
+                            std::vector<std::vector<unsigned char>>,
+                            std::vector<cl_int>)
+
 // Call and respond OpenCL API clGetDeviceInfo using Sync IPC Message
 IPC_SYNC_MESSAGE_CONTROL4_3(OpenCLChannelMsg_GetDeviceInfo_cl_uint,
                             cl_point,
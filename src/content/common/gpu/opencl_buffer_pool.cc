@@ -0,0 +1,166 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/common/gpu/opencl_buffer_pool.h"
+
+#include "base/logging.h"
+
+namespace content {
+
+OpenCLBufferPool::OpenCLBufferPool(size_t max_idle_bytes)
+    : max_idle_bytes_(max_idle_bytes),
+      idle_bytes_(0) {
+}
+
+OpenCLBufferPool::~OpenCLBufferPool() {
+  Trim(0);
+}
+
+// static
+bool OpenCLBufferPool::CanPool(cl_mem_flags flags, const void* host_ptr) {
+  const cl_mem_flags kHostPtrFlags =
+      CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR;
+  return !host_ptr && !(flags & kHostPtrFlags);
+}
+
+cl_mem OpenCLBufferPool::Acquire(cl_context context,
+                                 cl_mem_flags flags,
+                                 size_t size) {
+  Key key = { context, flags, size };
+  for (std::list<Entry>::iterator it = idle_.begin(); it != idle_.end();
+       ++it) {
+    if (it->key == key && IsUnused(&*it)) {
+      cl_mem buffer = it->buffer;
+      idle_bytes_ -= size;
+      idle_.erase(it);
+      tracked_[buffer] = key;
+      return buffer;
+    }
+  }
+  return NULL;
+}
+
+void OpenCLBufferPool::Track(cl_mem buffer,
+                             cl_context context,
+                             cl_mem_flags flags,
+                             size_t size) {
+  DCHECK(buffer);
+  Key key = { context, flags, size };
+  tracked_[buffer] = key;
+}
+
+bool OpenCLBufferPool::Recycle(cl_mem buffer) {
+  std::map<cl_mem, Key>::iterator it = tracked_.find(buffer);
+  if (it == tracked_.end())
+    return false;
+  Key key = it->second;
+  tracked_.erase(it);
+  if (key.size > max_idle_bytes_)
+    return false;
+
+  Entry entry;
+  entry.key = key;
+  entry.buffer = buffer;
+  for (std::map<cl_command_queue, cl_context>::iterator queue =
+           queues_.begin();
+       queue != queues_.end(); ++queue) {
+    if (queue->second != key.context)
+      continue;
+    cl_event marker = NULL;
+    if (clEnqueueMarkerWithWaitList(queue->first, 0, NULL, &marker) !=
+            CL_SUCCESS ||
+        clFlush(queue->first) != CL_SUCCESS) {
+      // Without a marker there is no telling when the buffer is free, so
+      // the caller releases it.
+      if (marker)
+        entry.markers.push_back(marker);
+      for (size_t i = 0; i < entry.markers.size(); ++i)
+        clReleaseEvent(entry.markers[i]);
+      return false;
+    }
+    entry.markers.push_back(marker);
+  }
+  idle_.push_front(entry);
+  idle_bytes_ += key.size;
+  Trim(max_idle_bytes_);
+  return true;
+}
+
+void OpenCLBufferPool::RetainContext(cl_context context) {
+  ++context_refs_[context];
+}
+
+void OpenCLBufferPool::ReleaseContext(cl_context context) {
+  // A context the pool never saw created is treated as released for good.
+  std::map<cl_context, int>::iterator ref = context_refs_.find(context);
+  if (ref != context_refs_.end()) {
+    if (--ref->second > 0)
+      return;
+    context_refs_.erase(ref);
+  }
+
+  for (std::list<Entry>::iterator it = idle_.begin(); it != idle_.end();) {
+    if (it->key.context == context) {
+      idle_bytes_ -= it->key.size;
+      ReleaseEntry(&*it);
+      it = idle_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Buffers still in use are released normally from now on.
+  for (std::map<cl_mem, Key>::iterator it = tracked_.begin();
+       it != tracked_.end();) {
+    if (it->second.context == context)
+      tracked_.erase(it++);
+    else
+      ++it;
+  }
+}
+
+void OpenCLBufferPool::AddQueue(cl_context context, cl_command_queue queue) {
+  DCHECK(queue);
+  queues_[queue] = context;
+}
+
+void OpenCLBufferPool::RemoveQueue(cl_command_queue queue) {
+  if (queues_.erase(queue))
+    clFinish(queue);
+}
+
+void OpenCLBufferPool::Trim(size_t max_idle_bytes) {
+  while (idle_bytes_ > max_idle_bytes) {
+    DCHECK(!idle_.empty());
+    idle_bytes_ -= idle_.back().key.size;
+    ReleaseEntry(&idle_.back());
+    idle_.pop_back();
+  }
+}
+
+// static
+bool OpenCLBufferPool::IsUnused(Entry* entry) {
+  while (!entry->markers.empty()) {
+    cl_int status = CL_QUEUED;
+    clGetEventInfo(entry->markers.back(), CL_EVENT_COMMAND_EXECUTION_STATUS,
+                   sizeof(status), &status, NULL);
+    // Negative values report a failed command, which no longer runs either.
+    if (status > CL_COMPLETE)
+      return false;
+    clReleaseEvent(entry->markers.back());
+    entry->markers.pop_back();
+  }
+  return true;
+}
+
+// static
+void OpenCLBufferPool::ReleaseEntry(Entry* entry) {
+  // Releasing the buffer is safe with commands in flight; the runtime frees
+  // it once they are done.
+  for (size_t i = 0; i < entry->markers.size(); ++i)
+    clReleaseEvent(entry->markers[i]);
+  entry->markers.clear();
+  clReleaseMemObject(entry->buffer);
+}
+
+}  // namespace content
@@ -0,0 +1,112 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_COMMON_GPU_OPENCL_BUFFER_POOL_H_
+#define CONTENT_COMMON_GPU_OPENCL_BUFFER_POOL_H_
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+
+#include <CL/OpenCL.h>
+
+namespace content {
+
+// Keeps buffers a page released so that a later clCreateBuffer of the same
+// context, flags and size can reuse them instead of going to the driver.
+// Pages that create temporaries every frame then allocate once. Only
+// buffers created without a host pointer are pooled. A released buffer may
+// still be used by commands in flight, so it is handed out again only once
+// a marker enqueued behind them on every queue of its context completed.
+// Idle buffers are released least recently used first once they exceed the
+// pool's limit, and all of them on memory pressure. Not thread safe.
+class OpenCLBufferPool {
+ public:
+  explicit OpenCLBufferPool(size_t max_idle_bytes);
+  ~OpenCLBufferPool();
+
+  // Whether buffers created with |flags| and |host_ptr| may be pooled.
+  static bool CanPool(cl_mem_flags flags, const void* host_ptr);
+
+  // Returns an idle buffer matching |context|, |flags| and |size| that no
+  // queued command uses anymore, or NULL.
+  cl_mem Acquire(cl_context context, cl_mem_flags flags, size_t size);
+
+  // Registers a buffer just created by clCreateBuffer, so that Recycle
+  // accepts it.
+  void Track(cl_mem buffer, cl_context context, cl_mem_flags flags,
+             size_t size);
+
+  // Called instead of clReleaseMemObject when the page drops the last
+  // reference to |buffer|. Returns false if the buffer is not pooled, in
+  // which case the caller releases it.
+  bool Recycle(cl_mem buffer);
+
+  // Counts a reference the page holds on |context|, from its creation or a
+  // clRetainContext.
+  void RetainContext(cl_context context);
+
+  // Called before each clReleaseContext of the page. On its last reference,
+  // releases the idle buffers of |context|, which they keep alive, and stops
+  // pooling the ones still in use.
+  void ReleaseContext(cl_context context);
+
+  // Registers a queue of |context|, behind which Recycle waits.
+  void AddQueue(cl_context context, cl_command_queue queue);
+
+  // Called before the page drops the last reference to |queue|. Waits for
+  // it, since buffers recycled later get no marker on it.
+  void RemoveQueue(cl_command_queue queue);
+
+  // Releases idle buffers until at most |max_idle_bytes| remain.
+  void Trim(size_t max_idle_bytes);
+
+  size_t idle_bytes() const { return idle_bytes_; }
+
+ private:
+  struct Key {
+    cl_context context;
+    cl_mem_flags flags;
+    size_t size;
+
+    bool operator==(const Key& other) const {
+      return context == other.context && flags == other.flags &&
+             size == other.size;
+    }
+  };
+
+  struct Entry {
+    Key key;
+    cl_mem buffer;
+    // Markers behind the commands queued when the buffer was recycled.
+    std::vector<cl_event> markers;
+  };
+
+  // Whether all the markers of |entry| completed. Releases the ones that did.
+  static bool IsUnused(Entry* entry);
+  static void ReleaseEntry(Entry* entry);
+
+  size_t max_idle_bytes_;
+  size_t idle_bytes_;
+
+  // Idle buffers, most recently recycled first.
+  std::list<Entry> idle_;
+
+  // Buffers in use by the page that go back to |idle_| when released.
+  std::map<cl_mem, Key> tracked_;
+
+  // References the page holds on each context.
+  std::map<cl_context, int> context_refs_;
+
+  // Live queues of the page and their context.
+  std::map<cl_command_queue, cl_context> queues_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpenCLBufferPool);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_COMMON_GPU_OPENCL_BUFFER_POOL_H_
@@ -0,0 +1,60 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_COMMON_GPU_OPENCL_COMMAND_H_
+#define CONTENT_COMMON_GPU_OPENCL_COMMAND_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+
+namespace content {
+
+// An OpenCL call that only reports an error code. The renderer queues these
+// in GpuChannelHost and sends them to the GPU process in batches through
+// OpenCLChannelMsg_CommandBatch, without waiting for a reply. Errors are
+// kept by GpuChannel and returned at the next synchronization point.
+struct OpenCLCommand {
+  enum Op {
+    // handles: kernel, arg value. sizes: arg index, arg size.
+    SET_KERNEL_ARG,
+    // handles: kernel. sizes: arg index. data: arg value.
+    SET_KERNEL_ARG_VECTOR,
+    // handles: kernel. sizes: arg index and arg size for each argument.
+    // data: the arg values back to back.
+    SET_KERNEL_ARGS,
+    // handles: queue, kernel, wait events. sizes: work dim, offsets,
+    // global sizes, local sizes.
+    ENQUEUE_ND_RANGE_KERNEL,
+    // handles: queue.
+    FLUSH,
+    // handles: object.
+    RELEASE_MEM_OBJECT,
+    RELEASE_KERNEL,
+    RELEASE_EVENT,
+    // Creation calls. handles[0] is the id the renderer picked for the new
+    // object, see GpuChannelHost::AllocateCLHandleId.
+    // handles: id, context, device. sizes: properties.
+    CREATE_COMMAND_QUEUE,
+    // handles: id, context. sizes: flags, size.
+    CREATE_BUFFER,
+    // handles: id, context. sizes: normalized coords, addressing mode,
+    // filter mode.
+    CREATE_SAMPLER,
+    // handles: id, program. data: kernel name.
+    CREATE_KERNEL,
+  };
+
+  OpenCLCommand() : op(FLUSH) {}
+  explicit OpenCLCommand(Op op) : op(op) {}
+
+  uint32 op;
+  std::vector<uint32> handles;
+  std::vector<size_t> sizes;
+  std::vector<unsigned char> data;
+};
+
+}  // namespace content
+
+#endif  // CONTENT_COMMON_GPU_OPENCL_COMMAND_H_
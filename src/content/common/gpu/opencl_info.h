@@ -0,0 +1,167 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_COMMON_GPU_OPENCL_INFO_H_
+#define CONTENT_COMMON_GPU_OPENCL_INFO_H_
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include <CL/OpenCL.h>
+
+namespace content {
+
+// Device parameters that never change for the lifetime of a device.
+// GpuChannelHost fetches all of them with a single
+// OpenCLChannelMsg_GetDeviceInfoList the first time a device is queried and
+// answers clGetDeviceInfo for them locally afterwards. Reference counts,
+// availability and handle valued parameters are left out.
+const cl_device_info kImmutableCLDeviceInfo[] = {
+  CL_DEVICE_TYPE,
+  CL_DEVICE_VENDOR_ID,
+  CL_DEVICE_MAX_COMPUTE_UNITS,
+  CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS,
+  CL_DEVICE_MAX_WORK_ITEM_SIZES,
+  CL_DEVICE_MAX_WORK_GROUP_SIZE,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_CHAR,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_SHORT,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_INT,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_LONG,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_DOUBLE,
+  CL_DEVICE_PREFERRED_VECTOR_WIDTH_HALF,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_CHAR,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_SHORT,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_INT,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_LONG,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_DOUBLE,
+  CL_DEVICE_NATIVE_VECTOR_WIDTH_HALF,
+  CL_DEVICE_MAX_CLOCK_FREQUENCY,
+  CL_DEVICE_ADDRESS_BITS,
+  CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+  CL_DEVICE_IMAGE_SUPPORT,
+  CL_DEVICE_MAX_READ_IMAGE_ARGS,
+  CL_DEVICE_MAX_WRITE_IMAGE_ARGS,
+  CL_DEVICE_IMAGE2D_MAX_WIDTH,
+  CL_DEVICE_IMAGE2D_MAX_HEIGHT,
+  CL_DEVICE_IMAGE3D_MAX_WIDTH,
+  CL_DEVICE_IMAGE3D_MAX_HEIGHT,
+  CL_DEVICE_IMAGE3D_MAX_DEPTH,
+  CL_DEVICE_IMAGE_MAX_BUFFER_SIZE,
+  CL_DEVICE_IMAGE_MAX_ARRAY_SIZE,
+  CL_DEVICE_MAX_SAMPLERS,
+  CL_DEVICE_MAX_PARAMETER_SIZE,
+  CL_DEVICE_MEM_BASE_ADDR_ALIGN,
+  CL_DEVICE_MIN_DATA_TYPE_ALIGN_SIZE,
+  CL_DEVICE_SINGLE_FP_CONFIG,
+  CL_DEVICE_DOUBLE_FP_CONFIG,
+  CL_DEVICE_GLOBAL_MEM_CACHE_TYPE,
+  CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE,
+  CL_DEVICE_GLOBAL_MEM_CACHE_SIZE,
+  CL_DEVICE_GLOBAL_MEM_SIZE,
+  CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE,
+  CL_DEVICE_MAX_CONSTANT_ARGS,
+  CL_DEVICE_LOCAL_MEM_TYPE,
+  CL_DEVICE_LOCAL_MEM_SIZE,
+  CL_DEVICE_ERROR_CORRECTION_SUPPORT,
+  CL_DEVICE_HOST_UNIFIED_MEMORY,
+  CL_DEVICE_PROFILING_TIMER_RESOLUTION,
+  CL_DEVICE_ENDIAN_LITTLE,
+  CL_DEVICE_COMPILER_AVAILABLE,
+  CL_DEVICE_LINKER_AVAILABLE,
+  CL_DEVICE_EXECUTION_CAPABILITIES,
+  CL_DEVICE_QUEUE_PROPERTIES,
+  CL_DEVICE_BUILT_IN_KERNELS,
+  CL_DEVICE_NAME,
+  CL_DEVICE_VENDOR,
+  CL_DRIVER_VERSION,
+  CL_DEVICE_PROFILE,
+  CL_DEVICE_VERSION,
+  CL_DEVICE_OPENCL_C_VERSION,
+  CL_DEVICE_EXTENSIONS,
+  CL_DEVICE_PRINTF_BUFFER_SIZE,
+  CL_DEVICE_PREFERRED_INTEROP_USER_SYNC,
+  CL_DEVICE_PARTITION_MAX_SUB_DEVICES,
+  CL_DEVICE_PARTITION_AFFINITY_DOMAIN,
+};
+
+// Platform parameters, all of which are immutable strings.
+const cl_platform_info kImmutableCLPlatformInfo[] = {
+  CL_PLATFORM_PROFILE,
+  CL_PLATFORM_VERSION,
+  CL_PLATFORM_NAME,
+  CL_PLATFORM_VENDOR,
+  CL_PLATFORM_EXTENSIONS,
+};
+
+inline bool IsImmutableCLDeviceInfo(cl_device_info param_name) {
+  for (size_t i = 0; i < arraysize(kImmutableCLDeviceInfo); ++i) {
+    if (kImmutableCLDeviceInfo[i] == param_name)
+      return true;
+  }
+  return false;
+}
+
+inline bool IsImmutableCLPlatformInfo(cl_platform_info param_name) {
+  for (size_t i = 0; i < arraysize(kImmutableCLPlatformInfo); ++i) {
+    if (kImmutableCLPlatformInfo[i] == param_name)
+      return true;
+  }
+  return false;
+}
+
+// Returns true for device parameters made of size_t values. These cross the
+// channel as uint64 so that the two processes may disagree on size_t.
+inline bool IsSizeTCLDeviceInfo(cl_device_info param_name) {
+  switch (param_name) {
+    case CL_DEVICE_MAX_WORK_ITEM_SIZES:
+    case CL_DEVICE_MAX_WORK_GROUP_SIZE:
+    case CL_DEVICE_IMAGE2D_MAX_WIDTH:
+    case CL_DEVICE_IMAGE2D_MAX_HEIGHT:
+    case CL_DEVICE_IMAGE3D_MAX_WIDTH:
+    case CL_DEVICE_IMAGE3D_MAX_HEIGHT:
+    case CL_DEVICE_IMAGE3D_MAX_DEPTH:
+    case CL_DEVICE_IMAGE_MAX_BUFFER_SIZE:
+    case CL_DEVICE_IMAGE_MAX_ARRAY_SIZE:
+    case CL_DEVICE_MAX_PARAMETER_SIZE:
+    case CL_DEVICE_PROFILING_TIMER_RESOLUTION:
+    case CL_DEVICE_PRINTF_BUFFER_SIZE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Rewrites a raw array of size_t as an array of uint64.
+inline void WidenCLSizeTInfo(std::vector<unsigned char>* value) {
+  size_t count = value->size() / sizeof(size_t);
+  std::vector<unsigned char> wide(count * sizeof(uint64));
+  for (size_t i = 0; i < count; ++i) {
+    size_t narrow;
+    memcpy(&narrow, &(*value)[i * sizeof(size_t)], sizeof(narrow));
+    uint64 widened = narrow;
+    memcpy(&wide[i * sizeof(uint64)], &widened, sizeof(widened));
+  }
+  value->swap(wide);
+}
+
+// Inverse of WidenCLSizeTInfo.
+inline void NarrowCLSizeTInfo(std::vector<unsigned char>* value) {
+  size_t count = value->size() / sizeof(uint64);
+  std::vector<unsigned char> narrow(count * sizeof(size_t));
+  for (size_t i = 0; i < count; ++i) {
+    uint64 wide;
+    memcpy(&wide, &(*value)[i * sizeof(uint64)], sizeof(wide));
+    size_t narrowed = static_cast<size_t>(wide);
+    memcpy(&narrow[i * sizeof(size_t)], &narrowed, sizeof(narrowed));
+  }
+  value->swap(narrow);
+}
+
+}  // namespace content
+
+#endif  // CONTENT_COMMON_GPU_OPENCL_INFO_H_
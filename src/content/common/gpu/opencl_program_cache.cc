@@ -0,0 +1,188 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/common/gpu/opencl_program_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/base_paths.h"
+#include "base/file_util.h"
+#include "base/files/file_enumerator.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/path_service.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+
+namespace content {
+
+namespace {
+
+const int64 kMaxCacheSizeBytes = 64 * 1024 * 1024;
+
+const base::FilePath::CharType kCacheExtension[] = FILE_PATH_LITERAL(".bin");
+
+std::string GetDeviceString(cl_device_id device, cl_device_info param_name) {
+  size_t size = 0;
+  if (CL_SUCCESS != clGetDeviceInfo(device, param_name, 0, NULL, &size) ||
+      size == 0)
+    return std::string();
+
+  std::vector<char> value(size);
+  if (CL_SUCCESS != clGetDeviceInfo(device, param_name, size, &value[0], NULL))
+    return std::string();
+  return std::string(value.begin(),
+                     std::find(value.begin(), value.end(), '\0'));
+}
+
+struct CacheEntry {
+  base::Time last_used;
+  int64 size;
+  base::FilePath path;
+
+  bool operator<(const CacheEntry& other) const {
+    return last_used < other.last_used;
+  }
+};
+
+base::FilePath GetDefaultCachePath() {
+  base::FilePath path;
+#if defined(OS_WIN)
+  bool have_path = PathService::Get(base::DIR_LOCAL_APP_DATA, &path);
+#else
+  bool have_path = PathService::Get(base::DIR_TEMP, &path);
+#endif
+  if (!have_path)
+    return base::FilePath();
+  return path.AppendASCII("WebCLProgramCache");
+}
+
+// The cache shared by all channels, created on first use.
+class SharedProgramCache {
+ public:
+  SharedProgramCache() : cache_(GetDefaultCachePath(), kMaxCacheSizeBytes) {}
+
+  OpenCLProgramCache* cache() { return &cache_; }
+
+ private:
+  OpenCLProgramCache cache_;
+};
+
+base::LazyInstance<SharedProgramCache> g_shared_program_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+OpenCLProgramCache::OpenCLProgramCache(const base::FilePath& path,
+                                       int64 max_size_bytes)
+    : path_(path),
+      max_size_bytes_(max_size_bytes) {
+}
+
+OpenCLProgramCache::~OpenCLProgramCache() {
+}
+
+// static
+OpenCLProgramCache* OpenCLProgramCache::GetInstance() {
+  return g_shared_program_cache.Get().cache();
+}
+
+// static
+std::string OpenCLProgramCache::ComputeKey(const std::string& source,
+                                           const std::string& options,
+                                           cl_device_id device) {
+  std::string data(source);
+  data.push_back('\0');
+  data.append(options);
+  data.push_back('\0');
+  data.append(GetDeviceString(device, CL_DEVICE_VENDOR));
+  data.push_back('\0');
+  data.append(GetDeviceString(device, CL_DEVICE_NAME));
+  data.push_back('\0');
+  data.append(GetDeviceString(device, CL_DEVICE_VERSION));
+  data.push_back('\0');
+  data.append(GetDeviceString(device, CL_DRIVER_VERSION));
+
+  std::string hash = base::SHA1HashString(data);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+bool OpenCLProgramCache::Load(const std::string& key, std::string* binary) {
+  if (path_.empty())
+    return false;
+
+  base::AutoLock auto_lock(lock_);
+  base::FilePath entry = GetEntryPath(key);
+  if (!file_util::ReadFileToString(entry, binary) || binary->empty())
+    return false;
+
+  // The modification time doubles as the last use for eviction.
+  base::Time now = base::Time::Now();
+  file_util::TouchFile(entry, now, now);
+  return true;
+}
+
+void OpenCLProgramCache::Store(const std::string& key,
+                               const std::string& binary) {
+  if (path_.empty() || binary.empty() ||
+      static_cast<int64>(binary.size()) > max_size_bytes_)
+    return;
+
+  base::AutoLock auto_lock(lock_);
+  if (!file_util::CreateDirectory(path_))
+    return;
+
+  base::FilePath entry = GetEntryPath(key);
+  int written = file_util::WriteFile(entry, binary.data(), binary.size());
+  if (written != static_cast<int>(binary.size())) {
+    DLOG(ERROR) << "Failed to write OpenCL program cache entry " << key;
+    base::DeleteFile(entry, false);
+    return;
+  }
+
+  Trim();
+}
+
+void OpenCLProgramCache::Remove(const std::string& key) {
+  if (path_.empty())
+    return;
+
+  base::AutoLock auto_lock(lock_);
+  base::DeleteFile(GetEntryPath(key), false);
+}
+
+base::FilePath OpenCLProgramCache::GetEntryPath(const std::string& key) const {
+  return path_.AppendASCII(key).AddExtension(kCacheExtension);
+}
+
+void OpenCLProgramCache::Trim() {
+  lock_.AssertAcquired();
+  std::vector<CacheEntry> entries;
+  int64 total_size = 0;
+
+  base::FileEnumerator enumerator(path_, false, base::FileEnumerator::FILES,
+                                  FILE_PATH_LITERAL("*.bin"));
+  for (base::FilePath name = enumerator.Next(); !name.empty();
+       name = enumerator.Next()) {
+    base::FileEnumerator::FileInfo info = enumerator.GetInfo();
+    CacheEntry entry;
+    entry.last_used = info.GetLastModifiedTime();
+    entry.size = info.GetSize();
+    entry.path = name;
+    entries.push_back(entry);
+    total_size += entry.size;
+  }
+  if (total_size <= max_size_bytes_)
+    return;
+
+  std::sort(entries.begin(), entries.end());
+  for (size_t i = 0; i < entries.size() && total_size > max_size_bytes_; ++i) {
+    if (base::DeleteFile(entries[i].path, false))
+      total_size -= entries[i].size;
+  }
+}
+
+}  // namespace content
@@ -0,0 +1,69 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_COMMON_GPU_OPENCL_PROGRAM_CACHE_H_
+#define CONTENT_COMMON_GPU_OPENCL_PROGRAM_CACHE_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/synchronization/lock.h"
+
+#if defined(OS_WIN)
+#include <CL/OpenCL.h>
+#endif
+
+namespace content {
+
+// Keeps CL_PROGRAM_BINARIES of programs built in the GPU process on disk, so
+// a page that compiles the same kernels on every load only pays for the
+// compile once. Each entry is a file named after its key; the least recently
+// used entries are deleted once the cache grows past its size limit. Thread
+// safe, as the OpenCL threads of all channels share it.
+class OpenCLProgramCache {
+ public:
+  // Creates a cache in |path| holding at most |max_size_bytes| of binaries.
+  OpenCLProgramCache(const base::FilePath& path, int64 max_size_bytes);
+  ~OpenCLProgramCache();
+
+  // Returns the cache shared by all channels in this process.
+  static OpenCLProgramCache* GetInstance();
+
+  // Returns the key of the binary |device| produces for |source| built with
+  // |options|. The device name and driver version are part of the key, so a
+  // driver update never loads a stale binary.
+  static std::string ComputeKey(const std::string& source,
+                                const std::string& options,
+                                cl_device_id device);
+
+  // Reads the binary stored under |key|. Returns false on a miss.
+  bool Load(const std::string& key, std::string* binary);
+
+  // Stores |binary| under |key|, evicting old entries if needed.
+  void Store(const std::string& key, const std::string& binary);
+
+  // Drops the entry stored under |key|, e.g. when the driver rejected it.
+  void Remove(const std::string& key);
+
+ private:
+  base::FilePath GetEntryPath(const std::string& key) const;
+
+  // Deletes least recently used entries until the cache fits its limit.
+  // |lock_| must be held.
+  void Trim();
+
+  base::FilePath path_;
+  int64 max_size_bytes_;
+
+  // Serializes access to the entries, so that no thread reads an entry
+  // another one is writing, or deletes it under it.
+  base::Lock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpenCLProgramCache);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_COMMON_GPU_OPENCL_PROGRAM_CACHE_H_
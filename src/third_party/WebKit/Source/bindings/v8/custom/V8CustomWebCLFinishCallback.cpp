@@ -33,9 +33,22 @@
 
 namespace WebCore {
 
-void V8WebCLFinishCallback::handleEventMethodCustom(const v8::Arguments& args)
+bool V8WebCLFinishCallback::handleEvent(int value)
 {
-	v8SetReturnValue(args, args.Holder());
+    if (!canInvokeCallback())
+        return true;
+
+    v8::HandleScope handleScope(m_isolate);
+
+    v8::Handle<v8::Context> v8Context = toV8Context(executionContext(), m_world.get());
+    if (v8Context.IsEmpty())
+        return true;
+
+    v8::Context::Scope scope(v8Context);
+
+    v8::Handle<v8::Value> argv[] = { v8Integer(value, m_isolate) };
+
+    return invokeCallback(m_callback.newLocal(m_isolate), WTF_ARRAY_LENGTH(argv), argv, executionContext(), m_isolate);
 }
 
 }
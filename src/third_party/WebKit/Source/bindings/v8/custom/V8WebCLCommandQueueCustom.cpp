@@ -30,6 +30,7 @@
 
 #include "..\V8Binding.h"
 #include "V8WebCLCommandQueue.h"
+#include "V8WebCLFinishCallback.h"
 #include "V8WebCLCustom.h"
 
 namespace WebCore {
@@ -53,6 +54,12 @@ void V8WebCLCommandQueue::finishMethodCustom(const v8::Arguments& args)
 
     ExceptionState es(args.GetIsolate());
     WebCLCommandQueue* queue = V8WebCLCommandQueue::toNative(args.Holder());
+    if (args.Length() > 0 && args[0]->IsFunction()) {
+        // finish(whenFinished) returns at once and calls back when done.
+        RefPtr<WebCLFinishCallback> callback = V8WebCLFinishCallback::create(v8::Handle<v8::Function>::Cast(args[0]), getExecutionContext());
+        queue->finish(callback.release(), es);
+        return;
+    }
     queue->finish(es);
     //return v8::Undefined();
 }
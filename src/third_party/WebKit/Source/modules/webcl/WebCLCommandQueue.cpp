@@ -600,9 +600,11 @@ void  WebCLCommandQueue::enqueueNDRangeKernel(WebCLKernel* kernel, Int32Array* o
 		}
 
 
+		// Only ask for an event when the caller wants one, so the launch
+		// can be batched instead of waiting on the GPU process.
 		err = webcl_clEnqueueNDRangeKernel(webcl_channel_, m_cl_command_queue, cl_kernel_id, work_dim, 
 						g_work_offset, g_work_size, l_work_size, eventsLength, 
-						cl_event_wait_lists, &cl_event_id);
+						cl_event_wait_lists, event != NULL ? &cl_event_id : NULL);
 
 
 		// Is free needed ??
@@ -716,47 +718,50 @@ void WebCLCommandQueue::finish(ExceptionState& ec)
 		}
 		return;
 }
-/*
-// TODO(siba.samal) Need to change user_data to Object type
-void WebCLCommandQueue::finish(PassRefPtr<WebCLFinishCallback> notify, int user_data, ExceptionState& ec)//object userData
+// Runs on the main thread once the GPU process reports that everything
+// queued before finish(callback) has completed. |userData| holds the
+// reference finish() leaked to keep the callback alive meanwhile.
+static void CL_CALLBACK finishCompleted(cl_int status, void* userData)
 {
-cl_int err = 0;
-
-if (m_cl_command_queue == NULL) {
-ec.throwDOMException(WebCLException::INVALID_COMMAND_QUEUE, "WebCLException::INVALID_COMMAND_QUEUE");
-printf("Error: Invalid Command Queue\n");
-return;
+		RefPtr<WebCLFinishCallback> callback = adoptRef(static_cast<WebCLFinishCallback*>(userData));
+		callback->handleEvent(status);
 }
-err = clFinish(m_cl_command_queue);
-if (err != CL_SUCCESS) {
-switch (err) {
-case CL_INVALID_COMMAND_QUEUE:
-printf("Error: CL_INVALID_COMAND_QUEUE \n");
-ec.throwDOMException(WebCLException::INVALID_COMMAND_QUEUE, "WebCLException::INVALID_COMMAND_QUEUE");
-break;
-case CL_OUT_OF_HOST_MEMORY:
-printf("Error: CL_OUT_OF_HOST_MEMORY \n");
-ec.throwDOMException(WebCLException::OUT_OF_HOST_MEMORY, "WebCLException::OUT_OF_HOST_MEMORY");
-break;
-case CL_OUT_OF_RESOURCES:
-printf("Error: CL_OUT_OF_RESOURCES \n");
-ec.throwDOMException(WebCLException::OUT_OF_RESOURCES, "WebCLException::OUT_OF_RESOURCES");
-break;
-default:
-printf("Error: Invaild Error Type\n");
-printf("Unused Argument %d\n",user_data);
-ec.throwDOMException(WebCLException::FAILURE, "WebCLException::FAILURE");
-break;
-}		
-} else {
-m_finishCallback = notify;
-//m_finishCallback->handleEvent(user_data);			
-m_finishCallback->handleEvent(m_context);			
-return;
-}
-return;
+
+void WebCLCommandQueue::finish(PassRefPtr<WebCLFinishCallback> notify, ExceptionState& ec)
+{
+		cl_int err = 0;
+
+		if (m_cl_command_queue == NULL) {
+				ec.throwDOMException(WebCLException::INVALID_COMMAND_QUEUE, "WebCLException::INVALID_COMMAND_QUEUE");
+				printf("Error: Invalid Command Queue\n");
+				return;
+		}
+		if (!notify) {
+				finish(ec);
+				return;
+		}
+		// Does not wait: the callback is invoked from the event loop instead.
+		WebCLFinishCallback* callback = notify.leakRef();
+		err = webcl_clFinishAsync(webcl_channel_, m_cl_command_queue, &finishCompleted, callback);
+		if (err != CL_SUCCESS) {
+				adoptRef(callback);
+				switch (err) {
+						case CL_INVALID_COMMAND_QUEUE:
+								printf("Error: CL_INVALID_COMAND_QUEUE \n");
+								ec.throwDOMException(WebCLException::INVALID_COMMAND_QUEUE, "WebCLException::INVALID_COMMAND_QUEUE");
+								break;
+						case CL_OUT_OF_HOST_MEMORY:
+								printf("Error: CL_OUT_OF_HOST_MEMORY \n");
+								ec.throwDOMException(WebCLException::OUT_OF_HOST_MEMORY, "WebCLException::OUT_OF_HOST_MEMORY");
+								break;
+						default:
+								printf("Error: Invaild Error Type\n");
+								ec.throwDOMException(WebCLException::FAILURE, "WebCLException::FAILURE");
+								break;
+				}
+		}
+		return;
 }
- */
 
 void WebCLCommandQueue::flush( ExceptionState& ec)
 {
@@ -105,6 +105,7 @@ public:
 		}
 	
 	void finish(ExceptionState&);
+	void finish(PassRefPtr<WebCLFinishCallback>, ExceptionState&);
 	void flush( ExceptionState&);
 	void releaseCL( ExceptionState&);
 	PassRefPtr<WebCLEvent> enqueueWriteImage(WebCLMem*, bool, Int32Array*, 
@@ -137,7 +138,6 @@ private:
 	WebCLCommandQueue(WebCL*, cl_command_queue);	
 	WebCL* m_context;
 	cl_command_queue m_cl_command_queue;
-	RefPtr<WebCLFinishCallback> m_finishCallback;
 	RefPtr<WebCLCommandQueue> m_command_queue;
 	
 	
@@ -362,33 +362,44 @@ PassRefPtr<WebCLProgram> WebCLContext::createProgram(const String& kernelSource,
 		return NULL;
 }
 
-PassRefPtr<WebCLMem> WebCLContext::createBuffer(int flags, int size, ExceptionState& ec)
+PassRefPtr<WebCLMem> WebCLContext::createBuffer(int flags, int size, ArrayBufferView* hostPtr, ExceptionState& ec)
 {
 		cl_int err = 0;	
 		cl_mem cl_mem_id = NULL;
+		cl_mem_flags cl_flags = 0;
+		void* host_ptr = NULL;
 		if (m_cl_context == NULL) {
 				printf("Error: Invalid CL Context\n");
 				ec.throwDOMException(WebCLException::INVALID_CONTEXT, "WebCLException::INVALID_CONTEXT");
 				return NULL;
 		}
-		// TODO(won.jeon) - NULL parameter needs to be addressed later
 		switch (flags)
 		{
 				case WebCL::MEM_READ_ONLY:
-						cl_mem_id = webcl_clCreateBuffer(webcl_channel_, m_cl_context, CL_MEM_READ_ONLY, size, NULL, &err);
+						cl_flags = CL_MEM_READ_ONLY;
 						break;
 				case WebCL::MEM_WRITE_ONLY:
-						cl_mem_id = webcl_clCreateBuffer(webcl_channel_, m_cl_context, CL_MEM_WRITE_ONLY, size, NULL, &err);
+						cl_flags = CL_MEM_WRITE_ONLY;
 						break;
 				case WebCL::MEM_READ_WRITE:
-						cl_mem_id = webcl_clCreateBuffer(webcl_channel_, m_cl_context, CL_MEM_READ_WRITE, size, NULL, &err);
+						cl_flags = CL_MEM_READ_WRITE;
 						break;
 				default:
 						printf("Error: Unsupported Mem Flsg\n");
-						//printf("WebCLContext::createBuffer host_ptr = %d\n", host_ptr);
 						ec.throwDOMException(WebCLException::INVALID_CONTEXT, "WebCLException::INVALID_CONTEXT");
-						break;
+						return NULL;
+		}
+		// The initial contents travel with the creation call, so the buffer
+		// is ready without a separate enqueueWriteBuffer.
+		if (hostPtr != NULL) {
+				if (size < 0 || hostPtr->byteLength() < static_cast<unsigned>(size)) {
+						ec.throwDOMException(WebCLException::INVALID_HOST_PTR, "WebCLException::INVALID_HOST_PTR");
+						return NULL;
+				}
+				cl_flags |= CL_MEM_COPY_HOST_PTR;
+				host_ptr = hostPtr->baseAddress();
 		}
+		cl_mem_id = webcl_clCreateBuffer(webcl_channel_, m_cl_context, cl_flags, size, host_ptr, &err);
 		if (err != CL_SUCCESS) {
 				printf("Error: clCreateBuffer\n");
 				switch(err) {
@@ -56,6 +56,7 @@
 #include "..\..\core\platform\graphics\ImageBuffer.h"
 //#include "..\..\core\loader\cache\CachedImage.h"
 #include <wtf/ArrayBuffer.h>
+#include <wtf/ArrayBufferView.h>
 
 
 #include <wtf/OwnPtr.h>
@@ -102,7 +103,10 @@ public:
 
 	//PassRefPtr<WebCLCommandQueue> createCommandQueue(WebCLDevice*, int, ExceptionState&);
 	PassRefPtr<WebCLProgram> createProgram(const String&, ExceptionState&);
-	PassRefPtr<WebCLMem> createBuffer(int, int, ExceptionState&);
+	PassRefPtr<WebCLMem> createBuffer(int, int, ArrayBufferView*, ExceptionState&);
+	PassRefPtr<WebCLMem> createBuffer(int flags, int size, ExceptionState& ec) {
+		return(createBuffer(flags, size, NULL, ec));
+	}
 	PassRefPtr<WebCLMem> createImage2D(int, HTMLCanvasElement*, ExceptionState&);
 	PassRefPtr<WebCLMem> createImage2D(int, HTMLImageElement*, ExceptionState&);
 	PassRefPtr<WebCLMem> createImage2D(int, HTMLVideoElement*, ExceptionState&);
@@ -199,31 +199,17 @@ WebCLGetInfo WebCLEvent::getProfilingInfo(int param_name, ExceptionState& ec)
 
 }
 
-/*
-void  WebCLEvent::execComplete(cl_event ev, cl_int event_status, void* this_pointer){
-	printf("Not used params from setCallback %d  \n",event_status);
-	ev = NULL;
-	 WebCLEvent* self = static_cast<WebCLEvent*>(this_pointer);
-	(self->m_finishCallback.get())->handleEvent(17);
-	printf("Afre handleEvent\n ");
-
-	return;
-	
-}
-
-
-static void callme( void* notify1 )
+// Runs on the main thread when the event reaches the status passed to
+// setEventCallback(). |userData| holds the reference setEventCallback()
+// leaked to keep the callback alive meanwhile.
+static void CL_CALLBACK eventCallbackFired(cl_event, cl_int status, void* userData)
 {
- 	WebCLEvent* self = static_cast<WebCLEvent*>(notify1);
-	self->m_finishCallback.get()->handleEvent(17);
-	//((WebCLFinishCallback*)(notify1))->handleEvent(17);
-
+	RefPtr<WebCLFinishCallback> callback = adoptRef(static_cast<WebCLFinishCallback*>(userData));
+	callback->handleEvent(status);
 }
-*/
 
-void WebCLEvent::setEventCallback(int executionStatus, PassRefPtr<WebCLFinishCallback> notify, int userData, ExceptionState& ec) //object userData
+void WebCLEvent::setEventCallback(int executionStatus, PassRefPtr<WebCLFinishCallback> notify, ExceptionState& ec)
 {
-	printf("WebCLEvent::setCallback is called\n");
 	cl_int err = 0;
 
 	if (m_cl_Event == NULL) {
@@ -231,14 +217,16 @@ void WebCLEvent::setEventCallback(int executionStatus, PassRefPtr<WebCLFinishCal
 		ec.throwDOMException(WebCLException::INVALID_EVENT, "WebCLException::INVALID_EVENT");
 		return;
 	}
-	
-	m_finishCallback = notify;
-	//err = clSetEventCallback(m_cl_Event, executionStatus, &WebCLEvent::execComplete, (void*)this);
-	//callme((void*)this);
-	executionStatus = CL_COMPLETE;
-	err = CL_SUCCESS;
+	if (!notify) {
+		ec.throwDOMException(WebCLException::INVALID_VALUE, "WebCLException::INVALID_VALUE");
+		return;
+	}
+
+	WebCLFinishCallback* callback = notify.leakRef();
+	err = webcl_clSetEventCallback(webcl_channel_, m_cl_Event, executionStatus, &eventCallbackFired, callback);
 
 	if (err != CL_SUCCESS) {
+		adoptRef(callback);
 		switch (err) {
 			case CL_INVALID_EVENT:
 				printf("Error: CL_INVALID_EVENT \n");
@@ -258,7 +246,6 @@ void WebCLEvent::setEventCallback(int executionStatus, PassRefPtr<WebCLFinishCal
 				break;
 			default:
 				printf("Error: Invaild Error Type\n");
-				printf("Unused Argument %d\n",userData);
 				ec.throwDOMException(WebCLException::FAILURE, "WebCLException::FAILURE");
 				break;
 		}
@@ -54,11 +54,10 @@ public:
         static PassRefPtr<WebCLEvent> create(WebCL*, cl_event);
 		WebCLGetInfo getInfo(int, ExceptionState&);
 		WebCLGetInfo getProfilingInfo(int, ExceptionState&);
-		void setEventCallback(int, PassRefPtr<WebCLFinishCallback>, int , ExceptionState&);
+		void setEventCallback(int, PassRefPtr<WebCLFinishCallback>, ExceptionState&);
 		void setUserEventStatus (int, ExceptionState&);
 		void releaseCL( ExceptionState&);
         cl_event getCLEvent();
-		RefPtr<WebCLFinishCallback> m_finishCallback;
 		WebCL*  getContext();
 		int b;
 		
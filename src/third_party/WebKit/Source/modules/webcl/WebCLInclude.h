@@ -46,6 +46,7 @@ typedef CL_API_ENTRY cl_int           (__cdecl *h_clRetainKernel
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clReleaseKernel                  ) (content::GpuChannelHost*, cl_kernel);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clSetKernelArg                   ) (content::GpuChannelHost*, cl_kernel, cl_uint, size_t, const void*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clSetKernelArg_vector                   ) (content::GpuChannelHost*, cl_kernel, cl_uint, size_t, const void*);
+typedef CL_API_ENTRY cl_int           (__cdecl *h_clSetKernelArgs                  ) (content::GpuChannelHost*, cl_kernel, cl_uint, const cl_uint*, const size_t*, const void*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clGetKernelInfo                  ) (content::GpuChannelHost*, cl_kernel, cl_kernel_info, size_t, void*, size_t*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clGetKernelArgInfo               ) (content::GpuChannelHost*, cl_kernel, cl_uint, cl_kernel_arg_info, size_t, void*, size_t*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clGetKernelWorkGroupInfo         ) (content::GpuChannelHost*, cl_kernel, cl_device_id, cl_kernel_work_group_info, size_t, void*, size_t*);
@@ -59,6 +60,7 @@ typedef CL_API_ENTRY cl_int           (__cdecl *h_clSetEventCallback
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clGetEventProfilingInfo          ) (content::GpuChannelHost*, cl_event, cl_profiling_info, size_t, void*, size_t*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clFlush                          ) (content::GpuChannelHost*, cl_command_queue);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clFinish                         ) (content::GpuChannelHost*, cl_command_queue);
+typedef CL_API_ENTRY cl_int           (__cdecl *h_clFinishAsync                    ) (content::GpuChannelHost*, cl_command_queue, void (CL_CALLBACK*)(cl_int, void*), void*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clEnqueueReadBuffer              ) (content::GpuChannelHost*, cl_command_queue, cl_mem, cl_bool, size_t, size_t, void*, cl_uint, const cl_event*, cl_event*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clEnqueueReadBufferRect          ) (content::GpuChannelHost*, cl_command_queue, cl_mem, cl_bool, const size_t*, const size_t*, const size_t*, size_t, size_t, size_t, size_t, void*, cl_uint, const cl_event*, cl_event*);
 typedef CL_API_ENTRY cl_int           (__cdecl *h_clEnqueueWriteBuffer             ) (content::GpuChannelHost*, cl_command_queue, cl_mem, cl_bool, size_t, size_t, const void*, cl_uint, const cl_event*, cl_event*);
@@ -168,6 +170,7 @@ CL_LOADING_PREFIX h_clRetainKernel                    webcl_clRetainKernel
 CL_LOADING_PREFIX h_clReleaseKernel                   webcl_clReleaseKernel                   CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clSetKernelArg                    webcl_clSetKernelArg                    CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clSetKernelArg_vector                    webcl_clSetKernelArg_vector                    CL_LOADING_SUFFIX;
+CL_LOADING_PREFIX h_clSetKernelArgs                   webcl_clSetKernelArgs                   CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clGetKernelInfo                   webcl_clGetKernelInfo                   CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clGetKernelArgInfo                webcl_clGetKernelArgInfo                CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clGetKernelWorkGroupInfo          webcl_clGetKernelWorkGroupInfo          CL_LOADING_SUFFIX;
@@ -181,6 +184,7 @@ CL_LOADING_PREFIX h_clSetEventCallback                webcl_clSetEventCallback
 CL_LOADING_PREFIX h_clGetEventProfilingInfo           webcl_clGetEventProfilingInfo           CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clFlush                           webcl_clFlush                           CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clFinish                          webcl_clFinish                          CL_LOADING_SUFFIX;
+CL_LOADING_PREFIX h_clFinishAsync                     webcl_clFinishAsync                     CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clEnqueueReadBuffer               webcl_clEnqueueReadBuffer               CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clEnqueueReadBufferRect           webcl_clEnqueueReadBufferRect           CL_LOADING_SUFFIX;
 CL_LOADING_PREFIX h_clEnqueueWriteBuffer              webcl_clEnqueueWriteBuffer              CL_LOADING_SUFFIX;
@@ -267,6 +271,7 @@ WEBCL_LOAD_FUN_DEF(clRetainKernel                   )
 WEBCL_LOAD_FUN_DEF(clReleaseKernel                  )
 WEBCL_LOAD_FUN_DEF(clSetKernelArg                   )
 WEBCL_LOAD_FUN_DEF(clSetKernelArg_vector                   )
+WEBCL_LOAD_FUN_DEF(clSetKernelArgs                  )
 WEBCL_LOAD_FUN_DEF(clGetKernelInfo                  )
 WEBCL_LOAD_FUN_DEF(clGetKernelArgInfo               )
 WEBCL_LOAD_FUN_DEF(clGetKernelWorkGroupInfo         )
@@ -280,6 +285,7 @@ WEBCL_LOAD_FUN_DEF(clSetEventCallback               )
 WEBCL_LOAD_FUN_DEF(clGetEventProfilingInfo          )
 WEBCL_LOAD_FUN_DEF(clFlush                          )
 WEBCL_LOAD_FUN_DEF(clFinish                         )
+WEBCL_LOAD_FUN_DEF(clFinishAsync                    )
 WEBCL_LOAD_FUN_DEF(clEnqueueReadBuffer              )
 WEBCL_LOAD_FUN_DEF(clEnqueueReadBufferRect          )
 WEBCL_LOAD_FUN_DEF(clEnqueueWriteBuffer             )
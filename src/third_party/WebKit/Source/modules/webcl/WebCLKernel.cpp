@@ -51,6 +51,8 @@ WebCLKernel::WebCLKernel(WebCL* compute_context, cl_kernel kernel)
 							: m_context(compute_context), m_cl_kernel(kernel)
 {
 		m_num_kernels = 0;
+		m_arg_types_resolved = false;
+		m_value_args_size = 0;
 }
 
 WebCLGetInfo WebCLKernel::getInfo (int kernel_info, ExceptionState& ec)
@@ -689,6 +691,127 @@ void WebCLKernel::setKernelArgLocal(unsigned int arg_index, unsigned int arg_siz
 	}
 }
 
+void WebCLKernel::setKernelArgs(ArrayBufferView* arg_values, ExceptionState& ec)
+{
+	cl_int err = 0;
+	if (m_cl_kernel == NULL) {
+		printf("Error: Invalid kernel\n");
+		ec.throwDOMException(WebCLException::INVALID_KERNEL, "WebCLException::INVALID_KERNEL");
+		return;
+	}
+	if (arg_values == NULL) {
+		printf("Error: arg_values null\n");
+		ec.throwDOMException(WebCLException::INVALID_ARG_VALUE, "WebCLException::INVALID_ARG_VALUE");
+		return;
+	}
+	if (!m_arg_types_resolved && !resolveArgTypes()) {
+		printf("Error: Kernel arg info not available\n");
+		ec.throwDOMException(WebCLException::INVALID_KERNEL_ARGS, "WebCLException::INVALID_KERNEL_ARGS");
+		return;
+	}
+	if (arg_values->byteLength() != m_value_args_size) {
+		printf("Error: CL_INVALID_ARG_SIZE \n");
+		ec.throwDOMException(WebCLException::INVALID_ARG_SIZE, "WebCLException::INVALID_ARG_SIZE");
+		return;
+	}
+	if (m_value_arg_indices.isEmpty())
+		return;
+
+	// One batched message for the whole argument block.
+	err = webcl_clSetKernelArgs(webcl_channel_, m_cl_kernel, m_value_arg_indices.size(),
+			m_value_arg_indices.data(), m_value_arg_sizes.data(), arg_values->baseAddress());
+	if (err != CL_SUCCESS) {
+		printf("Error: clSetKernelArgs failed %d\n", err);
+		ec.throwDOMException(WebCLException::FAILURE, "WebCLException::FAILURE");
+	}
+}
+
+// Returns the size of a by-value argument of OpenCL C type |type_name|, as
+// reported by CL_KERNEL_ARG_TYPE_NAME, or 0 if it is not a scalar or vector.
+static size_t kernelArgTypeSize(const char* type_name)
+{
+	static const struct {
+		const char* name;
+		size_t size;
+	} scalar_types[] = {
+		{ "char", sizeof(cl_char) },
+		{ "uchar", sizeof(cl_uchar) },
+		{ "short", sizeof(cl_short) },
+		{ "ushort", sizeof(cl_ushort) },
+		{ "int", sizeof(cl_int) },
+		{ "uint", sizeof(cl_uint) },
+		{ "long", sizeof(cl_long) },
+		{ "ulong", sizeof(cl_ulong) },
+		{ "half", sizeof(cl_half) },
+		{ "float", sizeof(cl_float) },
+		{ "double", sizeof(cl_double) },
+	};
+
+	size_t length = strlen(type_name);
+	size_t base_length = length;
+	while (base_length > 0 && type_name[base_length - 1] >= '0' && type_name[base_length - 1] <= '9')
+		--base_length;
+
+	size_t width = 1;
+	if (base_length != length) {
+		width = atoi(type_name + base_length);
+		// 3-component vectors are stored as 4.
+		if (width == 3)
+			width = 4;
+		if (width != 2 && width != 4 && width != 8 && width != 16)
+			return 0;
+	}
+
+	for (size_t i = 0; i < WTF_ARRAY_LENGTH(scalar_types); ++i) {
+		if (strlen(scalar_types[i].name) == base_length
+			&& !strncmp(scalar_types[i].name, type_name, base_length))
+			return scalar_types[i].size * width;
+	}
+	return 0;
+}
+
+bool WebCLKernel::resolveArgTypes()
+{
+	cl_uint num_args = 0;
+	cl_int err = webcl_clGetKernelInfo(webcl_channel_, m_cl_kernel, CL_KERNEL_NUM_ARGS, sizeof(cl_uint), &num_args, NULL);
+	if (err != CL_SUCCESS)
+		return false;
+
+	Vector<cl_uint> indices;
+	Vector<size_t> sizes;
+	size_t total_size = 0;
+	for (cl_uint index = 0; index < num_args; ++index) {
+		cl_kernel_arg_address_qualifier address_qualifier = 0;
+		char type_name[256];
+		err = webcl_clGetKernelArgInfo(webcl_channel_, m_cl_kernel, index, CL_KERNEL_ARG_ADDRESS_QUALIFIER,
+				sizeof(address_qualifier), &address_qualifier, NULL);
+		if (err != CL_SUCCESS)
+			return false;
+		// Buffers and local memory keep going through setKernelArgGlobal,
+		// setKernelArgConstant and setKernelArgLocal.
+		if (address_qualifier != CL_KERNEL_ARG_ADDRESS_PRIVATE)
+			continue;
+		err = webcl_clGetKernelArgInfo(webcl_channel_, m_cl_kernel, index, CL_KERNEL_ARG_TYPE_NAME,
+				sizeof(type_name), type_name, NULL);
+		if (err != CL_SUCCESS)
+			return false;
+		if (!strcmp(type_name, "sampler_t"))
+			continue;
+		size_t size = kernelArgTypeSize(type_name);
+		if (!size)
+			return false;
+		indices.append(index);
+		sizes.append(size);
+		total_size += size;
+	}
+
+	m_value_arg_indices.swap(indices);
+	m_value_arg_sizes.swap(sizes);
+	m_value_args_size = total_size;
+	m_arg_types_resolved = true;
+	return true;
+}
+
 /*
 // TODO (siba samal) Is this API is needed??
 unsigned long WebCLKernel::getKernelWorkGroupInfo(WebCLDeviceList* devices, int param_name)
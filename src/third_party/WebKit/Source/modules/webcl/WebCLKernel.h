@@ -45,8 +45,10 @@
 #else
 #include <CL/opencl.h>
 #endif
+#include <wtf/ArrayBufferView.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
@@ -63,6 +65,7 @@ public:
 	void setKernelArgGlobal(unsigned int, WebCLMem*, ExceptionState&);
 	void setKernelArgConstant(unsigned int, WebCLMem*, ExceptionState&);
 	void setKernelArgLocal(unsigned int,unsigned int, ExceptionState&);
+	void setKernelArgs(ArrayBufferView*, ExceptionState&);
 	//unsigned long getKernelWorkGroupInfo(WebCLDeviceList*, int);
 	void releaseCL( ExceptionState&);
 	void setDevice(RefPtr<WebCLDevice>);
@@ -77,12 +80,20 @@ private:
 							PassRefPtr<WebCLKernelTypeValue> kernelObject,
 							RefPtr<WebCLKernelTypeVector> array , 
 							unsigned int argIndex, int size,  unsigned int length);					
+	bool resolveArgTypes();
 							
 	WebCL* m_context;
 	cl_kernel m_cl_kernel;
 	RefPtr<WebCLDevice> m_device_id;
 	Vector<RefPtr<WebCLKernel> > m_kernel_list;
 	long m_num_kernels;
+
+	// Index and size of each by-value argument, resolved once from the
+	// kernel arg info for setKernelArgs.
+	bool m_arg_types_resolved;
+	Vector<cl_uint> m_value_arg_indices;
+	Vector<size_t> m_value_arg_sizes;
+	size_t m_value_args_size;
 	
 };
 
@@ -103,6 +103,7 @@ WEBCL_LOAD_FUNCTION(clRetainKernel                   )
 WEBCL_LOAD_FUNCTION(clReleaseKernel                  )
 WEBCL_LOAD_FUNCTION(clSetKernelArg                   )
 WEBCL_LOAD_FUNCTION(clSetKernelArg_vector                   )
+WEBCL_LOAD_FUNCTION(clSetKernelArgs                  )
 WEBCL_LOAD_FUNCTION(clGetKernelInfo                  )
 WEBCL_LOAD_FUNCTION(clGetKernelArgInfo               )
 WEBCL_LOAD_FUNCTION(clGetKernelWorkGroupInfo         )
@@ -116,6 +117,7 @@ WEBCL_LOAD_FUNCTION(clSetEventCallback               )
 WEBCL_LOAD_FUNCTION(clGetEventProfilingInfo          )
 WEBCL_LOAD_FUNCTION(clFlush                          )
 WEBCL_LOAD_FUNCTION(clFinish                         )
+WEBCL_LOAD_FUNCTION(clFinishAsync                    )
 WEBCL_LOAD_FUNCTION(clEnqueueReadBuffer              )
 WEBCL_LOAD_FUNCTION(clEnqueueReadBufferRect          )
 WEBCL_LOAD_FUNCTION(clEnqueueWriteBuffer             )
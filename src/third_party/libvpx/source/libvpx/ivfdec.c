@@ -12,6 +12,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static void fix_framerate(int *num, int *den) {
   // Some versions of vpxenc used 1/(2*fps) for the timebase, so
@@ -61,6 +62,7 @@ int file_is_ivf(struct VpxInputContext *input_ctx) {
     input_ctx->detect.buf_read = 0;
   } else {
     input_ctx->detect.position = 4;
+    input_ctx->map.pos = IVF_FILE_HDR_SZ;
   }
   return is_ivf;
 }
@@ -106,3 +108,74 @@ int ivf_read_frame(FILE *infile, uint8_t **buffer,
 
   return 1;
 }
+
+int ivf_read_frame_mapped(struct VpxInputMap *map, const uint8_t **buffer,
+                          size_t *bytes_read) {
+  size_t frame_size;
+
+  if (map->size - map->pos < IVF_FRAME_HDR_SZ)
+    return 1;
+
+  frame_size = mem_get_le32(map->data + map->pos);
+  map->pos += IVF_FRAME_HDR_SZ;
+
+  if (frame_size > 256 * 1024 * 1024) {
+    warn("Read invalid frame size (%u)\n", (unsigned int)frame_size);
+    frame_size = 0;
+  }
+
+  if (map->size - map->pos < frame_size) {
+    warn("Failed to read full frame\n");
+    map->pos = map->size;
+    return 1;
+  }
+
+  *buffer = map->data + map->pos;
+  *bytes_read = frame_size;
+  map->pos += frame_size;
+  return 0;
+}
+
+int ivf_peek_frame(struct VpxInputContext *input_ctx, uint8_t *peek,
+                   size_t *peek_size, int64_t *position) {
+  struct VpxInputMap *const map = &input_ctx->map;
+  unsigned char raw_header[IVF_FRAME_HDR_SZ];
+  size_t frame_size;
+
+  if (map->data) {
+    if (map->size - map->pos < IVF_FRAME_HDR_SZ)
+      return 1;
+    *position = map->pos;
+    frame_size = mem_get_le32(map->data + map->pos);
+    map->pos += IVF_FRAME_HDR_SZ;
+    if (map->size - map->pos < frame_size)
+      return 1;
+    if (*peek_size > frame_size)
+      *peek_size = frame_size;
+    memcpy(peek, map->data + map->pos, *peek_size);
+    map->pos += frame_size;
+    return 0;
+  }
+
+  *position = ftello(input_ctx->file);
+  if (*position < 0 ||
+      fread(raw_header, IVF_FRAME_HDR_SZ, 1, input_ctx->file) != 1)
+    return 1;
+  frame_size = mem_get_le32(raw_header);
+  if (*peek_size > frame_size)
+    *peek_size = frame_size;
+  if (fread(peek, 1, *peek_size, input_ctx->file) != *peek_size ||
+      fseeko(input_ctx->file, (off_t)(frame_size - *peek_size), SEEK_CUR))
+    return 1;
+  return 0;
+}
+
+int ivf_seek(struct VpxInputContext *input_ctx, int64_t position) {
+  if (input_ctx->map.data) {
+    if (position < 0 || (uint64_t)position > input_ctx->map.size)
+      return 1;
+    input_ctx->map.pos = (size_t)position;
+    return 0;
+  }
+  return fseeko(input_ctx->file, (off_t)position, SEEK_SET) ? 1 : 0;
+}
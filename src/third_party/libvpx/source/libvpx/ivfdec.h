@@ -21,6 +21,20 @@ int file_is_ivf(struct VpxInputContext *input);
 int ivf_read_frame(FILE *infile, uint8_t **buffer,
                    size_t *bytes_read, size_t *buffer_size);
 
+/* Reads the header of the next frame and steps over its payload, copying
+ * at most *peek_size leading bytes of it into peek. *position receives the
+ * offset ivf_seek() needs to return to this frame. Used to index a file
+ * without reading whole frames; fails on inputs that cannot seek.
+ */
+int ivf_peek_frame(struct VpxInputContext *input_ctx, uint8_t *peek,
+                   size_t *peek_size, int64_t *position);
+
+int ivf_seek(struct VpxInputContext *input_ctx, int64_t position);
+
+/* Returns the next frame as a pointer into the mapped file, no copy made. */
+int ivf_read_frame_mapped(struct VpxInputMap *map, const uint8_t **buffer,
+                          size_t *bytes_read);
+
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif
@@ -8,12 +8,23 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
 #include "test/codec_factory.h"
 #include "test/decode_test_driver.h"
 #include "test/ivf_video_source.h"
 #include "test/md5_helper.h"
 #include "test/util.h"
 #include "test/webm_video_source.h"
+#include "vpx/vp8dx.h"
 #include "vpx_ports/vpx_timer.h"
 #include "./vpx_version.h"
 
@@ -58,10 +69,47 @@ const decode_perf_param_t kVP9DecodePerfVectors[] = {
  deliberately limit the amount of system calls we make to avoid OS
  preemption.
 
+ Besides the totals, each DecodeFrame() call is timed individually so that
+ tail latency (p50/p95/p99/max) can be tracked, and the staged decoder's
+ per-step times and thread utilization are read back through
+ VP9D_GET_DECODE_STATS once the stream is done.
+
  TODO(joshualitt) create a more detailed perf measurement test to collect
-   power/temp/min max frame decode times/etc
+   power/temp/etc
  */
 
+// Returns the nearest-rank percentile of an ascending-sorted sample set.
+double Percentile(const std::vector<double> &sorted, double pct) {
+  if (sorted.empty())
+    return 0.0;
+  size_t rank = static_cast<size_t>(pct / 100.0 * sorted.size() + 0.5);
+  if (rank < 1)
+    rank = 1;
+  if (rank > sorted.size())
+    rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+// Returns the peak resident set size of the process in kilobytes, or 0 if it
+// is not available on this platform.
+uint64_t PeakRssKb() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return pmc.PeakWorkingSetSize / 1024;
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;  // bytes on OS X
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
 class DecodePerfTest : public ::testing::TestWithParam<decode_perf_param_t> {
 };
 
@@ -76,26 +124,64 @@ TEST_P(DecodePerfTest, PerfTest) {
   cfg.threads = threads;
   libvpx_test::VP9Decoder decoder(cfg, 0);
 
+  std::vector<double> frame_usecs;
+  frame_usecs.reserve(1024);
+
   vpx_usec_timer t;
   vpx_usec_timer_start(&t);
 
   for (video.Begin(); video.cxdata() != NULL; video.Next()) {
+    vpx_usec_timer frame_timer;
+    vpx_usec_timer_start(&frame_timer);
     decoder.DecodeFrame(video.cxdata(), video.frame_size());
+    vpx_usec_timer_mark(&frame_timer);
+    frame_usecs.push_back(double(vpx_usec_timer_elapsed(&frame_timer)));
   }
 
   vpx_usec_timer_mark(&t);
-  const double elapsed_secs = double(vpx_usec_timer_elapsed(&t))
-                              / kUsecsInSec;
+  const int64_t elapsed_usecs = vpx_usec_timer_elapsed(&t);
+  const double elapsed_secs = double(elapsed_usecs) / kUsecsInSec;
   const unsigned frames = video.frame_number();
   const double fps = double(frames) / elapsed_secs;
 
+  std::sort(frame_usecs.begin(), frame_usecs.end());
+
+  vp9_decode_stats stats;
+  decoder.Control(VP9D_GET_DECODE_STATS, &stats);
+
   printf("{\n");
   printf("\t\"version\" : \"%s\",\n", VERSION_STRING_NOSP);
   printf("\t\"videoName\" : \"%s\",\n", video_name);
   printf("\t\"threadCount\" : %u,\n", threads);
   printf("\t\"decodeTimeSecs\" : %f,\n", elapsed_secs);
   printf("\t\"totalFrames\" : %u,\n", frames);
-  printf("\t\"framesPerSecond\" : %f\n", fps);
+  printf("\t\"framesPerSecond\" : %f,\n", fps);
+  printf("\t\"frameLatencyUsecs\" : {\n");
+  printf("\t\t\"p50\" : %.0f,\n", Percentile(frame_usecs, 50));
+  printf("\t\t\"p95\" : %.0f,\n", Percentile(frame_usecs, 95));
+  printf("\t\t\"p99\" : %.0f,\n", Percentile(frame_usecs, 99));
+  printf("\t\t\"max\" : %.0f\n",
+         frame_usecs.empty() ? 0.0 : frame_usecs.back());
+  printf("\t},\n");
+  printf("\t\"peakRssKb\" : %llu,\n",
+         static_cast<unsigned long long>(PeakRssKb()));
+  printf("\t\"steps\" : [\n");
+  for (int i = 0; i < stats.step_count; ++i) {
+    printf("\t\t{ \"name\" : \"%s\", \"usecs\" : %lld, "
+           "\"runs\" : %d }%s\n",
+           stats.step_name[i],
+           static_cast<long long>(stats.step_usecs[i]),
+           stats.step_runs[i],
+           i + 1 < stats.step_count ? "," : "");
+  }
+  printf("\t],\n");
+  printf("\t\"threadUtilization\" : [");
+  for (int i = 0; i < stats.thread_count; ++i) {
+    const double utilization = elapsed_usecs > 0 ?
+        double(stats.thread_busy_usecs[i]) / double(elapsed_usecs) : 0.0;
+    printf("%s%f", i ? ", " : " ", utilization);
+  }
+  printf(" ]\n");
   printf("}\n");
 }
 
@@ -0,0 +1,333 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+// Total size of the six frames of MovingPatternSource coded on one thread, by
+// log2 of the tile columns. SB rows start from the rd thresholds of the row
+// above rather than from where the previous row ended, which moves the output
+// away from that of the serial encoder with four tile columns. It coded 122398
+// bytes there.
+const size_t kSingleThreadBytes[] = { 122198, 122248, 122438 };
+
+// Moving gradient wide enough to be split into four tile columns.
+class MovingPatternSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  MovingPatternSource() {
+    SetSize(1024, 144);
+    limit_ = 6;
+  }
+
+ protected:
+  virtual void FillFrame() {
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? 1 : 0;
+      const int w = width_ >> shift;
+      const int h = height_ >> shift;
+      uint8_t *buf = img_->planes[plane];
+      for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+          const int v = ((x + 3 * frame_) ^ (y + 2 * frame_)) +
+                        ((x * y + 7 * frame_) >> 6);
+          buf[x] = static_cast<uint8_t>(plane ? 128 + (v & 31) : v);
+        }
+        buf += img_->stride[plane];
+      }
+    }
+  }
+};
+
+class VP9EncoderThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWith2Params<libvpx_test::TestMode, int> {
+ protected:
+  VP9EncoderThreadTest()
+      : EncoderTest(GET_PARAM(0)), tile_columns_(GET_PARAM(2)) {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(GET_PARAM(1));
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_target_bitrate = 1000;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(VP9E_SET_TILE_COLUMNS, tile_columns_);
+      encoder->Control(VP8E_SET_CPUUSED, 2);
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    frames_.push_back(
+        std::string(reinterpret_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz));
+  }
+
+  std::vector<std::string> frames_;
+  int tile_columns_;
+};
+
+// The SB rows of every tile column are coded the same way whichever thread
+// encodes them, so the bitstream must not depend on the number of threads.
+TEST_P(VP9EncoderThreadTest, EncoderResultTest) {
+  MovingPatternSource video;
+
+  cfg_.g_threads = 1;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<std::string> single_thread_frames = frames_;
+  frames_.clear();
+
+  cfg_.g_threads = 4;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+  ASSERT_EQ(single_thread_frames.size(), frames_.size());
+  for (size_t i = 0; i < frames_.size(); ++i)
+    EXPECT_TRUE(single_thread_frames[i] == frames_[i]) << "frame " << i;
+}
+
+// Pins the single-thread output, which the wavefront row starts made differ
+// from the serial encoder's.
+TEST_P(VP9EncoderThreadTest, SingleThreadOutputSize) {
+  MovingPatternSource video;
+
+  cfg_.g_threads = 1;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+  size_t bytes = 0;
+  for (size_t i = 0; i < frames_.size(); ++i)
+    bytes += frames_[i].size();
+  EXPECT_EQ(kSingleThreadBytes[tile_columns_], bytes);
+}
+
+class VP9FirstPassThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<libvpx_test::TestMode> {
+ protected:
+  VP9FirstPassThreadTest() : EncoderTest(GET_PARAM(0)) {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(GET_PARAM(1));
+    cfg_.rc_target_bitrate = 1000;
+  }
+
+  // RunLoop() leaves abort_ set from the previous run.
+  virtual void BeginPassHook(unsigned int pass) {
+    abort_ = false;
+  }
+
+  // Only the first pass is of interest, so the second one is not run.
+  virtual void EndPassHook() {
+    const vpx_fixed_buf_t buf = stats_.buf();
+    first_pass_stats_.assign(static_cast<const char *>(buf.buf), buf.sz);
+    abort_ = true;
+  }
+
+  std::string first_pass_stats_;
+};
+
+// The MB rows of the first pass are coded as a wavefront and their statistics
+// summed in row order, so the stats must not depend on the number of threads.
+TEST_P(VP9FirstPassThreadTest, FirstPassStatsTest) {
+  MovingPatternSource video;
+  // Partial MBs at the right and bottom edges.
+  video.SetSize(1016, 136);
+
+  cfg_.g_threads = 1;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::string single_thread_stats = first_pass_stats_;
+  ASSERT_FALSE(single_thread_stats.empty());
+
+  const unsigned int threads[] = { 2, 8 };
+  for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+    cfg_.g_threads = threads[i];
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    EXPECT_TRUE(single_thread_stats == first_pass_stats_)
+        << threads[i] << " threads";
+  }
+}
+
+// Reads the loop filter level from the uncompressed header of a frame
+// written by vp9_bitstream.c, or returns -1 if the header is cut short.
+class FrameHeaderReader {
+ public:
+  explicit FrameHeaderReader(const std::string &frame)
+      : frame_(frame), bit_offset_(0) {}
+
+  int ReadFilterLevel() {
+    ReadLiteral(2);  // Frame marker.
+    ReadLiteral(2);  // Version.
+    ReadBit();  // Show existing frame.
+    const int key_frame = !ReadBit();
+    const int show_frame = ReadBit();
+    const int error_resilient_mode = ReadBit();
+
+    if (key_frame) {
+      ReadLiteral(24);  // Sync code.
+      ReadLiteral(3);  // Color space, never sRGB in profile 0.
+      ReadBit();  // Color range.
+      SkipFrameSize();
+    } else {
+      const int intra_only = show_frame ? 0 : ReadBit();
+      if (!error_resilient_mode)
+        ReadLiteral(2);  // Reset frame context.
+      if (intra_only) {
+        ReadLiteral(24);  // Sync code.
+        ReadLiteral(8);  // Refresh mask.
+        SkipFrameSize();
+      } else {
+        ReadLiteral(8);  // Refresh mask.
+        ReadLiteral(3 * (3 + 1));  // Reference indices and sign biases.
+        int found = 0;
+        for (int i = 0; i < 3 && !found; ++i)
+          found = ReadBit();
+        if (!found)
+          SkipSize();
+        SkipDisplaySize();
+        ReadBit();  // High precision mv.
+        if (!ReadBit())  // Switchable interpolation filter.
+          ReadLiteral(2);
+      }
+    }
+
+    if (!error_resilient_mode)
+      ReadLiteral(2);  // Refresh frame context, frame parallel mode.
+    ReadLiteral(2);  // Frame context index.
+
+    const int filter_level = ReadLiteral(6);
+    return bit_offset_ <= 8 * frame_.size() ? filter_level : -1;
+  }
+
+ private:
+  int ReadBit() {
+    const size_t byte = bit_offset_ / 8;
+    const int shift = 7 - static_cast<int>(bit_offset_ % 8);
+    ++bit_offset_;
+    if (byte >= frame_.size())
+      return 0;
+    return (static_cast<uint8_t>(frame_[byte]) >> shift) & 1;
+  }
+
+  int ReadLiteral(int bits) {
+    int value = 0;
+    for (int i = 0; i < bits; ++i)
+      value = (value << 1) | ReadBit();
+    return value;
+  }
+
+  void SkipSize() {
+    ReadLiteral(16);  // Width - 1.
+    ReadLiteral(16);  // Height - 1.
+  }
+
+  void SkipDisplaySize() {
+    if (ReadBit())
+      SkipSize();
+  }
+
+  void SkipFrameSize() {
+    SkipSize();
+    SkipDisplaySize();
+  }
+
+  const std::string &frame_;
+  size_t bit_offset_;
+};
+
+class VP9LoopFilterPickThreadTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<int> {
+ protected:
+  VP9LoopFilterPickThreadTest()
+      : EncoderTest(GET_PARAM(0)), cpu_used_(GET_PARAM(1)) {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(::libvpx_test::kOnePassGood);
+    cfg_.g_lag_in_frames = 0;
+    // The levels picked for the pattern at this rate are spread over the
+    // search range rather than stuck at its ends.
+    cfg_.rc_target_bitrate = 3000;
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1)
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    const std::string frame(static_cast<const char *>(pkt->data.frame.buf),
+                            pkt->data.frame.sz);
+    filter_levels_.push_back(FrameHeaderReader(frame).ReadFilterLevel());
+  }
+
+  std::vector<int> filter_levels_;
+
+ private:
+  int cpu_used_;
+};
+
+// vp9_pick_filter_level() tries the levels of a search step on separate
+// workers when there are threads for them, and one after the other
+// otherwise. Both must pick the same level for every frame of
+// LPF_PICK_FROM_FULL_IMAGE, the default method.
+TEST_P(VP9LoopFilterPickThreadTest, SameLevelAsSerialSearch) {
+  MovingPatternSource video;
+
+  cfg_.g_threads = 1;
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  const std::vector<int> serial_levels = filter_levels_;
+  ASSERT_FALSE(serial_levels.empty());
+  int max_level = 0;
+  for (size_t i = 0; i < serial_levels.size(); ++i) {
+    ASSERT_GE(serial_levels[i], 0) << "frame " << i;
+    max_level = std::max(max_level, serial_levels[i]);
+  }
+  // Level 0 is tried first, so only a nonzero pick exercises the search.
+  ASSERT_GT(max_level, 0);
+
+  // Two workers split the three candidates of the first step unevenly, three
+  // try one each.
+  const unsigned int threads[] = { 2, 3 };
+  for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+    filter_levels_.clear();
+    cfg_.g_threads = threads[i];
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    ASSERT_EQ(serial_levels.size(), filter_levels_.size());
+    for (size_t j = 0; j < filter_levels_.size(); ++j)
+      EXPECT_EQ(serial_levels[j], filter_levels_[j])
+          << threads[i] << " threads, frame " << j;
+  }
+}
+
+VP9_INSTANTIATE_TEST_CASE(
+    VP9EncoderThreadTest,
+    ::testing::Values(::libvpx_test::kOnePassGood, ::libvpx_test::kRealTime),
+    ::testing::Range(0, 3));
+
+VP9_INSTANTIATE_TEST_CASE(
+    VP9FirstPassThreadTest,
+    ::testing::Values(::libvpx_test::kTwoPassGood));
+
+VP9_INSTANTIATE_TEST_CASE(VP9LoopFilterPickThreadTest,
+                          ::testing::Values(2, 5));
+}  // namespace
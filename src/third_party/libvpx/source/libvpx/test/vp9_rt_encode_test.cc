@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cmath>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+#include "vpx_ports/vpx_timer.h"
+
+namespace {
+
+const int kRdCpuUsed = 4;
+const int kPickModeCpuUsed = 5;
+
+// The non-RD path has to be at least this much faster than the RD one...
+const double kMinSpeedup = 1.5;
+// ...while keeping the average PSNR of the panning source above this.
+const double kMinPsnr = 48.0;
+
+// Smooth texture panning by one row and two columns per frame, with a box
+// moving across it.
+class PanningSource : public ::libvpx_test::DummyVideoSource {
+ public:
+  PanningSource() {
+    SetSize(352, 288);
+    limit_ = 30;
+  }
+
+ protected:
+  virtual void FillFrame() {
+    const int w = width_;
+    const int h = height_;
+    const int box_x = 40 + (3 * frame_) % (w - 80);
+    uint8_t *buf = img_->planes[0];
+    for (int y = 0; y < h; ++y) {
+      for (int x = 0; x < w; ++x) {
+        const int px = x + 2 * frame_;
+        const int py = y + frame_;
+        int v = 128 + static_cast<int>(60 * sin(px * 0.05) * cos(py * 0.07) +
+                                       30 * sin((px + py) * 0.13));
+        if (x > box_x && x < box_x + 40 && y > 50 && y < 90)
+          v = 220 - ((x + y) & 7) * 4;
+        buf[x] = static_cast<uint8_t>(v);
+      }
+      buf += img_->stride[0];
+    }
+    for (int plane = 1; plane < 3; ++plane) {
+      buf = img_->planes[plane];
+      for (int y = 0; y < (h >> 1); ++y) {
+        for (int x = 0; x < (w >> 1); ++x)
+          buf[x] = static_cast<uint8_t>(128 + ((x + frame_) & 15));
+        buf += img_->stride[plane];
+      }
+    }
+  }
+};
+
+class VP9RealTimeEncodeTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<libvpx_test::TestMode> {
+ protected:
+  VP9RealTimeEncodeTest()
+      : EncoderTest(GET_PARAM(0)), cpu_used_(0), psnr_sum_(0.0), frames_(0),
+        encode_time_(0), timing_(false) {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(GET_PARAM(1));
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_target_bitrate = 400;
+    init_flags_ = VPX_CODEC_USE_PSNR;
+  }
+
+  // Encodes the panning source at cpu_used, which also checks that the
+  // decoder reconstructs the same frames as the encoder.
+  void Encode(int cpu_used) {
+    PanningSource video;
+    cpu_used_ = cpu_used;
+    psnr_sum_ = 0.0;
+    frames_ = 0;
+    encode_time_ = 0;
+    timing_ = false;
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1)
+      encoder->Control(VP8E_SET_CPUUSED, cpu_used_);
+    // Only the inter frames are timed. The key frame is coded the same way
+    // on both paths, and the first frame also pays for the encoder setup.
+    if (video->frame() > 0 && video->img()) {
+      vpx_usec_timer_start(&timer_);
+      timing_ = true;
+    }
+  }
+
+  // The first packet of a frame marks the end of its encode. Decoding it for
+  // the mismatch check is not timed.
+  virtual const vpx_codec_cx_pkt_t *MutateEncoderOutputHook(
+      const vpx_codec_cx_pkt_t *pkt) {
+    if (timing_) {
+      vpx_usec_timer_mark(&timer_);
+      encode_time_ += vpx_usec_timer_elapsed(&timer_);
+      timing_ = false;
+    }
+    return pkt;
+  }
+
+  virtual void PSNRPktHook(const vpx_codec_cx_pkt_t *pkt) {
+    psnr_sum_ += pkt->data.psnr.psnr[0];
+    ++frames_;
+  }
+
+  double average_psnr() const {
+    return frames_ ? psnr_sum_ / frames_ : 0.0;
+  }
+
+  int cpu_used_;
+  double psnr_sum_;
+  int frames_;
+  int64_t encode_time_;
+
+ private:
+  struct vpx_usec_timer timer_;
+  bool timing_;
+};
+
+TEST_P(VP9RealTimeEncodeTest, PickModeIsFasterThanRd) {
+  ASSERT_NO_FATAL_FAILURE(Encode(kRdCpuUsed));
+  const int64_t rd_time = encode_time_;
+  const double rd_psnr = average_psnr();
+
+  ASSERT_NO_FATAL_FAILURE(Encode(kPickModeCpuUsed));
+  const int64_t pick_mode_time = encode_time_;
+  const double pick_mode_psnr = average_psnr();
+
+  ASSERT_GT(pick_mode_time, 0);
+  EXPECT_GE(static_cast<double>(rd_time) / pick_mode_time, kMinSpeedup)
+      << "rd " << rd_time << "us, pick mode " << pick_mode_time << "us";
+  EXPECT_GE(pick_mode_psnr, kMinPsnr) << "rd psnr " << rd_psnr;
+}
+
+VP9_INSTANTIATE_TEST_CASE(
+    VP9RealTimeEncodeTest,
+    ::testing::Values(::libvpx_test::kRealTime));
+}  // namespace
@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/util.h"
+#include "test/video_source.h"
+
+namespace {
+
+const int kPadding = 64;
+const unsigned int kFrames = 20;
+
+// Frames with a visible area neither dimension of which is a multiple of 64,
+// each in its own image padded by kPadding pixels of noise. Images are
+// scribbled over once released, so later reads of them change the output.
+class PaddedFrameSource : public ::libvpx_test::VideoSource {
+ public:
+  PaddedFrameSource() : frame_(0), released_(kFrames, 0) {
+    for (unsigned int i = 0; i < kFrames; ++i)
+      imgs_[i] = vpx_img_alloc(NULL, VPX_IMG_FMT_I420, kWidth + 2 * kPadding,
+                               kHeight + 2 * kPadding, 32);
+  }
+
+  virtual ~PaddedFrameSource() {
+    for (unsigned int i = 0; i < kFrames; ++i)
+      vpx_img_free(imgs_[i]);
+  }
+
+  virtual void Begin() {
+    frame_ = 0;
+    released_.assign(kFrames, 0);
+    FillFrame();
+  }
+
+  virtual void Next() {
+    ++frame_;
+    FillFrame();
+  }
+
+  virtual vpx_image_t *img() const {
+    return frame_ < kFrames ? imgs_[frame_] : NULL;
+  }
+
+  virtual vpx_codec_pts_t pts() const { return frame_; }
+
+  virtual unsigned long duration() const { return 1; }
+
+  virtual vpx_rational_t timebase() const {
+    const vpx_rational_t t = {1, 30};
+    return t;
+  }
+
+  virtual unsigned int frame() const { return frame_; }
+
+  virtual unsigned int limit() const { return kFrames; }
+
+  static void Release(void *cb_priv, void *user_priv) {
+    PaddedFrameSource *const source =
+        reinterpret_cast<PaddedFrameSource *>(cb_priv);
+    const size_t frame = reinterpret_cast<size_t>(user_priv);
+    vpx_image_t *const img = source->imgs_[frame];
+
+    ++source->released_[frame];
+    memset(img->img_data, 0x5a, img->stride[0] * img->h * 3 / 2);
+  }
+
+  const std::vector<int> &released() const { return released_; }
+
+ private:
+  static const unsigned int kWidth = 200;
+  static const unsigned int kHeight = 120;
+
+  void FillFrame() {
+    if (frame_ >= kFrames)
+      return;
+
+    vpx_image_t *const img = imgs_[frame_];
+    libvpx_test::ACMRandom rnd(frame_);
+    for (size_t i = 0; i < img->stride[0] * img->h * 3 / 2; ++i)
+      img->img_data[i] = rnd.Rand8();
+
+    vpx_img_set_rect(img, kPadding, kPadding, kWidth, kHeight);
+    img->user_priv = reinterpret_cast<void *>(frame_);
+    for (int plane = 0; plane < 3; ++plane) {
+      const int shift = plane ? 1 : 0;
+      uint8_t *buf = img->planes[plane];
+      for (unsigned int y = 0; y < kHeight >> shift; ++y) {
+        for (unsigned int x = 0; x < kWidth >> shift; ++x) {
+          const int v = ((x + 3 * frame_) ^ (y + 2 * frame_)) +
+                        ((x * y + 7 * frame_) >> 6);
+          buf[x] = static_cast<uint8_t>(plane ? 128 + (v & 31) : v);
+        }
+        buf += img->stride[plane];
+      }
+    }
+  }
+
+  vpx_image_t *imgs_[kFrames];
+  unsigned int frame_;
+  std::vector<int> released_;
+};
+
+class VP9SourceReleaseTest
+    : public ::libvpx_test::EncoderTest,
+      public ::libvpx_test::CodecTestWithParam<libvpx_test::TestMode> {
+ protected:
+  VP9SourceReleaseTest()
+      : EncoderTest(GET_PARAM(0)), mode_(GET_PARAM(1)), source_(NULL),
+        reference_(false), scale_(false) {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(mode_);
+    cfg_.rc_target_bitrate = 600;
+    cfg_.g_lag_in_frames = mode_ == ::libvpx_test::kRealTime ? 0 : 25;
+  }
+
+  // Encodes the padded frames, referencing them instead of copying them if
+  // reference is set and scaling them down internally if scale is set, and
+  // returns the frame packets of the last pass.
+  std::vector<std::string> Encode(bool reference, bool scale) {
+    PaddedFrameSource video;
+    source_ = &video;
+    reference_ = reference;
+    scale_ = scale;
+    frames_.clear();
+    RunLoop(&video);
+    source_ = NULL;
+    return frames_;
+  }
+
+  virtual void BeginPassHook(unsigned int /*pass*/) {
+    frames_.clear();
+  }
+
+  virtual void PreEncodeFrameHook(::libvpx_test::VideoSource *video,
+                                  ::libvpx_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(VP8E_SET_CPUUSED, 2);
+      encoder->Control(VP8E_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(VP8E_SET_ARNR_MAXFRAMES, 7);
+      encoder->Control(VP8E_SET_ARNR_STRENGTH, 5);
+      encoder->Control(VP8E_SET_ARNR_TYPE, 3);
+      if (reference_) {
+        vpx_source_release_cb_t cb = { PaddedFrameSource::Release, source_ };
+        encoder->Control(VP9E_SET_SOURCE_RELEASE_CB, &cb);
+      }
+      if (scale_) {
+        struct vpx_scaling_mode mode = {VP8E_FOURFIVE, VP8E_THREEFIVE};
+        encoder->Control(VP8E_SET_SCALEMODE, &mode);
+      }
+    }
+  }
+
+  virtual void FramePktHook(const vpx_codec_cx_pkt_t *pkt) {
+    frames_.push_back(
+        std::string(reinterpret_cast<const char *>(pkt->data.frame.buf),
+                    pkt->data.frame.sz));
+  }
+
+  // Flushing the encoder pops every frame, which releases the referenced
+  // ones. Frame 0 is encoded before the callback is set.
+  virtual void EndPassHook() {
+    if (reference_) {
+      for (unsigned int i = 0; i < kFrames; ++i)
+        EXPECT_EQ(i > 0 ? 1 : 0, source_->released()[i]) << "frame " << i;
+    }
+  }
+
+  ::libvpx_test::TestMode mode_;
+  PaddedFrameSource *source_;
+  bool reference_;
+  bool scale_;
+  std::vector<std::string> frames_;
+};
+
+TEST_P(VP9SourceReleaseTest, ReferencedSourcesEncodeLikeCopies) {
+  const std::vector<std::string> copied = Encode(false, false);
+  const std::vector<std::string> referenced = Encode(true, false);
+
+  ASSERT_EQ(copied.size(), referenced.size());
+  for (size_t i = 0; i < copied.size(); ++i)
+    EXPECT_TRUE(copied[i] == referenced[i]) << "frame " << i;
+}
+
+// The scaler filters across every edge of the source, so the padding around
+// a referenced frame must not reach the output either.
+TEST_P(VP9SourceReleaseTest, ScaledReferencedSourcesEncodeLikeCopies) {
+  const std::vector<std::string> copied = Encode(false, true);
+  const std::vector<std::string> referenced = Encode(true, true);
+
+  ASSERT_EQ(copied.size(), referenced.size());
+  for (size_t i = 0; i < copied.size(); ++i)
+    EXPECT_TRUE(copied[i] == referenced[i]) << "frame " << i;
+}
+
+VP9_INSTANTIATE_TEST_CASE(
+    VP9SourceReleaseTest,
+    ::testing::Values(::libvpx_test::kRealTime,
+                      ::libvpx_test::kTwoPassGood));
+}  // namespace
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "third_party/googletest/src/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+extern "C" {
+#include "./vpx_config.h"
+#include "./vp9_rtcd.h"
+#include "vpx_mem/vpx_mem.h"
+}
+
+typedef void (*temporal_filter_apply_fn_t)(uint8_t *frame1,
+                                           unsigned int stride,
+                                           uint8_t *frame2,
+                                           unsigned int block_size,
+                                           int strength,
+                                           int filter_weight,
+                                           unsigned int *accumulator,
+                                           uint16_t *count);
+
+namespace vp9 {
+
+using libvpx_test::ACMRandom;
+
+const int kStride = 48;
+const int kMaxBlockSize = 16;
+const int kMaxStrength = 6;
+const int kMaxFilterWeight = 2;
+
+void ReferenceTemporalFilterApply(const uint8_t *frame1, int stride,
+                                  const uint8_t *frame2, int block_size,
+                                  int strength, int filter_weight,
+                                  unsigned int *accumulator,
+                                  uint16_t *count) {
+  const int rounding = strength > 0 ? 1 << (strength - 1) : 0;
+  for (int r = 0; r < block_size; ++r) {
+    for (int c = 0; c < block_size; ++c) {
+      const int k = r * block_size + c;
+      const int diff = frame1[r * stride + c] - frame2[k];
+      int modifier = (3 * diff * diff + rounding) >> strength;
+      if (modifier > 16)
+        modifier = 16;
+      modifier = (16 - modifier) * filter_weight;
+      count[k] += modifier;
+      accumulator[k] += modifier * frame2[k];
+    }
+  }
+}
+
+class VP9TemporalFilterApplyTest
+    : public ::testing::TestWithParam<temporal_filter_apply_fn_t> {
+ public:
+  virtual void SetUp() {
+    frame1_ = reinterpret_cast<uint8_t *>(
+        vpx_memalign(16, kStride * kMaxBlockSize));
+    frame2_ = reinterpret_cast<uint8_t *>(
+        vpx_memalign(16, kMaxBlockSize * kMaxBlockSize));
+    accumulator_ = reinterpret_cast<unsigned int *>(
+        vpx_memalign(16, sizeof(*accumulator_) * kMaxBlockSize *
+                     kMaxBlockSize));
+    count_ = reinterpret_cast<uint16_t *>(
+        vpx_memalign(16, sizeof(*count_) * kMaxBlockSize * kMaxBlockSize));
+  }
+
+  virtual void TearDown() {
+    vpx_free(frame1_);
+    vpx_free(frame2_);
+    vpx_free(accumulator_);
+    vpx_free(count_);
+    libvpx_test::ClearSystemState();
+  }
+
+ protected:
+  // Runs the function under test and the reference on the same inputs, and
+  // checks that they add the same values to the accumulator and count.
+  void CheckBlock(ACMRandom *rnd, int block_size) {
+    unsigned int ref_accumulator[kMaxBlockSize * kMaxBlockSize];
+    uint16_t ref_count[kMaxBlockSize * kMaxBlockSize];
+
+    for (int strength = 0; strength <= kMaxStrength; ++strength) {
+      for (int weight = 0; weight <= kMaxFilterWeight; ++weight) {
+        for (int i = 0; i < block_size * block_size; ++i) {
+          accumulator_[i] = ref_accumulator[i] = rnd->Rand16();
+          count_[i] = ref_count[i] = rnd->Rand8();
+        }
+
+        ReferenceTemporalFilterApply(frame1_, kStride, frame2_, block_size,
+                                     strength, weight, ref_accumulator,
+                                     ref_count);
+        REGISTER_STATE_CHECK(GetParam()(frame1_, kStride, frame2_,
+                                        block_size, strength, weight,
+                                        accumulator_, count_));
+
+        for (int i = 0; i < block_size * block_size; ++i) {
+          ASSERT_EQ(ref_count[i], count_[i])
+              << "i = " << i << ", bs = " << block_size
+              << ", strength = " << strength << ", weight = " << weight;
+          ASSERT_EQ(ref_accumulator[i], accumulator_[i])
+              << "i = " << i << ", bs = " << block_size
+              << ", strength = " << strength << ", weight = " << weight;
+        }
+      }
+    }
+  }
+
+  uint8_t *frame1_;
+  uint8_t *frame2_;
+  unsigned int *accumulator_;
+  uint16_t *count_;
+};
+
+TEST_P(VP9TemporalFilterApplyTest, RandomValues) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  for (int block_size = 8; block_size <= kMaxBlockSize; block_size *= 2) {
+    for (int n = 0; n < 100; ++n) {
+      for (int i = 0; i < kStride * kMaxBlockSize; ++i)
+        frame1_[i] = rnd.Rand8();
+      for (int i = 0; i < kMaxBlockSize * kMaxBlockSize; ++i)
+        frame2_[i] = rnd.Rand8();
+      CheckBlock(&rnd, block_size);
+    }
+  }
+}
+
+// Differences large enough for 3 * diff^2 to overflow 16 bits.
+TEST_P(VP9TemporalFilterApplyTest, ExtremeValues) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  for (int block_size = 8; block_size <= kMaxBlockSize; block_size *= 2) {
+    for (int n = 0; n < 100; ++n) {
+      for (int i = 0; i < kStride * kMaxBlockSize; ++i)
+        frame1_[i] = rnd(2) ? 255 - rnd(64) : rnd(64);
+      for (int i = 0; i < kMaxBlockSize * kMaxBlockSize; ++i)
+        frame2_[i] = rnd(2) ? 255 - rnd(64) : rnd(64);
+      CheckBlock(&rnd, block_size);
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(C, VP9TemporalFilterApplyTest,
+                        ::testing::Values(vp9_temporal_filter_apply_c));
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(SSE2, VP9TemporalFilterApplyTest,
+                        ::testing::Values(vp9_temporal_filter_apply_sse2));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, VP9TemporalFilterApplyTest,
+                        ::testing::Values(vp9_temporal_filter_apply_avx2));
+#endif
+}  // namespace vp9
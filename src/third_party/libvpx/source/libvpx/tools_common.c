@@ -26,6 +26,16 @@
 #endif
 #endif
 
+#if CONFIG_OS_SUPPORT
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+#endif
+
 #define LOG_ERROR(label) do {\
   const char *l = label;\
   va_list ap;\
@@ -130,3 +140,75 @@ int read_yuv_frame(struct VpxInputContext *input_ctx, vpx_image_t *yuv_frame) {
 
   return shortread;
 }
+
+int map_input_file(struct VpxInputMap *map, FILE *file) {
+  memset(map, 0, sizeof(*map));
+#if CONFIG_OS_SUPPORT
+#if defined(_WIN32)
+  {
+    const HANDLE fh = (HANDLE)_get_osfhandle(_fileno(file));
+    LARGE_INTEGER size;
+    HANDLE mapping;
+    void *data;
+
+    if (fh == INVALID_HANDLE_VALUE || GetFileType(fh) != FILE_TYPE_DISK ||
+        !GetFileSizeEx(fh, &size) || size.QuadPart <= 0 ||
+        (uint64_t)size.QuadPart > (size_t)-1)
+      return 0;
+
+    mapping = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+      return 0;
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+      CloseHandle(mapping);
+      return 0;
+    }
+    map->data = (const uint8_t *)data;
+    map->base = data;
+    map->size = (size_t)size.QuadPart;
+    map->handle = mapping;
+  }
+#else
+  {
+    struct stat st;
+    void *data;
+
+    if (fstat(fileno(file), &st) || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (uint64_t)st.st_size > (size_t)-1)
+      return 0;
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                fileno(file), 0);
+    if (data == MAP_FAILED)
+      return 0;
+#if defined(MADV_SEQUENTIAL)
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    map->data = (const uint8_t *)data;
+    map->base = data;
+    map->size = (size_t)st.st_size;
+  }
+#endif
+  /* The detection code may already have consumed a header through stdio. */
+  map->pos = (size_t)ftello(file);
+  return 1;
+#else
+  (void)file;
+  return 0;
+#endif
+}
+
+void unmap_input_file(struct VpxInputMap *map) {
+  if (!map->data)
+    return;
+#if CONFIG_OS_SUPPORT
+#if defined(_WIN32)
+  UnmapViewOfFile(map->base);
+  CloseHandle((HANDLE)map->handle);
+#else
+  munmap(map->base, map->size);
+#endif
+#endif
+  memset(map, 0, sizeof(*map));
+}
@@ -84,9 +84,21 @@ struct VpxRational {
   int denominator;
 };
 
+/* A read-only view of a whole input file. When data is non-NULL the readers
+ * consume bytes from it at pos instead of calling fread() on the FILE.
+ */
+struct VpxInputMap {
+  const uint8_t *data;
+  size_t size;
+  size_t pos;
+  void *base;  /* The mapping data points into, for unmap_input_file(). */
+  void *handle;
+};
+
 struct VpxInputContext {
   const char *filename;
   FILE *file;
+  struct VpxInputMap map;
   off_t length;
   struct FileTypeDetectionBuffer detect;
   enum VideoFileType file_type;
@@ -120,6 +132,13 @@ uint32_t mem_get_le32(const void *data);
 
 int read_yuv_frame(struct VpxInputContext *input_ctx, vpx_image_t *yuv_frame);
 
+/* Maps a regular file into memory. Returns 0 (leaving map->data NULL) for
+ * pipes, stdin or when the platform has no mapping support; callers then
+ * fall back to stdio.
+ */
+int map_input_file(struct VpxInputMap *map, FILE *file);
+void unmap_input_file(struct VpxInputMap *map);
+
 #ifdef __cplusplus
 //}  /* extern "C" */
 #endif
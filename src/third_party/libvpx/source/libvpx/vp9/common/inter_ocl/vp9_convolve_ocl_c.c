@@ -50,7 +50,8 @@ static const int16_t vp9_inter_pred_filters_8_ocl_c[INTER_FILER_COUNT_OCL] = {
 
 static const int vp9_convolve_mode_ocl_c[2][2] = {{24, 16}, {8, 0}};
 
-void build_inter_pred_calcu_ocl_c(int tile_num, uint8_t *new_buffer) {
+void build_inter_pred_calcu_ocl_c(INTER_OCL_OBJ *inter_ocl, int tile_num,
+                                  uint8_t *new_buffer) {
   int i;
   int mode_num;
   uint8_t *src;
@@ -58,13 +59,13 @@ void build_inter_pred_calcu_ocl_c(int tile_num, uint8_t *new_buffer) {
   const int16_t *filter_x;
   const int16_t *filter_y;
 
-  const int fri_block_count = *inter_ocl_obj.cpu_fri_count[tile_num];
-  const int sec_block_count = *inter_ocl_obj.cpu_sec_count[tile_num];
+  const int fri_block_count = *inter_ocl->cpu_fri_count[tile_num];
+  const int sec_block_count = *inter_ocl->cpu_sec_count[tile_num];
   const INTER_PRED_PARAM_CPU *pred_param_fri =
-            inter_ocl_obj.pred_param_cpu_fri[tile_num];
+            inter_ocl->pred_param_cpu_fri[tile_num];
   const INTER_PRED_PARAM_CPU *pred_param_sec =
-            inter_ocl_obj.pred_param_cpu_sec[tile_num];
-  convolve_fn_t *switch_convolve_t = inter_ocl_obj.switch_convolve_t;
+            inter_ocl->pred_param_cpu_sec[tile_num];
+  convolve_fn_t *switch_convolve_t = inter_ocl->switch_convolve_t;
 
   for (i = 0; i < fri_block_count; ++i) {
     mode_num = vp9_convolve_mode_ocl_c[(pred_param_fri[i].x_step_q4 == 16)]
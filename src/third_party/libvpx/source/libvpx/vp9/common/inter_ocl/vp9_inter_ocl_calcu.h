@@ -14,7 +14,9 @@
 #include "vp9/common/vp9_common.h"
 #include "vp9/common/vp9_onyxc_int.h"
 
-int get_second_ref_count_ocl();
+struct inter_ocl_obj;
+
+int get_second_ref_count_ocl(struct inter_ocl_obj *inter_ocl);
 
 int inter_pred_index_ocl_whole_frame(VP9_COMMON *const cm);
 
@@ -12,6 +12,7 @@
 #include <stdio.h>
 
 #include "vpx_mem/vpx_mem.h"
+#include "vpx_ports/vpx_once.h"
 #include "vp9/sched/thread.h"
 
 #include "vp9/common/inter_ocl/vp9_inter_ocl_init.h"
@@ -28,45 +29,53 @@
 #define FREE_INTER(alloc_p)      vpx_free(alloc_p)
 #define MALLOC_INTER(type, size) (type *)vpx_memalign(32, size)
 
-static void inter_convolve_init_ocl() {
-  inter_ocl_obj.switch_convolve_t[0] = vp9_convolve_copy;
-  inter_ocl_obj.switch_convolve_t[1] = vp9_convolve_avg;
-  inter_ocl_obj.switch_convolve_t[2] = vp9_convolve8_vert;
-  inter_ocl_obj.switch_convolve_t[3] = vp9_convolve8_avg_vert;
-  inter_ocl_obj.switch_convolve_t[4] = vp9_convolve8_horiz;
-  inter_ocl_obj.switch_convolve_t[5] = vp9_convolve8_avg_horiz;
-  inter_ocl_obj.switch_convolve_t[6] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[7] = vp9_convolve8_avg;
-
-  inter_ocl_obj.switch_convolve_t[8] = vp9_convolve8_vert;
-  inter_ocl_obj.switch_convolve_t[9] = vp9_convolve8_avg_vert;
-  inter_ocl_obj.switch_convolve_t[10] = vp9_convolve8_vert;
-  inter_ocl_obj.switch_convolve_t[11] = vp9_convolve8_avg_vert;
-  inter_ocl_obj.switch_convolve_t[12] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[13] = vp9_convolve8_avg;
-  inter_ocl_obj.switch_convolve_t[14] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[15] = vp9_convolve8_avg;
-
-  inter_ocl_obj.switch_convolve_t[16] = vp9_convolve8_horiz;
-  inter_ocl_obj.switch_convolve_t[17] = vp9_convolve8_avg_horiz;
-  inter_ocl_obj.switch_convolve_t[18] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[19] = vp9_convolve8_avg;
-  inter_ocl_obj.switch_convolve_t[20] = vp9_convolve8_horiz;
-  inter_ocl_obj.switch_convolve_t[21] = vp9_convolve8_avg_horiz;
-  inter_ocl_obj.switch_convolve_t[22] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[23] = vp9_convolve8_avg;
-
-  inter_ocl_obj.switch_convolve_t[24] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[25] = vp9_convolve8_avg;
-  inter_ocl_obj.switch_convolve_t[26] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[27] = vp9_convolve8_avg;
-  inter_ocl_obj.switch_convolve_t[28] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[29] = vp9_convolve8_avg;
-  inter_ocl_obj.switch_convolve_t[30] = vp9_convolve8;
-  inter_ocl_obj.switch_convolve_t[31] = vp9_convolve8_avg;
+static pthread_mutex_t ocl_context_lock;
+static int ocl_context_users = 0;
+
+static void ocl_context_lock_init() {
+  pthread_mutex_init(&ocl_context_lock, NULL);
+}
+
+static void inter_convolve_init_ocl(INTER_OCL_OBJ *inter_ocl) {
+  inter_ocl->switch_convolve_t[0] = vp9_convolve_copy;
+  inter_ocl->switch_convolve_t[1] = vp9_convolve_avg;
+  inter_ocl->switch_convolve_t[2] = vp9_convolve8_vert;
+  inter_ocl->switch_convolve_t[3] = vp9_convolve8_avg_vert;
+  inter_ocl->switch_convolve_t[4] = vp9_convolve8_horiz;
+  inter_ocl->switch_convolve_t[5] = vp9_convolve8_avg_horiz;
+  inter_ocl->switch_convolve_t[6] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[7] = vp9_convolve8_avg;
+
+  inter_ocl->switch_convolve_t[8] = vp9_convolve8_vert;
+  inter_ocl->switch_convolve_t[9] = vp9_convolve8_avg_vert;
+  inter_ocl->switch_convolve_t[10] = vp9_convolve8_vert;
+  inter_ocl->switch_convolve_t[11] = vp9_convolve8_avg_vert;
+  inter_ocl->switch_convolve_t[12] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[13] = vp9_convolve8_avg;
+  inter_ocl->switch_convolve_t[14] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[15] = vp9_convolve8_avg;
+
+  inter_ocl->switch_convolve_t[16] = vp9_convolve8_horiz;
+  inter_ocl->switch_convolve_t[17] = vp9_convolve8_avg_horiz;
+  inter_ocl->switch_convolve_t[18] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[19] = vp9_convolve8_avg;
+  inter_ocl->switch_convolve_t[20] = vp9_convolve8_horiz;
+  inter_ocl->switch_convolve_t[21] = vp9_convolve8_avg_horiz;
+  inter_ocl->switch_convolve_t[22] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[23] = vp9_convolve8_avg;
+
+  inter_ocl->switch_convolve_t[24] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[25] = vp9_convolve8_avg;
+  inter_ocl->switch_convolve_t[26] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[27] = vp9_convolve8_avg;
+  inter_ocl->switch_convolve_t[28] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[29] = vp9_convolve8_avg;
+  inter_ocl->switch_convolve_t[30] = vp9_convolve8;
+  inter_ocl->switch_convolve_t[31] = vp9_convolve8_avg;
 }
 
-static int create_inter_ocl_buffer(const int buffer_size,
+static int create_inter_ocl_buffer(INTER_OCL_OBJ *inter_ocl,
+                                   const int buffer_size,
                                    const int tile_count) {
   int i;
   int status;
@@ -79,48 +88,48 @@ static int create_inter_ocl_buffer(const int buffer_size,
   int index_size_param = param_count_gpu * sizeof(INTER_INDEX_PARAM_GPU);
   int index_size_param_all =
           param_count_gpu_all * sizeof(INTER_INDEX_PARAM_GPU);
-  inter_ocl_obj.index_param_size = index_size_param;
+  inter_ocl->index_param_size = index_size_param;
 
-  inter_ocl_obj.tile_count = tile_count;
-  inter_ocl_obj.buffer_size = sizeof(uint8_t) * buffer_size;
-  inter_ocl_obj.buffer_pool_size =
-  inter_ocl_obj.buffer_size * FRAME_BUFFERS;
+  inter_ocl->tile_count = tile_count;
+  inter_ocl->buffer_size = sizeof(uint8_t) * buffer_size;
+  inter_ocl->buffer_pool_size =
+  inter_ocl->buffer_size * FRAME_BUFFERS;
 
-  inter_ocl_obj.param_count_gpu_all = param_count_gpu_all;
-  inter_ocl_obj.tile_param_count_gpu = param_count_gpu;
+  inter_ocl->param_count_gpu_all = param_count_gpu_all;
+  inter_ocl->tile_param_count_gpu = param_count_gpu;
 
-  inter_ocl_obj.pred_param_size =
+  inter_ocl->pred_param_size =
     param_count_gpu * sizeof(INTER_PRED_PARAM_GPU);
-  inter_ocl_obj.pred_param_size_all =
+  inter_ocl->pred_param_size_all =
     param_count_gpu_all * sizeof(INTER_PRED_PARAM_GPU);
-  inter_ocl_obj.index_size_param_num = param_count_gpu * sizeof(int);
-  inter_ocl_obj.index_size_param_num_all = param_count_gpu_all * sizeof(int);
-  inter_ocl_obj.index_size_xmv = inter_ocl_obj.index_size_param_num;
-  inter_ocl_obj.index_size_xmv_all = inter_ocl_obj.index_size_param_num_all;
+  inter_ocl->index_size_param_num = param_count_gpu * sizeof(int);
+  inter_ocl->index_size_param_num_all = param_count_gpu_all * sizeof(int);
+  inter_ocl->index_size_xmv = inter_ocl->index_size_param_num;
+  inter_ocl->index_size_xmv_all = inter_ocl->index_size_param_num_all;
 
   // Alloc prameters buffers: the 0th gpu buffer size is the whole frame size
-  inter_ocl_obj.pred_param_kernel_td0 =
+  inter_ocl->pred_param_kernel_td0 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
-                     inter_ocl_obj.pred_param_size_all,
+                     inter_ocl->pred_param_size_all,
                      NULL, &status);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clCreateBuffe pred_param_kernel_td0, error: %d \n", status);
     return -1;
   }
-  inter_ocl_obj.pred_param_kernel_td1 =
+  inter_ocl->pred_param_kernel_td1 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
-                     inter_ocl_obj.pred_param_size_all,
+                     inter_ocl->pred_param_size_all,
                      NULL, &status);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clCreateBuffe pred_param_kernel_td1, error: %d \n", status);
     return -1;
   }
 
-  inter_ocl_obj.index_param_num_kernel_td0 =
+  inter_ocl->index_param_num_kernel_td0 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_READ_WRITE,
                      param_count_gpu_all * sizeof(int) * 4,
@@ -130,7 +139,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
          status);
     return -1;
   }
-  inter_ocl_obj.index_param_num_kernel_td1 =
+  inter_ocl->index_param_num_kernel_td1 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_READ_WRITE,
                      param_count_gpu_all * sizeof(int) * 4,
@@ -141,7 +150,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.index_xmv_kernel_td0 =
+  inter_ocl->index_xmv_kernel_td0 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_READ_WRITE,
                     param_count_gpu_all * sizeof(int) * 4,
@@ -150,7 +159,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     LOGE("Failed to clCreateBuffe index_xmv_kernel_td0, error: %d \n", status);
     return -1;
   }
-  inter_ocl_obj.index_xmv_kernel_td1 =
+  inter_ocl->index_xmv_kernel_td1 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_READ_WRITE,
                     param_count_gpu_all * sizeof(int) * 4,
@@ -160,7 +169,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.dst_index_xmv_kernel_td0 =
+  inter_ocl->dst_index_xmv_kernel_td0 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_READ_WRITE,
                      param_count_gpu_all * sizeof(int) * 4,
@@ -169,7 +178,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     LOGE("Failed to clCreateBuffe dst_index_xmv_kernel_td0, error: %d \n", status);
     return -1;
   }
-  inter_ocl_obj.dst_index_xmv_kernel_td1 =
+  inter_ocl->dst_index_xmv_kernel_td1 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_READ_WRITE,
                      param_count_gpu_all * sizeof(int) * 4,
@@ -179,7 +188,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.case_count_kernel_td0 =
+  inter_ocl->case_count_kernel_td0 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_WRITE,
@@ -190,7 +199,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.case_count_kernel_td1 =
+  inter_ocl->case_count_kernel_td1 =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_WRITE,
@@ -201,7 +210,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.one_case_interval_count_kernel =
+  inter_ocl->one_case_interval_count_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -212,7 +221,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.all_b_count_kernel =
+  inter_ocl->all_b_count_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -224,7 +233,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.new_fb_idx_kernel =
+  inter_ocl->new_fb_idx_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -236,7 +245,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.buffer_size_kernel =
+  inter_ocl->buffer_size_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -248,7 +257,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.index_case_mode_offset_kernel =
+  inter_ocl->index_case_mode_offset_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -260,7 +269,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.tile_param_count_gpu_offset_kernel =
+  inter_ocl->tile_param_count_gpu_offset_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -272,7 +281,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.gpu_block_count_kernel =
+  inter_ocl->gpu_block_count_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -284,7 +293,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.index_param_kernel =
+  inter_ocl->index_param_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -296,7 +305,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.tile_count_kernel =
+  inter_ocl->tile_count_kernel =
       clCreateBuffer(ocl_context.context,
                      CL_MEM_ALLOC_HOST_PTR |
                      CL_MEM_READ_ONLY,
@@ -308,9 +317,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.case_count_gpu_td0 =
+  inter_ocl->case_count_gpu_td0 =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.case_count_kernel_td0,
+                                 inter_ocl->case_count_kernel_td0,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  4 * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -319,9 +328,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.case_count_gpu_td1 =
+  inter_ocl->case_count_gpu_td1 =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.case_count_kernel_td1,
+                                 inter_ocl->case_count_kernel_td1,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  4 * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -330,9 +339,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.all_b_count_gpu =
+  inter_ocl->all_b_count_gpu =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.all_b_count_kernel,
+                                 inter_ocl->all_b_count_kernel,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  1 * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -341,9 +350,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.new_fb_idx_gpu =
+  inter_ocl->new_fb_idx_gpu =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.new_fb_idx_kernel,
+                                 inter_ocl->new_fb_idx_kernel,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  1 * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -352,9 +361,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.buffer_size_gpu =
+  inter_ocl->buffer_size_gpu =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.buffer_size_kernel,
+                                 inter_ocl->buffer_size_kernel,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  1 * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -363,9 +372,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.index_case_mode_offset_gpu =
+  inter_ocl->index_case_mode_offset_gpu =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.index_case_mode_offset_kernel,
+                                 inter_ocl->index_case_mode_offset_kernel,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  4 * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -375,9 +384,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.tile_param_count_gpu_offset_gpu =
+  inter_ocl->tile_param_count_gpu_offset_gpu =
       (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.tile_param_count_gpu_offset_kernel,
+                                 inter_ocl->tile_param_count_gpu_offset_kernel,
                                  CL_TRUE, CL_MAP_WRITE, 0,
                                  tile_count * sizeof(int),
                                  0, NULL, NULL, &status);
@@ -387,9 +396,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 
-  inter_ocl_obj.one_case_interval_count_gpu =
+  inter_ocl->one_case_interval_count_gpu =
   (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                             inter_ocl_obj.one_case_interval_count_kernel,
+                             inter_ocl->one_case_interval_count_kernel,
                              CL_TRUE, CL_MAP_WRITE, 0,
                              1 * sizeof(int),
                              0, NULL, NULL, &status);
@@ -401,7 +410,7 @@ static int create_inter_ocl_buffer(const int buffer_size,
   // This for inter index (Init some buffer)
   status = clEnqueueWriteBuffer(
                ocl_context.command_queue,
-               inter_ocl_obj.tile_count_kernel,
+               inter_ocl->tile_count_kernel,
                CL_TRUE,
                0,
                sizeof(int),
@@ -413,13 +422,13 @@ static int create_inter_ocl_buffer(const int buffer_size,
       return -1;
   }
 
-  inter_ocl_obj.buffer_size_gpu[0] = inter_ocl_obj.buffer_size;
-  inter_ocl_obj.one_case_interval_count_gpu[0] = param_count_gpu_all;
+  inter_ocl->buffer_size_gpu[0] = inter_ocl->buffer_size;
+  inter_ocl->one_case_interval_count_gpu[0] = param_count_gpu_all;
 
 #if 0//USE_INTER_PARAM_ZERO_COP
-  inter_ocl_obj.gpu_block_count =
+  inter_ocl->gpu_block_count =
   (int *) clEnqueueMapBuffer(ocl_context.command_queue,
-                             inter_ocl_obj.gpu_block_count_kernel,
+                             inter_ocl->gpu_block_count_kernel,
                              CL_TRUE, CL_MAP_WRITE, 0,
                              tile_count * sizeof(int),
                              0, NULL, NULL, &status);
@@ -428,46 +437,46 @@ static int create_inter_ocl_buffer(const int buffer_size,
     return -1;
   }
 #else
-  inter_ocl_obj.gpu_block_count =
+  inter_ocl->gpu_block_count =
       MALLOC_INTER(int, sizeof(int) * tile_count);
 #endif // USE_INTER_PARAM_ZERO_COPY
 
   for (i = 0; i < 4; ++i){
-    inter_ocl_obj.index_case_mode_offset[i] =
-        i * inter_ocl_obj.param_count_gpu_all;
-    inter_ocl_obj.index_case_mode_offset_gpu[i] =
-        inter_ocl_obj.index_case_mode_offset[i];
+    inter_ocl->index_case_mode_offset[i] =
+        i * inter_ocl->param_count_gpu_all;
+    inter_ocl->index_case_mode_offset_gpu[i] =
+        inter_ocl->index_case_mode_offset[i];
   }
 
   for (i = 0; i < tile_count; ++i) {
-    inter_ocl_obj.tile_param_count_gpu_offset[i] =
-        i * inter_ocl_obj.tile_param_count_gpu;
-    inter_ocl_obj.tile_param_count_gpu_offset_gpu[i] =
-        inter_ocl_obj.tile_param_count_gpu_offset[i];
+    inter_ocl->tile_param_count_gpu_offset[i] =
+        i * inter_ocl->tile_param_count_gpu;
+    inter_ocl->tile_param_count_gpu_offset_gpu[i] =
+        inter_ocl->tile_param_count_gpu_offset[i];
 
-    inter_ocl_obj.ref_buffer[i] =
-        MALLOC_INTER(uint8_t, inter_ocl_obj.buffer_size);
+    inter_ocl->ref_buffer[i] =
+        MALLOC_INTER(uint8_t, inter_ocl->buffer_size);
 
-    inter_ocl_obj.pred_param_cpu_fri_td0[i] =
+    inter_ocl->pred_param_cpu_fri_td0[i] =
         MALLOC_INTER(INTER_PRED_PARAM_CPU,
                      param_count_cpu * sizeof(INTER_PRED_PARAM_CPU));
-    inter_ocl_obj.pred_param_cpu_fri_td1[i] =
+    inter_ocl->pred_param_cpu_fri_td1[i] =
         MALLOC_INTER(INTER_PRED_PARAM_CPU,
                      param_count_cpu * sizeof(INTER_PRED_PARAM_CPU));
-    inter_ocl_obj.pred_param_cpu_sec_td0[i] =
+    inter_ocl->pred_param_cpu_sec_td0[i] =
         MALLOC_INTER(INTER_PRED_PARAM_CPU,
                      param_count_cpu * sizeof(INTER_PRED_PARAM_CPU));
-    inter_ocl_obj.pred_param_cpu_sec_td1[i] =
+    inter_ocl->pred_param_cpu_sec_td1[i] =
         MALLOC_INTER(INTER_PRED_PARAM_CPU,
                      param_count_cpu * sizeof(INTER_PRED_PARAM_CPU));
 
 #if USE_INTER_PARAM_ZERO_COPY
-    inter_ocl_obj.pred_param_gpu_td0[i] =
+    inter_ocl->pred_param_gpu_td0[i] =
     (INTER_PRED_PARAM_GPU *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.pred_param_kernel_td0,
+                                 inter_ocl->pred_param_kernel_td0,
                                  CL_TRUE, CL_MAP_WRITE,
-                                 i * inter_ocl_obj.pred_param_size,
-                                 inter_ocl_obj.pred_param_size,
+                                 i * inter_ocl->pred_param_size,
+                                 inter_ocl->pred_param_size,
                                  0, NULL, NULL, &status);
     if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueMapBuffer pred_param_gpu_td0 %d, error: %d \n",
@@ -475,12 +484,12 @@ static int create_inter_ocl_buffer(const int buffer_size,
       return -1;
     }
 
-    inter_ocl_obj.pred_param_gpu_td1[i] =
+    inter_ocl->pred_param_gpu_td1[i] =
     (INTER_PRED_PARAM_GPU *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                 inter_ocl_obj.pred_param_kernel_td1,
+                                 inter_ocl->pred_param_kernel_td1,
                                  CL_TRUE, CL_MAP_WRITE,
-                                 i * inter_ocl_obj.pred_param_size,
-                                 inter_ocl_obj.pred_param_size,
+                                 i * inter_ocl->pred_param_size,
+                                 inter_ocl->pred_param_size,
                                  0, NULL, NULL, &status);
     if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueMapBuffer pred_param_gpu_td0 %d, error: %d \n",
@@ -488,9 +497,9 @@ static int create_inter_ocl_buffer(const int buffer_size,
       return -1;
     }
 
-    inter_ocl_obj.index_param_gpu[i] =
+    inter_ocl->index_param_gpu[i] =
     (INTER_INDEX_PARAM_GPU *) clEnqueueMapBuffer(ocl_context.command_queue,
-                                  inter_ocl_obj.index_param_kernel,
+                                  inter_ocl->index_param_kernel,
                                   CL_TRUE, CL_MAP_WRITE,
                                   i * index_size_param,
                                   index_size_param,
@@ -501,89 +510,90 @@ static int create_inter_ocl_buffer(const int buffer_size,
       return -1;
     }
 
-    inter_ocl_obj.pred_param_gpu_pre[i] =
-        inter_ocl_obj.pred_param_gpu_td0[i];
+    inter_ocl->pred_param_gpu_pre[i] =
+        inter_ocl->pred_param_gpu_td0[i];
 #else
-    inter_ocl_obj.pred_param_gpu[i] =
-        MALLOC_INTER(INTER_PRED_PARAM_GPU, inter_ocl_obj.pred_param_size);
-    assert(inter_ocl_obj.pred_param_gpu[i] != NULL);
+    inter_ocl->pred_param_gpu[i] =
+        MALLOC_INTER(INTER_PRED_PARAM_GPU, inter_ocl->pred_param_size);
+    assert(inter_ocl->pred_param_gpu[i] != NULL);
 
-    inter_ocl_obj.index_param_gpu[i] =
+    inter_ocl->index_param_gpu[i] =
         MALLOC_INTER(INTER_INDEX_PARAM_GPU, index_size_param);
 #endif // USE_INTER_PARAM_ZERO_COPY
 
-    assert(inter_ocl_obj.pred_param_cpu_fri_td0[i] != NULL);
-    assert(inter_ocl_obj.pred_param_cpu_fri_td1[i] != NULL);
-    assert(inter_ocl_obj.pred_param_cpu_sec_td0[i] != NULL);
-    assert(inter_ocl_obj.pred_param_cpu_sec_td1[i] != NULL);
-    assert(inter_ocl_obj.index_param_gpu[i] != NULL);
+    assert(inter_ocl->pred_param_cpu_fri_td0[i] != NULL);
+    assert(inter_ocl->pred_param_cpu_fri_td1[i] != NULL);
+    assert(inter_ocl->pred_param_cpu_sec_td0[i] != NULL);
+    assert(inter_ocl->pred_param_cpu_sec_td1[i] != NULL);
+    assert(inter_ocl->index_param_gpu[i] != NULL);
 
-    inter_ocl_obj.pred_param_cpu_fri_pre[i] =
-        inter_ocl_obj.pred_param_cpu_fri_td0[i];
-    inter_ocl_obj.pred_param_cpu_sec_pre[i] =
-        inter_ocl_obj.pred_param_cpu_sec_td0[i];
+    inter_ocl->pred_param_cpu_fri_pre[i] =
+        inter_ocl->pred_param_cpu_fri_td0[i];
+    inter_ocl->pred_param_cpu_sec_pre[i] =
+        inter_ocl->pred_param_cpu_sec_td0[i];
 
-    inter_ocl_obj.switch_td_calcu_cpu[i] = 0;
+    inter_ocl->switch_td_calcu_cpu[i] = 0;
   }
 
-  inter_ocl_obj.pred_param_kernel_pre =
-      &inter_ocl_obj.pred_param_kernel_td0;
-  inter_ocl_obj.index_param_num_kernel_pre =
-      &inter_ocl_obj.index_param_num_kernel_td0;
-  inter_ocl_obj.index_xmv_kernel_pre =
-      &inter_ocl_obj.index_xmv_kernel_td0;
-  inter_ocl_obj.dst_index_xmv_kernel_pre =
-      &inter_ocl_obj.dst_index_xmv_kernel_td0;
-  inter_ocl_obj.case_count_kernel_pre =
-      &inter_ocl_obj.case_count_kernel_td0;
+  inter_ocl->pred_param_kernel_pre =
+      &inter_ocl->pred_param_kernel_td0;
+  inter_ocl->index_param_num_kernel_pre =
+      &inter_ocl->index_param_num_kernel_td0;
+  inter_ocl->index_xmv_kernel_pre =
+      &inter_ocl->index_xmv_kernel_td0;
+  inter_ocl->dst_index_xmv_kernel_pre =
+      &inter_ocl->dst_index_xmv_kernel_td0;
+  inter_ocl->case_count_kernel_pre =
+      &inter_ocl->case_count_kernel_td0;
 
-  inter_ocl_obj.case_count_gpu = inter_ocl_obj.case_count_gpu_td0;
-  inter_ocl_obj.index_count_pre = inter_ocl_obj.index_count_td0;
-  inter_ocl_obj.cpu_fri_count_pre = inter_ocl_obj.cpu_fri_count_td0;
-  inter_ocl_obj.cpu_sec_count_pre = inter_ocl_obj.cpu_sec_count_td0;
+  inter_ocl->case_count_gpu = inter_ocl->case_count_gpu_td0;
+  inter_ocl->index_count_pre = inter_ocl->index_count_td0;
+  inter_ocl->cpu_fri_count_pre = inter_ocl->cpu_fri_count_td0;
+  inter_ocl->cpu_sec_count_pre = inter_ocl->cpu_sec_count_td0;
 
-  inter_ocl_obj.switch_td_param = 1;
-  inter_ocl_obj.switch_td_calcu_gpu = 0;
+  inter_ocl->switch_td_param = 1;
+  inter_ocl->switch_td_calcu_gpu = 0;
 
   return 0;
 }
 
-static int release_inter_ocl_buffer(const int tile_count) {
+static int release_inter_ocl_buffer(INTER_OCL_OBJ *inter_ocl,
+                                    const int tile_count) {
   int i;
   int status = 0;
 
   for (i = 0; i < tile_count; ++i) {
-    if (inter_ocl_obj.ref_buffer[i]) {
-      FREE_INTER(inter_ocl_obj.ref_buffer[i]);
-      inter_ocl_obj.ref_buffer[i] = NULL;
+    if (inter_ocl->ref_buffer[i]) {
+      FREE_INTER(inter_ocl->ref_buffer[i]);
+      inter_ocl->ref_buffer[i] = NULL;
     }
-    if (inter_ocl_obj.pred_param_cpu_fri_td0[i] != NULL) {
-      FREE_INTER(inter_ocl_obj.pred_param_cpu_fri_td0[i]);
-      inter_ocl_obj.pred_param_cpu_fri_td0[i] = NULL;
-      inter_ocl_obj.pred_param_cpu_fri[i] = NULL;
-      inter_ocl_obj.pred_param_cpu_fri_pre[i] = NULL;
+    if (inter_ocl->pred_param_cpu_fri_td0[i] != NULL) {
+      FREE_INTER(inter_ocl->pred_param_cpu_fri_td0[i]);
+      inter_ocl->pred_param_cpu_fri_td0[i] = NULL;
+      inter_ocl->pred_param_cpu_fri[i] = NULL;
+      inter_ocl->pred_param_cpu_fri_pre[i] = NULL;
     }
-    if (inter_ocl_obj.pred_param_cpu_fri_td1[i] != NULL) {
-      FREE_INTER(inter_ocl_obj.pred_param_cpu_fri_td1[i]);
-      inter_ocl_obj.pred_param_cpu_fri_td1[i] = NULL;
+    if (inter_ocl->pred_param_cpu_fri_td1[i] != NULL) {
+      FREE_INTER(inter_ocl->pred_param_cpu_fri_td1[i]);
+      inter_ocl->pred_param_cpu_fri_td1[i] = NULL;
     }
-    if (inter_ocl_obj.pred_param_cpu_sec_td0[i] != NULL) {
-      FREE_INTER(inter_ocl_obj.pred_param_cpu_sec_td0[i]);
-      inter_ocl_obj.pred_param_cpu_sec_td0[i] = NULL;
-      inter_ocl_obj.pred_param_cpu_sec[i] = NULL;
-      inter_ocl_obj.pred_param_cpu_sec_pre[i] = NULL;
+    if (inter_ocl->pred_param_cpu_sec_td0[i] != NULL) {
+      FREE_INTER(inter_ocl->pred_param_cpu_sec_td0[i]);
+      inter_ocl->pred_param_cpu_sec_td0[i] = NULL;
+      inter_ocl->pred_param_cpu_sec[i] = NULL;
+      inter_ocl->pred_param_cpu_sec_pre[i] = NULL;
     }
-    if (inter_ocl_obj.pred_param_cpu_sec_td1[i] != NULL) {
-      FREE_INTER(inter_ocl_obj.pred_param_cpu_sec_td1[i]);
-      inter_ocl_obj.pred_param_cpu_sec_td1[i] = NULL;
+    if (inter_ocl->pred_param_cpu_sec_td1[i] != NULL) {
+      FREE_INTER(inter_ocl->pred_param_cpu_sec_td1[i]);
+      inter_ocl->pred_param_cpu_sec_td1[i] = NULL;
     }
 
 
 #if USE_INTER_PARAM_ZERO_COPY
     status = clEnqueueUnmapMemObject(
                  ocl_context.command_queue,
-                 inter_ocl_obj.pred_param_kernel_td0,
-                 inter_ocl_obj.pred_param_gpu_td0[i], 0, NULL, NULL);
+                 inter_ocl->pred_param_kernel_td0,
+                 inter_ocl->pred_param_gpu_td0[i], 0, NULL, NULL);
     if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueUnMapBuffer pred_param_gpu_td0 %d, error: %d \n",
            i, status);
@@ -592,8 +602,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
     status = clEnqueueUnmapMemObject(
                  ocl_context.command_queue,
-                 inter_ocl_obj.pred_param_kernel_td1,
-                 inter_ocl_obj.pred_param_gpu_td1[i], 0, NULL, NULL);
+                 inter_ocl->pred_param_kernel_td1,
+                 inter_ocl->pred_param_gpu_td1[i], 0, NULL, NULL);
     if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueUnMapBuffer pred_param_gpu_td1 %d, error: %d \n",
            i, status);
@@ -602,55 +612,55 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
     status = clEnqueueUnmapMemObject(
                  ocl_context.command_queue,
-                 inter_ocl_obj.index_param_kernel,
-                 inter_ocl_obj.index_param_gpu[i], 0, NULL, NULL);
+                 inter_ocl->index_param_kernel,
+                 inter_ocl->index_param_gpu[i], 0, NULL, NULL);
     if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueUnMapBuffer param_count_gpu %d, error: %d \n",
            i, status);
       return -1;
     }
 
-    inter_ocl_obj.pred_param_gpu_td0[i] = NULL;
-    inter_ocl_obj.pred_param_gpu_td1[i] = NULL;
-    inter_ocl_obj.pred_param_gpu_pre[i] = NULL;
+    inter_ocl->pred_param_gpu_td0[i] = NULL;
+    inter_ocl->pred_param_gpu_td1[i] = NULL;
+    inter_ocl->pred_param_gpu_pre[i] = NULL;
 #else
-    if (inter_ocl_obj.pred_param_gpu[i] != NULL) {
-      FREE_INTER(inter_ocl_obj.pred_param_gpu[i]);
-      inter_ocl_obj.pred_param_gpu[i] = NULL;
-      inter_ocl_obj.pred_param_gpu_pre[i] = NULL;
+    if (inter_ocl->pred_param_gpu[i] != NULL) {
+      FREE_INTER(inter_ocl->pred_param_gpu[i]);
+      inter_ocl->pred_param_gpu[i] = NULL;
+      inter_ocl->pred_param_gpu_pre[i] = NULL;
     }
 
-    if (inter_ocl_obj.index_param_gpu[i] != NULL)
-      FREE_INTER(inter_ocl_obj.index_param_gpu[i]);
+    if (inter_ocl->index_param_gpu[i] != NULL)
+      FREE_INTER(inter_ocl->index_param_gpu[i]);
 #endif // USE_INTER_PARAM_ZERO_COPY
 
-    inter_ocl_obj.index_param_gpu[i] = NULL;
-    inter_ocl_obj.index_param_gpu_pre[i] = NULL;
+    inter_ocl->index_param_gpu[i] = NULL;
+    inter_ocl->index_param_gpu_pre[i] = NULL;
   }
 
 #if 0//USE_INTER_PARAM_ZERO_COPY
     status = clEnqueueUnmapMemObject(
                  ocl_context.command_queue,
-                 inter_ocl_obj.gpu_block_count_kernel,
-                 inter_ocl_obj.gpu_block_count, 0, NULL, NULL);
+                 inter_ocl->gpu_block_count_kernel,
+                 inter_ocl->gpu_block_count, 0, NULL, NULL);
     if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueUnMapBuffer pred_param_gpu_td0 %d, error: %d \n",
            i, status);
       return -1;
     }
 
-    inter_ocl_obj.gpu_block_count = NULL;
+    inter_ocl->gpu_block_count = NULL;
 #else
-    if (inter_ocl_obj.gpu_block_count != NULL) {
-      FREE_INTER(inter_ocl_obj.gpu_block_count);
-      inter_ocl_obj.gpu_block_count = NULL;
+    if (inter_ocl->gpu_block_count != NULL) {
+      FREE_INTER(inter_ocl->gpu_block_count);
+      inter_ocl->gpu_block_count = NULL;
     }
 #endif // USE_INTER_PARAM_ZERO_COPY
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.one_case_interval_count_kernel,
-               inter_ocl_obj.one_case_interval_count_gpu, 0, NULL, NULL);
+               inter_ocl->one_case_interval_count_kernel,
+               inter_ocl->one_case_interval_count_gpu, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer param_count_gpu, error: %d \n",
          status);
@@ -659,8 +669,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.case_count_kernel_td0,
-               inter_ocl_obj.case_count_gpu_td0, 0, NULL, NULL);
+               inter_ocl->case_count_kernel_td0,
+               inter_ocl->case_count_gpu_td0, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer all_b_count_gpu, error: %d \n",
          status);
@@ -669,8 +679,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.case_count_kernel_td1,
-               inter_ocl_obj.case_count_gpu_td1, 0, NULL, NULL);
+               inter_ocl->case_count_kernel_td1,
+               inter_ocl->case_count_gpu_td1, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer all_b_count_gpu, error: %d \n",
          status);
@@ -679,8 +689,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.all_b_count_kernel,
-               inter_ocl_obj.all_b_count_gpu, 0, NULL, NULL);
+               inter_ocl->all_b_count_kernel,
+               inter_ocl->all_b_count_gpu, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer all_b_count_gpu, error: %d \n",
          status);
@@ -689,8 +699,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.new_fb_idx_kernel,
-               inter_ocl_obj.new_fb_idx_gpu, 0, NULL, NULL);
+               inter_ocl->new_fb_idx_kernel,
+               inter_ocl->new_fb_idx_gpu, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer new_fb_idx_gpu, error: %d \n",
          status);
@@ -699,8 +709,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.buffer_size_kernel,
-               inter_ocl_obj.buffer_size_gpu, 0, NULL, NULL);
+               inter_ocl->buffer_size_kernel,
+               inter_ocl->buffer_size_gpu, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer buffer_size_gpu, error: %d \n",
          status);
@@ -709,8 +719,8 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.index_case_mode_offset_kernel,
-               inter_ocl_obj.index_case_mode_offset_gpu, 0, NULL, NULL);
+               inter_ocl->index_case_mode_offset_kernel,
+               inter_ocl->index_case_mode_offset_gpu, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer index_case_mode_offset_gpu, error: %d \n",
          status);
@@ -719,252 +729,238 @@ static int release_inter_ocl_buffer(const int tile_count) {
 
   status = clEnqueueUnmapMemObject(
                ocl_context.command_queue,
-               inter_ocl_obj.index_case_mode_offset_kernel,
-               inter_ocl_obj.tile_param_count_gpu_offset_gpu, 0, NULL, NULL);
+               inter_ocl->index_case_mode_offset_kernel,
+               inter_ocl->tile_param_count_gpu_offset_gpu, 0, NULL, NULL);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clEnqueueUnMapBuffer tile_param_count_gpu_offset_gpu, error: %d \n",
          status);
     return -1;
   }
 
-  inter_ocl_obj.case_count_gpu = NULL;
-  inter_ocl_obj.case_count_gpu_td0 = NULL;
-  inter_ocl_obj.case_count_gpu_td1 = NULL;
-
-  inter_ocl_obj.new_fb_idx_gpu = NULL;
-  inter_ocl_obj.all_b_count_gpu = NULL;
-  inter_ocl_obj.buffer_size_gpu = NULL;
-  inter_ocl_obj.index_case_mode_offset_gpu = NULL;
-  inter_ocl_obj.one_case_interval_count_gpu= NULL;
-  inter_ocl_obj.tile_param_count_gpu_offset_gpu = NULL;
-
-  if (inter_ocl_obj.pred_param_kernel_td0)
-    status |= clReleaseMemObject(inter_ocl_obj.pred_param_kernel_td0);
-  if (inter_ocl_obj.pred_param_kernel_td1)
-    status |= clReleaseMemObject(inter_ocl_obj.pred_param_kernel_td1);
-  if (inter_ocl_obj.index_param_num_kernel_td0)
-    status |= clReleaseMemObject(inter_ocl_obj.index_param_num_kernel_td0);
-  if (inter_ocl_obj.index_param_num_kernel_td1)
-    status |= clReleaseMemObject(inter_ocl_obj.index_param_num_kernel_td1);
-  if (inter_ocl_obj.index_xmv_kernel_td0)
-    status |= clReleaseMemObject(inter_ocl_obj.index_xmv_kernel_td0);
-  if (inter_ocl_obj.index_xmv_kernel_td1)
-    status |= clReleaseMemObject(inter_ocl_obj.index_xmv_kernel_td1);
-  if (inter_ocl_obj.dst_index_xmv_kernel_td0)
-    status |= clReleaseMemObject(inter_ocl_obj.dst_index_xmv_kernel_td0);
-  if (inter_ocl_obj.dst_index_xmv_kernel_td1)
-    status |= clReleaseMemObject(inter_ocl_obj.dst_index_xmv_kernel_td1);
-
-  if (inter_ocl_obj.case_count_kernel_td0)
-    status |= clReleaseMemObject(inter_ocl_obj.case_count_kernel_td0);
-  if (inter_ocl_obj.case_count_kernel_td1)
-    status |= clReleaseMemObject(inter_ocl_obj.case_count_kernel_td1);
-  if (inter_ocl_obj.one_case_interval_count_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.one_case_interval_count_kernel);
-
-  if (inter_ocl_obj.all_b_count_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.all_b_count_kernel);
-  if (inter_ocl_obj.tile_count_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.tile_count_kernel);
-  if (inter_ocl_obj.new_fb_idx_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.new_fb_idx_kernel);
-  if (inter_ocl_obj.buffer_size_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.buffer_size_kernel);
-  if (inter_ocl_obj.index_param_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.index_param_kernel);
-  if (inter_ocl_obj.gpu_block_count_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.gpu_block_count_kernel);
-  if (inter_ocl_obj.index_case_mode_offset_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.index_case_mode_offset_kernel);
-  if (inter_ocl_obj.tile_param_count_gpu_offset_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.tile_param_count_gpu_offset_kernel);
+  inter_ocl->case_count_gpu = NULL;
+  inter_ocl->case_count_gpu_td0 = NULL;
+  inter_ocl->case_count_gpu_td1 = NULL;
+
+  inter_ocl->new_fb_idx_gpu = NULL;
+  inter_ocl->all_b_count_gpu = NULL;
+  inter_ocl->buffer_size_gpu = NULL;
+  inter_ocl->index_case_mode_offset_gpu = NULL;
+  inter_ocl->one_case_interval_count_gpu= NULL;
+  inter_ocl->tile_param_count_gpu_offset_gpu = NULL;
+
+  if (inter_ocl->pred_param_kernel_td0)
+    status |= clReleaseMemObject(inter_ocl->pred_param_kernel_td0);
+  if (inter_ocl->pred_param_kernel_td1)
+    status |= clReleaseMemObject(inter_ocl->pred_param_kernel_td1);
+  if (inter_ocl->index_param_num_kernel_td0)
+    status |= clReleaseMemObject(inter_ocl->index_param_num_kernel_td0);
+  if (inter_ocl->index_param_num_kernel_td1)
+    status |= clReleaseMemObject(inter_ocl->index_param_num_kernel_td1);
+  if (inter_ocl->index_xmv_kernel_td0)
+    status |= clReleaseMemObject(inter_ocl->index_xmv_kernel_td0);
+  if (inter_ocl->index_xmv_kernel_td1)
+    status |= clReleaseMemObject(inter_ocl->index_xmv_kernel_td1);
+  if (inter_ocl->dst_index_xmv_kernel_td0)
+    status |= clReleaseMemObject(inter_ocl->dst_index_xmv_kernel_td0);
+  if (inter_ocl->dst_index_xmv_kernel_td1)
+    status |= clReleaseMemObject(inter_ocl->dst_index_xmv_kernel_td1);
+
+  if (inter_ocl->case_count_kernel_td0)
+    status |= clReleaseMemObject(inter_ocl->case_count_kernel_td0);
+  if (inter_ocl->case_count_kernel_td1)
+    status |= clReleaseMemObject(inter_ocl->case_count_kernel_td1);
+  if (inter_ocl->one_case_interval_count_kernel)
+    status |= clReleaseMemObject(inter_ocl->one_case_interval_count_kernel);
+
+  if (inter_ocl->all_b_count_kernel)
+    status |= clReleaseMemObject(inter_ocl->all_b_count_kernel);
+  if (inter_ocl->tile_count_kernel)
+    status |= clReleaseMemObject(inter_ocl->tile_count_kernel);
+  if (inter_ocl->new_fb_idx_kernel)
+    status |= clReleaseMemObject(inter_ocl->new_fb_idx_kernel);
+  if (inter_ocl->buffer_size_kernel)
+    status |= clReleaseMemObject(inter_ocl->buffer_size_kernel);
+  if (inter_ocl->index_param_kernel)
+    status |= clReleaseMemObject(inter_ocl->index_param_kernel);
+  if (inter_ocl->gpu_block_count_kernel)
+    status |= clReleaseMemObject(inter_ocl->gpu_block_count_kernel);
+  if (inter_ocl->index_case_mode_offset_kernel)
+    status |= clReleaseMemObject(inter_ocl->index_case_mode_offset_kernel);
+  if (inter_ocl->tile_param_count_gpu_offset_kernel)
+    status |= clReleaseMemObject(inter_ocl->tile_param_count_gpu_offset_kernel);
 
   return 0;
 }
 
-int vp9_init_ocl() {
+// Takes a reference on the OpenCL context shared by all decoder instances,
+// creating it for the first one.
+static int acquire_ocl_context(Interop_Context *interop_context) {
   int status = 0;
-  const char *psource = NULL;
-  inter_ocl_obj.buffer_pool_flag = 0;
-  inter_ocl_obj.inter_ocl_init = 1;
-
-  status = ocl_wrapper_init();
-  if (status < 0) {
-    LOGE("Failed to init ocl wrapper, error: %d\n", status);
-    exit(1);
-  }
-
-  status = ocl_context_init(&ocl_context, 1);
-  if (status < 0) {
-    LOGE("Failed to init ocl context, error: %d\n", status);
-    exit(1);
-  }
-  status = load_source_from_file(
-               "vp9_inter_pred_4x4.cl",
-               &inter_ocl_obj.source,
-               &inter_ocl_obj.source_len);
-  if (status < 0) {
-    LOGE("Failed to load kernel, error: %d\n", status);
-    exit(1);
-  }
-
-  psource = inter_ocl_obj.source;
-  inter_ocl_obj.program = create_and_build_program(
-                              &ocl_context, 1,
-                              (const char **)&psource,
-                              &inter_ocl_obj.source_len, &status);
-  if (status < 0) {
-    LOGE("There is some error in create&build program, error: %d\n", status);
-    exit(1);
-  }
 
-  inter_ocl_obj.kernel = clCreateKernel(
-                                inter_ocl_obj.program,
-                                "inter_pred_calcu", &status);
-  if (status != CL_SUCCESS) {
-    LOGE("Failed to clCreateKernel inter_pred_calcu, error: %d\n", status);
-    exit(1);
-  }
-  // This for inter index
-  inter_ocl_obj.kernel_index = clCreateKernel(
-                                inter_ocl_obj.program,
-                                "inter_pred_index", &status);
-  if (status != CL_SUCCESS) {
-    LOGE("Failed to clCreateKernel inter_pred_index, error: %d\n", status);
-    exit(1);
-  }
-
-  inter_ocl_obj.update_buffer_pool_kernel = clCreateKernel(
-                                                inter_ocl_obj.program,
-                                                "update_buffer_pool", &status);
-  if (status != CL_SUCCESS) {
-    LOGE("Failed to clCreateKernel update_buffer_pool, error: %d\n", status);
-    exit(1);
-  }
+  once(ocl_context_lock_init);
+  pthread_mutex_lock(&ocl_context_lock);
+  if (ocl_context_users == 0) {
+    status = ocl_wrapper_init();
+    if (status < 0) {
+      LOGE("Failed to init ocl wrapper, error: %d\n", status);
+    } else {
+      if (interop_context != NULL)
+        status = ocl_context_init_for_d3d9_interOp(&ocl_context,
+                                                   interop_context, 1);
+      else
+        status = ocl_context_init(&ocl_context, 1);
+      if (status < 0) {
+        LOGE("Failed to init ocl context, error: %d\n", status);
+        ocl_wrapper_finalize();
+      }
+    }
+  } else if (interop_context != NULL) {
+    // The interop context is bound to the caller's D3D9 device, so it cannot
+    // be swapped in under the instances already using the shared one.
+    LOGE("Failed to init ocl context, already in use by %d decoders\n",
+         ocl_context_users);
+    status = -1;
+  }
+  if (status >= 0)
+    ++ocl_context_users;
+  pthread_mutex_unlock(&ocl_context_lock);
+
+  return status < 0 ? -1 : 0;
+}
 
-  status = create_inter_ocl_buffer(STABLE_BUFFER_SIZE_OCL, MAX_TILE_COUNT_OCL);
-  if (status < 0) {
-    LOGE("Failed to create inter opencl buffer \n");
-    exit(1);
+static void release_ocl_context() {
+  pthread_mutex_lock(&ocl_context_lock);
+  assert(ocl_context_users > 0);
+  if (--ocl_context_users == 0) {
+    ocl_context_fini(&ocl_context);
+    ocl_wrapper_finalize();
   }
-
-  return 0;
+  pthread_mutex_unlock(&ocl_context_lock);
 }
 
-int vp9_init_ocl_ex(void *id3d9_devices) {
- Interop_Context *P_context;
+static int init_ocl(INTER_OCL_OBJ *inter_ocl,
+                    Interop_Context *interop_context) {
   int status = 0;
   const char *psource = NULL;
-  inter_ocl_obj.buffer_pool_flag = 0;
-  inter_ocl_obj.inter_ocl_init = 1;
+  inter_ocl->buffer_pool_flag = 0;
+  inter_ocl->inter_ocl_init = 1;
 
-  P_context = (Interop_Context*)id3d9_devices;
-  status = ocl_wrapper_init();
-  if (status < 0) {
-    LOGE("Failed to init ocl wrapper, error: %d\n", status);
-    exit(1);
-  }
+  status = acquire_ocl_context(interop_context);
+  if (status < 0)
+    return -1;
 
-  status = ocl_context_init_for_d3d9_interOp(&ocl_context,P_context, 1);
-  if (status < 0) {
-    LOGE("Failed to init ocl context, error: %d\n", status);
-    exit(1);
-  }
   status = load_source_from_file(
                "vp9_inter_pred_4x4.cl",
-               &inter_ocl_obj.source,
-               &inter_ocl_obj.source_len);
+               &inter_ocl->source,
+               &inter_ocl->source_len);
   if (status < 0) {
     LOGE("Failed to load kernel, error: %d\n", status);
-    exit(1);
+    goto fail;
   }
 
-  psource = inter_ocl_obj.source;
-  inter_ocl_obj.program = create_and_build_program(
+  psource = inter_ocl->source;
+  inter_ocl->program = create_and_build_program(
                               &ocl_context, 1,
                               (const char **)&psource,
-                              &inter_ocl_obj.source_len, &status);
+                              &inter_ocl->source_len, &status);
   if (status < 0) {
     LOGE("There is some error in create&build program, error: %d\n", status);
-    exit(1);
+    goto fail;
   }
 
-  inter_ocl_obj.kernel = clCreateKernel(
-                                inter_ocl_obj.program,
+  // Kernels are created per instance as clSetKernelArg() is not thread safe.
+  inter_ocl->kernel = clCreateKernel(
+                                inter_ocl->program,
                                 "inter_pred_calcu", &status);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clCreateKernel inter_pred_calcu, error: %d\n", status);
-    exit(1);
+    goto fail;
   }
   // This for inter index
-  inter_ocl_obj.kernel_index = clCreateKernel(
-                                inter_ocl_obj.program,
+  inter_ocl->kernel_index = clCreateKernel(
+                                inter_ocl->program,
                                 "inter_pred_index", &status);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clCreateKernel inter_pred_index, error: %d\n", status);
-    exit(1);
+    goto fail;
   }
 
-   inter_ocl_obj.update_buffer_pool_kernel = clCreateKernel(
-                                                inter_ocl_obj.program,
+  inter_ocl->update_buffer_pool_kernel = clCreateKernel(
+                                                inter_ocl->program,
                                                 "update_buffer_pool", &status);
   if (status != CL_SUCCESS) {
     LOGE("Failed to clCreateKernel update_buffer_pool, error: %d\n", status);
-    exit(1);
+    goto fail;
   }
 
-  status = create_inter_ocl_buffer(STABLE_BUFFER_SIZE_OCL, MAX_TILE_COUNT_OCL);
+  status = create_inter_ocl_buffer(inter_ocl, STABLE_BUFFER_SIZE_OCL,
+                                   MAX_TILE_COUNT_OCL);
   if (status < 0) {
     LOGE("Failed to create inter opencl buffer \n");
-    exit(1);
+    goto fail;
   }
+
   return 0;
+
+fail:
+  vp9_release_ocl(inter_ocl);
+  return -1;
+}
+
+int vp9_init_ocl(INTER_OCL_OBJ *inter_ocl) {
+  return init_ocl(inter_ocl, NULL);
+}
+
+int vp9_init_ocl_ex(INTER_OCL_OBJ *inter_ocl, void *id3d9_devices) {
+  return init_ocl(inter_ocl, (Interop_Context *)id3d9_devices);
 }
 
 int vp9_init_inter_ocl(VP9_COMMON *const cm, int tile_count) {
+  INTER_OCL_OBJ *const inter_ocl = cm->inter_ocl;
   int status = 0;
   const YV12_BUFFER_CONFIG *cfg_source = &cm->yv12_fb[cm->new_fb_idx];
   int param_count_gpu = ((cfg_source->buffer_alloc_sz >> 4) / tile_count) << 1;
 
-  inter_ocl_obj.tile_count = tile_count;
-  inter_ocl_obj.globalThreads[0] = param_count_gpu * tile_count;
-  inter_ocl_obj.globalThreads[1] = 1;
-  inter_ocl_obj.globalThreads[2] = 1;
-  inter_ocl_obj.localThreads[0] = 64;
-  inter_ocl_obj.localThreads[1] = 1;
-  inter_ocl_obj.localThreads[2] = 1;
+  inter_ocl->tile_count = tile_count;
+  inter_ocl->globalThreads[0] = param_count_gpu * tile_count;
+  inter_ocl->globalThreads[1] = 1;
+  inter_ocl->globalThreads[2] = 1;
+  inter_ocl->localThreads[0] = 64;
+  inter_ocl->localThreads[1] = 1;
+  inter_ocl->localThreads[2] = 1;
 
   if (cfg_source->buffer_alloc_sz != STABLE_BUFFER_SIZE_OCL
       || tile_count != MAX_TILE_COUNT_OCL) {
-    status = release_inter_ocl_buffer(MAX_TILE_COUNT_OCL);
+    status = release_inter_ocl_buffer(inter_ocl, MAX_TILE_COUNT_OCL);
     if (status < 0) {
       LOGE("Failed to release inter opencl buffer \n");
       return -1;
     }
 
-    status = create_inter_ocl_buffer(cfg_source->buffer_alloc_sz, tile_count);
+    status = create_inter_ocl_buffer(inter_ocl, cfg_source->buffer_alloc_sz,
+                                     tile_count);
     if (status < 0) {
       LOGE("Failed to create inter opencl buffer \n");
       return -1;
     }
 
-    inter_ocl_obj.release_max = 0;
+    inter_ocl->release_max = 0;
   } else {
-    inter_ocl_obj.release_max = 1;
+    inter_ocl->release_max = 1;
   }
 
   status = clSetKernelArg(
-             inter_ocl_obj.update_buffer_pool_kernel,
+             inter_ocl->update_buffer_pool_kernel,
              0, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.buffer_pool_kernel);
+             (void*) &inter_ocl->buffer_pool_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set arguments 0, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.update_buffer_pool_kernel,
+             inter_ocl->update_buffer_pool_kernel,
              1, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.buffer_pool_read_only_kernel);
+             (void*) &inter_ocl->buffer_pool_read_only_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set arguments 1, error: %d\n", status);
     return -1;
@@ -972,25 +968,25 @@ int vp9_init_inter_ocl(VP9_COMMON *const cm, int tile_count) {
 
   // Args' setting for kernel
   status = clSetKernelArg(
-             inter_ocl_obj.kernel,
+             inter_ocl->kernel,
              0, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.buffer_pool_kernel);
+             (void*) &inter_ocl->buffer_pool_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set arguments 0, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-               inter_ocl_obj.kernel,
+               inter_ocl->kernel,
                6, sizeof(cl_mem),
-               (void*) &inter_ocl_obj.one_case_interval_count_kernel);
+               (void*) &inter_ocl->one_case_interval_count_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set arguments 6, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel,
+             inter_ocl->kernel,
              8, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.buffer_pool_read_only_kernel);
+             (void*) &inter_ocl->buffer_pool_read_only_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set arguments 8, error: %d\n", status);
     return -1;
@@ -998,152 +994,151 @@ int vp9_init_inter_ocl(VP9_COMMON *const cm, int tile_count) {
 
   // Args' setting for kernel_index
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              0, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.index_param_kernel);
+             (void*) &inter_ocl->index_param_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 0, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              1, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.new_fb_idx_kernel);
+             (void*) &inter_ocl->new_fb_idx_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 1, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              2, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.buffer_size_kernel);
+             (void*) &inter_ocl->buffer_size_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 2, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              3, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.gpu_block_count_kernel);
+             (void*) &inter_ocl->gpu_block_count_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 3, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              4, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.index_case_mode_offset_kernel);
+             (void*) &inter_ocl->index_case_mode_offset_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 4, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              5, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.tile_param_count_gpu_offset_kernel);
+             (void*) &inter_ocl->tile_param_count_gpu_offset_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 5, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              6, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.all_b_count_kernel);
+             (void*) &inter_ocl->all_b_count_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 6, error: %d\n", status);
     return -1;
   }
   status = clSetKernelArg(
-             inter_ocl_obj.kernel_index,
+             inter_ocl->kernel_index,
              7, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.tile_count_kernel);
+             (void*) &inter_ocl->tile_count_kernel);
   if (status != CL_SUCCESS) {
     LOGE("Failed to set kernel_index arguments 7, error: %d\n", status);
     return -1;
   }
 
-  inter_ocl_obj.previous_f = cm->new_fb_idx;
-  inter_ocl_obj.before_previous_f = cm->new_fb_idx;
+  inter_ocl->previous_f = cm->new_fb_idx;
+  inter_ocl->before_previous_f = cm->new_fb_idx;
 
-  inter_ocl_obj.previous_f_show = 1;
+  inter_ocl->previous_f_show = 1;
 
-  inter_convolve_init_ocl();
+  inter_convolve_init_ocl(inter_ocl);
 
   return 0;
 }
 
-int vp9_release_ocl() {
+int vp9_release_ocl(INTER_OCL_OBJ *inter_ocl) {
   int status = 0;
 
-  if (inter_ocl_obj.release_max) {
-    status = release_inter_ocl_buffer(MAX_TILE_COUNT_OCL);
+  if (inter_ocl->release_max) {
+    status = release_inter_ocl_buffer(inter_ocl, MAX_TILE_COUNT_OCL);
   } else {
-    status = release_inter_ocl_buffer(inter_ocl_obj.tile_count);
+    status = release_inter_ocl_buffer(inter_ocl, inter_ocl->tile_count);
   }
 
-  if (inter_ocl_obj.buffer_pool_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.buffer_pool_kernel);
-  if (inter_ocl_obj.buffer_pool_read_only_kernel)
-    status |= clReleaseMemObject(inter_ocl_obj.buffer_pool_read_only_kernel);
+  if (inter_ocl->buffer_pool_kernel)
+    status |= clReleaseMemObject(inter_ocl->buffer_pool_kernel);
+  if (inter_ocl->buffer_pool_read_only_kernel)
+    status |= clReleaseMemObject(inter_ocl->buffer_pool_read_only_kernel);
 
-  if (inter_ocl_obj.kernel)
-    status |= clReleaseKernel(inter_ocl_obj.kernel);
-  if (inter_ocl_obj.program)
-    status |= clReleaseProgram(inter_ocl_obj.program);
-  if (inter_ocl_obj.source != NULL) {
-    free(inter_ocl_obj.source);
-    inter_ocl_obj.source = NULL;
+  if (inter_ocl->kernel)
+    status |= clReleaseKernel(inter_ocl->kernel);
+  if (inter_ocl->program)
+    status |= clReleaseProgram(inter_ocl->program);
+  if (inter_ocl->source != NULL) {
+    free(inter_ocl->source);
+    inter_ocl->source = NULL;
   }
 
   // This for inter index
-  if (inter_ocl_obj.kernel_index)
-    status |= clReleaseKernel(inter_ocl_obj.kernel_index);
+  if (inter_ocl->kernel_index)
+    status |= clReleaseKernel(inter_ocl->kernel_index);
 
-  if (inter_ocl_obj.update_buffer_pool_kernel)
-    status |= clReleaseKernel(inter_ocl_obj.update_buffer_pool_kernel);
+  if (inter_ocl->update_buffer_pool_kernel)
+    status |= clReleaseKernel(inter_ocl->update_buffer_pool_kernel);
 
-  ocl_context_fini(&ocl_context);
-  ocl_wrapper_finalize();
+  release_ocl_context();
 
   if (status != CL_SUCCESS) {
     LOGE("Failed to Release ocl! \n");
-    exit(1);
+    return -1;
   }
 
   return 0;
 }
 
-int reset_inter_ocl_param_buffer(int tile_num) {
- inter_ocl_obj.gpu_block_count[tile_num] = 0;
- inter_ocl_obj.index_count_pre[tile_num] = 0;
- inter_ocl_obj.cpu_fri_count_pre[tile_num] = 0;
- inter_ocl_obj.cpu_sec_count_pre[tile_num] = 0;
+int reset_inter_ocl_param_buffer(INTER_OCL_OBJ *inter_ocl, int tile_num) {
+ inter_ocl->gpu_block_count[tile_num] = 0;
+ inter_ocl->index_count_pre[tile_num] = 0;
+ inter_ocl->cpu_fri_count_pre[tile_num] = 0;
+ inter_ocl->cpu_sec_count_pre[tile_num] = 0;
 
 #if !USE_INTER_PARAM_ZERO_COPY
-  inter_ocl_obj.pred_param_gpu_pre[tile_num] =
-      inter_ocl_obj.pred_param_gpu[tile_num];
+  inter_ocl->pred_param_gpu_pre[tile_num] =
+      inter_ocl->pred_param_gpu[tile_num];
 #endif
-  inter_ocl_obj.pref[tile_num] =
-      inter_ocl_obj.ref_buffer[tile_num];
-  inter_ocl_obj.index_param_gpu_pre[tile_num] =
-      inter_ocl_obj.index_param_gpu[tile_num];
+  inter_ocl->pref[tile_num] =
+      inter_ocl->ref_buffer[tile_num];
+  inter_ocl->index_param_gpu_pre[tile_num] =
+      inter_ocl->index_param_gpu[tile_num];
 
   return 0;
 }
 
-int vp9_inter_write_param_to_gpu(int tile_num) {
+int vp9_inter_write_param_to_gpu(INTER_OCL_OBJ *inter_ocl, int tile_num) {
   int status;
 
 #if !USE_INTER_PARAM_ZERO_COPY
-  if (inter_ocl_obj.gpu_block_count[tile_num] > 0) {
+  if (inter_ocl->gpu_block_count[tile_num] > 0) {
     status = clEnqueueWriteBuffer(
                  ocl_context.command_queue,
-                 *inter_ocl_obj.pred_param_kernel_pre,
+                 *inter_ocl->pred_param_kernel_pre,
                  CL_FALSE,
-                 inter_ocl_obj.pred_param_size * tile_num,
-                 inter_ocl_obj.gpu_block_count[tile_num] *
+                 inter_ocl->pred_param_size * tile_num,
+                 inter_ocl->gpu_block_count[tile_num] *
                  sizeof(INTER_PRED_PARAM_GPU),
-                 inter_ocl_obj.pred_param_gpu[tile_num],
+                 inter_ocl->pred_param_gpu[tile_num],
                  0, NULL, NULL);
     if (status != CL_SUCCESS) {
         LOGE("Failed to clEnqueueWriteBuffer(pred_param) %d, error: %d \n",
@@ -1154,12 +1149,12 @@ int vp9_inter_write_param_to_gpu(int tile_num) {
     // This for inter index
     status = clEnqueueWriteBuffer(
                  ocl_context.command_queue,
-                 inter_ocl_obj.index_param_kernel,
+                 inter_ocl->index_param_kernel,
                  CL_FALSE,
-                 inter_ocl_obj.index_param_size * tile_num,
-                 inter_ocl_obj.gpu_block_count[tile_num] *
+                 inter_ocl->index_param_size * tile_num,
+                 inter_ocl->gpu_block_count[tile_num] *
                  sizeof(INTER_INDEX_PARAM_GPU),
-                 inter_ocl_obj.index_param_gpu[tile_num],
+                 inter_ocl->index_param_gpu[tile_num],
                  0, NULL, NULL);
     if (status != CL_SUCCESS) {
         LOGE("Failed to clEnqueueWriteBuffer(index_param) %d, error: %d \n",
@@ -1171,9 +1166,9 @@ int vp9_inter_write_param_to_gpu(int tile_num) {
 
   status = clEnqueueWriteBuffer(
                ocl_context.command_queue,
-               inter_ocl_obj.gpu_block_count_kernel,
+               inter_ocl->gpu_block_count_kernel,
                CL_FALSE, sizeof(int) * tile_num, sizeof(int),
-               &inter_ocl_obj.gpu_block_count[tile_num],
+               &inter_ocl->gpu_block_count[tile_num],
                0, NULL, NULL);
   if (status != CL_SUCCESS) {
       LOGE("Failed to clEnqueueWriteBuffer(gpu_block_count) %d, error: %d \n",
@@ -1191,20 +1186,21 @@ int vp9_inter_write_param_to_gpu(int tile_num) {
 }
 
 int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
+  INTER_OCL_OBJ *const inter_ocl = cm->inter_ocl;
   int status;
   int buffer_pool_offset;
   const YV12_BUFFER_CONFIG *cfg_source;
 
   if (cm->frame_type != KEY_FRAME && cm->show_frame) {
-    if (!inter_ocl_obj.previous_f_show) {
-      cfg_source = &cm->yv12_fb[inter_ocl_obj.before_previous_f];
+    if (!inter_ocl->previous_f_show) {
+      cfg_source = &cm->yv12_fb[inter_ocl->before_previous_f];
       buffer_pool_offset =
-          cfg_source->buffer_alloc - inter_ocl_obj.buffer_pool_map_ptr;
+          cfg_source->buffer_alloc - inter_ocl->buffer_pool_map_ptr;
 #if USE_KERNEL_UPDATE_BUFFER_POOL
       const size_t global_threads = cfg_source->buffer_alloc_sz >> 2;
 
       status = clSetKernelArg(
-                 inter_ocl_obj.update_buffer_pool_kernel,
+                 inter_ocl->update_buffer_pool_kernel,
                  2, sizeof(int),
                  (void*) &buffer_pool_offset);
       if (status != CL_SUCCESS) {
@@ -1213,7 +1209,7 @@ int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
       }
 
       status = clEnqueueNDRangeKernel(ocl_context.command_queue,
-                                      inter_ocl_obj.update_buffer_pool_kernel,
+                                      inter_ocl->update_buffer_pool_kernel,
                                       1, 0, &global_threads,
                                       NULL, 0, NULL, NULL);
       if (status != CL_SUCCESS) {
@@ -1224,8 +1220,8 @@ int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
 #else
       status = clEnqueueCopyBuffer(
                    ocl_context.command_queue,
-                   inter_ocl_obj.buffer_pool_kernel,
-                   inter_ocl_obj.buffer_pool_read_only_kernel,
+                   inter_ocl->buffer_pool_kernel,
+                   inter_ocl->buffer_pool_read_only_kernel,
                    buffer_pool_offset, buffer_pool_offset,
                    cfg_source->buffer_alloc_sz,
                    0, NULL, NULL);
@@ -1237,14 +1233,14 @@ int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
 #endif // USE_KERNEL_UPDATE_BUFFER_POOL
     }
 
-    cfg_source = &cm->yv12_fb[inter_ocl_obj.previous_f];
+    cfg_source = &cm->yv12_fb[inter_ocl->previous_f];
     buffer_pool_offset =
-        cfg_source->buffer_alloc - inter_ocl_obj.buffer_pool_map_ptr;
+        cfg_source->buffer_alloc - inter_ocl->buffer_pool_map_ptr;
 #if USE_KERNEL_UPDATE_BUFFER_POOL
     const size_t global_threads = cfg_source->buffer_alloc_sz >> 2;
 
     status = clSetKernelArg(
-               inter_ocl_obj.update_buffer_pool_kernel,
+               inter_ocl->update_buffer_pool_kernel,
                2, sizeof(int),
                (void*) &buffer_pool_offset);
     if (status != CL_SUCCESS) {
@@ -1253,7 +1249,7 @@ int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
     }
 
     status = clEnqueueNDRangeKernel(ocl_context.command_queue,
-                                    inter_ocl_obj.update_buffer_pool_kernel,
+                                    inter_ocl->update_buffer_pool_kernel,
                                     1, 0, &global_threads,
                                     NULL, 0, NULL, NULL);
     if (status != CL_SUCCESS) {
@@ -1264,8 +1260,8 @@ int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
 #else
     status = clEnqueueCopyBuffer(
                  ocl_context.command_queue,
-                 inter_ocl_obj.buffer_pool_kernel,
-                 inter_ocl_obj.buffer_pool_read_only_kernel,
+                 inter_ocl->buffer_pool_kernel,
+                 inter_ocl->buffer_pool_read_only_kernel,
                  buffer_pool_offset, buffer_pool_offset,
                  cfg_source->buffer_alloc_sz,
                  0, NULL, NULL);
@@ -1284,9 +1280,9 @@ int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm) {
   }
 
 
-  inter_ocl_obj.before_previous_f = inter_ocl_obj.previous_f;
-  inter_ocl_obj.previous_f_show = cm->show_frame;
-  inter_ocl_obj.previous_f = cm->new_fb_idx;
+  inter_ocl->before_previous_f = inter_ocl->previous_f;
+  inter_ocl->previous_f_show = cm->show_frame;
+  inter_ocl->previous_f = cm->new_fb_idx;
 
   return 0;
 }
@@ -22,17 +22,26 @@
 
 #define DO_PROFILING 0
 
-int vp9_init_ocl();
+struct inter_ocl_obj;
 
-int vp9_init_ocl_ex(void *id3d9_devices);
+// Sets up the kernels and buffers of one decoder instance. All instances
+// share one OpenCL context and command queue, which is created by the first
+// caller and torn down by the last vp9_release_ocl(). Returns < 0 on failure.
+int vp9_init_ocl(struct inter_ocl_obj *inter_ocl);
 
-int vp9_release_ocl();
+// As vp9_init_ocl(), but creates the shared context for D3D9 interop. Fails
+// if a context without interop is already in use by another instance.
+int vp9_init_ocl_ex(struct inter_ocl_obj *inter_ocl, void *id3d9_devices);
+
+int vp9_release_ocl(struct inter_ocl_obj *inter_ocl);
 
 int vp9_init_inter_ocl(VP9_COMMON *const cm, int tile_count);
 
-int reset_inter_ocl_param_buffer(int tile_num);
+int reset_inter_ocl_param_buffer(struct inter_ocl_obj *inter_ocl,
+                                 int tile_num);
 
-int vp9_inter_write_param_to_gpu(int tile_num);
+int vp9_inter_write_param_to_gpu(struct inter_ocl_obj *inter_ocl,
+                                 int tile_num);
 
 int vp9_update_gpu_buffer_pool(VP9_COMMON *const cm);
 
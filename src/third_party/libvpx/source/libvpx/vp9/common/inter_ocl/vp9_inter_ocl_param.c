@@ -21,9 +21,7 @@
 #include "vp9/common/vp9_scale.h"
 #include "vp9/common/inter_ocl/vp9_inter_ocl_param.h"
 
-int CpuFlag;
 OCL_CONTEXT ocl_context = {0};
-INTER_OCL_OBJ inter_ocl_obj = {0};
 
 static const int16_t *inter_filter[4] = {vp9_sub_pel_filters_8[0],
                                          vp9_sub_pel_filters_8lp[0],
@@ -146,6 +144,7 @@ void build_inter_pred_param_sec_ref_ocl(const int plane,
                                         const int src_num,
                                         const int filter_num,
                                         const int tile_num) {
+  INTER_OCL_OBJ *const inter_ocl = cm->inter_ocl;
   int xs, ys, w, h;
   int subpel_x, subpel_y;
 
@@ -267,50 +266,50 @@ void build_inter_pred_param_sec_ref_ocl(const int plane,
 
       reset_src_buffer = 1;
 
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->pref =
-          inter_ocl_obj.pref[tile_num];
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->buf_ptr1 = buf_ptr1;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->pre_stride = pre_buf->stride;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->x0 = x0;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->x1 = x1;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->y0 = y0;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->y1 = y1;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->frame_width = frame_width;
-      inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->frame_height = frame_height;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->pref =
+          inter_ocl->pref[tile_num];
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->buf_ptr1 = buf_ptr1;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->pre_stride = pre_buf->stride;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->x0 = x0;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->x1 = x1;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->y0 = y0;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->y1 = y1;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->frame_width = frame_width;
+      inter_ocl->pred_param_cpu_sec_pre[tile_num]->frame_height = frame_height;
 
       buf_stride = x1 - x0;
-      buf_ptr = inter_ocl_obj.pref[tile_num] + y_pad * 3 * buf_stride + x_pad * 3;
-      inter_ocl_obj.pref[tile_num] += (x1 - x0) * (y1 - y0);
+      buf_ptr = inter_ocl->pref[tile_num] + y_pad * 3 * buf_stride + x_pad * 3;
+      inter_ocl->pref[tile_num] += (x1 - x0) * (y1 - y0);
     }
   }
 
   cfg_dst = &cm->yv12_fb[cm->new_fb_idx];
   dst_fri = cfg_dst->buffer_alloc;
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->pred_mode =
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->pred_mode =
     ((subpel_x != 0) << 2) + ((subpel_y != 0) << 1);
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->psrc = buf_ptr;
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->src_stride = buf_stride;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->psrc = buf_ptr;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->src_stride = buf_stride;
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->dst_mv = dst - dst_fri;
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->dst_stride = dst_buf->stride;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->dst_mv = dst - dst_fri;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->dst_stride = dst_buf->stride;
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->filter_x =
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->filter_x =
     subpix->filter_x[subpel_x];
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->filter_y =
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->filter_y =
     subpix->filter_y[subpel_y];
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->x_step_q4 = xs;
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->y_step_q4 = ys;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->x_step_q4 = xs;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->y_step_q4 = ys;
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->w = 4 << pred_w;
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->h = 4 << pred_h;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->w = 4 << pred_w;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->h = 4 << pred_h;
 
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]->reset_src_buffer = reset_src_buffer;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]->reset_src_buffer = reset_src_buffer;
 
-  inter_ocl_obj.cpu_sec_count_pre[tile_num]++;
-  inter_ocl_obj.pred_param_cpu_sec_pre[tile_num]++;
+  inter_ocl->cpu_sec_count_pre[tile_num]++;
+  inter_ocl->pred_param_cpu_sec_pre[tile_num]++;
 }
 
 void build_inter_pred_param_fri_ref_ocl(const int plane,
@@ -321,6 +320,7 @@ void build_inter_pred_param_fri_ref_ocl(const int plane,
                                         const int src_num,
                                         const int filter_num,
                                         const int tile_num) {
+  INTER_OCL_OBJ *const inter_ocl = cm->inter_ocl;
   int xs, ys, w, h;
   int buf_offset;
   int filter_radix;
@@ -453,20 +453,20 @@ void build_inter_pred_param_fri_ref_ocl(const int plane,
 
       reset_src_buffer = 1;
 
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->pref =
-          inter_ocl_obj.pref[tile_num];
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->buf_ptr1 = buf_ptr1;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->pre_stride = pre_buf->stride;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->x0 = x0;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->x1 = x1;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->y0 = y0;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->y1 = y1;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->frame_width = frame_width;
-      inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->frame_height = frame_height;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->pref =
+          inter_ocl->pref[tile_num];
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->buf_ptr1 = buf_ptr1;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->pre_stride = pre_buf->stride;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->x0 = x0;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->x1 = x1;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->y0 = y0;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->y1 = y1;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->frame_width = frame_width;
+      inter_ocl->pred_param_cpu_fri_pre[tile_num]->frame_height = frame_height;
 
       buf_stride = x1 - x0;
-      buf_ptr = inter_ocl_obj.pref[tile_num] + y_pad * 3 * buf_stride + x_pad * 3;
-      inter_ocl_obj.pref[tile_num] += (x1 - x0) * (y1 - y0);
+      buf_ptr = inter_ocl->pref[tile_num] + y_pad * 3 * buf_stride + x_pad * 3;
+      inter_ocl->pref[tile_num] += (x1 - x0) * (y1 - y0);
     }
   }
 
@@ -484,55 +484,55 @@ void build_inter_pred_param_fri_ref_ocl(const int plane,
   buf_offset = buf_ptr - src_fri;
 
   if (!ref_idx && xs == 16 && ys == 16 && buf_offset > 0 &&
-      buf_offset < inter_ocl_obj.buffer_size && !CpuFlag &&
+      buf_offset < inter_ocl->buffer_size && !inter_ocl->cpu_flag &&
       cm->show_frame) {
-    inter_ocl_obj.pred_param_gpu_pre[tile_num]->src_stride = pre_buf->stride;
-    inter_ocl_obj.pred_param_gpu_pre[tile_num]->filter_x_mv =
+    inter_ocl->pred_param_gpu_pre[tile_num]->src_stride = pre_buf->stride;
+    inter_ocl->pred_param_gpu_pre[tile_num]->filter_x_mv =
         filter_radix + subpix->filter_x[subpel_x] - filter;
-    inter_ocl_obj.pred_param_gpu_pre[tile_num]->filter_y_mv =
+    inter_ocl->pred_param_gpu_pre[tile_num]->filter_y_mv =
         filter_radix + subpix->filter_y[subpel_y] - filter;
 
     h = h >> 2;
     w = w >> 2;
 
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->pred_mode = pred_mode;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->buf_offset = buf_offset;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->dst_offset = dst - dst_fri;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->dst_stride = dst_buf->stride;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->pre_stride = pre_buf->stride;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->src_num = src_num;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->w = w;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->h = h;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->sub_x = sub_x;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]->sub_y = sub_y;
-
-    inter_ocl_obj.index_count_pre[tile_num] += w * h;
-
-    inter_ocl_obj.gpu_block_count[tile_num]++;
-    inter_ocl_obj.index_param_gpu_pre[tile_num]++;
-    inter_ocl_obj.pred_param_gpu_pre[tile_num]++;
+    inter_ocl->index_param_gpu_pre[tile_num]->pred_mode = pred_mode;
+    inter_ocl->index_param_gpu_pre[tile_num]->buf_offset = buf_offset;
+    inter_ocl->index_param_gpu_pre[tile_num]->dst_offset = dst - dst_fri;
+    inter_ocl->index_param_gpu_pre[tile_num]->dst_stride = dst_buf->stride;
+    inter_ocl->index_param_gpu_pre[tile_num]->pre_stride = pre_buf->stride;
+    inter_ocl->index_param_gpu_pre[tile_num]->src_num = src_num;
+    inter_ocl->index_param_gpu_pre[tile_num]->w = w;
+    inter_ocl->index_param_gpu_pre[tile_num]->h = h;
+    inter_ocl->index_param_gpu_pre[tile_num]->sub_x = sub_x;
+    inter_ocl->index_param_gpu_pre[tile_num]->sub_y = sub_y;
+
+    inter_ocl->index_count_pre[tile_num] += w * h;
+
+    inter_ocl->gpu_block_count[tile_num]++;
+    inter_ocl->index_param_gpu_pre[tile_num]++;
+    inter_ocl->pred_param_gpu_pre[tile_num]++;
   } else {
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->pred_mode = pred_mode;
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->psrc = buf_ptr;
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->src_stride = buf_stride;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->pred_mode = pred_mode;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->psrc = buf_ptr;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->src_stride = buf_stride;
 
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->dst_mv = dst - dst_fri;
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->dst_stride = dst_buf->stride;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->dst_mv = dst - dst_fri;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->dst_stride = dst_buf->stride;
 
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->filter_x =
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->filter_x =
       subpix->filter_x[subpel_x];
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->filter_y =
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->filter_y =
       subpix->filter_y[subpel_y];
 
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->x_step_q4 = xs;
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->y_step_q4 = ys;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->x_step_q4 = xs;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->y_step_q4 = ys;
 
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->w = w;
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->h = h;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->w = w;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->h = h;
 
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]->reset_src_buffer = reset_src_buffer;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]->reset_src_buffer = reset_src_buffer;
 
-    inter_ocl_obj.cpu_fri_count_pre[tile_num]++;
-    inter_ocl_obj.pred_param_cpu_fri_pre[tile_num]++;
+    inter_ocl->cpu_fri_count_pre[tile_num]++;
+    inter_ocl->pred_param_cpu_fri_pre[tile_num]++;
   }
 }
@@ -86,8 +86,12 @@ typedef struct inter_mt_attr {
   uint8_t *new_buffer;
 }INTER_MT_ATTR;
 
+// OpenCL inter prediction state of one decoder instance.
 typedef struct inter_ocl_obj {
   int inter_ocl_init;
+  // Set when frame buffers come from the application rather than the
+  // mapped GPU buffer pool.
+  int cpu_flag;
   int previous_f;
   int before_previous_f;
   int previous_f_show;
@@ -261,8 +265,6 @@ void build_mc_border_ocl(const uint8_t *src,
                          int b_w, int b_h,
                          int w, int h);
 
-extern int CpuFlag;
 extern OCL_CONTEXT ocl_context;
-extern INTER_OCL_OBJ inter_ocl_obj;
 
 #endif // VP9_INTER_OCL_PARAM_H_
@@ -18,7 +18,7 @@
 #else
 typedef void * HANDLE;
 #endif
-FILE *pLog = NULL;
+static FILE *pLog = NULL;
 VP9_YUV2RGBA_OCL yuv2rgba_ocl_obj;
 
 int init_yuv2rgba_ocl_obj() {
@@ -33,7 +33,7 @@ int init_yuv2rgba_ocl_obj() {
                &yuv2rgba_ocl_obj.source_len);
   if (status < 0) {
     printf("Failed to load kernel, error: %d\n", status);
-    exit(1);
+    return -1;
   }
 
   psource = yuv2rgba_ocl_obj.source;
@@ -43,7 +43,7 @@ int init_yuv2rgba_ocl_obj() {
                               &yuv2rgba_ocl_obj.source_len, &status);
   if (status < 0) {
     printf("There is some error in create&build program, error: %d\n", status);
-    exit(1);
+    return -1;
   }
 
  
@@ -55,7 +55,7 @@ int init_yuv2rgba_ocl_obj() {
                                 "yuv_rgba", &status);
   if (status != CL_SUCCESS) {
     printf("Failed to clCreateKernel yuv_rgba, error: %d\n", status);
-    exit(1);
+    return -1;
   }
   #if 0
   yuv2rgba_ocl_obj.rgb_buffer = clCreateBuffer(ocl_context.context,
@@ -65,7 +65,7 @@ int init_yuv2rgba_ocl_obj() {
   	                                                             &status);
   if (status != CL_SUCCESS) {
     printf("Failed to clCreateBuffer rgb, error: %d\n", status);
-    exit(1);
+    return -1;
   }
   printf("ocl_context.command_queue=%d\n", ocl_context.command_queue);
   yuv2rgba_ocl_obj.rgb_map = (uint8_t *)clEnqueueMapBuffer(ocl_context.command_queue,
@@ -76,7 +76,7 @@ int init_yuv2rgba_ocl_obj() {
                                   0, NULL, NULL, &status);
    if (status != CL_SUCCESS) {
     printf("Failed to clEnqueueMapBuffer rgb, error: %d\n", status);
-    exit(1);
+    return -1;
   }
   #endif
   return 0;
@@ -189,7 +189,8 @@ static cl_mem* get_cl_image(VP9_YUV2RGBA_OCL *obj, void *d3d_surface9, HANDLE pS
 
 
 
-int vp9_yuv2rgba( VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj, void *texture) {
+int vp9_yuv2rgba(VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj,
+                 struct inter_ocl_obj *inter_ocl, void *texture) {
 
   int status, arg = 0;
   Interop_Context *p_context;
@@ -205,9 +206,9 @@ int vp9_yuv2rgba( VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj, void *texture) {
   p_context = (Interop_Context *)(texture);
   vpx_usec_timer_start(&timer);
   real_imag = get_cl_image(yuv2rgba_ocl_obj, p_context->pSurface, (HANDLE)(p_context->pSharedHandle));
-   
- // clGetMemObjectInfo(real_imag, CL_MEM_TYPE, sizeof(int), &ty, NULL);
- 
+   
+ // clGetMemObjectInfo(real_imag, CL_MEM_TYPE, sizeof(int), &ty, NULL);
+ 
  // clGetImageInfo(real_imag, CL_IMAGE_FORMAT, sizeof(format), &format, NULL);
   //printf("ty = %xd\n", ty);
  // printf("order = %xd\n", format.image_channel_order);
@@ -220,7 +221,7 @@ int vp9_yuv2rgba( VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj, void *texture) {
    status = clSetKernelArg(
              yuv2rgba_ocl_obj->only_color_space_transform_kernel,
              arg++, sizeof(cl_mem),
-             (void*) &inter_ocl_obj.buffer_pool_kernel);
+             (void*) &inter_ocl->buffer_pool_kernel);
   if (status != CL_SUCCESS) {
     printf("Failed to set arguments 0, error: %d\n", status);
     return -1;
@@ -344,18 +345,49 @@ int vp9_yuv2rgba( VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj, void *texture) {
  
   ///////////////////////////////////////////////////////////////////////////////////////////////
    
-  fprintf(pLog, "create buffer time(from d3d9 surface): %lu us\n"
-	            "clEnqueueAcquireDX9MediaSurfacesKHR API time: %lu us\n"
-				"YUV to RGB kernel time: %lu us\n"
-				"clEnqueueReleaseDX9MediaSurfacesKHR API time: %lu us\n",
-				get_cl_image_time, clEnqueueAcquireDX9MediaSurfacesKHR_time, 
-				clEnqueueNDRangeKernel_time, clEnqueueReleaseDX9MediaSurfacesKHR_time);
+  yuv2rgba_ocl_obj->get_cl_image_time = get_cl_image_time;
+  yuv2rgba_ocl_obj->acquire_time = clEnqueueAcquireDX9MediaSurfacesKHR_time;
+  yuv2rgba_ocl_obj->kernel_time = clEnqueueNDRangeKernel_time;
+  yuv2rgba_ocl_obj->release_time = clEnqueueReleaseDX9MediaSurfacesKHR_time;
   
   return 0;
 }
 
 
 
+int vp9_yuv2rgba_log_open() {
+  if (pLog == NULL)
+    pLog = fopen("Interop_log.txt", "w");
+  return pLog != NULL ? 0 : -1;
+}
+
+void vp9_yuv2rgba_log_close() {
+  if (pLog != NULL) {
+    fclose(pLog);
+    pLog = NULL;
+  }
+}
+
+void vp9_yuv2rgba_log_frame(unsigned long dx_time) {
+  if (pLog == NULL)
+    return;
+
+  if (yuv2rgba_ocl_obj.log_pending) {
+    fprintf(pLog, "create buffer time(from d3d9 surface): %lu us\n"
+                  "clEnqueueAcquireDX9MediaSurfacesKHR API time: %lu us\n"
+                  "YUV to RGB kernel time: %lu us\n"
+                  "clEnqueueReleaseDX9MediaSurfacesKHR API time: %lu us\n",
+            yuv2rgba_ocl_obj.get_cl_image_time, yuv2rgba_ocl_obj.acquire_time,
+            yuv2rgba_ocl_obj.kernel_time, yuv2rgba_ocl_obj.release_time);
+    fprintf(pLog, "decode one frame time(without YUV to RGB): %lu us\n"
+                  "the whole time of YUV to RGB:  %lu us\n",
+            yuv2rgba_ocl_obj.decode_time, yuv2rgba_ocl_obj.yuv2rgb_time);
+    yuv2rgba_ocl_obj.log_pending = 0;
+  }
+  fprintf(pLog, "the whole time of decode one frame: %lu us\n"
+                "------------------------------------------\n", dx_time);
+}
+
 int release_yuv2rgba_ocl_obj() {
   int status;
   int i;
@@ -16,7 +16,6 @@
 #include "vp9/common/inter_ocl/opencl/ocl_wrapper.h"
 #include "vp9/common/inter_ocl/vp9_inter_ocl_init.h"
 
-extern FILE *pLog;
 
 #define IMAGE_CACHE 50
 typedef struct vp9_yuv2rgba_ocl {
@@ -55,6 +54,16 @@ typedef struct vp9_yuv2rgba_ocl {
   cl_program program;
   cl_kernel yuv_rgba_kernel;
   cl_kernel only_color_space_transform_kernel; //for the last frame
+
+  // Timings of the last converted frame. They are written to the log by
+  // vp9_yuv2rgba_log_frame() once the decode call has been timed.
+  int log_pending;
+  unsigned long get_cl_image_time;
+  unsigned long acquire_time;
+  unsigned long kernel_time;
+  unsigned long release_time;
+  unsigned long decode_time;
+  unsigned long yuv2rgb_time;
 } VP9_YUV2RGBA_OCL;
 
 struct IDirect3DSurface9;
@@ -63,7 +72,14 @@ int init_yuv2rgba_ocl_obj();
 
 int release_yuv2rgba_ocl_obj();
 
-int vp9_yuv2rgba( VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj, void *texture) ;
+int vp9_yuv2rgba_log_open();
+
+void vp9_yuv2rgba_log_close();
+
+void vp9_yuv2rgba_log_frame(unsigned long dx_time);
+
+int vp9_yuv2rgba(VP9_YUV2RGBA_OCL *yuv2rgba_ocl_obj,
+                 struct inter_ocl_obj *inter_ocl, void *texture);
 
 
 extern VP9_YUV2RGBA_OCL yuv2rgba_ocl_obj;
@@ -638,11 +638,12 @@ static void build_y_mask(const loop_filter_info_n *const lfi_n,
 // This function sets up the bit masks for the entire 64x64 region represented
 // by mi_row, mi_col.
 // TODO(JBB): This function only works for yv12.
-static void setup_mask(VP9_COMMON *const cm, const int mi_row, const int mi_col,
+static void setup_mask(VP9_COMMON *const cm,
+                       const loop_filter_info_n *const lfi_n,
+                       const int mi_row, const int mi_col,
                        MODE_INFO **mi_8x8, const int mode_info_stride,
                        LOOP_FILTER_MASK *lfm) {
   int idx_32, idx_16, idx_8;
-  const loop_filter_info_n *const lfi_n = &cm->lf_info;
   MODE_INFO **mip = mi_8x8;
   MODE_INFO **mip2 = mi_8x8;
 
@@ -930,6 +931,7 @@ static void filter_selectively_vert(uint8_t *s, int pitch,
 }
 
 static void filter_block_plane_non420(VP9_COMMON *cm,
+                                      const loop_filter_info_n *lfi_n,
                                       struct macroblockd_plane *plane,
                                       MODE_INFO **mi_8x8,
                                       int mi_row, int mi_col) {
@@ -975,7 +977,7 @@ static void filter_block_plane_non420(VP9_COMMON *cm,
 
       // Filter level can vary per MI
       if (!(lfl[(r << 3) + (c >> ss_x)] =
-          build_lfi(&cm->lf_info, &mi[0].mbmi)))
+          build_lfi(lfi_n, &mi[0].mbmi)))
         continue;
 
       // Build masks based on the transform size of each block
@@ -1033,7 +1035,7 @@ static void filter_block_plane_non420(VP9_COMMON *cm,
                             mask_8x8_c & border_mask,
                             mask_4x4_c & border_mask,
                             mask_4x4_int[r],
-                            &cm->lf_info, &lfl[r << 3]);
+                            lfi_n, &lfl[r << 3]);
     dst->buf += 8 * dst->stride;
     mi_8x8 += row_step_stride;
   }
@@ -1063,13 +1065,14 @@ static void filter_block_plane_non420(VP9_COMMON *cm,
                              mask_8x8_r,
                              mask_4x4_r,
                              mask_4x4_int_r,
-                             &cm->lf_info, &lfl[r << 3]);
+                             lfi_n, &lfl[r << 3]);
     dst->buf += 8 * dst->stride;
   }
 }
 #endif
 
 static void filter_block_plane(VP9_COMMON *const cm,
+                               const loop_filter_info_n *const lfi_n,
                                struct macroblockd_plane *const plane,
                                int mi_row,
                                LOOP_FILTER_MASK *lfm) {
@@ -1097,7 +1100,7 @@ static void filter_block_plane(VP9_COMMON *const cm,
                                    mask_8x8_l,
                                    mask_4x4_l,
                                    mask_4x4_int_l,
-                                   &cm->lf_info, &lfm->lfl_y[r << 3]);
+                                   lfi_n, &lfm->lfl_y[r << 3]);
 
       dst->buf += 16 * dst->stride;
       mask_16x16 >>= 16;
@@ -1133,7 +1136,7 @@ static void filter_block_plane(VP9_COMMON *const cm,
                                mask_8x8_r,
                                mask_4x4_r,
                                mask_4x4_int & 0xff,
-                               &cm->lf_info, &lfm->lfl_y[r << 3]);
+                               lfi_n, &lfm->lfl_y[r << 3]);
 
       dst->buf += 8 * dst->stride;
       mask_16x16 >>= 8;
@@ -1170,7 +1173,7 @@ static void filter_block_plane(VP9_COMMON *const cm,
                                      mask_8x8_l,
                                      mask_4x4_l,
                                      mask_4x4_int_l,
-                                     &cm->lf_info, &lfm->lfl_uv[r << 1]);
+                                     lfi_n, &lfm->lfl_uv[r << 1]);
 
         dst->buf += 16 * dst->stride;
         mask_16x16 >>= 8;
@@ -1210,7 +1213,7 @@ static void filter_block_plane(VP9_COMMON *const cm,
                                mask_8x8_r,
                                mask_4x4_r,
                                mask_4x4_int_r,
-                               &cm->lf_info, &lfm->lfl_uv[r << 1]);
+                               lfi_n, &lfm->lfl_uv[r << 1]);
 
       dst->buf += 8 * dst->stride;
       mask_16x16 >>= 4;
@@ -1221,9 +1224,10 @@ static void filter_block_plane(VP9_COMMON *const cm,
   }
 }
 
-void vp9_loop_filter_rows(const YV12_BUFFER_CONFIG *frame_buffer,
-                          VP9_COMMON *cm, MACROBLOCKD *xd,
-                          int start, int stop, int y_only) {
+void vp9_loop_filter_rows_lfi(const YV12_BUFFER_CONFIG *frame_buffer,
+                              VP9_COMMON *cm, const loop_filter_info_n *lfi,
+                              MACROBLOCKD *xd,
+                              int start, int stop, int y_only) {
   const int num_planes = y_only ? 1 : MAX_MB_PLANE;
   int mi_row, mi_col;
   LOOP_FILTER_MASK lfm;
@@ -1244,24 +1248,31 @@ void vp9_loop_filter_rows(const YV12_BUFFER_CONFIG *frame_buffer,
 #if CONFIG_NON420
       if (use_420)
 #endif
-        setup_mask(cm, mi_row, mi_col, mi_8x8 + mi_col, cm->mode_info_stride,
-                   &lfm);
+        setup_mask(cm, lfi, mi_row, mi_col, mi_8x8 + mi_col,
+                   cm->mode_info_stride, &lfm);
 
       for (plane = 0; plane < num_planes; ++plane) {
 #if CONFIG_NON420
         if (use_420)
 #endif
-          filter_block_plane(cm, &xd->plane[plane], mi_row, &lfm);
+          filter_block_plane(cm, lfi, &xd->plane[plane], mi_row, &lfm);
 #if CONFIG_NON420
         else
-          filter_block_plane_non420(cm, &xd->plane[plane], mi_8x8 + mi_col,
-                                    mi_row, mi_col);
+          filter_block_plane_non420(cm, lfi, &xd->plane[plane],
+                                    mi_8x8 + mi_col, mi_row, mi_col);
 #endif
       }
     }
   }
 }
 
+void vp9_loop_filter_rows(const YV12_BUFFER_CONFIG *frame_buffer,
+                          VP9_COMMON *cm, MACROBLOCKD *xd,
+                          int start, int stop, int y_only) {
+  vp9_loop_filter_rows_lfi(frame_buffer, cm, &cm->lf_info, xd, start, stop,
+                           y_only);
+}
+
 void vp9_loop_filter_frame(VP9_COMMON *cm, MACROBLOCKD *xd,
                            int frame_filter_level,
                            int y_only, int partial) {
@@ -78,6 +78,14 @@ void vp9_loop_filter_rows(const YV12_BUFFER_CONFIG *frame_buffer,
                           struct VP9Common *cm, struct macroblockd *xd,
                           int start, int stop, int y_only);
 
+// Same as vp9_loop_filter_rows(), with the filter levels and limits of lfi in
+// place of cm->lf_info.
+void vp9_loop_filter_rows_lfi(const YV12_BUFFER_CONFIG *frame_buffer,
+                              struct VP9Common *cm,
+                              const loop_filter_info_n *lfi,
+                              struct macroblockd *xd,
+                              int start, int stop, int y_only);
+
 typedef struct LoopFilterWorkerData {
   const YV12_BUFFER_CONFIG *frame_buffer;
   struct VP9Common *cm;
@@ -175,6 +175,9 @@ extern "C"
     int tile_columns;
     int tile_rows;
 
+    // Maximum number of threads encoding tile columns concurrently.
+    int max_threads;
+
     struct vpx_fixed_buf         two_pass_stats_in;
     struct vpx_codec_pkt_list  *output_pkt_list;
 
@@ -190,10 +193,12 @@ extern "C"
   void vp9_change_config(VP9_PTR onyx, VP9_CONFIG *oxcf);
 
   // receive a frames worth of data. caller can assume that a copy of this
-  // frame is made and not just a copy of the pointer..
+  // frame is made and not just a copy of the pointer, unless a source release
+  // callback is set. The frame is then released with user_priv once it is
+  // no longer needed, which happens before returning if it was copied.
   int vp9_receive_raw_frame(VP9_PTR comp, unsigned int frame_flags,
                             YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                            int64_t end_time_stamp);
+                            int64_t end_time_stamp, void *user_priv);
 
   int vp9_get_compressed_data(VP9_PTR comp, unsigned int *frame_flags,
                               size_t *size, uint8_t *dest,
@@ -234,6 +239,9 @@ extern "C"
 
   void vp9_set_svc(VP9_PTR comp, int use_svc);
 
+  void vp9_set_source_release_cb(VP9_PTR comp,
+                                 const vpx_source_release_cb_t *cb);
+
   int vp9_get_quantizer(VP9_PTR c);
 
 #ifdef __cplusplus
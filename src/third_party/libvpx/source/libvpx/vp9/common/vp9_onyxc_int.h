@@ -225,6 +225,9 @@ typedef struct VP9Common {
   int fb_lru;  // Flag telling if lru is on/off
   uint32_t *fb_idx_ref_lru;  // Frame buffer lru cache
   uint32_t fb_idx_ref_lru_count;
+
+  // OpenCL inter prediction state, owned by the decoder instance.
+  struct inter_ocl_obj *inter_ocl;
 } VP9_COMMON;
 
 static YV12_BUFFER_CONFIG *get_frame_new_buffer(VP9_COMMON *cm) {
@@ -754,7 +754,7 @@ prototype int vp9_full_range_search "struct macroblock *x, struct mv *ref_mv, st
 specialize vp9_full_range_search
 
 prototype void vp9_temporal_filter_apply "uint8_t *frame1, unsigned int stride, uint8_t *frame2, unsigned int block_size, int strength, int filter_weight, unsigned int *accumulator, uint16_t *count"
-specialize vp9_temporal_filter_apply sse2
+specialize vp9_temporal_filter_apply sse2 avx2
 
 fi
 # end encoder functions
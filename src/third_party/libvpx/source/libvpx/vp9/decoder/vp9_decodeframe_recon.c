@@ -39,7 +39,7 @@
 #include "vp9/decoder/vp9_onyxd_int.h"
 #include "vp9/decoder/vp9_read_bit_buffer.h"
 #include "vp9/decoder/vp9_reader.h"
-#include "vp9/decoder/vp9_thread.h"
+#include "vp9/common/vp9_thread.h"
 
 #include "vp9/decoder/vp9_detokenize_recon.h"
 #include "vp9/decoder/vp9_append.h"
@@ -54,9 +54,6 @@
 
 #include "vp9/ppa.h"
 
-static struct task *g_tsk;
-extern int CpuFlag;
-
 typedef struct TileWorkerData {
   VP9_COMMON *cm;
   vp9_reader bit_reader;
@@ -803,14 +800,15 @@ static void apply_frame_size(VP9D_COMP *pbi, int width, int height) {
                              cm->subsampling_x, cm->subsampling_y,
                              VP9BORDERINPIXELS, NULL, NULL, NULL);*/
 #if USE_INTER_PREDICT_OCL
-    if(CpuFlag) {
+    if (cm->inter_ocl->cpu_flag) {
       vp9_realloc_frame_buffer(get_frame_new_buffer(cm), cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
                                VP9BORDERINPIXELS, NULL, NULL, NULL);
     } else {
        vp9_realloc_frame_buffer_ocl(get_frame_new_buffer(cm), cm->width, cm->height,
                                    cm->subsampling_x, cm->subsampling_y,
-                                   VP9BORDERINPIXELS, NULL, NULL, NULL, cm->new_fb_idx);
+                                   VP9BORDERINPIXELS, NULL, NULL, NULL, cm->new_fb_idx,
+                                   cm->inter_ocl);
     }
 #else
     vp9_realloc_frame_buffer(get_frame_new_buffer(cm), cm->width, cm->height,
@@ -867,14 +865,15 @@ static void apply_frame_size_recon(VP9D_COMP *pbi,
                              cm->subsampling_x, cm->subsampling_y,
                              VP9BORDERINPIXELS, NULL, NULL, NULL);*/
 #if USE_INTER_PREDICT_OCL
-    if(CpuFlag) {
+    if (cm->inter_ocl->cpu_flag) {
       vp9_realloc_frame_buffer(get_frame_new_buffer(cm), cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
                                VP9BORDERINPIXELS, NULL, NULL, NULL);
     } else {
        vp9_realloc_frame_buffer_ocl(get_frame_new_buffer(cm), cm->width, cm->height,
                                    cm->subsampling_x, cm->subsampling_y,
-                                   VP9BORDERINPIXELS, NULL, NULL, NULL, cm->new_fb_idx);
+                                   VP9BORDERINPIXELS, NULL, NULL, NULL, cm->new_fb_idx,
+                                   cm->inter_ocl);
     }
 #else
     vp9_realloc_frame_buffer(get_frame_new_buffer(cm), cm->width, cm->height,
@@ -2219,7 +2218,7 @@ static void inter_pred_param_ocl(VP9_DECODER_RECON *const decoder_recon,
   PPAStartCpuEventFunc(para_prepare_time);
 #endif
 
-  reset_inter_ocl_param_buffer(tile_num);
+  reset_inter_ocl_param_buffer(decoder_recon->cm->inter_ocl, tile_num);
 
   for (i = blocks_start; i < blocks_end; ++i) {
     ref_idx =
@@ -2234,7 +2233,7 @@ static void inter_pred_param_ocl(VP9_DECODER_RECON *const decoder_recon,
 #if USE_PPA
   PPAStartCpuEventFunc(inter_param_write_time);
 #endif
-  vp9_inter_write_param_to_gpu(tile_num);
+  vp9_inter_write_param_to_gpu(decoder_recon->cm->inter_ocl, tile_num);
 #if USE_PPA
   PPAStopCpuEventFunc(inter_param_write_time);
 #endif
@@ -3406,9 +3405,9 @@ static int vp9_single_thread_decode_entropy_recon(VP9D_COMP *pbi,
 #if USE_INTER_PREDICT_OCL
   // Initialize opencl buffer parameter for inter prediction
   // Copy cpu previous frame data to gpu memory
-  if (inter_ocl_obj.inter_ocl_init) {
-    inter_ocl_obj.inter_ocl_init = vp9_init_inter_ocl(cm_new, tile_cols);
-    assert(inter_ocl_obj.inter_ocl_init == 0);
+  if (cm_new->inter_ocl->inter_ocl_init) {
+    cm_new->inter_ocl->inter_ocl_init = vp9_init_inter_ocl(cm_new, tile_cols);
+    assert(cm_new->inter_ocl->inter_ocl_init == 0);
   } else {
 #if USE_PPA
   PPAStartCpuEventFunc(update_gpu_buffer_pool);
@@ -3557,9 +3556,9 @@ static int vp9_single_thread_decode_entropy_recon_last_frame(VP9D_COMP *pbi,
 /*#if USE_INTER_PREDICT_OCL
   // Initialize opencl buffer parameter for inter prediction
   // Copy cpu previous frame data to gpu memory
-  if (inter_ocl_obj.inter_ocl_init) {
-    inter_ocl_obj.inter_ocl_init = vp9_init_inter_ocl(cm_new, tile_cols);
-    assert(inter_ocl_obj.inter_ocl_init == 0);
+  if (cm_new->inter_ocl->inter_ocl_init) {
+    cm_new->inter_ocl->inter_ocl_init = vp9_init_inter_ocl(cm_new, tile_cols);
+    assert(cm_new->inter_ocl->inter_ocl_init == 0);
   } else {
 #if USE_PPA
   PPAStartCpuEventFunc(update_gpu_buffer_pool);
@@ -3639,6 +3638,7 @@ static int vp9_sched_frame_entrop_dec_entropy_recon(VP9D_COMP *pbi,
                                       const uint8_t **p_data_end) {                                   
   struct task *tsk;
   struct frame_entropy_dec_param *param;
+  struct task *frame_tsk;
   struct frame_entropy_dec_param *entropy_param;
   VP9Worker *worker = &pbi->copy_worker_frame;
   const uint8_t *data = pbi->source;
@@ -3653,9 +3653,9 @@ static int vp9_sched_frame_entrop_dec_entropy_recon(VP9D_COMP *pbi,
 #if USE_INTER_PREDICT_OCL
   // Initialize opencl buffer parameter for inter prediction
   // Copy cpu previous frame data to gpu memory
-  if (inter_ocl_obj.inter_ocl_init) {
-    inter_ocl_obj.inter_ocl_init = vp9_init_inter_ocl(cm, tile_cols);
-    assert(inter_ocl_obj.inter_ocl_init == 0);
+  if (cm->inter_ocl->inter_ocl_init) {
+    cm->inter_ocl->inter_ocl_init = vp9_init_inter_ocl(cm, tile_cols);
+    assert(cm->inter_ocl->inter_ocl_init == 0);
   }
 #endif // USE_INTER_PREDICT_OCL
 
@@ -3718,13 +3718,13 @@ static int vp9_sched_frame_entrop_dec_entropy_recon(VP9D_COMP *pbi,
 //    cm_new = &storage_pbi[(pbi->l_bufpool_flag_output)& 1]->common;
 
 
-    g_tsk = (struct task *) task_cache_get_task(pbi->tsk_cache, NULL, 1);
-    assert(g_tsk);
-    param = (struct frame_entropy_dec_param *) frame_dec_param_get(g_tsk);
+    frame_tsk = (struct task *) task_cache_get_task(pbi->tsk_cache, NULL, 1);
+    assert(frame_tsk);
+    param = (struct frame_entropy_dec_param *) frame_dec_param_get(frame_tsk);
     assert(param);
     param->pbi =storage_pbi[(pbi->l_bufpool_flag_output)& 1];
     param->p_data_end = p_data_end;
-    scheduler_sched_task(pbi->sched, g_tsk);
+    scheduler_sched_task(pbi->sched, frame_tsk);
 
     ret_pbi_queue(pbi, storage_pbi[(pbi->l_bufpool_flag_output + 1) & 1]);
     vp9_tiles_entropy_dec_recon(pbi, data + first_partition_size);
@@ -3749,9 +3749,9 @@ static int vp9_sched_frame_entrop_dec_entropy_recon(VP9D_COMP *pbi,
     worker->hook = copy_hook;
     vp9_worker_launch(worker);
 
-    task_sync(g_tsk);
-    task_cache_put_task(g_tsk->cache, g_tsk);
-    task_param_free(g_tsk);
+    task_sync(frame_tsk);
+    task_cache_put_task(frame_tsk->cache, frame_tsk);
+    task_param_free(frame_tsk);
 
      
     swap_frame_buffers_recon(storage_pbi[(pbi->l_bufpool_flag_output)& 1]);
@@ -3770,7 +3770,7 @@ static int vp9_sched_frame_entrop_dec_entropy_recon(VP9D_COMP *pbi,
 // update buffer pool
     #if USE_INTER_PREDICT_OCL
     // Copy cpu previous frame data to gpu memory
-    if (!inter_ocl_obj.inter_ocl_init) {
+    if (!cm->inter_ocl->inter_ocl_init) {
 #if USE_PPA
     PPAStartCpuEventFunc(update_gpu_buffer_pool);
 #endif
@@ -3791,6 +3791,7 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_ex(VP9D_COMP *pbi,
                                       
   struct task *tsk;
   struct frame_entropy_dec_param *param;
+  struct task *frame_tsk;
   struct frame_entropy_dec_param *entropy_param;
   VP9Worker *worker = &pbi->copy_worker_frame;
   const uint8_t *data = pbi->source;
@@ -3806,9 +3807,9 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_ex(VP9D_COMP *pbi,
 #if USE_INTER_PREDICT_OCL
   // Initialize opencl buffer parameter for inter prediction
   // Copy cpu previous frame data to gpu memory
-  if (inter_ocl_obj.inter_ocl_init) {
-    inter_ocl_obj.inter_ocl_init = vp9_init_inter_ocl(cm, tile_cols);
-    assert(inter_ocl_obj.inter_ocl_init == 0);
+  if (cm->inter_ocl->inter_ocl_init) {
+    cm->inter_ocl->inter_ocl_init = vp9_init_inter_ocl(cm, tile_cols);
+    assert(cm->inter_ocl->inter_ocl_init == 0);
   }
 #endif // USE_INTER_PREDICT_OCL
 
@@ -3872,13 +3873,13 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_ex(VP9D_COMP *pbi,
 //    cm_new = &storage_pbi[(pbi->l_bufpool_flag_output)& 1]->common;
 
 
-    g_tsk = (struct task *) task_cache_get_task(pbi->tsk_cache, NULL, 1);
-    assert(g_tsk);
-    param = (struct frame_entropy_dec_param *) frame_dec_param_get(g_tsk);
+    frame_tsk = (struct task *) task_cache_get_task(pbi->tsk_cache, NULL, 1);
+    assert(frame_tsk);
+    param = (struct frame_entropy_dec_param *) frame_dec_param_get(frame_tsk);
     assert(param);
     param->pbi =storage_pbi[(pbi->l_bufpool_flag_output)& 1];
     param->p_data_end = p_data_end;
-    scheduler_sched_task(pbi->sched, g_tsk);
+    scheduler_sched_task(pbi->sched, frame_tsk);
 
     ret_pbi_queue(pbi, storage_pbi[(pbi->l_bufpool_flag_output + 1) & 1]);
     vp9_tiles_entropy_dec_recon(pbi, data + first_partition_size);
@@ -3903,9 +3904,9 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_ex(VP9D_COMP *pbi,
     worker->hook = copy_hook;
     vp9_worker_launch(worker);
 
-    task_sync(g_tsk);
-    task_cache_put_task(g_tsk->cache, g_tsk);
-    task_param_free(g_tsk);
+    task_sync(frame_tsk);
+    task_cache_put_task(frame_tsk->cache, frame_tsk);
+    task_param_free(frame_tsk);
 
     swap_frame_buffers_recon(storage_pbi[(pbi->l_bufpool_flag_output)& 1]);
     if (!storage_pbi[(pbi->l_bufpool_flag_output) & 1]->do_loopfilter_inline) {
@@ -3935,6 +3936,7 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_last_frame(VP9D_COMP *pbi,
                                       VP9D_COMP **storage_pbi,
                                       const uint8_t **p_data_end) {  
   struct frame_entropy_dec_param *param;
+  struct task *frame_tsk;
   const uint8_t *data = pbi->source;
   size_t first_partition_size = 0;
   VP9_COMMON *const cm = &pbi->common;
@@ -3947,17 +3949,17 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_last_frame(VP9D_COMP *pbi,
                                     first_partition_size, data);
   }
 
-  g_tsk = task_cache_get_task(pbi->tsk_cache, NULL, 0);
-  assert(g_tsk);
-  param = (struct frame_entropy_dec_param *)frame_dec_param_get(g_tsk);
+  frame_tsk = task_cache_get_task(pbi->tsk_cache, NULL, 0);
+  assert(frame_tsk);
+  param = (struct frame_entropy_dec_param *)frame_dec_param_get(frame_tsk);
   assert(param);
   param->pbi =storage_pbi[(pbi->l_bufpool_flag_output)& 1];
   param->p_data_end = p_data_end;
-  scheduler_sched_task(pbi->sched, g_tsk);
+  scheduler_sched_task(pbi->sched, frame_tsk);
 
-  task_sync(g_tsk);
-  task_cache_put_task(g_tsk->cache, g_tsk);
-  task_param_free(g_tsk);
+  task_sync(frame_tsk);
+  task_cache_put_task(frame_tsk->cache, frame_tsk);
+  task_param_free(frame_tsk);
 
   swap_frame_buffers_recon(storage_pbi[(pbi->l_bufpool_flag_output)& 1]);
   if (!storage_pbi[pbi->l_bufpool_flag_output & 1]->do_loopfilter_inline) {
@@ -3981,6 +3983,7 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_last_frame_ex(VP9D_COMP *pbi
                                       void *texture) {
                                       
   struct frame_entropy_dec_param *param;
+  struct task *frame_tsk;
   const uint8_t *data = pbi->source;
   size_t first_partition_size = 0;
   VP9_COMMON *const cm = &pbi->common;
@@ -3993,17 +3996,17 @@ static int vp9_sched_frame_entrop_dec_entropy_recon_last_frame_ex(VP9D_COMP *pbi
                                     first_partition_size, data, texture);
   }
 
-  g_tsk = task_cache_get_task(pbi->tsk_cache, NULL, 0);
-  assert(g_tsk);
-  param = (struct frame_entropy_dec_param *)frame_dec_param_get(g_tsk);
+  frame_tsk = task_cache_get_task(pbi->tsk_cache, NULL, 0);
+  assert(frame_tsk);
+  param = (struct frame_entropy_dec_param *)frame_dec_param_get(frame_tsk);
   assert(param);
   param->pbi =storage_pbi[(pbi->l_bufpool_flag_output)& 1];
   param->p_data_end = p_data_end;
-  scheduler_sched_task(pbi->sched, g_tsk);
+  scheduler_sched_task(pbi->sched, frame_tsk);
 
-  task_sync(g_tsk);
-  task_cache_put_task(g_tsk->cache, g_tsk);
-  task_param_free(g_tsk);
+  task_sync(frame_tsk);
+  task_cache_put_task(frame_tsk->cache, frame_tsk);
+  task_param_free(frame_tsk);
 
   swap_frame_buffers_recon(storage_pbi[(pbi->l_bufpool_flag_output)& 1]);
   if (!storage_pbi[pbi->l_bufpool_flag_output & 1]->do_loopfilter_inline) {
@@ -4037,9 +4040,9 @@ static int vp9_sched_frame_entrop_dec(VP9D_COMP *pbi,
 #if USE_INTER_PREDICT_OCL
   // Initialize opencl buffer parameter for inter prediction
   // Copy cpu previous frame data to gpu memory
-  if (inter_ocl_obj.inter_ocl_init) {
-    inter_ocl_obj.inter_ocl_init = vp9_init_inter_ocl(cm, tile_cols);
-    assert(inter_ocl_obj.inter_ocl_init == 0);
+  if (cm->inter_ocl->inter_ocl_init) {
+    cm->inter_ocl->inter_ocl_init = vp9_init_inter_ocl(cm, tile_cols);
+    assert(cm->inter_ocl->inter_ocl_init == 0);
   } else {
 #if USE_PPA
   PPAStartCpuEventFunc(update_gpu_buffer_pool);
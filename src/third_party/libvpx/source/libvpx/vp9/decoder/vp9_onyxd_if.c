@@ -24,6 +24,7 @@
 #include "vp9/common/vp9_quant_common.h"
 #include "vpx_scale/vpx_scale.h"
 #include "vp9/common/vp9_systemdependent.h"
+#include "vpx_ports/vpx_once.h"
 #include "vpx_ports/vpx_timer.h"
 #include "vp9/decoder/vp9_decodeframe.h"
 #include "vp9/decoder/vp9_detokenize.h"
@@ -108,14 +109,13 @@ void write_dx_frame_to_file(YV12_BUFFER_CONFIG *frame, int this_frame) {
 }
 #endif
 
-void vp9_initialize_dec() {
-  static int init_done = 0;
+static void initialize_dec() {
+  vp9_initialize_common();
+  vp9_init_quant_tables();
+}
 
-  if (!init_done) {
-    vp9_initialize_common();
-    vp9_init_quant_tables();
-    init_done = 1;
-  }
+void vp9_initialize_dec() {
+  once(initialize_dec);
 }
 
 static void init_macroblockd(VP9D_COMP *const pbi) {
@@ -353,22 +353,6 @@ void vp9_remove_decompressor_recon(VP9D_PTR ptr, VP9D_PTR *ptr2) {
   vpx_free(store_pbi[0]);
   vpx_free(store_pbi[1]);
   vpx_free(pbi);
-
-#if USE_INTER_PREDICT_OCL
-  // Release opencl for vp9
-  vp9_release_ocl();
-#if DO_PROFILING
-  printf("\n***********kernels avg time**************\n");
-  printf("index_param_kernel_time : %f ms\n", 
-  inter_ocl_obj.param_index_kernel_time / inter_ocl_obj.index_run_times);
-  printf("inter_pred_kernel_time : %f ms\n", 
-  inter_ocl_obj.inter_pred_kernel_time/ inter_ocl_obj.inter_pred_run_tmes);
-  printf("cpy_mip_kernel_time : %f ms\n", 
-  ocl_cpy_mip_obj.cpy_mip_kernel_time/ ocl_cpy_mip_obj.cpy_mip_run_times);
-
-#endif
-#endif // USE_INTER_PREDICT_OCL
-
 }
 
 static int equal_dimensions(YV12_BUFFER_CONFIG *a, YV12_BUFFER_CONFIG *b) {
@@ -15,7 +15,7 @@
 
 #include "vp9/common/vp9_onyxc_int.h"
 #include "vp9/decoder/vp9_onyxd.h"
-#include "vp9/decoder/vp9_thread.h"
+#include "vp9/common/vp9_thread.h"
 #include "vp9/decoder/vp9_reader.h"
 #include "vp9/sched/sched.h"
 #include "vp9/decoder/vp9_tile_info.h"
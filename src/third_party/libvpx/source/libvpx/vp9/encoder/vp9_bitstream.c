@@ -27,6 +27,7 @@
 
 #include "vp9/encoder/vp9_mcomp.h"
 #include "vp9/encoder/vp9_encodemv.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_bitstream.h"
 #include "vp9/encoder/vp9_segmentation.h"
 #include "vp9/encoder/vp9_subexp.h"
@@ -94,11 +95,11 @@ static void prob_diff_update(const vp9_tree_index *tree,
     vp9_cond_prob_diff_update(w, &probs[i], branch_ct[i]);
 }
 
-static void write_selected_tx_size(const VP9_COMP *cpi, MODE_INFO *m,
+static void write_selected_tx_size(const VP9_COMP *cpi,
+                                   const MACROBLOCKD *xd, MODE_INFO *m,
                                    TX_SIZE tx_size, BLOCK_SIZE bsize,
                                    vp9_writer *w) {
   const TX_SIZE max_tx_size = max_txsize_lookup[bsize];
-  const MACROBLOCKD *const xd = &cpi->mb.e_mbd;
   const vp9_prob *const tx_probs = get_tx_probs2(max_tx_size, xd,
                                                  &cpi->common.fc.tx_probs);
   vp9_write(w, tx_size != TX_4X4, tx_probs[0]);
@@ -109,9 +110,8 @@ static void write_selected_tx_size(const VP9_COMP *cpi, MODE_INFO *m,
   }
 }
 
-static int write_skip_coeff(const VP9_COMP *cpi, int segment_id, MODE_INFO *m,
-                            vp9_writer *w) {
-  const MACROBLOCKD *const xd = &cpi->mb.e_mbd;
+static int write_skip_coeff(const VP9_COMP *cpi, const MACROBLOCKD *xd,
+                            int segment_id, MODE_INFO *m, vp9_writer *w) {
   if (vp9_segfeature_active(&cpi->common.seg, segment_id, SEG_LVL_SKIP)) {
     return 1;
   } else {
@@ -211,10 +211,9 @@ static void write_segment_id(vp9_writer *w, const struct segmentation *seg,
 }
 
 // This function encodes the reference frame
-static void encode_ref_frame(VP9_COMP *cpi, vp9_writer *bc) {
+static void encode_ref_frame(VP9_COMP *cpi, const MACROBLOCKD *xd,
+                             vp9_writer *bc) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
-  MACROBLOCKD *const xd = &x->e_mbd;
   MB_MODE_INFO *mi = &xd->mi_8x8[0]->mbmi;
   const int segment_id = mi->segment_id;
   int seg_ref_active = vp9_segfeature_active(&cm->seg, segment_id,
@@ -252,10 +251,10 @@ static void encode_ref_frame(VP9_COMP *cpi, vp9_writer *bc) {
   // the reference frame is fully coded by the segment.
 }
 
-static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
+static void pack_inter_mode_mvs(VP9_COMP *cpi, MACROBLOCK *x, MODE_INFO *m,
+                                vp9_writer *bc) {
   VP9_COMMON *const cm = &cpi->common;
   const nmv_context *nmvc = &cm->fc.nmvc;
-  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   struct segmentation *seg = &cm->seg;
   MB_MODE_INFO *const mi = &m->mbmi;
@@ -282,7 +281,7 @@ static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
     }
   }
 
-  skip_coeff = write_skip_coeff(cpi, segment_id, m, bc);
+  skip_coeff = write_skip_coeff(cpi, xd, segment_id, m, bc);
 
   if (!vp9_segfeature_active(seg, segment_id, SEG_LVL_REF_FRAME))
     vp9_write(bc, rf != INTRA_FRAME, vp9_get_intra_inter_prob(cm, xd));
@@ -290,7 +289,7 @@ static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
   if (bsize >= BLOCK_8X8 && cm->tx_mode == TX_MODE_SELECT &&
       !(rf != INTRA_FRAME &&
         (skip_coeff || vp9_segfeature_active(seg, segment_id, SEG_LVL_SKIP)))) {
-    write_selected_tx_size(cpi, m, mi->tx_size, bsize, bc);
+    write_selected_tx_size(cpi, xd, m, mi->tx_size, bsize, bc);
   }
 
   if (rf == INTRA_FRAME) {
@@ -314,7 +313,7 @@ static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
     write_intra_mode(bc, mi->uv_mode, cm->fc.uv_mode_prob[mode]);
   } else {
     vp9_prob *mv_ref_p;
-    encode_ref_frame(cpi, bc);
+    encode_ref_frame(cpi, xd, bc);
     mv_ref_p = cpi->common.fc.inter_mode_probs[mi->mode_context[rf]];
 
 #ifdef ENTROPY_STATS
@@ -325,7 +324,7 @@ static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
     if (!vp9_segfeature_active(seg, segment_id, SEG_LVL_SKIP)) {
       if (bsize >= BLOCK_8X8) {
         write_inter_mode(bc, mode, mv_ref_p);
-        ++cm->counts.inter_mode[mi->mode_context[rf]][INTER_OFFSET(mode)];
+        ++x->counts.inter_mode[mi->mode_context[rf]][INTER_OFFSET(mode)];
       }
     }
 
@@ -347,19 +346,21 @@ static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
           const int j = idy * 2 + idx;
           const MB_PREDICTION_MODE blockmode = m->bmi[j].as_mode;
           write_inter_mode(bc, blockmode, mv_ref_p);
-          ++cm->counts.inter_mode[mi->mode_context[rf]]
-                                 [INTER_OFFSET(blockmode)];
+          ++x->counts.inter_mode[mi->mode_context[rf]]
+                                [INTER_OFFSET(blockmode)];
 
           if (blockmode == NEWMV) {
 #ifdef ENTROPY_STATS
             active_section = 11;
 #endif
             vp9_encode_mv(cpi, bc, &m->bmi[j].as_mv[0].as_mv,
-                          &mi->best_mv[0].as_mv, nmvc, allow_hp);
+                          &mi->best_mv[0].as_mv, nmvc, allow_hp,
+                          &x->max_mv_magnitude);
 
             if (has_second_ref(mi))
               vp9_encode_mv(cpi, bc, &m->bmi[j].as_mv[1].as_mv,
-                            &mi->best_mv[1].as_mv, nmvc, allow_hp);
+                            &mi->best_mv[1].as_mv, nmvc, allow_hp,
+                            &x->max_mv_magnitude);
           }
         }
       }
@@ -368,19 +369,20 @@ static void pack_inter_mode_mvs(VP9_COMP *cpi, MODE_INFO *m, vp9_writer *bc) {
       active_section = 5;
 #endif
       vp9_encode_mv(cpi, bc, &mi->mv[0].as_mv,
-                    &mi->best_mv[0].as_mv, nmvc, allow_hp);
+                    &mi->best_mv[0].as_mv, nmvc, allow_hp,
+                    &x->max_mv_magnitude);
 
       if (has_second_ref(mi))
         vp9_encode_mv(cpi, bc, &mi->mv[1].as_mv,
-                      &mi->best_mv[1].as_mv, nmvc, allow_hp);
+                      &mi->best_mv[1].as_mv, nmvc, allow_hp,
+                      &x->max_mv_magnitude);
     }
   }
 }
 
-static void write_mb_modes_kf(const VP9_COMP *cpi, MODE_INFO **mi_8x8,
-                              vp9_writer *bc) {
+static void write_mb_modes_kf(const VP9_COMP *cpi, const MACROBLOCKD *xd,
+                              MODE_INFO **mi_8x8, vp9_writer *bc) {
   const VP9_COMMON *const cm = &cpi->common;
-  const MACROBLOCKD *const xd = &cpi->mb.e_mbd;
   const struct segmentation *const seg = &cm->seg;
   MODE_INFO *m = mi_8x8[0];
   const int ym = m->mbmi.mode;
@@ -391,10 +393,10 @@ static void write_mb_modes_kf(const VP9_COMP *cpi, MODE_INFO **mi_8x8,
   if (seg->update_map)
     write_segment_id(bc, seg, m->mbmi.segment_id);
 
-  write_skip_coeff(cpi, segment_id, m, bc);
+  write_skip_coeff(cpi, xd, segment_id, m, bc);
 
   if (m->mbmi.sb_type >= BLOCK_8X8 && cm->tx_mode == TX_MODE_SELECT)
-    write_selected_tx_size(cpi, m, m->mbmi.tx_size, m->mbmi.sb_type, bc);
+    write_selected_tx_size(cpi, xd, m, m->mbmi.tx_size, m->mbmi.sb_type, bc);
 
   if (m->mbmi.sb_type >= BLOCK_8X8) {
     const MB_PREDICTION_MODE A = above_block_mode(m, above_mi, 0);
@@ -418,11 +420,12 @@ static void write_mb_modes_kf(const VP9_COMP *cpi, MODE_INFO **mi_8x8,
   write_intra_mode(bc, m->mbmi.uv_mode, vp9_kf_uv_mode_prob[ym]);
 }
 
-static void write_modes_b(VP9_COMP *cpi, const TileInfo *const tile,
-                          vp9_writer *w, TOKENEXTRA **tok, TOKENEXTRA *tok_end,
+static void write_modes_b(VP9_COMP *cpi, MACROBLOCK *x,
+                          const TileInfo *const tile, vp9_writer *w,
+                          TOKENEXTRA **tok, TOKENEXTRA *tok_end,
                           int mi_row, int mi_col) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->mb.e_mbd;
+  MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO *m;
 
   xd->mi_8x8 = cm->mi_grid_visible + (mi_row * cm->mode_info_stride + mi_col);
@@ -433,12 +436,12 @@ static void write_modes_b(VP9_COMP *cpi, const TileInfo *const tile,
                  mi_col, num_8x8_blocks_wide_lookup[m->mbmi.sb_type],
                  cm->mi_rows, cm->mi_cols);
   if (frame_is_intra_only(cm)) {
-    write_mb_modes_kf(cpi, xd->mi_8x8, w);
+    write_mb_modes_kf(cpi, xd, xd->mi_8x8, w);
 #ifdef ENTROPY_STATS
     active_section = 8;
 #endif
   } else {
-    pack_inter_mode_mvs(cpi, m, w);
+    pack_inter_mode_mvs(cpi, x, m, w);
 #ifdef ENTROPY_STATS
     active_section = 1;
 #endif
@@ -448,11 +451,12 @@ static void write_modes_b(VP9_COMP *cpi, const TileInfo *const tile,
   pack_mb_tokens(w, tok, tok_end);
 }
 
-static void write_partition(VP9_COMP *cpi, int hbs, int mi_row, int mi_col,
-                            PARTITION_TYPE p, BLOCK_SIZE bsize, vp9_writer *w) {
+static void write_partition(VP9_COMP *cpi, const MACROBLOCKD *xd, int hbs,
+                            int mi_row, int mi_col, PARTITION_TYPE p,
+                            BLOCK_SIZE bsize, vp9_writer *w) {
   VP9_COMMON *const cm = &cpi->common;
   const int ctx = partition_plane_context(cpi->above_seg_context,
-                                          cpi->left_seg_context,
+                                          xd->left_seg_context,
                                           mi_row, mi_col, bsize);
   const vp9_prob *const probs = get_partition_probs(cm, ctx);
   const int has_rows = (mi_row + hbs) < cm->mi_rows;
@@ -471,10 +475,12 @@ static void write_partition(VP9_COMP *cpi, int hbs, int mi_row, int mi_col,
   }
 }
 
-static void write_modes_sb(VP9_COMP *cpi, const TileInfo *const tile,
-                           vp9_writer *w, TOKENEXTRA **tok, TOKENEXTRA *tok_end,
+static void write_modes_sb(VP9_COMP *cpi, MACROBLOCK *x,
+                           const TileInfo *const tile, vp9_writer *w,
+                           TOKENEXTRA **tok, TOKENEXTRA *tok_end,
                            int mi_row, int mi_col, BLOCK_SIZE bsize) {
   VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
   const int bsl = b_width_log2(bsize);
   const int bs = (1 << bsl) / 4;
   PARTITION_TYPE partition;
@@ -485,33 +491,33 @@ static void write_modes_sb(VP9_COMP *cpi, const TileInfo *const tile,
     return;
 
   partition = partition_lookup[bsl][m->mbmi.sb_type];
-  write_partition(cpi, bs, mi_row, mi_col, partition, bsize, w);
+  write_partition(cpi, xd, bs, mi_row, mi_col, partition, bsize, w);
   subsize = get_subsize(bsize, partition);
   if (subsize < BLOCK_8X8) {
-    write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+    write_modes_b(cpi, x, tile, w, tok, tok_end, mi_row, mi_col);
   } else {
     switch (partition) {
       case PARTITION_NONE:
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_modes_b(cpi, x, tile, w, tok, tok_end, mi_row, mi_col);
         break;
       case PARTITION_HORZ:
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_modes_b(cpi, x, tile, w, tok, tok_end, mi_row, mi_col);
         if (mi_row + bs < cm->mi_rows)
-          write_modes_b(cpi, tile, w, tok, tok_end, mi_row + bs, mi_col);
+          write_modes_b(cpi, x, tile, w, tok, tok_end, mi_row + bs, mi_col);
         break;
       case PARTITION_VERT:
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+        write_modes_b(cpi, x, tile, w, tok, tok_end, mi_row, mi_col);
         if (mi_col + bs < cm->mi_cols)
-          write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + bs);
+          write_modes_b(cpi, x, tile, w, tok, tok_end, mi_row, mi_col + bs);
         break;
       case PARTITION_SPLIT:
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, subsize);
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col + bs,
-                       subsize);
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row + bs, mi_col,
+        write_modes_sb(cpi, x, tile, w, tok, tok_end, mi_row, mi_col, subsize);
+        write_modes_sb(cpi, x, tile, w, tok, tok_end, mi_row, mi_col + bs,
                        subsize);
-        write_modes_sb(cpi, tile, w, tok, tok_end, mi_row + bs, mi_col + bs,
+        write_modes_sb(cpi, x, tile, w, tok, tok_end, mi_row + bs, mi_col,
                        subsize);
+        write_modes_sb(cpi, x, tile, w, tok, tok_end, mi_row + bs,
+                       mi_col + bs, subsize);
         break;
       default:
         assert(0);
@@ -521,20 +527,21 @@ static void write_modes_sb(VP9_COMP *cpi, const TileInfo *const tile,
   // update partition context
   if (bsize >= BLOCK_8X8 &&
       (bsize == BLOCK_8X8 || partition != PARTITION_SPLIT))
-    update_partition_context(cpi->above_seg_context, cpi->left_seg_context,
+    update_partition_context(cpi->above_seg_context, xd->left_seg_context,
                              mi_row, mi_col, subsize, bsize);
 }
 
-static void write_modes(VP9_COMP *cpi, const TileInfo *const tile,
-                        vp9_writer *w, TOKENEXTRA **tok, TOKENEXTRA *tok_end) {
+static void write_modes(VP9_COMP *cpi, MACROBLOCK *x,
+                        const TileInfo *const tile, vp9_writer *w,
+                        TOKENEXTRA **tok, TOKENEXTRA *tok_end) {
   int mi_row, mi_col;
 
   for (mi_row = tile->mi_row_start; mi_row < tile->mi_row_end;
        mi_row += MI_BLOCK_SIZE) {
-      vp9_zero(cpi->left_seg_context);
+      vp9_zero(x->e_mbd.left_seg_context);
     for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
          mi_col += MI_BLOCK_SIZE)
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, BLOCK_64X64);
+      write_modes_sb(cpi, x, tile, w, tok, tok_end, mi_row, mi_col, BLOCK_64X64);
   }
 }
 
@@ -1004,56 +1011,159 @@ static int get_refresh_mask(VP9_COMP *cpi) {
     }
 }
 
-static size_t encode_tiles(VP9_COMP *cpi, uint8_t *data_ptr) {
-  VP9_COMMON *const cm = &cpi->common;
-  vp9_writer residual_bc;
+typedef struct TileBuffer {
+  uint8_t *data;
+  size_t size;
+} TileBuffer;
+
+struct pack_tiles_args {
+  // Buffers the tiles are coded into when several workers code them. With a
+  // single worker it is NULL, and the tiles are coded straight into dest,
+  // each behind its size, size bytes in all.
+  TileBuffer (*tile_buffers)[1 << 6];
+  uint8_t *dest;
+  size_t size;
+};
+
+// Room for the coded data of a tile, by the same rule as the output buffer of
+// the codec interface.
+static size_t get_tile_buffer_size(const TileInfo *tile) {
+  const size_t width = (tile->mi_col_end - tile->mi_col_start) * MI_SIZE;
+  const size_t height = (tile->mi_row_end - tile->mi_row_start) * MI_SIZE;
+  return MAX(width * height * 3 / 2 * 8, 4096);
+}
 
-  int tile_row, tile_col;
-  TOKENEXTRA *tok[4][1 << 6], *tok_end;
-  size_t total_size = 0;
+static int pack_tiles_worker(void *arg1, void *arg2) {
+  EncWorkerData *const data = (EncWorkerData*)arg1;
+  struct pack_tiles_args *const args = (struct pack_tiles_args*)arg2;
+  VP9_COMP *const cpi = data->cpi;
+  VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCK *const x = &data->mb;
   const int tile_cols = 1 << cm->log2_tile_cols;
   const int tile_rows = 1 << cm->log2_tile_rows;
+  int tile_row, tile_col;
 
-  vpx_memset(cpi->above_seg_context, 0, sizeof(*cpi->above_seg_context) *
-             mi_cols_aligned_to_sb(cm->mi_cols));
-
-  tok[0][0] = cpi->tok;
-  for (tile_row = 0; tile_row < tile_rows; tile_row++) {
-    if (tile_row)
-      tok[tile_row][0] = tok[tile_row - 1][tile_cols - 1] +
-                         cpi->tok_count[tile_row - 1][tile_cols - 1];
-
-    for (tile_col = 1; tile_col < tile_cols; tile_col++)
-      tok[tile_row][tile_col] = tok[tile_row][tile_col - 1] +
-                                cpi->tok_count[tile_row][tile_col - 1];
-  }
-
-  for (tile_row = 0; tile_row < tile_rows; tile_row++) {
-    for (tile_col = 0; tile_col < tile_cols; tile_col++) {
+  x->e_mbd = cpi->mb.e_mbd;
+  vp9_zero(x->counts.inter_mode);
+  x->max_mv_magnitude = 0;
+
+  // The partition context above a tile is left by the tile above it, so the
+  // tiles of a column are written in order by the same worker.
+  for (tile_col = data->start; tile_col < tile_cols;
+       tile_col += data->num_workers) {
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+      const int has_size = tile_col < tile_cols - 1 ||
+                           tile_row < tile_rows - 1;
+      TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+      TOKENEXTRA *const tok_end = tok + cpi->tok_count[tile_row][tile_col];
       TileInfo tile;
+      vp9_writer residual_bc;
 
       vp9_tile_init(&tile, cm, tile_row, tile_col);
-      tok_end = tok[tile_row][tile_col] + cpi->tok_count[tile_row][tile_col];
-
-      if (tile_col < tile_cols - 1 || tile_row < tile_rows - 1)
-        vp9_start_encode(&residual_bc, data_ptr + total_size + 4);
+      if (args->tile_buffers)
+        vp9_start_encode(&residual_bc,
+                         args->tile_buffers[tile_row][tile_col].data);
       else
-        vp9_start_encode(&residual_bc, data_ptr + total_size);
-
-      write_modes(cpi, &tile, &residual_bc, &tok[tile_row][tile_col], tok_end);
-      assert(tok[tile_row][tile_col] == tok_end);
+        vp9_start_encode(&residual_bc,
+                         args->dest + args->size + (has_size ? 4 : 0));
+      write_modes(cpi, x, &tile, &residual_bc, &tok, tok_end);
+      assert(tok == tok_end);
       vp9_stop_encode(&residual_bc);
-      if (tile_col < tile_cols - 1 || tile_row < tile_rows - 1) {
+
+      if (args->tile_buffers) {
+        args->tile_buffers[tile_row][tile_col].size = residual_bc.pos;
+      } else {
         // size of this tile
-        write_be32(data_ptr + total_size, residual_bc.pos);
-        total_size += 4;
+        if (has_size) {
+          write_be32(args->dest + args->size, residual_bc.pos);
+          args->size += 4;
+        }
+        args->size += residual_bc.pos;
+      }
+    }
+  }
+  return 1;
+}
+
+static size_t encode_tiles(VP9_COMP *cpi, uint8_t *data_ptr) {
+  VP9_COMMON *const cm = &cpi->common;
+  TileBuffer tile_buffers[4][1 << 6];
+  struct pack_tiles_args args;
+  int tile_row, tile_col, i;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  const int num_workers = vp9_get_num_enc_workers(cpi, tile_cols);
+
+  args.tile_buffers = NULL;
+  args.dest = data_ptr;
+  args.size = 0;
+
+  // The size of every tile but the last one is only known once it is coded.
+  // A single worker codes the tiles in order and writes each size in front
+  // of its tile. Several workers code them into buffers of their own, which
+  // are moved into place after their size.
+  if (num_workers > 1) {
+    size_t buffer_size = 0;
+    for (tile_row = 0; tile_row < tile_rows; tile_row++) {
+      for (tile_col = 0; tile_col < tile_cols; tile_col++) {
+        TileInfo tile;
+        vp9_tile_init(&tile, cm, tile_row, tile_col);
+        buffer_size += get_tile_buffer_size(&tile);
       }
+    }
+    if (buffer_size > cpi->tile_buffer_size) {
+      vpx_free(cpi->tile_buffer);
+      cpi->tile_buffer_size = 0;
+      CHECK_MEM_ERROR(cm, cpi->tile_buffer, vpx_malloc(buffer_size));
+      cpi->tile_buffer_size = buffer_size;
+    }
 
-      total_size += residual_bc.pos;
+    buffer_size = 0;
+    for (tile_row = 0; tile_row < tile_rows; tile_row++) {
+      for (tile_col = 0; tile_col < tile_cols; tile_col++) {
+        TileInfo tile;
+        vp9_tile_init(&tile, cm, tile_row, tile_col);
+        tile_buffers[tile_row][tile_col].data = cpi->tile_buffer + buffer_size;
+        buffer_size += get_tile_buffer_size(&tile);
+      }
     }
+    args.tile_buffers = tile_buffers;
+  }
+
+  vpx_memset(cpi->above_seg_context, 0, sizeof(*cpi->above_seg_context) *
+             mi_cols_aligned_to_sb(cm->mi_cols));
+
+  vp9_run_enc_workers(cpi, pack_tiles_worker, &args, num_workers);
+
+  if (args.tile_buffers) {
+    for (tile_row = 0; tile_row < tile_rows; tile_row++) {
+      for (tile_col = 0; tile_col < tile_cols; tile_col++) {
+        const TileBuffer *const buf = &tile_buffers[tile_row][tile_col];
+        if (tile_col < tile_cols - 1 || tile_row < tile_rows - 1) {
+          // size of this tile
+          write_be32(data_ptr + args.size, (int)buf->size);
+          args.size += 4;
+        }
+
+        vpx_memcpy(data_ptr + args.size, buf->data, buf->size);
+        args.size += buf->size;
+      }
+    }
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    const EncWorkerData *const data =
+        (const EncWorkerData*)cpi->enc_workers[i].data1;
+    const MACROBLOCK *const x = &data->mb;
+    int j, k;
+
+    for (j = 0; j < INTER_MODE_CONTEXTS; ++j)
+      for (k = 0; k < INTER_MODES; ++k)
+        cm->counts.inter_mode[j][k] += x->counts.inter_mode[j][k];
+    cpi->max_mv_magnitude = MAX(cpi->max_mv_magnitude, x->max_mv_magnitude);
   }
 
-  return total_size;
+  return args.size;
 }
 
 static void write_display_size(const VP9_COMMON *cm,
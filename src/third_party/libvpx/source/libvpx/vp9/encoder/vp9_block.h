@@ -17,6 +17,9 @@
 #include "vpx_ports/mem.h"
 #include "vp9/common/vp9_onyxc_int.h"
 
+#define MAX_MODES 30
+#define MAX_REFS  6
+
 // motion search site
 typedef struct {
   MV mv;
@@ -87,6 +90,25 @@ typedef unsigned int vp9_coeff_cost[PLANE_TYPES][REF_TYPES][COEF_BANDS][2]
                                    [COEFF_CONTEXTS][ENTROPY_TOKENS];
 
 typedef struct macroblock MACROBLOCK;
+struct rdcost_block_args {
+  MACROBLOCK *x;
+  ENTROPY_CONTEXT t_above[16];
+  ENTROPY_CONTEXT t_left[16];
+  TX_SIZE tx_size;
+  int bw;
+  int bh;
+  int rate;
+  int64_t dist;
+  int64_t sse;
+  int this_rate;
+  int64_t this_dist;
+  int64_t this_sse;
+  int64_t this_rd;
+  int64_t best_rd;
+  int skip;
+  const int16_t *scan, *nb;
+};
+
 struct macroblock {
   struct macroblock_plane plane[MAX_MB_PLANE];
 
@@ -196,6 +218,31 @@ struct macroblock {
   BLOCK_SIZE sb64_partitioning;
 
   void (*fwd_txm4x4)(const int16_t *input, int16_t *output, int stride);
+
+  // Scratch state of the rd mode search for the current block.
+  struct rdcost_block_args rdcost_stack;
+  int64_t rd_filter_cache[SWITCHABLE_FILTER_CONTEXTS];
+  int64_t mask_filter_rd;
+  int64_t mode_skip_mask;
+  int ref_frame_mask;
+  int zbin_mode_boost;
+  BLOCK_SIZE min_partition_size;
+  BLOCK_SIZE max_partition_size;
+
+  // Adaptive rd threshold factors for mode selection.
+  int rd_thresh_freq_fact[BLOCK_SIZES][MAX_MODES];
+  int rd_thresh_freq_sub8x8[BLOCK_SIZES][MAX_REFS];
+
+  // Statistics of the blocks coded with this MACROBLOCK in the current frame.
+  // They are summed into the frame totals once every tile has been encoded.
+  FRAME_COUNTS counts;
+  vp9_coeff_count coef_counts[TX_SIZES][PLANE_TYPES];
+  int64_t rd_comp_pred_diff[REFERENCE_MODES];
+  int64_t rd_tx_select_diff[TX_MODES];
+  int64_t rd_filter_diff[SWITCHABLE_FILTER_CONTEXTS];
+  unsigned int mode_chosen_counts[MAX_MODES];
+  unsigned int tx_stepdown_count[TX_SIZES];
+  unsigned int max_mv_magnitude;
 };
 
 // TODO(jingning): the variables used here are little complicated. need further
@@ -235,23 +282,4 @@ static PICK_MODE_CONTEXT *get_block_context(MACROBLOCK *x, BLOCK_SIZE bsize) {
   }
 }
 
-struct rdcost_block_args {
-  MACROBLOCK *x;
-  ENTROPY_CONTEXT t_above[16];
-  ENTROPY_CONTEXT t_left[16];
-  TX_SIZE tx_size;
-  int bw;
-  int bh;
-  int rate;
-  int64_t dist;
-  int64_t sse;
-  int this_rate;
-  int64_t this_dist;
-  int64_t this_sse;
-  int64_t this_rd;
-  int64_t best_rd;
-  int skip;
-  const int16_t *scan, *nb;
-};
-
 #endif  // VP9_ENCODER_VP9_BLOCK_H_
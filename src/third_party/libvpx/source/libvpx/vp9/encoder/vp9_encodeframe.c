@@ -32,6 +32,7 @@
 #include "vp9/encoder/vp9_encodeframe.h"
 #include "vp9/encoder/vp9_encodemb.h"
 #include "vp9/encoder/vp9_encodemv.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_extend.h"
 #include "vp9/encoder/vp9_onyx_int.h"
 #include "vp9/encoder/vp9_pickmode.h"
@@ -73,7 +74,8 @@ static INLINE uint8_t *get_sb_index(MACROBLOCK *x, BLOCK_SIZE subsize) {
   }
 }
 
-static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
+static void encode_superblock(VP9_COMP *cpi, MACROBLOCK *const x,
+                              TOKENEXTRA **t, int output_enabled,
                               int mi_row, int mi_col, BLOCK_SIZE bsize);
 
 static void adjust_act_zbin(VP9_COMP *cpi, MACROBLOCK *x);
@@ -110,6 +112,20 @@ static unsigned int get_sby_perpixel_variance(VP9_COMP *cpi, MACROBLOCK *x,
   return ROUND_POWER_OF_TWO(var, num_pels_log2_lookup[bs]);
 }
 
+// Per pixel variance of the difference between the source block and the
+// co-located block of the last frame.
+static unsigned int get_sby_perpixel_diff_variance(VP9_COMP *cpi,
+                                                   MACROBLOCK *x,
+                                                   int mi_row, int mi_col,
+                                                   BLOCK_SIZE bs) {
+  const YV12_BUFFER_CONFIG *const last = get_ref_frame_buffer(cpi, LAST_FRAME);
+  const int offset = (mi_row * MI_SIZE) * last->y_stride + (mi_col * MI_SIZE);
+  unsigned int var, sse;
+  var = cpi->fn_ptr[bs].vf(x->plane[0].src.buf, x->plane[0].src.stride,
+                           last->y_buffer + offset, last->y_stride, &sse);
+  return ROUND_POWER_OF_TWO(var, num_pels_log2_lookup[bs]);
+}
+
 // Original activity measure from Tim T's code.
 static unsigned int tt_activity_measure(MACROBLOCK *x) {
   unsigned int sse;
@@ -394,11 +410,11 @@ static void select_in_frame_q_segment(VP9_COMP *cpi,
   }
 }
 
-static void update_state(VP9_COMP *cpi, PICK_MODE_CONTEXT *ctx,
+static void update_state(VP9_COMP *cpi, MACROBLOCK *const x,
+                         PICK_MODE_CONTEXT *ctx,
                          BLOCK_SIZE bsize, int output_enabled) {
   int i, x_idx, y;
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   struct macroblock_plane *const p = x->plane;
   struct macroblockd_plane *const pd = xd->plane;
@@ -475,7 +491,7 @@ static void update_state(VP9_COMP *cpi, PICK_MODE_CONTEXT *ctx,
 
   if (!vp9_segfeature_active(&cm->seg, mbmi->segment_id, SEG_LVL_SKIP)) {
     for (i = 0; i < TX_MODES; i++)
-      cpi->rd_tx_select_diff[i] += ctx->tx_rd_diff[i];
+      x->rd_tx_select_diff[i] += ctx->tx_rd_diff[i];
   }
 
   if (frame_is_intra_only(cm)) {
@@ -492,11 +508,11 @@ static void update_state(VP9_COMP *cpi, PICK_MODE_CONTEXT *ctx,
       THR_D63_PRED /*D63_PRED*/,
       THR_TM /*TM_PRED*/,
     };
-    cpi->mode_chosen_counts[kf_mode_index[mi->mbmi.mode]]++;
+    x->mode_chosen_counts[kf_mode_index[mi->mbmi.mode]]++;
 #endif
   } else {
     // Note how often each mode chosen as best
-    cpi->mode_chosen_counts[mb_mode_index]++;
+    x->mode_chosen_counts[mb_mode_index]++;
     if (is_inter_block(mbmi) &&
         (mbmi->sb_type < BLOCK_8X8 || mbmi->mode == NEWMV)) {
       int_mv best_mv[2];
@@ -516,15 +532,15 @@ static void update_state(VP9_COMP *cpi, PICK_MODE_CONTEXT *ctx,
 
     if (cm->mcomp_filter_type == SWITCHABLE && is_inter_mode(mbmi->mode)) {
       const int ctx = vp9_get_pred_context_switchable_interp(xd);
-      ++cm->counts.switchable_interp[ctx][mbmi->interp_filter];
+      ++x->counts.switchable_interp[ctx][mbmi->interp_filter];
     }
 
-    cpi->rd_comp_pred_diff[SINGLE_REFERENCE] += ctx->single_pred_diff;
-    cpi->rd_comp_pred_diff[COMPOUND_REFERENCE] += ctx->comp_pred_diff;
-    cpi->rd_comp_pred_diff[REFERENCE_MODE_SELECT] += ctx->hybrid_pred_diff;
+    x->rd_comp_pred_diff[SINGLE_REFERENCE] += ctx->single_pred_diff;
+    x->rd_comp_pred_diff[COMPOUND_REFERENCE] += ctx->comp_pred_diff;
+    x->rd_comp_pred_diff[REFERENCE_MODE_SELECT] += ctx->hybrid_pred_diff;
 
     for (i = 0; i < SWITCHABLE_FILTER_CONTEXTS; i++)
-      cpi->rd_filter_diff[i] += ctx->best_filter_diff[i];
+      x->rd_filter_diff[i] += ctx->best_filter_diff[i];
   }
 }
 
@@ -545,9 +561,9 @@ void vp9_setup_src_planes(MACROBLOCK *x, const YV12_BUFFER_CONFIG *src,
                      x->e_mbd.plane[i].subsampling_y);
 }
 
-static void set_offsets(VP9_COMP *cpi, const TileInfo *const tile,
+static void set_offsets(VP9_COMP *cpi, MACROBLOCK *const x,
+                        const TileInfo *const tile,
                         int mi_row, int mi_col, BLOCK_SIZE bsize) {
-  MACROBLOCK *const x = &cpi->mb;
   VP9_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
   MB_MODE_INFO *mbmi;
@@ -559,7 +575,7 @@ static void set_offsets(VP9_COMP *cpi, const TileInfo *const tile,
   const int idx_map = mb_row * cm->mb_cols + mb_col;
   const struct segmentation *const seg = &cm->seg;
 
-  set_skip_context(xd, cpi->above_context, cpi->left_context, mi_row, mi_col);
+  set_skip_context(xd, cpi->above_context, xd->left_context, mi_row, mi_col);
 
   // Activity map pointer
   x->mb_activity_ptr = &cpi->mb_activity_map[idx_map];
@@ -607,22 +623,6 @@ static void set_offsets(VP9_COMP *cpi, const TileInfo *const tile,
     }
     vp9_mb_init_quantizer(cpi, x);
 
-    if (seg->enabled && cpi->seg0_cnt > 0 &&
-        !vp9_segfeature_active(seg, 0, SEG_LVL_REF_FRAME) &&
-        vp9_segfeature_active(seg, 1, SEG_LVL_REF_FRAME)) {
-      cpi->seg0_progress = (cpi->seg0_idx << 16) / cpi->seg0_cnt;
-    } else {
-      const int y = mb_row & ~3;
-      const int x = mb_col & ~3;
-      const int p16 = ((mb_row & 1) << 1) + (mb_col & 1);
-      const int p32 = ((mb_row & 2) << 2) + ((mb_col & 2) << 1);
-      const int tile_progress = tile->mi_col_start * cm->mb_rows >> 1;
-      const int mb_cols = (tile->mi_col_end - tile->mi_col_start) >> 1;
-
-      cpi->seg0_progress = ((y * mb_cols + x * 4 + p32 + p16 + tile_progress)
-          << 16) / cm->MBs;
-    }
-
     x->encode_breakout = cpi->segment_encode_breakout[mbmi->segment_id];
   } else {
     mbmi->segment_id = 0;
@@ -630,13 +630,12 @@ static void set_offsets(VP9_COMP *cpi, const TileInfo *const tile,
   }
 }
 
-static void rd_pick_sb_modes(VP9_COMP *cpi, const TileInfo *const tile,
-                             int mi_row, int mi_col,
+static void rd_pick_sb_modes(VP9_COMP *cpi, MACROBLOCK *const x,
+                             const TileInfo *const tile, int mi_row, int mi_col,
                              int *totalrate, int64_t *totaldist,
                              BLOCK_SIZE bsize, PICK_MODE_CONTEXT *ctx,
                              int64_t best_rd) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   struct macroblock_plane *const p = x->plane;
   struct macroblockd_plane *const pd = xd->plane;
@@ -660,7 +659,7 @@ static void rd_pick_sb_modes(VP9_COMP *cpi, const TileInfo *const tile,
     }
   }
 
-  set_offsets(cpi, tile, mi_row, mi_col, bsize);
+  set_offsets(cpi, x, tile, mi_row, mi_col, bsize);
   xd->mi_8x8[0]->mbmi.sb_type = bsize;
 
   for (i = 0; i < MAX_MB_PLANE; ++i) {
@@ -707,7 +706,10 @@ static void rd_pick_sb_modes(VP9_COMP *cpi, const TileInfo *const tile,
     vp9_rd_pick_intra_mode_sb(cpi, x, totalrate, totaldist, bsize, ctx,
                               best_rd);
   } else {
-    if (bsize >= BLOCK_8X8)
+    if (bsize >= BLOCK_8X8 && cpi->sf.use_pick_mode)
+      vp9_pick_inter_mode(cpi, x, tile, mi_row, mi_col,
+                          totalrate, totaldist, bsize, ctx);
+    else if (bsize >= BLOCK_8X8)
       vp9_rd_pick_inter_mode_sb(cpi, x, tile, mi_row, mi_col,
                                 totalrate, totaldist, bsize, ctx, best_rd);
     else
@@ -724,9 +726,8 @@ static void rd_pick_sb_modes(VP9_COMP *cpi, const TileInfo *const tile,
   }
 }
 
-static void update_stats(VP9_COMP *cpi) {
+static void update_stats(VP9_COMP *cpi, MACROBLOCK *const x) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO *mi = xd->mi_8x8[0];
   MB_MODE_INFO *const mbmi = &mi->mbmi;
@@ -736,26 +737,26 @@ static void update_stats(VP9_COMP *cpi) {
                                                      SEG_LVL_REF_FRAME);
 
     if (!seg_ref_active)
-      cm->counts.intra_inter[vp9_get_intra_inter_context(xd)]
-                            [is_inter_block(mbmi)]++;
+      x->counts.intra_inter[vp9_get_intra_inter_context(xd)]
+                           [is_inter_block(mbmi)]++;
 
     // If the segment reference feature is enabled we have only a single
     // reference frame allowed for the segment so exclude it from
     // the reference frame counts used to work out probabilities.
     if (is_inter_block(mbmi) && !seg_ref_active) {
       if (cm->reference_mode == REFERENCE_MODE_SELECT)
-        cm->counts.comp_inter[vp9_get_reference_mode_context(cm, xd)]
-                             [has_second_ref(mbmi)]++;
+        x->counts.comp_inter[vp9_get_reference_mode_context(cm, xd)]
+                            [has_second_ref(mbmi)]++;
 
       if (has_second_ref(mbmi)) {
-        cm->counts.comp_ref[vp9_get_pred_context_comp_ref_p(cm, xd)]
-                           [mbmi->ref_frame[0] == GOLDEN_FRAME]++;
+        x->counts.comp_ref[vp9_get_pred_context_comp_ref_p(cm, xd)]
+                          [mbmi->ref_frame[0] == GOLDEN_FRAME]++;
       } else {
-        cm->counts.single_ref[vp9_get_pred_context_single_ref_p1(xd)][0]
-                             [mbmi->ref_frame[0] != LAST_FRAME]++;
+        x->counts.single_ref[vp9_get_pred_context_single_ref_p1(xd)][0]
+                            [mbmi->ref_frame[0] != LAST_FRAME]++;
         if (mbmi->ref_frame[0] != LAST_FRAME)
-          cm->counts.single_ref[vp9_get_pred_context_single_ref_p2(xd)][1]
-                               [mbmi->ref_frame[0] != GOLDEN_FRAME]++;
+          x->counts.single_ref[vp9_get_pred_context_single_ref_p2(xd)][1]
+                              [mbmi->ref_frame[0] != GOLDEN_FRAME]++;
       }
     }
   }
@@ -777,12 +778,12 @@ static BLOCK_SIZE *get_sb_partitioning(MACROBLOCK *x, BLOCK_SIZE bsize) {
   }
 }
 
-static void restore_context(VP9_COMP *cpi, int mi_row, int mi_col,
+static void restore_context(VP9_COMP *cpi, MACROBLOCK *const x,
+                            int mi_row, int mi_col,
                             ENTROPY_CONTEXT a[16 * MAX_MB_PLANE],
                             ENTROPY_CONTEXT l[16 * MAX_MB_PLANE],
                             PARTITION_CONTEXT sa[8], PARTITION_CONTEXT sl[8],
                             BLOCK_SIZE bsize) {
-  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   int p;
   const int num_4x4_blocks_wide = num_4x4_blocks_wide_lookup[bsize];
@@ -796,7 +797,7 @@ static void restore_context(VP9_COMP *cpi, int mi_row, int mi_col,
         (sizeof(ENTROPY_CONTEXT) * num_4x4_blocks_wide) >>
         xd->plane[p].subsampling_x);
     vpx_memcpy(
-        cpi->left_context[p]
+        xd->left_context[p]
             + ((mi_row & MI_MASK) * 2 >> xd->plane[p].subsampling_y),
         l + num_4x4_blocks_high * p,
         (sizeof(ENTROPY_CONTEXT) * num_4x4_blocks_high) >>
@@ -804,15 +805,15 @@ static void restore_context(VP9_COMP *cpi, int mi_row, int mi_col,
   }
   vpx_memcpy(cpi->above_seg_context + mi_col, sa,
              sizeof(*cpi->above_seg_context) * mi_width);
-  vpx_memcpy(cpi->left_seg_context + (mi_row & MI_MASK), sl,
-             sizeof(cpi->left_seg_context[0]) * mi_height);
+  vpx_memcpy(xd->left_seg_context + (mi_row & MI_MASK), sl,
+             sizeof(xd->left_seg_context[0]) * mi_height);
 }
-static void save_context(VP9_COMP *cpi, int mi_row, int mi_col,
+static void save_context(VP9_COMP *cpi, MACROBLOCK *const x,
+                         int mi_row, int mi_col,
                          ENTROPY_CONTEXT a[16 * MAX_MB_PLANE],
                          ENTROPY_CONTEXT l[16 * MAX_MB_PLANE],
                          PARTITION_CONTEXT sa[8], PARTITION_CONTEXT sl[8],
                          BLOCK_SIZE bsize) {
-  const MACROBLOCK *const x = &cpi->mb;
   const MACROBLOCKD *const xd = &x->e_mbd;
   int p;
   const int num_4x4_blocks_wide = num_4x4_blocks_wide_lookup[bsize];
@@ -829,21 +830,21 @@ static void save_context(VP9_COMP *cpi, int mi_row, int mi_col,
         xd->plane[p].subsampling_x);
     vpx_memcpy(
         l + num_4x4_blocks_high * p,
-        cpi->left_context[p]
+        xd->left_context[p]
             + ((mi_row & MI_MASK) * 2 >> xd->plane[p].subsampling_y),
         (sizeof(ENTROPY_CONTEXT) * num_4x4_blocks_high) >>
         xd->plane[p].subsampling_y);
   }
   vpx_memcpy(sa, cpi->above_seg_context + mi_col,
              sizeof(*cpi->above_seg_context) * mi_width);
-  vpx_memcpy(sl, cpi->left_seg_context + (mi_row & MI_MASK),
-             sizeof(cpi->left_seg_context[0]) * mi_height);
+  vpx_memcpy(sl, xd->left_seg_context + (mi_row & MI_MASK),
+             sizeof(xd->left_seg_context[0]) * mi_height);
 }
 
-static void encode_b(VP9_COMP *cpi, const TileInfo *const tile,
+static void encode_b(VP9_COMP *cpi, MACROBLOCK *const x,
+                     const TileInfo *const tile,
                      TOKENEXTRA **tp, int mi_row, int mi_col,
                      int output_enabled, BLOCK_SIZE bsize) {
-  MACROBLOCK *const x = &cpi->mb;
 
   if (bsize < BLOCK_8X8) {
     // When ab_index = 0 all sub-blocks are handled, so for ab_index != 0
@@ -851,23 +852,24 @@ static void encode_b(VP9_COMP *cpi, const TileInfo *const tile,
     if (x->ab_index > 0)
       return;
   }
-  set_offsets(cpi, tile, mi_row, mi_col, bsize);
-  update_state(cpi, get_block_context(x, bsize), bsize, output_enabled);
-  encode_superblock(cpi, tp, output_enabled, mi_row, mi_col, bsize);
+  set_offsets(cpi, x, tile, mi_row, mi_col, bsize);
+  update_state(cpi, x, get_block_context(x, bsize), bsize, output_enabled);
+  encode_superblock(cpi, x, tp, output_enabled, mi_row, mi_col, bsize);
 
   if (output_enabled) {
-    update_stats(cpi);
+    update_stats(cpi, x);
 
     (*tp)->token = EOSB_TOKEN;
     (*tp)++;
   }
 }
 
-static void encode_sb(VP9_COMP *cpi, const TileInfo *const tile,
+static void encode_sb(VP9_COMP *cpi, MACROBLOCK *const x,
+                      const TileInfo *const tile,
                       TOKENEXTRA **tp, int mi_row, int mi_col,
                       int output_enabled, BLOCK_SIZE bsize) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
   const int bsl = b_width_log2(bsize), hbs = (1 << bsl) / 4;
   int ctx;
   PARTITION_TYPE partition;
@@ -877,7 +879,7 @@ static void encode_sb(VP9_COMP *cpi, const TileInfo *const tile,
     return;
 
   if (bsize >= BLOCK_8X8) {
-    ctx = partition_plane_context(cpi->above_seg_context, cpi->left_seg_context,
+    ctx = partition_plane_context(cpi->above_seg_context, xd->left_seg_context,
                                  mi_row, mi_col, bsize);
     subsize = *get_sb_partitioning(x, bsize);
   } else {
@@ -890,42 +892,46 @@ static void encode_sb(VP9_COMP *cpi, const TileInfo *const tile,
   switch (partition) {
     case PARTITION_NONE:
       if (output_enabled && bsize >= BLOCK_8X8)
-        cm->counts.partition[ctx][PARTITION_NONE]++;
-      encode_b(cpi, tile, tp, mi_row, mi_col, output_enabled, subsize);
+        x->counts.partition[ctx][PARTITION_NONE]++;
+      encode_b(cpi, x, tile, tp, mi_row, mi_col, output_enabled, subsize);
       break;
     case PARTITION_VERT:
       if (output_enabled)
-        cm->counts.partition[ctx][PARTITION_VERT]++;
+        x->counts.partition[ctx][PARTITION_VERT]++;
       *get_sb_index(x, subsize) = 0;
-      encode_b(cpi, tile, tp, mi_row, mi_col, output_enabled, subsize);
+      encode_b(cpi, x, tile, tp, mi_row, mi_col, output_enabled, subsize);
       if (mi_col + hbs < cm->mi_cols) {
         *get_sb_index(x, subsize) = 1;
-        encode_b(cpi, tile, tp, mi_row, mi_col + hbs, output_enabled, subsize);
+        encode_b(cpi, x, tile, tp, mi_row, mi_col + hbs, output_enabled,
+                 subsize);
       }
       break;
     case PARTITION_HORZ:
       if (output_enabled)
-        cm->counts.partition[ctx][PARTITION_HORZ]++;
+        x->counts.partition[ctx][PARTITION_HORZ]++;
       *get_sb_index(x, subsize) = 0;
-      encode_b(cpi, tile, tp, mi_row, mi_col, output_enabled, subsize);
+      encode_b(cpi, x, tile, tp, mi_row, mi_col, output_enabled, subsize);
       if (mi_row + hbs < cm->mi_rows) {
         *get_sb_index(x, subsize) = 1;
-        encode_b(cpi, tile, tp, mi_row + hbs, mi_col, output_enabled, subsize);
+        encode_b(cpi, x, tile, tp, mi_row + hbs, mi_col, output_enabled,
+                 subsize);
       }
       break;
     case PARTITION_SPLIT:
       subsize = get_subsize(bsize, PARTITION_SPLIT);
       if (output_enabled)
-        cm->counts.partition[ctx][PARTITION_SPLIT]++;
+        x->counts.partition[ctx][PARTITION_SPLIT]++;
 
       *get_sb_index(x, subsize) = 0;
-      encode_sb(cpi, tile, tp, mi_row, mi_col, output_enabled, subsize);
+      encode_sb(cpi, x, tile, tp, mi_row, mi_col, output_enabled, subsize);
       *get_sb_index(x, subsize) = 1;
-      encode_sb(cpi, tile, tp, mi_row, mi_col + hbs, output_enabled, subsize);
+      encode_sb(cpi, x, tile, tp, mi_row, mi_col + hbs, output_enabled,
+                subsize);
       *get_sb_index(x, subsize) = 2;
-      encode_sb(cpi, tile, tp, mi_row + hbs, mi_col, output_enabled, subsize);
+      encode_sb(cpi, x, tile, tp, mi_row + hbs, mi_col, output_enabled,
+                subsize);
       *get_sb_index(x, subsize) = 3;
-      encode_sb(cpi, tile, tp, mi_row + hbs, mi_col + hbs, output_enabled,
+      encode_sb(cpi, x, tile, tp, mi_row + hbs, mi_col + hbs, output_enabled,
                 subsize);
       break;
     default:
@@ -933,7 +939,7 @@ static void encode_sb(VP9_COMP *cpi, const TileInfo *const tile,
   }
 
   if (partition != PARTITION_SPLIT || bsize == BLOCK_8X8)
-    update_partition_context(cpi->above_seg_context, cpi->left_seg_context,
+    update_partition_context(cpi->above_seg_context, xd->left_seg_context,
                              mi_row, mi_col, subsize, bsize);
 }
 
@@ -963,9 +969,10 @@ static BLOCK_SIZE find_partition_size(BLOCK_SIZE bsize,
 // may not be allowed in which case this code attempts to choose the largest
 // allowable partition.
 static void set_partitioning(VP9_COMP *cpi, const TileInfo *const tile,
-                             MODE_INFO **mi_8x8, int mi_row, int mi_col) {
+                             MODE_INFO **mi_8x8, int mi_row, int mi_col,
+                             BLOCK_SIZE bsize) {
   VP9_COMMON *const cm = &cpi->common;
-  BLOCK_SIZE bsize = cpi->sf.always_this_block_size;
+  const BLOCK_SIZE requested_bsize = bsize;
   const int mis = cm->mode_info_stride;
   int row8x8_remaining = tile->mi_row_end - mi_row;
   int col8x8_remaining = tile->mi_col_end - mi_col;
@@ -992,7 +999,7 @@ static void set_partitioning(VP9_COMP *cpi, const TileInfo *const tile,
       for (block_col = 0; block_col < MI_BLOCK_SIZE; block_col += bw) {
         int index = block_row * mis + block_col;
         // Find a partition size that fits
-        bsize = find_partition_size(cpi->sf.always_this_block_size,
+        bsize = find_partition_size(requested_bsize,
                                     (row8x8_remaining - block_row),
                                     (col8x8_remaining - block_col), &bh, &bw);
         mi_8x8[index] = mi_upper_left + index;
@@ -1002,6 +1009,35 @@ static void set_partitioning(VP9_COMP *cpi, const TileInfo *const tile,
   }
 }
 
+// Returns the block size the SB64 at mi_row, mi_col is partitioned into when
+// the partition search is skipped. For VAR_BASED_FIXED_PARTITION the size
+// shrinks as the SB64 changes more from the co-located one of the last frame.
+// x->plane[0].src must already point at the SB64.
+static BLOCK_SIZE get_fixed_partition_size(VP9_COMP *cpi, MACROBLOCK *x,
+                                           const TileInfo *const tile,
+                                           int mi_row, int mi_col) {
+  VP9_COMMON *const cm = &cpi->common;
+  unsigned int var;
+
+  if (cpi->sf.partition_search_type != VAR_BASED_FIXED_PARTITION ||
+      frame_is_intra_only(cm) ||
+      !(cpi->ref_frame_flags & VP9_LAST_FLAG) ||
+      vp9_is_scaled(&cm->frame_refs[LAST_FRAME - 1].sf) ||
+      tile->mi_row_end - mi_row < MI_BLOCK_SIZE ||
+      tile->mi_col_end - mi_col < MI_BLOCK_SIZE)
+    return cpi->sf.always_this_block_size;
+
+  var = get_sby_perpixel_diff_variance(cpi, x, mi_row, mi_col, BLOCK_64X64);
+  if (var < 8)
+    return BLOCK_64X64;
+  else if (var < 128)
+    return BLOCK_32X32;
+  else if (var < 2048)
+    return BLOCK_16X16;
+  else
+    return BLOCK_8X8;
+}
+
 static void copy_partitioning(VP9_COMMON *cm, MODE_INFO **mi_8x8,
                               MODE_INFO **prev_mi_8x8) {
   const int mis = cm->mode_info_stride;
@@ -1039,30 +1075,33 @@ static int sb_has_motion(const VP9_COMMON *cm, MODE_INFO **prev_mi_8x8) {
   return 0;
 }
 
-// TODO(jingning) This currently serves as a test framework for non-RD mode
-// decision. To be continued on optimizing the partition type decisions.
-static void pick_partition_type(VP9_COMP *cpi,
+// Codes an SB with the partitioning already stored in mi_8x8, choosing the
+// mode of each block with the non-RD mode decision of vp9_pickmode.c.
+// TODO(jingning) Search the partition type too instead of taking it as given.
+static void pick_partition_type(VP9_COMP *cpi, MACROBLOCK *const x,
                                 const TileInfo *const tile,
                                 MODE_INFO **mi_8x8, TOKENEXTRA **tp,
                                 int mi_row, int mi_col,
                                 BLOCK_SIZE bsize, int *rate, int64_t *dist,
                                 int do_recon) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
-  const int mi_stride = cm->mode_info_stride;
+  const int mis = cm->mode_info_stride;
+  const int bsl = b_width_log2(bsize);
   const int num_8x8_subsize = (num_8x8_blocks_wide_lookup[bsize] >> 1);
+  const int bss = (1 << bsl) / 4;
   int i;
   PARTITION_TYPE partition = PARTITION_NONE;
   BLOCK_SIZE subsize;
   BLOCK_SIZE bs_type = mi_8x8[0]->mbmi.sb_type;
+  ENTROPY_CONTEXT l[16 * MAX_MB_PLANE], a[16 * MAX_MB_PLANE];
+  PARTITION_CONTEXT sl[8], sa[8];
   int sub_rate[4] = {0};
   int64_t sub_dist[4] = {0};
-  int mi_offset;
 
   if (mi_row >= cm->mi_rows || mi_col >= cm->mi_cols)
     return;
 
-  partition = partition_lookup[b_width_log2(bsize)][bs_type];
+  partition = partition_lookup[bsl][bs_type];
   subsize = get_subsize(bsize, partition);
 
   if (bsize < BLOCK_8X8) {
@@ -1076,21 +1115,30 @@ static void pick_partition_type(VP9_COMP *cpi,
   } else {
     *(get_sb_partitioning(x, bsize)) = subsize;
   }
+  save_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
+
+  if (bsize == BLOCK_16X16) {
+    set_offsets(cpi, x, tile, mi_row, mi_col, bsize);
+    x->mb_energy = vp9_block_energy(cpi, x, bsize);
+  }
+
+  *rate = 0;
+  *dist = 0;
 
   switch (partition) {
     case PARTITION_NONE:
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, rate, dist,
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, rate, dist,
                        bsize, get_block_context(x, bsize), INT64_MAX);
       break;
     case PARTITION_HORZ:
       *get_sb_index(x, subsize) = 0;
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &sub_rate[0], &sub_dist[0],
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &sub_rate[0], &sub_dist[0],
                        subsize, get_block_context(x, subsize), INT64_MAX);
       if (bsize >= BLOCK_8X8 && mi_row + num_8x8_subsize < cm->mi_rows) {
-        update_state(cpi, get_block_context(x, subsize), subsize, 0);
-        encode_superblock(cpi, tp, 0, mi_row, mi_col, subsize);
+        update_state(cpi, x, get_block_context(x, subsize), subsize, 0);
+        encode_superblock(cpi, x, tp, 0, mi_row, mi_col, subsize);
         *get_sb_index(x, subsize) = 1;
-        rd_pick_sb_modes(cpi, tile, mi_row + num_8x8_subsize, mi_col,
+        rd_pick_sb_modes(cpi, x, tile, mi_row + num_8x8_subsize, mi_col,
                          &sub_rate[1], &sub_dist[1], subsize,
                          get_block_context(x, subsize), INT64_MAX);
       }
@@ -1099,57 +1147,44 @@ static void pick_partition_type(VP9_COMP *cpi,
       break;
     case PARTITION_VERT:
       *get_sb_index(x, subsize) = 0;
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &sub_rate[0], &sub_dist[0],
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &sub_rate[0], &sub_dist[0],
                        subsize, get_block_context(x, subsize), INT64_MAX);
       if (bsize >= BLOCK_8X8 && mi_col + num_8x8_subsize < cm->mi_cols) {
-        update_state(cpi, get_block_context(x, subsize), subsize, 0);
-        encode_superblock(cpi, tp, 0, mi_row, mi_col, subsize);
+        update_state(cpi, x, get_block_context(x, subsize), subsize, 0);
+        encode_superblock(cpi, x, tp, 0, mi_row, mi_col, subsize);
         *get_sb_index(x, subsize) = 1;
-        rd_pick_sb_modes(cpi, tile, mi_row, mi_col + num_8x8_subsize,
+        rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col + num_8x8_subsize,
                          &sub_rate[1], &sub_dist[1], subsize,
                          get_block_context(x, subsize), INT64_MAX);
       }
       *rate = sub_rate[0] + sub_rate[1];
-      *dist = sub_dist[1] + sub_dist[1];
+      *dist = sub_dist[0] + sub_dist[1];
       break;
     case PARTITION_SPLIT:
-      *get_sb_index(x, subsize) = 0;
-      pick_partition_type(cpi, tile, mi_8x8, tp, mi_row, mi_col, subsize,
-                          &sub_rate[0], &sub_dist[0], 0);
-
-      if ((mi_col + num_8x8_subsize) < cm->mi_cols) {
-        *get_sb_index(x, subsize) = 1;
-        pick_partition_type(cpi, tile, mi_8x8 + num_8x8_subsize, tp,
-                            mi_row, mi_col + num_8x8_subsize, subsize,
-                            &sub_rate[1], &sub_dist[1], 0);
-      }
-
-      if ((mi_row + num_8x8_subsize) < cm->mi_rows) {
-        *get_sb_index(x, subsize) = 2;
-        pick_partition_type(cpi, tile, mi_8x8 + num_8x8_subsize * mi_stride, tp,
-                            mi_row + num_8x8_subsize, mi_col, subsize,
-                            &sub_rate[2], &sub_dist[2], 0);
-      }
+      for (i = 0; i < 4; ++i) {
+        const int x_idx = (i & 1) * num_8x8_subsize;
+        const int y_idx = (i >> 1) * num_8x8_subsize;
+        const int jj = i >> 1, ii = i & 0x01;
 
-      if ((mi_col + num_8x8_subsize) < cm->mi_cols &&
-          (mi_row + num_8x8_subsize) < cm->mi_rows) {
-        *get_sb_index(x, subsize) = 3;
-        mi_offset = num_8x8_subsize * mi_stride + num_8x8_subsize;
-        pick_partition_type(cpi, tile, mi_8x8 + mi_offset, tp,
-                            mi_row + num_8x8_subsize, mi_col + num_8x8_subsize,
-                            subsize, &sub_rate[3], &sub_dist[3], 0);
-      }
+        if ((mi_row + y_idx >= cm->mi_rows) || (mi_col + x_idx >= cm->mi_cols))
+          continue;
 
-      for (i = 0; i < 4; ++i) {
+        *get_sb_index(x, subsize) = i;
+        // Each sub-block is reconstructed, except for the last one, so that
+        // the next one predicts from it.
+        pick_partition_type(cpi, x, tile, mi_8x8 + jj * bss * mis + ii * bss,
+                            tp, mi_row + y_idx, mi_col + x_idx, subsize,
+                            &sub_rate[i], &sub_dist[i], i != 3);
         *rate += sub_rate[i];
         *dist += sub_dist[i];
       }
-
       break;
     default:
       assert(0);
   }
 
+  restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
+
   if (do_recon) {
     int output_enabled = (bsize == BLOCK_64X64);
 
@@ -1161,18 +1196,18 @@ static void pick_partition_type(VP9_COMP *cpi,
                                 output_enabled, *rate);
     }
 
-    encode_sb(cpi, tile, tp, mi_row, mi_col, output_enabled, bsize);
+    encode_sb(cpi, x, tile, tp, mi_row, mi_col, output_enabled, bsize);
   }
 }
 
-static void rd_use_partition(VP9_COMP *cpi,
+static void rd_use_partition(VP9_COMP *cpi, MACROBLOCK *const x,
                              const TileInfo *const tile,
                              MODE_INFO **mi_8x8,
                              TOKENEXTRA **tp, int mi_row, int mi_col,
                              BLOCK_SIZE bsize, int *rate, int64_t *dist,
                              int do_recon) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
   const int mis = cm->mode_info_stride;
   const int bsl = b_width_log2(bsize);
   const int num_4x4_blocks_wide = num_4x4_blocks_wide_lookup[bsize];
@@ -1214,10 +1249,10 @@ static void rd_use_partition(VP9_COMP *cpi,
   } else {
     *(get_sb_partitioning(x, bsize)) = subsize;
   }
-  save_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+  save_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
 
   if (bsize == BLOCK_16X16) {
-    set_offsets(cpi, tile, mi_row, mi_col, bsize);
+    set_offsets(cpi, x, tile, mi_row, mi_col, bsize);
     x->mb_energy = vp9_block_energy(cpi, x, bsize);
   }
 
@@ -1244,15 +1279,15 @@ static void rd_use_partition(VP9_COMP *cpi,
         mi_row + (ms >> 1) < cm->mi_rows &&
         mi_col + (ms >> 1) < cm->mi_cols) {
       *(get_sb_partitioning(x, bsize)) = bsize;
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &none_rate, &none_dist, bsize,
-                       get_block_context(x, bsize), INT64_MAX);
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &none_rate, &none_dist,
+                       bsize, get_block_context(x, bsize), INT64_MAX);
 
       pl = partition_plane_context(cpi->above_seg_context,
-                                   cpi->left_seg_context,
+                                   xd->left_seg_context,
                                    mi_row, mi_col, bsize);
       none_rate += x->partition_cost[pl][PARTITION_NONE];
 
-      restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+      restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
       mi_8x8[0]->mbmi.sb_type = bs_type;
       *(get_sb_partitioning(x, bsize)) = subsize;
     }
@@ -1260,23 +1295,23 @@ static void rd_use_partition(VP9_COMP *cpi,
 
   switch (partition) {
     case PARTITION_NONE:
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &last_part_rate,
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &last_part_rate,
                        &last_part_dist, bsize,
                        get_block_context(x, bsize), INT64_MAX);
       break;
     case PARTITION_HORZ:
       *get_sb_index(x, subsize) = 0;
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &last_part_rate,
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &last_part_rate,
                        &last_part_dist, subsize,
                        get_block_context(x, subsize), INT64_MAX);
       if (last_part_rate != INT_MAX &&
           bsize >= BLOCK_8X8 && mi_row + (mh >> 1) < cm->mi_rows) {
         int rt = 0;
         int64_t dt = 0;
-        update_state(cpi, get_block_context(x, subsize), subsize, 0);
-        encode_superblock(cpi, tp, 0, mi_row, mi_col, subsize);
+        update_state(cpi, x, get_block_context(x, subsize), subsize, 0);
+        encode_superblock(cpi, x, tp, 0, mi_row, mi_col, subsize);
         *get_sb_index(x, subsize) = 1;
-        rd_pick_sb_modes(cpi, tile, mi_row + (ms >> 1), mi_col, &rt, &dt,
+        rd_pick_sb_modes(cpi, x, tile, mi_row + (ms >> 1), mi_col, &rt, &dt,
                          subsize, get_block_context(x, subsize), INT64_MAX);
         if (rt == INT_MAX || dt == INT_MAX) {
           last_part_rate = INT_MAX;
@@ -1290,17 +1325,17 @@ static void rd_use_partition(VP9_COMP *cpi,
       break;
     case PARTITION_VERT:
       *get_sb_index(x, subsize) = 0;
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &last_part_rate,
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &last_part_rate,
                        &last_part_dist, subsize,
                        get_block_context(x, subsize), INT64_MAX);
       if (last_part_rate != INT_MAX &&
           bsize >= BLOCK_8X8 && mi_col + (ms >> 1) < cm->mi_cols) {
         int rt = 0;
         int64_t dt = 0;
-        update_state(cpi, get_block_context(x, subsize), subsize, 0);
-        encode_superblock(cpi, tp, 0, mi_row, mi_col, subsize);
+        update_state(cpi, x, get_block_context(x, subsize), subsize, 0);
+        encode_superblock(cpi, x, tp, 0, mi_row, mi_col, subsize);
         *get_sb_index(x, subsize) = 1;
-        rd_pick_sb_modes(cpi, tile, mi_row, mi_col + (ms >> 1), &rt, &dt,
+        rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col + (ms >> 1), &rt, &dt,
                          subsize, get_block_context(x, subsize), INT64_MAX);
         if (rt == INT_MAX || dt == INT_MAX) {
           last_part_rate = INT_MAX;
@@ -1327,7 +1362,7 @@ static void rd_use_partition(VP9_COMP *cpi,
 
         *get_sb_index(x, subsize) = i;
 
-        rd_use_partition(cpi, tile, mi_8x8 + jj * bss * mis + ii * bss, tp,
+        rd_use_partition(cpi, x, tile, mi_8x8 + jj * bss * mis + ii * bss, tp,
                          mi_row + y_idx, mi_col + x_idx, subsize, &rt, &dt,
                          i != 3);
         if (rt == INT_MAX || dt == INT_MAX) {
@@ -1343,7 +1378,7 @@ static void rd_use_partition(VP9_COMP *cpi,
       assert(0);
   }
 
-  pl = partition_plane_context(cpi->above_seg_context, cpi->left_seg_context,
+  pl = partition_plane_context(cpi->above_seg_context, xd->left_seg_context,
                                mi_row, mi_col, bsize);
   if (last_part_rate < INT_MAX)
     last_part_rate += x->partition_cost[pl][partition];
@@ -1355,7 +1390,7 @@ static void rd_use_partition(VP9_COMP *cpi,
     BLOCK_SIZE split_subsize = get_subsize(bsize, PARTITION_SPLIT);
     split_rate = 0;
     split_dist = 0;
-    restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+    restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
 
     // Split partition.
     for (i = 0; i < 4; i++) {
@@ -1373,13 +1408,13 @@ static void rd_use_partition(VP9_COMP *cpi,
       *get_sb_partitioning(x, bsize) = split_subsize;
       *get_sb_partitioning(x, split_subsize) = split_subsize;
 
-      save_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+      save_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
 
-      rd_pick_sb_modes(cpi, tile, mi_row + y_idx, mi_col + x_idx, &rt, &dt,
+      rd_pick_sb_modes(cpi, x, tile, mi_row + y_idx, mi_col + x_idx, &rt, &dt,
                        split_subsize, get_block_context(x, split_subsize),
                        INT64_MAX);
 
-      restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+      restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
 
       if (rt == INT_MAX || dt == INT_MAX) {
         split_rate = INT_MAX;
@@ -1388,18 +1423,18 @@ static void rd_use_partition(VP9_COMP *cpi,
       }
 
       if (i != 3)
-        encode_sb(cpi, tile, tp,  mi_row + y_idx, mi_col + x_idx, 0,
+        encode_sb(cpi, x, tile, tp,  mi_row + y_idx, mi_col + x_idx, 0,
                   split_subsize);
 
       split_rate += rt;
       split_dist += dt;
       pl = partition_plane_context(cpi->above_seg_context,
-                                   cpi->left_seg_context,
+                                   xd->left_seg_context,
                                    mi_row + y_idx, mi_col + x_idx,
                                    split_subsize);
       split_rate += x->partition_cost[pl][PARTITION_NONE];
     }
-    pl = partition_plane_context(cpi->above_seg_context, cpi->left_seg_context,
+    pl = partition_plane_context(cpi->above_seg_context, xd->left_seg_context,
                                  mi_row, mi_col, bsize);
     if (split_rate < INT_MAX) {
       split_rate += x->partition_cost[pl][PARTITION_SPLIT];
@@ -1427,7 +1462,7 @@ static void rd_use_partition(VP9_COMP *cpi,
     chosen_dist = none_dist;
   }
 
-  restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+  restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
 
   // We must have chosen a partitioning and encoding or we'll fail later on.
   // No other opportunities for success.
@@ -1445,7 +1480,7 @@ static void rd_use_partition(VP9_COMP *cpi,
                                 output_enabled, chosen_rate);
     }
 
-    encode_sb(cpi, tile, tp, mi_row, mi_col, output_enabled, bsize);
+    encode_sb(cpi, x, tile, tp, mi_row, mi_col, output_enabled, bsize);
   }
 
   *rate = chosen_rate;
@@ -1474,7 +1509,7 @@ static const BLOCK_SIZE max_partition_size[BLOCK_SIZES] = {
 static void get_sb_partition_size_range(VP9_COMP *cpi, MODE_INFO ** mi_8x8,
                                         BLOCK_SIZE * min_block_size,
                                         BLOCK_SIZE * max_block_size ) {
-  MACROBLOCKD *const xd = &cpi->mb.e_mbd;
+  const VP9_COMMON *const cm = &cpi->common;
   int sb_width_in_blocks = MI_BLOCK_SIZE;
   int sb_height_in_blocks  = MI_BLOCK_SIZE;
   int i, j;
@@ -1488,18 +1523,19 @@ static void get_sb_partition_size_range(VP9_COMP *cpi, MODE_INFO ** mi_8x8,
       *min_block_size = MIN(*min_block_size, sb_type);
       *max_block_size = MAX(*max_block_size, sb_type);
     }
-    index += xd->mode_info_stride;
+    index += cm->mode_info_stride;
   }
 }
 
 // Look at neighboring blocks and set a min and max partition size based on
 // what they chose.
-static void rd_auto_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
+static void rd_auto_partition_range(VP9_COMP *cpi, MACROBLOCK *const x,
+                                    const TileInfo *const tile,
                                     int row, int col,
                                     BLOCK_SIZE *min_block_size,
                                     BLOCK_SIZE *max_block_size) {
   VP9_COMMON * const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->mb.e_mbd;
+  MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO ** mi_8x8 = xd->mi_8x8;
   MODE_INFO ** prev_mi_8x8 = xd->prev_mi_8x8;
 
@@ -1558,9 +1594,10 @@ static void rd_auto_partition_range(VP9_COMP *cpi, const TileInfo *const tile,
   *min_block_size = MIN(*min_block_size, *max_block_size);
 }
 
-static void compute_fast_motion_search_level(VP9_COMP *cpi, BLOCK_SIZE bsize) {
+static void compute_fast_motion_search_level(VP9_COMP *cpi,
+                                             MACROBLOCK *const x,
+                                             BLOCK_SIZE bsize) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
 
   // Only use 8x8 result for non HD videos.
   // int use_8x8 = (MIN(cpi->common.width, cpi->common.height) < 720) ? 1 : 0;
@@ -1659,12 +1696,13 @@ static INLINE void load_pred_mv(MACROBLOCK *x, PICK_MODE_CONTEXT *ctx) {
 // TODO(jingning,jimbankoski,rbultje): properly skip partition types that are
 // unlikely to be selected depending on previous rate-distortion optimization
 // results, for encoding speed-up.
-static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
+static void rd_pick_partition(VP9_COMP *cpi, MACROBLOCK *const x,
+                              const TileInfo *const tile,
                               TOKENEXTRA **tp, int mi_row,
                               int mi_col, BLOCK_SIZE bsize, int *rate,
                               int64_t *dist, int do_recon, int64_t best_rd) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
   const int ms = num_8x8_blocks_wide_lookup[bsize] / 2;
   ENTROPY_CONTEXT l[16 * MAX_MB_PLANE], a[16 * MAX_MB_PLANE];
   PARTITION_CONTEXT sl[8], sa[8];
@@ -1704,29 +1742,29 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
              num_8x8_blocks_high_lookup[bsize]);
 
   if (bsize == BLOCK_16X16) {
-    set_offsets(cpi, tile, mi_row, mi_col, bsize);
+    set_offsets(cpi, x, tile, mi_row, mi_col, bsize);
     x->mb_energy = vp9_block_energy(cpi, x, bsize);
   }
 
   // Determine partition types in search according to the speed features.
   // The threshold set here has to be of square block size.
   if (cpi->sf.auto_min_max_partition_size) {
-    partition_none_allowed &= (bsize <= cpi->sf.max_partition_size &&
-                               bsize >= cpi->sf.min_partition_size);
-    partition_horz_allowed &= ((bsize <= cpi->sf.max_partition_size &&
-                                bsize >  cpi->sf.min_partition_size) ||
+    partition_none_allowed &= (bsize <= x->max_partition_size &&
+                               bsize >= x->min_partition_size);
+    partition_horz_allowed &= ((bsize <= x->max_partition_size &&
+                                bsize >  x->min_partition_size) ||
                                 force_horz_split);
-    partition_vert_allowed &= ((bsize <= cpi->sf.max_partition_size &&
-                                bsize >  cpi->sf.min_partition_size) ||
+    partition_vert_allowed &= ((bsize <= x->max_partition_size &&
+                                bsize >  x->min_partition_size) ||
                                 force_vert_split);
-    do_split &= bsize > cpi->sf.min_partition_size;
+    do_split &= bsize > x->min_partition_size;
   }
   if (cpi->sf.use_square_partition_only) {
     partition_horz_allowed &= force_horz_split;
     partition_vert_allowed &= force_vert_split;
   }
 
-  save_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+  save_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
 
   if (cpi->sf.disable_split_var_thresh && partition_none_allowed) {
     unsigned int source_variancey;
@@ -1741,12 +1779,12 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
 
   // PARTITION_NONE
   if (partition_none_allowed) {
-    rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &this_rate, &this_dist, bsize,
-                     get_block_context(x, bsize), best_rd);
+    rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &this_rate, &this_dist,
+                     bsize, get_block_context(x, bsize), best_rd);
     if (this_rate != INT_MAX) {
       if (bsize >= BLOCK_8X8) {
         pl = partition_plane_context(cpi->above_seg_context,
-                                     cpi->left_seg_context,
+                                     xd->left_seg_context,
                                      mi_row, mi_col, bsize);
         this_rate += x->partition_cost[pl][PARTITION_NONE];
       }
@@ -1774,7 +1812,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
         }
       }
     }
-    restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+    restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
   }
 
   // store estimated motion vector
@@ -1801,8 +1839,9 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
           partition_none_allowed)
         get_block_context(x, subsize)->pred_filter_type =
             get_block_context(x, bsize)->mic.mbmi.interp_filter;
-      rd_pick_partition(cpi, tile, tp, mi_row + y_idx, mi_col + x_idx, subsize,
-                        &this_rate, &this_dist, i != 3, best_rd - sum_rd);
+      rd_pick_partition(cpi, x, tile, tp, mi_row + y_idx, mi_col + x_idx,
+                        subsize, &this_rate, &this_dist, i != 3,
+                        best_rd - sum_rd);
 
       if (this_rate == INT_MAX) {
         sum_rd = INT64_MAX;
@@ -1814,7 +1853,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
     }
     if (sum_rd < best_rd && i == 4) {
       pl = partition_plane_context(cpi->above_seg_context,
-                                   cpi->left_seg_context,
+                                   xd->left_seg_context,
                                    mi_row, mi_col, bsize);
       sum_rate += x->partition_cost[pl][PARTITION_SPLIT];
       sum_rd = RDCOST(x->rdmult, x->rddiv, sum_rate, sum_dist);
@@ -1831,7 +1870,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
         do_rect &= !partition_none_allowed;
     }
     partition_split_done = 1;
-    restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+    restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
   }
 
   x->fast_ms = 0;
@@ -1839,7 +1878,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
 
   if (partition_split_done &&
       cpi->sf.using_small_partition_info) {
-    compute_fast_motion_search_level(cpi, bsize);
+    compute_fast_motion_search_level(cpi, x, bsize);
   }
 
   // PARTITION_HORZ
@@ -1852,13 +1891,13 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
         partition_none_allowed)
       get_block_context(x, subsize)->pred_filter_type =
           get_block_context(x, bsize)->mic.mbmi.interp_filter;
-    rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &sum_rate, &sum_dist, subsize,
-                     get_block_context(x, subsize), best_rd);
+    rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &sum_rate, &sum_dist,
+                     subsize, get_block_context(x, subsize), best_rd);
     sum_rd = RDCOST(x->rdmult, x->rddiv, sum_rate, sum_dist);
 
     if (sum_rd < best_rd && mi_row + ms < cm->mi_rows) {
-      update_state(cpi, get_block_context(x, subsize), subsize, 0);
-      encode_superblock(cpi, tp, 0, mi_row, mi_col, subsize);
+      update_state(cpi, x, get_block_context(x, subsize), subsize, 0);
+      encode_superblock(cpi, x, tp, 0, mi_row, mi_col, subsize);
 
       *get_sb_index(x, subsize) = 1;
       if (cpi->sf.adaptive_motion_search)
@@ -1867,7 +1906,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
           partition_none_allowed)
         get_block_context(x, subsize)->pred_filter_type =
             get_block_context(x, bsize)->mic.mbmi.interp_filter;
-      rd_pick_sb_modes(cpi, tile, mi_row + ms, mi_col, &this_rate,
+      rd_pick_sb_modes(cpi, x, tile, mi_row + ms, mi_col, &this_rate,
                        &this_dist, subsize, get_block_context(x, subsize),
                        best_rd - sum_rd);
       if (this_rate == INT_MAX) {
@@ -1880,7 +1919,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
     }
     if (sum_rd < best_rd) {
       pl = partition_plane_context(cpi->above_seg_context,
-                                   cpi->left_seg_context,
+                                   xd->left_seg_context,
                                    mi_row, mi_col, bsize);
       sum_rate += x->partition_cost[pl][PARTITION_HORZ];
       sum_rd = RDCOST(x->rdmult, x->rddiv, sum_rate, sum_dist);
@@ -1891,7 +1930,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
         *(get_sb_partitioning(x, bsize)) = subsize;
       }
     }
-    restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+    restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
   }
 
   // PARTITION_VERT
@@ -1905,12 +1944,12 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
         partition_none_allowed)
       get_block_context(x, subsize)->pred_filter_type =
           get_block_context(x, bsize)->mic.mbmi.interp_filter;
-    rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &sum_rate, &sum_dist, subsize,
-                     get_block_context(x, subsize), best_rd);
+    rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &sum_rate, &sum_dist,
+                     subsize, get_block_context(x, subsize), best_rd);
     sum_rd = RDCOST(x->rdmult, x->rddiv, sum_rate, sum_dist);
     if (sum_rd < best_rd && mi_col + ms < cm->mi_cols) {
-      update_state(cpi, get_block_context(x, subsize), subsize, 0);
-      encode_superblock(cpi, tp, 0, mi_row, mi_col, subsize);
+      update_state(cpi, x, get_block_context(x, subsize), subsize, 0);
+      encode_superblock(cpi, x, tp, 0, mi_row, mi_col, subsize);
 
       *get_sb_index(x, subsize) = 1;
       if (cpi->sf.adaptive_motion_search)
@@ -1919,7 +1958,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
           partition_none_allowed)
         get_block_context(x, subsize)->pred_filter_type =
             get_block_context(x, bsize)->mic.mbmi.interp_filter;
-      rd_pick_sb_modes(cpi, tile, mi_row, mi_col + ms, &this_rate,
+      rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col + ms, &this_rate,
                        &this_dist, subsize, get_block_context(x, subsize),
                        best_rd - sum_rd);
       if (this_rate == INT_MAX) {
@@ -1932,7 +1971,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
     }
     if (sum_rd < best_rd) {
       pl = partition_plane_context(cpi->above_seg_context,
-                                   cpi->left_seg_context,
+                                   xd->left_seg_context,
                                    mi_row, mi_col, bsize);
       sum_rate += x->partition_cost[pl][PARTITION_VERT];
       sum_rd = RDCOST(x->rdmult, x->rddiv, sum_rate, sum_dist);
@@ -1943,7 +1982,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
         *(get_sb_partitioning(x, bsize)) = subsize;
       }
     }
-    restore_context(cpi, mi_row, mi_col, a, l, sa, sl, bsize);
+    restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, bsize);
   }
 
 
@@ -1959,7 +1998,7 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
     if ((cpi->oxcf.aq_mode == COMPLEXITY_AQ) && cm->seg.update_map) {
       select_in_frame_q_segment(cpi, mi_row, mi_col, output_enabled, best_rate);
     }
-    encode_sb(cpi, tile, tp, mi_row, mi_col, output_enabled, bsize);
+    encode_sb(cpi, x, tile, tp, mi_row, mi_col, output_enabled, bsize);
   }
   if (bsize == BLOCK_64X64) {
     assert(tp_orig < *tp);
@@ -1971,10 +2010,11 @@ static void rd_pick_partition(VP9_COMP *cpi, const TileInfo *const tile,
 }
 
 // Examines 64x64 block and chooses a best reference frame
-static void rd_pick_reference_frame(VP9_COMP *cpi, const TileInfo *const tile,
+static void rd_pick_reference_frame(VP9_COMP *cpi, MACROBLOCK *const x,
+                                    const TileInfo *const tile,
                                     int mi_row, int mi_col) {
   VP9_COMMON * const cm = &cpi->common;
-  MACROBLOCK * const x = &cpi->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
   int bsl = b_width_log2(BLOCK_64X64), bs = 1 << bsl;
   int ms = bs / 2;
   ENTROPY_CONTEXT l[16 * MAX_MB_PLANE], a[16 * MAX_MB_PLANE];
@@ -1983,38 +2023,78 @@ static void rd_pick_reference_frame(VP9_COMP *cpi, const TileInfo *const tile,
   int r;
   int64_t d;
 
-  save_context(cpi, mi_row, mi_col, a, l, sa, sl, BLOCK_64X64);
+  save_context(cpi, x, mi_row, mi_col, a, l, sa, sl, BLOCK_64X64);
 
   // Default is non mask (all reference frames allowed.
-  cpi->ref_frame_mask = 0;
+  x->ref_frame_mask = 0;
 
   // Do RD search for 64x64.
   if ((mi_row + (ms >> 1) < cm->mi_rows) &&
       (mi_col + (ms >> 1) < cm->mi_cols)) {
-    cpi->set_ref_frame_mask = 1;
-    rd_pick_sb_modes(cpi, tile, mi_row, mi_col, &r, &d, BLOCK_64X64,
+    rd_pick_sb_modes(cpi, x, tile, mi_row, mi_col, &r, &d, BLOCK_64X64,
                      get_block_context(x, BLOCK_64X64), INT64_MAX);
-    pl = partition_plane_context(cpi->above_seg_context, cpi->left_seg_context,
+    pl = partition_plane_context(cpi->above_seg_context, xd->left_seg_context,
                                  mi_row, mi_col, BLOCK_64X64);
     r += x->partition_cost[pl][PARTITION_NONE];
 
     *(get_sb_partitioning(x, BLOCK_64X64)) = BLOCK_64X64;
-    cpi->set_ref_frame_mask = 0;
   }
 
-  restore_context(cpi, mi_row, mi_col, a, l, sa, sl, BLOCK_64X64);
+  restore_context(cpi, x, mi_row, mi_col, a, l, sa, sl, BLOCK_64X64);
+}
+
+static int get_sb_rows(const VP9_COMMON *const cm) {
+  return (cm->mi_rows + MI_BLOCK_SIZE - 1) >> MI_BLOCK_SIZE_LOG2;
+}
+
+static int get_tile_sb_cols(const TileInfo *const tile) {
+  return (tile->mi_col_end - tile->mi_col_start + MI_BLOCK_SIZE - 1) >>
+         MI_BLOCK_SIZE_LOG2;
+}
+
+static int get_sb_row_token_alloc(const TileInfo *const tile, int mi_row) {
+  const int mi_row_end = MIN(mi_row + MI_BLOCK_SIZE, tile->mi_row_end);
+  return get_token_alloc((mi_row_end - mi_row + 1) >> 1,
+                         (tile->mi_col_end - tile->mi_col_start + 1) >> 1);
+}
+
+static void init_tile_of_sb_row(const VP9_COMMON *const cm, TileInfo *tile,
+                                int mi_row, int tile_col) {
+  int tile_row = 0;
+
+  vp9_tile_init(tile, cm, tile_row, tile_col);
+  while (mi_row >= tile->mi_row_end)
+    vp9_tile_init(tile, cm, ++tile_row, tile_col);
 }
 
-static void encode_sb_row_rt(VP9_COMP *cpi, const TileInfo *const tile,
-                             int mi_row, TOKENEXTRA **tp) {
+// Waits until the SB row above has encoded the SB above and to the right of
+// SB sb_col, the last one the current SB depends on.
+static void sb_row_sync_read(SB_ROW_SYNC *const above, int sb_col,
+                             int sb_cols) {
+  vp9_row_sync_read(&above->sync, MIN(sb_col + 2, sb_cols));
+}
+
+static void sb_row_sync_write(SB_ROW_SYNC *const sync,
+                              const MACROBLOCK *const x) {
+  if (sync->sync.done == 0) {
+    vp9_copy(sync->rd_thresh.freq_fact, x->rd_thresh_freq_fact);
+    vp9_copy(sync->rd_thresh.freq_sub8x8, x->rd_thresh_freq_sub8x8);
+  }
+  vp9_row_sync_write(&sync->sync);
+}
+
+static void encode_sb_row_rt(VP9_COMP *cpi, MACROBLOCK *const x,
+                             const TileInfo *const tile,
+                             int mi_row, TOKENEXTRA **tp,
+                             SB_ROW_SYNC *const above,
+                             SB_ROW_SYNC *const sync) {
   VP9_COMMON *const cm = &cpi->common;
+  const int sb_cols = get_tile_sb_cols(tile);
   int mi_col;
 
-  cpi->sf.always_this_block_size = BLOCK_8X8;
-
   // Initialize the left context for the new SB row
-  vpx_memset(&cpi->left_context, 0, sizeof(cpi->left_context));
-  vpx_memset(cpi->left_seg_context, 0, sizeof(cpi->left_seg_context));
+  vp9_zero(x->e_mbd.left_context);
+  vp9_zero(x->e_mbd.left_seg_context);
 
   // Code each SB in the row
   for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
@@ -2024,23 +2104,34 @@ static void encode_sb_row_rt(VP9_COMP *cpi, const TileInfo *const tile,
     const int idx_str = cm->mode_info_stride * mi_row + mi_col;
     MODE_INFO **mi_8x8 = cm->mi_grid_visible + idx_str;
 
-    vp9_zero(cpi->mb.pred_mv);
+    if (above)
+      sb_row_sync_read(above, (mi_col - tile->mi_col_start) >>
+                              MI_BLOCK_SIZE_LOG2, sb_cols);
 
-    set_offsets(cpi, tile, mi_row, mi_col, BLOCK_64X64);
-    set_partitioning(cpi, tile, mi_8x8, mi_row, mi_col);
-    pick_partition_type(cpi, tile, mi_8x8, tp, mi_row, mi_col, BLOCK_64X64,
+    vp9_zero(x->pred_mv);
+
+    set_offsets(cpi, x, tile, mi_row, mi_col, BLOCK_64X64);
+    set_partitioning(cpi, tile, mi_8x8, mi_row, mi_col,
+                     get_fixed_partition_size(cpi, x, tile, mi_row, mi_col));
+    pick_partition_type(cpi, x, tile, mi_8x8, tp, mi_row, mi_col, BLOCK_64X64,
                         &dummy_rate, &dummy_dist, 1);
+
+    sb_row_sync_write(sync, x);
   }
 }
 
-static void encode_sb_row(VP9_COMP *cpi, const TileInfo *const tile,
-                          int mi_row, TOKENEXTRA **tp) {
+static void encode_sb_row(VP9_COMP *cpi, MACROBLOCK *const x,
+                          const TileInfo *const tile,
+                          int mi_row, TOKENEXTRA **tp,
+                          SB_ROW_SYNC *const above,
+                          SB_ROW_SYNC *const sync) {
   VP9_COMMON *const cm = &cpi->common;
+  const int sb_cols = get_tile_sb_cols(tile);
   int mi_col;
 
   // Initialize the left context for the new SB row
-  vpx_memset(&cpi->left_context, 0, sizeof(cpi->left_context));
-  vpx_memset(cpi->left_seg_context, 0, sizeof(cpi->left_seg_context));
+  vp9_zero(x->e_mbd.left_context);
+  vp9_zero(x->e_mbd.left_seg_context);
 
   // Code each SB in the row
   for (mi_col = tile->mi_col_start; mi_col < tile->mi_col_end;
@@ -2049,7 +2140,11 @@ static void encode_sb_row(VP9_COMP *cpi, const TileInfo *const tile,
     int64_t dummy_dist;
 
     BLOCK_SIZE i;
-    MACROBLOCK *x = &cpi->mb;
+
+    if (above)
+      sb_row_sync_read(above, (mi_col - tile->mi_col_start) >>
+                              MI_BLOCK_SIZE_LOG2, sb_cols);
+
     for (i = BLOCK_4X4; i < BLOCK_8X8; ++i) {
       const int num_4x4_w = num_4x4_blocks_wide_lookup[i];
       const int num_4x4_h = num_4x4_blocks_high_lookup[i];
@@ -2060,19 +2155,21 @@ static void encode_sb_row(VP9_COMP *cpi, const TileInfo *const tile,
             get_block_context(x, i)->pred_filter_type = SWITCHABLE;
     }
 
-    vp9_zero(cpi->mb.pred_mv);
+    vp9_zero(x->pred_mv);
 
     if (cpi->sf.use_lastframe_partitioning ||
-        cpi->sf.use_one_partition_size_always ) {
+        cpi->sf.partition_search_type != SEARCH_PARTITION) {
       const int idx_str = cm->mode_info_stride * mi_row + mi_col;
       MODE_INFO **mi_8x8 = cm->mi_grid_visible + idx_str;
       MODE_INFO **prev_mi_8x8 = cm->prev_mi_grid_visible + idx_str;
 
-      cpi->mb.source_variance = UINT_MAX;
-      if (cpi->sf.use_one_partition_size_always) {
-        set_offsets(cpi, tile, mi_row, mi_col, BLOCK_64X64);
-        set_partitioning(cpi, tile, mi_8x8, mi_row, mi_col);
-        rd_use_partition(cpi, tile, mi_8x8, tp, mi_row, mi_col, BLOCK_64X64,
+      x->source_variance = UINT_MAX;
+      if (cpi->sf.partition_search_type != SEARCH_PARTITION) {
+        set_offsets(cpi, x, tile, mi_row, mi_col, BLOCK_64X64);
+        set_partitioning(cpi, tile, mi_8x8, mi_row, mi_col,
+                         get_fixed_partition_size(cpi, x, tile,
+                                                  mi_row, mi_col));
+        rd_use_partition(cpi, x, tile, mi_8x8, tp, mi_row, mi_col, BLOCK_64X64,
                          &dummy_rate, &dummy_dist, 1);
       } else {
         if ((cm->current_video_frame
@@ -2086,30 +2183,32 @@ static void encode_sb_row(VP9_COMP *cpi, const TileInfo *const tile,
                  sb_has_motion(cm, prev_mi_8x8))) {
           // If required set upper and lower partition size limits
           if (cpi->sf.auto_min_max_partition_size) {
-            set_offsets(cpi, tile, mi_row, mi_col, BLOCK_64X64);
-            rd_auto_partition_range(cpi, tile, mi_row, mi_col,
-                                    &cpi->sf.min_partition_size,
-                                    &cpi->sf.max_partition_size);
+            set_offsets(cpi, x, tile, mi_row, mi_col, BLOCK_64X64);
+            rd_auto_partition_range(cpi, x, tile, mi_row, mi_col,
+                                    &x->min_partition_size,
+                                    &x->max_partition_size);
           }
-          rd_pick_partition(cpi, tile, tp, mi_row, mi_col, BLOCK_64X64,
+          rd_pick_partition(cpi, x, tile, tp, mi_row, mi_col, BLOCK_64X64,
                             &dummy_rate, &dummy_dist, 1, INT64_MAX);
         } else {
           copy_partitioning(cm, mi_8x8, prev_mi_8x8);
-          rd_use_partition(cpi, tile, mi_8x8, tp, mi_row, mi_col, BLOCK_64X64,
-                           &dummy_rate, &dummy_dist, 1);
+          rd_use_partition(cpi, x, tile, mi_8x8, tp, mi_row, mi_col,
+                           BLOCK_64X64, &dummy_rate, &dummy_dist, 1);
         }
       }
     } else {
       // If required set upper and lower partition size limits
       if (cpi->sf.auto_min_max_partition_size) {
-        set_offsets(cpi, tile, mi_row, mi_col, BLOCK_64X64);
-        rd_auto_partition_range(cpi, tile, mi_row, mi_col,
-                                &cpi->sf.min_partition_size,
-                                &cpi->sf.max_partition_size);
+        set_offsets(cpi, x, tile, mi_row, mi_col, BLOCK_64X64);
+        rd_auto_partition_range(cpi, x, tile, mi_row, mi_col,
+                                &x->min_partition_size,
+                                &x->max_partition_size);
       }
-      rd_pick_partition(cpi, tile, tp, mi_row, mi_col, BLOCK_64X64,
+      rd_pick_partition(cpi, x, tile, tp, mi_row, mi_col, BLOCK_64X64,
                         &dummy_rate, &dummy_dist, 1, INT64_MAX);
     }
+
+    sb_row_sync_write(sync, x);
   }
 }
 
@@ -2178,10 +2277,243 @@ static void switch_tx_mode(VP9_COMP *cpi) {
     cpi->common.tx_mode = ALLOW_32X32;
 }
 
+static void reset_mode_info(PICK_MODE_CONTEXT *ctx, int n) {
+  int i;
+  for (i = 0; i < n; ++i)
+    vp9_zero(ctx[i].mic);
+}
+
+#define RESET_MODE_INFO(contexts) \
+  reset_mode_info((PICK_MODE_CONTEXT *)(contexts), \
+                  sizeof(contexts) / sizeof(PICK_MODE_CONTEXT))
+
+// The partition search reads the modes of sub-blocks it did not code in the
+// current SB, so they must not be left over from another row.
+static void reset_block_contexts(MACROBLOCK *const x) {
+  RESET_MODE_INFO(x->ab4x4_context);
+  RESET_MODE_INFO(x->sb8x4_context);
+  RESET_MODE_INFO(x->sb4x8_context);
+  RESET_MODE_INFO(x->sb8x8_context);
+  RESET_MODE_INFO(x->sb8x16_context);
+  RESET_MODE_INFO(x->sb16x8_context);
+  RESET_MODE_INFO(x->mb_context);
+  RESET_MODE_INFO(x->sb32x16_context);
+  RESET_MODE_INFO(x->sb16x32_context);
+  RESET_MODE_INFO(x->sb32_context);
+  RESET_MODE_INFO(x->sb32x64_context);
+  RESET_MODE_INFO(x->sb64x32_context);
+  reset_mode_info(&x->sb64_context, 1);
+}
+
+// Encodes an SB row of a tile column. Whatever carries over from one SB to the
+// next is restarted from the rows above, so the row is coded the same way
+// whichever worker encodes it.
+static void encode_sb_row_job(VP9_COMP *cpi, MACROBLOCK *const x,
+                              int tile_col, int sb_row) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int sb_rows = get_sb_rows(cm);
+  const int mi_row = sb_row << MI_BLOCK_SIZE_LOG2;
+  SB_ROW_SYNC *const sync = &cpi->sb_row_sync[tile_col * sb_rows + sb_row];
+  SB_ROW_SYNC *const above = sb_row > 0 ? sync - 1 : NULL;
+  const RD_THRESH_FACTS *rd_thresh = &cpi->tile_rd_thresh[tile_col];
+  TOKENEXTRA *tp = sync->tok;
+  TileInfo tile;
+
+  init_tile_of_sb_row(cm, &tile, mi_row, tile_col);
+
+  if (above) {
+    sb_row_sync_read(above, 0, get_tile_sb_cols(&tile));
+    rd_thresh = &above->rd_thresh;
+  }
+  vp9_copy(x->rd_thresh_freq_fact, rd_thresh->freq_fact);
+  vp9_copy(x->rd_thresh_freq_sub8x8, rd_thresh->freq_sub8x8);
+  x->min_partition_size = cpi->sf.min_partition_size;
+  x->max_partition_size = cpi->sf.max_partition_size;
+  reset_block_contexts(x);
+
+  if (cpi->sf.use_pick_mode)
+    encode_sb_row_rt(cpi, x, &tile, mi_row, &tp, above, sync);
+  else
+    encode_sb_row(cpi, x, &tile, mi_row, &tp, above, sync);
+
+  sync->tok_count = (unsigned int)(tp - sync->tok);
+  assert(tp - sync->tok <= get_sb_row_token_alloc(&tile, mi_row));
+
+  if (sb_row == sb_rows - 1) {
+    vp9_copy(cpi->tile_rd_thresh[tile_col].freq_fact, x->rd_thresh_freq_fact);
+    vp9_copy(cpi->tile_rd_thresh[tile_col].freq_sub8x8,
+             x->rd_thresh_freq_sub8x8);
+  }
+}
+
+// Encodes SB row jobs start, start + num_workers, ... of the frame. Job j is
+// SB row j / tile_cols of tile column j % tile_cols.
+static int encode_tile_worker(void *arg1, void *arg2) {
+  EncWorkerData *const data = (EncWorkerData*)arg1;
+  VP9_COMP *const cpi = data->cpi;
+  const VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int num_jobs = tile_cols * get_sb_rows(cm);
+  int job;
+  (void)arg2;
+
+  vp9_init_worker_mb(cpi, &data->mb);
+  for (job = data->start; job < num_jobs; job += data->num_workers)
+    encode_sb_row_job(cpi, &data->mb, job % tile_cols, job / tile_cols);
+  return 1;
+}
+
+static void free_sb_row_sync(VP9_COMP *cpi) {
+  int i;
+
+  for (i = 0; i < cpi->num_sb_row_sync; ++i)
+    vp9_row_sync_free(&cpi->sb_row_sync[i].sync);
+  vpx_free(cpi->sb_row_sync);
+  cpi->sb_row_sync = NULL;
+  cpi->num_sb_row_sync = 0;
+}
+
+void vp9_free_tile_coders(VP9_COMP *cpi) {
+  free_sb_row_sync(cpi);
+
+  vpx_free(cpi->tile_rd_thresh);
+  cpi->tile_rd_thresh = NULL;
+  cpi->num_tile_rd_thresh = 0;
+}
+
+static void alloc_tile_coders(VP9_COMP *cpi, int tile_cols, int sb_rows) {
+  VP9_COMMON *const cm = &cpi->common;
+  int i, j, k;
+
+  if (tile_cols > cpi->num_tile_rd_thresh) {
+    vpx_free(cpi->tile_rd_thresh);
+    cpi->num_tile_rd_thresh = 0;
+
+    CHECK_MEM_ERROR(cm, cpi->tile_rd_thresh,
+                    vpx_malloc(tile_cols * sizeof(*cpi->tile_rd_thresh)));
+    for (i = 0; i < tile_cols; ++i) {
+      RD_THRESH_FACTS *const rd_thresh = &cpi->tile_rd_thresh[i];
+
+      // Default rd threshold factors for mode selection
+      for (j = 0; j < BLOCK_SIZES; ++j) {
+        for (k = 0; k < MAX_MODES; ++k)
+          rd_thresh->freq_fact[j][k] = 32;
+        for (k = 0; k < MAX_REFS; ++k)
+          rd_thresh->freq_sub8x8[j][k] = 32;
+      }
+    }
+    cpi->num_tile_rd_thresh = tile_cols;
+  }
+
+  if (tile_cols * sb_rows > cpi->num_sb_row_sync) {
+    free_sb_row_sync(cpi);
+
+    CHECK_MEM_ERROR(cm, cpi->sb_row_sync,
+                    vpx_calloc(tile_cols * sb_rows,
+                               sizeof(*cpi->sb_row_sync)));
+    for (i = 0; i < tile_cols * sb_rows; ++i) {
+      vp9_row_sync_init(cm, &cpi->sb_row_sync[i].sync);
+      ++cpi->num_sb_row_sync;
+    }
+  }
+}
+
+static void add_counts(unsigned int *dst, const unsigned int *src, size_t n) {
+  size_t i;
+  for (i = 0; i < n; ++i)
+    dst[i] += src[i];
+}
+
+static void encode_tiles(VP9_COMP *cpi) {
+  VP9_COMMON *const cm = &cpi->common;
+  const int tile_cols = 1 << cm->log2_tile_cols;
+  const int tile_rows = 1 << cm->log2_tile_rows;
+  const int sb_rows = get_sb_rows(cm);
+  TOKENEXTRA *tok = cpi->tok;
+  int max_workers = 0;
+  int num_workers;
+  int tile_row, tile_col, mi_row, i;
+
+  // Every SB row of every tile writes its tokens to its own fixed range of the
+  // buffer. The ranges of a tile follow each other, so the tokens only need
+  // to be moved together once the tile is encoded.
+  for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+    TileInfo tile;
+    vp9_tile_init(&tile, cm, 0, tile_col);
+
+    // With the two SB lag at most every other SB of a column has a row
+    // encoding it.
+    max_workers += MIN(sb_rows, (get_tile_sb_cols(&tile) + 1) >> 1);
+  }
+  num_workers = vp9_get_num_enc_workers(cpi, max_workers);
+
+  alloc_tile_coders(cpi, tile_cols, sb_rows);
+
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      TileInfo tile;
+      vp9_tile_init(&tile, cm, tile_row, tile_col);
+      cpi->tile_tok[tile_row][tile_col] = tok;
+      for (mi_row = tile.mi_row_start; mi_row < tile.mi_row_end;
+           mi_row += MI_BLOCK_SIZE) {
+        SB_ROW_SYNC *const sync = &cpi->sb_row_sync[
+            tile_col * sb_rows + (mi_row >> MI_BLOCK_SIZE_LOG2)];
+        sync->sync.done = 0;
+        sync->tok = tok;
+        tok += get_sb_row_token_alloc(&tile, mi_row);
+      }
+    }
+  }
+
+  vp9_run_enc_workers(cpi, encode_tile_worker, NULL, num_workers);
+
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      TileInfo tile;
+      vp9_tile_init(&tile, cm, tile_row, tile_col);
+      tok = cpi->tile_tok[tile_row][tile_col];
+      for (mi_row = tile.mi_row_start; mi_row < tile.mi_row_end;
+           mi_row += MI_BLOCK_SIZE) {
+        const SB_ROW_SYNC *const sync = &cpi->sb_row_sync[
+            tile_col * sb_rows + (mi_row >> MI_BLOCK_SIZE_LOG2)];
+        if (tok != sync->tok)
+          vpx_memmove(tok, sync->tok, sync->tok_count * sizeof(*tok));
+        tok += sync->tok_count;
+      }
+      cpi->tok_count[tile_row][tile_col] =
+          (unsigned int)(tok - cpi->tile_tok[tile_row][tile_col]);
+    }
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    const EncWorkerData *const data =
+        (const EncWorkerData*)cpi->enc_workers[i].data1;
+    const MACROBLOCK *const x = &data->mb;
+    int j;
+
+    // FRAME_COUNTS and the coefficient counts only hold unsigned int
+    // counters.
+    add_counts((unsigned int *)&cm->counts, (const unsigned int *)&x->counts,
+               sizeof(x->counts) / sizeof(unsigned int));
+    add_counts((unsigned int *)cpi->coef_counts,
+               (const unsigned int *)x->coef_counts,
+               sizeof(x->coef_counts) / sizeof(unsigned int));
+    for (j = 0; j < REFERENCE_MODES; ++j)
+      cpi->rd_comp_pred_diff[j] += x->rd_comp_pred_diff[j];
+    for (j = 0; j < TX_MODES; ++j)
+      cpi->rd_tx_select_diff[j] += x->rd_tx_select_diff[j];
+    for (j = 0; j < SWITCHABLE_FILTER_CONTEXTS; ++j)
+      cpi->rd_filter_diff[j] += x->rd_filter_diff[j];
+    for (j = 0; j < MAX_MODES; ++j)
+      cpi->mode_chosen_counts[j] += x->mode_chosen_counts[j];
+    for (j = 0; j < TX_SIZES; ++j)
+      cpi->tx_stepdown_count[j] += x->tx_stepdown_count[j];
+  }
+}
+
 static void encode_frame_internal(VP9_COMP *cpi) {
-  int mi_row;
-  MACROBLOCK *const x = &cpi->mb;
   VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
 
 //  fprintf(stderr, "encode_frame_internal frame %d (%d) type %d\n",
@@ -2218,7 +2550,7 @@ static void encode_frame_internal(VP9_COMP *cpi) {
   vp9_frame_init_quantizer(cpi);
 
   vp9_initialize_rd_consts(cpi);
-  vp9_initialize_me_consts(cpi, cm->base_qindex);
+  vp9_initialize_me_consts(cpi, &cpi->mb, cm->base_qindex);
   switch_tx_mode(cpi);
 
   if (cpi->oxcf.tuning == VP8_TUNE_SSIM) {
@@ -2243,33 +2575,7 @@ static void encode_frame_internal(VP9_COMP *cpi) {
     struct vpx_usec_timer emr_timer;
     vpx_usec_timer_start(&emr_timer);
 
-    {
-      // Take tiles into account and give start/end MB
-      int tile_col, tile_row;
-      TOKENEXTRA *tp = cpi->tok;
-      const int tile_cols = 1 << cm->log2_tile_cols;
-      const int tile_rows = 1 << cm->log2_tile_rows;
-
-      for (tile_row = 0; tile_row < tile_rows; tile_row++) {
-        for (tile_col = 0; tile_col < tile_cols; tile_col++) {
-          TileInfo tile;
-          TOKENEXTRA *tp_old = tp;
-
-          // For each row of SBs in the frame
-          vp9_tile_init(&tile, cm, tile_row, tile_col);
-          for (mi_row = tile.mi_row_start;
-               mi_row < tile.mi_row_end; mi_row += 8)
-#if 1
-            encode_sb_row(cpi, &tile, mi_row, &tp);
-#else
-            encode_sb_row_rt(cpi, &tile, mi_row, &tp);
-#endif
-
-          cpi->tok_count[tile_row][tile_col] = (unsigned int)(tp - tp_old);
-          assert(tp - cpi->tok <= get_token_alloc(cm->mb_rows, cm->mb_cols));
-        }
-      }
-    }
+    encode_tiles(cpi);
 
     vpx_usec_timer_mark(&emr_timer);
     cpi->time_encode_sb_row += vpx_usec_timer_elapsed(&emr_timer);
@@ -2661,10 +2967,10 @@ static int get_zbin_mode_boost(const MB_MODE_INFO *mbmi, int enabled) {
   }
 }
 
-static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
+static void encode_superblock(VP9_COMP *cpi, MACROBLOCK *const x,
+                              TOKENEXTRA **t, int output_enabled,
                               int mi_row, int mi_col, BLOCK_SIZE bsize) {
   VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO **mi_8x8 = xd->mi_8x8;
   MODE_INFO *mi = mi_8x8[0];
@@ -2674,8 +2980,10 @@ static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
   const int mis = cm->mode_info_stride;
   const int mi_width = num_8x8_blocks_wide_lookup[bsize];
   const int mi_height = num_8x8_blocks_high_lookup[bsize];
+  // The non-RD mode decision leaves no coefficients behind to reuse.
   x->skip_recode = !x->select_txfm_size && mbmi->sb_type >= BLOCK_8X8 &&
-                   (cpi->oxcf.aq_mode != COMPLEXITY_AQ);
+                   (cpi->oxcf.aq_mode != COMPLEXITY_AQ) &&
+                   !cpi->sf.use_pick_mode;
   x->skip_optimize = ctx->is_coded;
   ctx->is_coded = 1;
   x->use_lp32x32fdct = cpi->sf.use_lp32x32fdct;
@@ -2699,8 +3007,8 @@ static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
 
     // Experimental code. Special case for gf and arf zeromv modes.
     // Increase zbin size to suppress noise
-    cpi->zbin_mode_boost = get_zbin_mode_boost(mbmi,
-                                               cpi->zbin_mode_boost_enabled);
+    x->zbin_mode_boost = get_zbin_mode_boost(mbmi,
+                                             cpi->zbin_mode_boost_enabled);
     vp9_update_zbin_extra(cpi, x);
   }
 
@@ -2709,7 +3017,7 @@ static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
     vp9_encode_intra_block_y(x, MAX(bsize, BLOCK_8X8));
     vp9_encode_intra_block_uv(x, MAX(bsize, BLOCK_8X8));
     if (output_enabled)
-      sum_intra_stats(&cm->counts, mi);
+      sum_intra_stats(&x->counts, mi);
   } else {
     int ref;
     const int is_compound = has_second_ref(mbmi);
@@ -2722,15 +3030,15 @@ static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
   }
 
   if (!is_inter_block(mbmi)) {
-    vp9_tokenize_sb(cpi, t, !output_enabled, MAX(bsize, BLOCK_8X8));
+    vp9_tokenize_sb(cpi, x, t, !output_enabled, MAX(bsize, BLOCK_8X8));
   } else if (!x->skip) {
     mbmi->skip_coeff = 1;
     vp9_encode_sb(x, MAX(bsize, BLOCK_8X8));
-    vp9_tokenize_sb(cpi, t, !output_enabled, MAX(bsize, BLOCK_8X8));
+    vp9_tokenize_sb(cpi, x, t, !output_enabled, MAX(bsize, BLOCK_8X8));
   } else {
     mbmi->skip_coeff = 1;
     if (output_enabled)
-      cm->counts.mbskip[vp9_get_skip_context(xd)][1]++;
+      x->counts.mbskip[vp9_get_skip_context(xd)][1]++;
     reset_skip_context(xd, MAX(bsize, BLOCK_8X8));
   }
 
@@ -2741,7 +3049,7 @@ static void encode_superblock(VP9_COMP *cpi, TOKENEXTRA **t, int output_enabled,
             (mbmi->skip_coeff ||
              vp9_segfeature_active(&cm->seg, segment_id, SEG_LVL_SKIP)))) {
       ++get_tx_counts(max_txsize_lookup[bsize], vp9_get_tx_size_context(xd),
-                      &cm->counts.tx)[mbmi->tx_size];
+                      &x->counts.tx)[mbmi->tx_size];
     } else {
       int x, y;
       TX_SIZE tx_size;
@@ -14,9 +14,13 @@
 
 struct macroblock;
 struct yv12_buffer_config;
+struct VP9_COMP;
 
 void vp9_setup_src_planes(struct macroblock *x,
                           const struct yv12_buffer_config *src,
                           int mi_row, int mi_col);
 
+// Frees the wavefront state of the tile columns.
+void vp9_free_tile_coders(struct VP9_COMP *cpi);
+
 #endif  // VP9_ENCODER_VP9_ENCODEFRAME_H_
@@ -203,7 +203,8 @@ void vp9_write_nmv_probs(VP9_COMMON *cm, int usehp, vp9_writer *w) {
 
 void vp9_encode_mv(VP9_COMP* cpi, vp9_writer* w,
                    const MV* mv, const MV* ref,
-                   const nmv_context* mvctx, int usehp) {
+                   const nmv_context* mvctx, int usehp,
+                   unsigned int *max_mv_magnitude) {
   const MV diff = {mv->row - ref->row,
                    mv->col - ref->col};
   const MV_JOINT_TYPE j = vp9_get_mv_joint(&diff);
@@ -220,7 +221,7 @@ void vp9_encode_mv(VP9_COMP* cpi, vp9_writer* w,
   // motion vector component used.
   if (!cpi->dummy_packing && cpi->sf.auto_mv_step_size) {
     unsigned int maxv = MAX(abs(mv->row), abs(mv->col)) >> 3;
-    cpi->max_mv_magnitude = MAX(maxv, cpi->max_mv_magnitude);
+    *max_mv_magnitude = MAX(maxv, *max_mv_magnitude);
   }
 }
 
@@ -252,7 +253,7 @@ void vp9_update_mv_count(VP9_COMP *cpi, MACROBLOCK *x, int_mv best_ref_mv[2]) {
   MODE_INFO *mi = x->e_mbd.mi_8x8[0];
   MB_MODE_INFO *const mbmi = &mi->mbmi;
   const int is_compound = has_second_ref(mbmi);
-  nmv_context_counts *counts = &cpi->common.counts.mv;
+  nmv_context_counts *counts = &x->counts.mv;
 
   if (mbmi->sb_type < BLOCK_8X8) {
     const int num_4x4_w = num_4x4_blocks_wide_lookup[mbmi->sb_type];
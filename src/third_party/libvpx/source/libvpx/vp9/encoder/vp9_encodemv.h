@@ -18,8 +18,11 @@ void vp9_entropy_mv_init();
 
 void vp9_write_nmv_probs(VP9_COMMON *cm, int usehp, vp9_writer* const);
 
+// Also raises *max_mv_magnitude to the largest component of mv when the
+// encoder tracks it.
 void vp9_encode_mv(VP9_COMP *cpi, vp9_writer* w, const MV* mv, const MV* ref,
-                   const nmv_context* mvctx, int usehp);
+                   const nmv_context* mvctx, int usehp,
+                   unsigned int *max_mv_magnitude);
 
 void vp9_build_nmv_cost_table(int *mvjoint,
                               int *mvcost[2],
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+
+#include "vpx_mem/vpx_mem.h"
+
+#include "vp9/encoder/vp9_ethread.h"
+#if CONFIG_MULTITHREAD
+#include "vp9/sched/thread.h"
+#endif
+
+int vp9_get_num_enc_workers(const VP9_COMP *cpi, int max_workers) {
+#if CONFIG_MULTITHREAD
+  return MIN(MAX(cpi->oxcf.max_threads, 1), max_workers);
+#else
+  // Without threads the workers run one after the other, so a single one
+  // has to do the jobs in order.
+  (void)cpi;
+  (void)max_workers;
+  return 1;
+#endif
+}
+
+void vp9_init_worker_mb(VP9_COMP *cpi, MACROBLOCK *x) {
+  const MACROBLOCK *const mb = &cpi->mb;
+  int i;
+
+  x->e_mbd = mb->e_mbd;
+  x->zbin_mode_boost = mb->zbin_mode_boost;
+  x->act_zbin_adj = mb->act_zbin_adj;
+  for (i = 0; i < MAX_MB_PLANE; ++i) {
+    x->plane[i].quant = mb->plane[i].quant;
+    x->plane[i].quant_shift = mb->plane[i].quant_shift;
+    x->plane[i].zbin = mb->plane[i].zbin;
+    x->plane[i].round = mb->plane[i].round;
+    x->plane[i].zbin_extra = mb->plane[i].zbin_extra;
+  }
+  x->skip_block = mb->skip_block;
+  x->q_index = mb->q_index;
+
+  x->ss = mb->ss;
+  x->ss_count = mb->ss_count;
+  x->searches_per_step = mb->searches_per_step;
+  x->errorperbit = mb->errorperbit;
+  x->sadperbit16 = mb->sadperbit16;
+  x->sadperbit4 = mb->sadperbit4;
+  x->rddiv = mb->rddiv;
+  x->rdmult = mb->rdmult;
+  x->optimize = mb->optimize;
+  x->select_txfm_size = mb->select_txfm_size;
+  x->fwd_txm4x4 = mb->fwd_txm4x4;
+
+  // The motion vector cost tables are only read while the workers run, so
+  // they are shared with the template.
+  vp9_copy(x->nmvjointcost, mb->nmvjointcost);
+  vp9_copy(x->nmvjointsadcost, mb->nmvjointsadcost);
+  x->nmvsadcost[0] = mb->nmvsadcost[0];
+  x->nmvsadcost[1] = mb->nmvsadcost[1];
+  x->mvcost = mb->mvcost;
+  x->mvsadcost = mb->mvsadcost;
+
+  vp9_copy(x->mbmode_cost, mb->mbmode_cost);
+  vp9_copy(x->inter_mode_cost, mb->inter_mode_cost);
+  vp9_copy(x->intra_uv_mode_cost, mb->intra_uv_mode_cost);
+  vp9_copy(x->y_mode_costs, mb->y_mode_costs);
+  vp9_copy(x->switchable_interp_costs, mb->switchable_interp_costs);
+  vp9_copy(x->partition_cost, mb->partition_cost);
+  vp9_copy(x->token_costs, mb->token_costs);
+
+  vp9_zero(x->counts);
+  vp9_zero(x->coef_counts);
+  vp9_zero(x->rd_comp_pred_diff);
+  vp9_zero(x->rd_tx_select_diff);
+  vp9_zero(x->rd_filter_diff);
+  vp9_zero(x->mode_chosen_counts);
+  vp9_zero(x->tx_stepdown_count);
+}
+
+static void alloc_enc_workers(VP9_COMP *cpi, int num_workers) {
+  VP9_COMMON *const cm = &cpi->common;
+  int i;
+
+  if (num_workers <= cpi->num_enc_workers)
+    return;
+
+  // The threads of the existing workers refer to their VP9Worker, so all of
+  // them are recreated rather than moved.
+  vp9_free_enc_workers(cpi);
+
+  CHECK_MEM_ERROR(cm, cpi->enc_workers,
+                  vpx_calloc(num_workers, sizeof(*cpi->enc_workers)));
+  for (i = 0; i < num_workers; ++i) {
+    VP9Worker *const worker = &cpi->enc_workers[i];
+    EncWorkerData *data;
+    ++cpi->num_enc_workers;
+
+    vp9_worker_init(worker);
+    CHECK_MEM_ERROR(cm, data, vpx_memalign(32, sizeof(*data)));
+    vpx_memset(data, 0, sizeof(*data));
+    worker->data1 = data;
+    vp9_init_pick_mode_context(cm, &data->mb);
+    if (i < num_workers - 1 && !vp9_worker_reset(worker)) {
+      vpx_internal_error(&cm->error, VPX_CODEC_ERROR,
+                         "Encoder thread creation failed");
+    }
+  }
+}
+
+void vp9_run_enc_workers(VP9_COMP *cpi, VP9WorkerHook hook, void *data2,
+                         int num_workers) {
+  int i;
+
+  alloc_enc_workers(cpi, num_workers);
+
+  for (i = 0; i < num_workers; ++i) {
+    VP9Worker *const worker = &cpi->enc_workers[i];
+    EncWorkerData *const data = (EncWorkerData*)worker->data1;
+
+    worker->hook = hook;
+    worker->data2 = data2;
+    data->cpi = cpi;
+    data->start = i;
+    data->num_workers = num_workers;
+    worker->had_error = 0;
+    if (i == num_workers - 1)
+      vp9_worker_execute(worker);
+    else
+      vp9_worker_launch(worker);
+  }
+
+  for (i = 0; i < num_workers - 1; ++i)
+    vp9_worker_sync(&cpi->enc_workers[i]);
+}
+
+void vp9_free_enc_workers(VP9_COMP *cpi) {
+  int i;
+
+  for (i = 0; i < cpi->num_enc_workers; ++i) {
+    VP9Worker *const worker = &cpi->enc_workers[i];
+    EncWorkerData *const data = (EncWorkerData*)worker->data1;
+    vp9_worker_end(worker);
+    if (data) {
+      vp9_free_pick_mode_context(&data->mb);
+      vpx_free(data);
+    }
+  }
+  vpx_free(cpi->enc_workers);
+  cpi->enc_workers = NULL;
+  cpi->num_enc_workers = 0;
+}
+
+void vp9_row_sync_init(VP9_COMMON *cm, ROW_SYNC *sync) {
+#if CONFIG_MULTITHREAD
+  if (pthread_mutex_init(&sync->mutex, NULL) ||
+      pthread_cond_init(&sync->cond, NULL)) {
+    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                       "Failed to init row sync");
+  }
+#else
+  (void)cm;
+#endif
+  sync->done = 0;
+}
+
+void vp9_row_sync_free(ROW_SYNC *sync) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&sync->mutex);
+  pthread_cond_destroy(&sync->cond);
+#else
+  (void)sync;
+#endif
+}
+
+void vp9_row_sync_read(ROW_SYNC *sync, int num_done) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&sync->mutex);
+  while (sync->done < num_done)
+    pthread_cond_wait(&sync->cond, &sync->mutex);
+  pthread_mutex_unlock(&sync->mutex);
+#else
+  assert(sync->done >= num_done);
+#endif
+}
+
+void vp9_row_sync_write(ROW_SYNC *sync) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&sync->mutex);
+  ++sync->done;
+  pthread_cond_signal(&sync->cond);
+  pthread_mutex_unlock(&sync->mutex);
+#else
+  ++sync->done;
+#endif
+}
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VP9_ENCODER_VP9_ETHREAD_H_
+#define VP9_ENCODER_VP9_ETHREAD_H_
+
+#include "vp9/encoder/vp9_onyx_int.h"
+
+// Worker running jobs start, start + num_workers, ... of the current task with
+// its own MACROBLOCK.
+typedef struct {
+  MACROBLOCK mb;
+  // Mode info of tasks that work on a single block, which mb.e_mbd.mi_8x8
+  // points to while they run.
+  MODE_INFO mi;
+  MODE_INFO *mi_8x8;
+  VP9_COMP *cpi;
+  int start;
+  int num_workers;
+} EncWorkerData;
+
+// Returns how many workers to use for a task of which at most max_workers
+// jobs can run at the same time.
+int vp9_get_num_enc_workers(const VP9_COMP *cpi, int max_workers);
+
+// Prepares the coding state of a worker for the current frame from the
+// template in cpi->mb.
+void vp9_init_worker_mb(VP9_COMP *cpi, MACROBLOCK *x);
+
+// Runs hook on num_workers workers, the last of them on the calling thread,
+// and returns once all of them are done. hook gets the EncWorkerData of its
+// worker and data2.
+void vp9_run_enc_workers(VP9_COMP *cpi, VP9WorkerHook hook, void *data2,
+                         int num_workers);
+
+void vp9_free_enc_workers(VP9_COMP *cpi);
+
+void vp9_row_sync_init(VP9_COMMON *cm, ROW_SYNC *sync);
+void vp9_row_sync_free(ROW_SYNC *sync);
+
+// Waits until at least num_done blocks of the row are done.
+void vp9_row_sync_read(ROW_SYNC *sync, int num_done);
+
+// Marks one more block of the row as done.
+void vp9_row_sync_write(ROW_SYNC *sync);
+
+#endif  // VP9_ENCODER_VP9_ETHREAD_H_
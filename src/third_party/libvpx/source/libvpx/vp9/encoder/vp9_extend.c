@@ -8,17 +8,42 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <assert.h>
+
 #include "vpx_mem/vpx_mem.h"
 
 #include "vp9/common/vp9_common.h"
 #include "vp9/encoder/vp9_extend.h"
 
+// Copies the top and bottom lines, already extended left and right, into each
+// line of the respective borders.
+static void extend_top_and_bottom(uint8_t *buf, int pitch, int w, int h,
+                                  int extend_top, int extend_left,
+                                  int extend_bottom, int extend_right) {
+  int i;
+  const int linesize = extend_left + extend_right + w;
+  const uint8_t *src_ptr1 = buf - extend_left;
+  const uint8_t *src_ptr2 = buf + pitch * (h - 1) - extend_left;
+  uint8_t *dst_ptr1 = buf + pitch * (-extend_top) - extend_left;
+  uint8_t *dst_ptr2 = buf + pitch * (h) - extend_left;
+
+  for (i = 0; i < extend_top; i++) {
+    vpx_memcpy(dst_ptr1, src_ptr1, linesize);
+    dst_ptr1 += pitch;
+  }
+
+  for (i = 0; i < extend_bottom; i++) {
+    vpx_memcpy(dst_ptr2, src_ptr2, linesize);
+    dst_ptr2 += pitch;
+  }
+}
+
 static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
                                   uint8_t *dst, int dst_pitch,
                                   int w, int h,
                                   int extend_top, int extend_left,
                                   int extend_bottom, int extend_right) {
-  int i, linesize;
+  int i;
 
   // copy the left and right most columns out
   const uint8_t *src_ptr1 = src;
@@ -36,38 +61,44 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
     dst_ptr2 += dst_pitch;
   }
 
-  // Now copy the top and bottom lines into each line of the respective
-  // borders
-  src_ptr1 = dst - extend_left;
-  src_ptr2 = dst + dst_pitch * (h - 1) - extend_left;
-  dst_ptr1 = dst + dst_pitch * (-extend_top) - extend_left;
-  dst_ptr2 = dst + dst_pitch * (h) - extend_left;
-  linesize = extend_left + extend_right + w;
+  extend_top_and_bottom(dst, dst_pitch, w, h,
+                        extend_top, extend_left, extend_bottom, extend_right);
+}
 
-  for (i = 0; i < extend_top; i++) {
-    vpx_memcpy(dst_ptr1, src_ptr1, linesize);
-    dst_ptr1 += dst_pitch;
-  }
+static void extend_plane(uint8_t *buf, int pitch, int w, int h,
+                         int extend_top, int extend_left,
+                         int extend_bottom, int extend_right) {
+  int i;
+  uint8_t *row = buf;
 
-  for (i = 0; i < extend_bottom; i++) {
-    vpx_memcpy(dst_ptr2, src_ptr2, linesize);
-    dst_ptr2 += dst_pitch;
+  // extend the left and right most columns in place
+  for (i = 0; i < h; i++) {
+    vpx_memset(row - extend_left, row[0], extend_left);
+    vpx_memset(row + w, row[w - 1], extend_right);
+    row += pitch;
   }
+
+  extend_top_and_bottom(buf, pitch, w, h,
+                        extend_top, extend_left, extend_bottom, extend_right);
+}
+
+// Altref filtering assumes 16 pixel extension
+#define SOURCE_EXTEND 16
+
+// Motion estimation may use src block variance with the block size up
+// to 64x64, so the right and bottom need to be extended to 64 multiple
+// or up to 16, whichever is greater.
+static int source_extend_far_edge(int size) {
+  return MAX(ALIGN_POWER_OF_TWO(size, 6) - size, SOURCE_EXTEND);
 }
 
 void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst) {
   // Extend src frame in buffer
-  // Altref filtering assumes 16 pixel extension
-  const int et_y = 16;
-  const int el_y = 16;
-  // Motion estimation may use src block variance with the block size up
-  // to 64x64, so the right and bottom need to be extended to 64 multiple
-  // or up to 16, whichever is greater.
-  const int eb_y = MAX(ALIGN_POWER_OF_TWO(src->y_width, 6) - src->y_width,
-                       16);
-  const int er_y = MAX(ALIGN_POWER_OF_TWO(src->y_height, 6) - src->y_height,
-                       16);
+  const int et_y = SOURCE_EXTEND;
+  const int el_y = SOURCE_EXTEND;
+  const int eb_y = source_extend_far_edge(src->y_height);
+  const int er_y = source_extend_far_edge(src->y_width);
   const int uv_width_subsampling = (src->uv_width != src->y_width);
   const int uv_height_subsampling = (src->uv_height != src->y_height);
   const int et_uv = et_y >> uv_height_subsampling;
@@ -103,6 +134,34 @@ void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                         et_uv, el_uv, eb_uv, er_uv);
 }
 
+int vp9_source_frame_border_fits(const YV12_BUFFER_CONFIG *ybf) {
+  return ybf->border >= source_extend_far_edge(ybf->y_crop_width) &&
+         ybf->border >= source_extend_far_edge(ybf->y_crop_height);
+}
+
+void vp9_extend_source_frame(YV12_BUFFER_CONFIG *ybf, int near_edges) {
+  const int ss_x = ybf->uv_width < ybf->y_width;
+  const int ss_y = ybf->uv_height < ybf->y_height;
+  const int et_y = near_edges ? SOURCE_EXTEND : 0;
+  const int el_y = near_edges ? SOURCE_EXTEND : 0;
+  const int eb_y = source_extend_far_edge(ybf->y_crop_height);
+  const int er_y = source_extend_far_edge(ybf->y_crop_width);
+
+  assert(vp9_source_frame_border_fits(ybf));
+
+  extend_plane(ybf->y_buffer, ybf->y_stride,
+               ybf->y_crop_width, ybf->y_crop_height,
+               et_y, el_y, eb_y, er_y);
+
+  extend_plane(ybf->u_buffer, ybf->uv_stride,
+               ybf->uv_crop_width, ybf->uv_crop_height,
+               et_y >> ss_y, el_y >> ss_x, eb_y >> ss_y, er_y >> ss_x);
+
+  extend_plane(ybf->v_buffer, ybf->uv_stride,
+               ybf->uv_crop_width, ybf->uv_crop_height,
+               et_y >> ss_y, el_y >> ss_x, eb_y >> ss_y, er_y >> ss_x);
+}
+
 void vp9_copy_and_extend_frame_with_rect(const YV12_BUFFER_CONFIG *src,
                                          YV12_BUFFER_CONFIG *dst,
                                          int srcy, int srcx,
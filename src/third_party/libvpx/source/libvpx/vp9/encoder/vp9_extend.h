@@ -18,6 +18,15 @@
 void vp9_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst);
 
+// Returns non-zero if the border of ybf, a source frame referenced rather
+// than copied, has room for the extension vp9_copy_and_extend_frame() does.
+int vp9_source_frame_border_fits(const YV12_BUFFER_CONFIG *ybf);
+
+// Extends a referenced source frame in place like vp9_copy_and_extend_frame()
+// extends its copy. The right and bottom edges, which source blocks read past
+// the frame, are always extended; the top and left only with near_edges set.
+void vp9_extend_source_frame(YV12_BUFFER_CONFIG *ybf, int near_edges);
+
 void vp9_copy_and_extend_frame_with_rect(const YV12_BUFFER_CONFIG *src,
                                          YV12_BUFFER_CONFIG *dst,
                                          int srcy, int srcx,
@@ -29,6 +29,7 @@
 #include "vp9/common/vp9_quant_common.h"
 #include "vp9/common/vp9_entropymv.h"
 #include "vp9/encoder/vp9_encodemv.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_vaq.h"
 #include "./vpx_scale_rtcd.h"
 // TODO(jkoleszar): for setup_dst_planes
@@ -471,16 +472,43 @@ static void first_pass_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   }
 }
 
-void vp9_first_pass(VP9_COMP *cpi) {
-  int mb_row, mb_col;
-  MACROBLOCK *const x = &cpi->mb;
+void vp9_free_first_pass_rows(VP9_COMP *cpi) {
+  int i;
+
+  for (i = 0; i < cpi->num_fp_mb_rows; ++i)
+    vp9_row_sync_free(&cpi->fp_mb_rows[i].sync);
+  vpx_free(cpi->fp_mb_rows);
+  cpi->fp_mb_rows = NULL;
+  cpi->num_fp_mb_rows = 0;
+}
+
+static void alloc_first_pass_rows(VP9_COMP *cpi, int mb_rows) {
+  VP9_COMMON *const cm = &cpi->common;
+  int i;
+
+  if (mb_rows <= cpi->num_fp_mb_rows)
+    return;
+
+  vp9_free_first_pass_rows(cpi);
+
+  CHECK_MEM_ERROR(cm, cpi->fp_mb_rows,
+                  vpx_calloc(mb_rows, sizeof(*cpi->fp_mb_rows)));
+  for (i = 0; i < mb_rows; ++i) {
+    vp9_row_sync_init(cm, &cpi->fp_mb_rows[i].sync);
+    ++cpi->num_fp_mb_rows;
+  }
+}
+
+// Codes an MB row of the first pass and collects its statistics. The row
+// only depends on the reconstruction of the rows above, so it is coded the
+// same way whichever worker codes it.
+static void first_pass_mb_row(VP9_COMP *cpi, MACROBLOCK *const x, int mb_row) {
   VP9_COMMON *const cm = &cpi->common;
   MACROBLOCKD *const xd = &x->e_mbd;
+  FIRSTPASS_MB_ROW *const row = &cpi->fp_mb_rows[mb_row];
+  ROW_SYNC *const above = mb_row > 0 ? &row[-1].sync : NULL;
   TileInfo tile;
-  struct macroblock_plane *const p = x->plane;
-  struct macroblockd_plane *const pd = xd->plane;
-  PICK_MODE_CONTEXT *ctx = &x->sb64_context;
-  int i;
+  int mb_col;
 
   int recon_yoffset, recon_uvoffset;
   YV12_BUFFER_CONFIG *const lst_yv12 = get_ref_frame_buffer(cpi, LAST_FRAME);
@@ -489,299 +517,397 @@ void vp9_first_pass(VP9_COMP *cpi) {
   const int recon_y_stride = lst_yv12->y_stride;
   const int recon_uv_stride = lst_yv12->uv_stride;
   const int uv_mb_height = 16 >> (lst_yv12->y_height > lst_yv12->uv_height);
-  int64_t intra_error = 0;
-  int64_t coded_error = 0;
-  int64_t sr_coded_error = 0;
-
-  int sum_mvr = 0, sum_mvc = 0;
-  int sum_mvr_abs = 0, sum_mvc_abs = 0;
-  int sum_mvrs = 0, sum_mvcs = 0;
-  int mvcount = 0;
-  int intercount = 0;
-  int second_ref_count = 0;
-  int intrapenalty = 256;
-  int neutral_count = 0;
-  int new_mv_count = 0;
-  int sum_in_vectors = 0;
+  const int intrapenalty = 256;
   uint32_t lastmv_as_int = 0;
 
-  int_mv zero_ref_mv;
+  int_mv best_ref_mv, zero_ref_mv;
 
+  best_ref_mv.as_int = 0;
   zero_ref_mv.as_int = 0;
 
-  vp9_clear_system_state();  // __asm emms;
-
-  vp9_setup_src_planes(x, cpi->Source, 0, 0);
-  setup_pre_planes(xd, 0, lst_yv12, 0, 0, NULL);
-  setup_dst_planes(xd, new_yv12, 0, 0);
-
-  xd->mi_8x8 = cm->mi_grid_visible;
-  // required for vp9_frame_init_quantizer
-  xd->mi_8x8[0] = cm->mi;
-
-  setup_block_dptrs(&x->e_mbd, cm->subsampling_x, cm->subsampling_y);
-
-  vp9_frame_init_quantizer(cpi);
-
-  for (i = 0; i < MAX_MB_PLANE; ++i) {
-    p[i].coeff = ctx->coeff_pbuf[i][1];
-    p[i].qcoeff = ctx->qcoeff_pbuf[i][1];
-    pd[i].dqcoeff = ctx->dqcoeff_pbuf[i][1];
-    p[i].eobs = ctx->eobs_pbuf[i][1];
-  }
-  x->skip_recode = 0;
-
-
-  // Initialise the MV cost table to the defaults
-  // if( cm->current_video_frame == 0)
-  // if ( 0 )
-  {
-    vp9_init_mv_probs(cm);
-    vp9_initialize_rd_consts(cpi);
-  }
+  row->intra_error = 0;
+  row->coded_error = 0;
+  row->sr_coded_error = 0;
+  row->sum_mvr = row->sum_mvc = 0;
+  row->sum_mvr_abs = row->sum_mvc_abs = 0;
+  row->sum_mvrs = row->sum_mvcs = 0;
+  row->mvcount = 0;
+  row->intercount = 0;
+  row->second_ref_count = 0;
+  row->neutral_count = 0;
+  row->new_mv_count = 0;
+  row->sum_in_vectors = 0;
+  row->first_mv_as_int = 0;
 
   // tiling is ignored in the first pass
   vp9_tile_init(&tile, cm, 0, 0);
 
-  // for each macroblock row in image
-  for (mb_row = 0; mb_row < cm->mb_rows; mb_row++) {
-    int_mv best_ref_mv;
+  vp9_setup_src_planes(x, cpi->Source, mb_row << 1, 0);
+
+  // vp9_encode_intra() measures the error over the whole MB, so an MB cut by
+  // the frame edge also counts the residual the MB coded before it left
+  // behind. For the first MB of a row that is the last MB of the row above,
+  // or of the previous frame.
+  if (mb_row * 2 + 1 >= cm->mi_rows || cm->mi_cols == 1) {
+    const FIRSTPASS_MB_ROW *const prev =
+        above ? &row[-1] : &cpi->fp_mb_rows[cm->mb_rows - 1];
+    if (above)
+      vp9_row_sync_read(above, cm->mb_cols);
+    vpx_memcpy(x->plane[0].src_diff, prev->src_diff, sizeof(prev->src_diff));
+  }
 
-    best_ref_mv.as_int = 0;
+  // reset above block coeffs
+  xd->up_available = (mb_row != 0);
+  recon_yoffset = (mb_row * recon_y_stride * 16);
+  recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
+
+  // Set up limit values for motion vectors to prevent them extending
+  // outside the UMV borders
+  x->mv_row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
+  x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16)
+                  + BORDER_MV_PIXELS_B16;
+
+  // for each macroblock col in image
+  for (mb_col = 0; mb_col < cm->mb_cols; mb_col++) {
+    int this_error;
+    int gf_motion_error = INT_MAX;
+    int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
+    double error_weight = 1.0;
+
+    // The intra prediction reads the reconstruction up to the MB above and to
+    // the right.
+    if (above)
+      vp9_row_sync_read(above, MIN(mb_col + 2, cm->mb_cols));
 
-    // reset above block coeffs
-    xd->up_available = (mb_row != 0);
-    recon_yoffset = (mb_row * recon_y_stride * 16);
-    recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
+    vp9_clear_system_state();  // __asm emms;
 
-    // Set up limit values for motion vectors to prevent them extending
-    // outside the UMV borders
-    x->mv_row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
-    x->mv_row_max = ((cm->mb_rows - 1 - mb_row) * 16)
-                    + BORDER_MV_PIXELS_B16;
+    xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
+    xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
+    xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
+    xd->left_available = (mb_col != 0);
 
-    // for each macroblock col in image
-    for (mb_col = 0; mb_col < cm->mb_cols; mb_col++) {
-      int this_error;
-      int gf_motion_error = INT_MAX;
-      int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
-      double error_weight = 1.0;
+    if (mb_col * 2 + 1 < cm->mi_cols) {
+      if (mb_row * 2 + 1 < cm->mi_rows) {
+        xd->mi_8x8[0]->mbmi.sb_type = BLOCK_16X16;
+      } else {
+        xd->mi_8x8[0]->mbmi.sb_type = BLOCK_16X8;
+      }
+    } else {
+      if (mb_row * 2 + 1 < cm->mi_rows) {
+        xd->mi_8x8[0]->mbmi.sb_type = BLOCK_8X16;
+      } else {
+        xd->mi_8x8[0]->mbmi.sb_type = BLOCK_8X8;
+      }
+    }
+    xd->mi_8x8[0]->mbmi.ref_frame[0] = INTRA_FRAME;
+    set_mi_row_col(xd, &tile,
+                   mb_row << 1,
+                   num_8x8_blocks_high_lookup[xd->mi_8x8[0]->mbmi.sb_type],
+                   mb_col << 1,
+                   num_8x8_blocks_wide_lookup[xd->mi_8x8[0]->mbmi.sb_type],
+                   cm->mi_rows, cm->mi_cols);
+
+    if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
+      int energy = vp9_block_energy(cpi, x, xd->mi_8x8[0]->mbmi.sb_type);
+      error_weight = vp9_vaq_inv_q_ratio(energy);
+    }
 
+    // do intra 16x16 prediction
+    this_error = vp9_encode_intra(x, use_dc_pred);
+    if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
       vp9_clear_system_state();  // __asm emms;
+      this_error *= error_weight;
+    }
 
-      xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
-      xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
-      xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
-      xd->left_available = (mb_col != 0);
+    // intrapenalty below deals with situations where the intra and inter
+    // error scores are very low (eg a plain black frame).
+    // We do not have special cases in first pass for 0,0 and nearest etc so
+    // all inter modes carry an overhead cost estimate for the mv.
+    // When the error score is very low this causes us to pick all or lots of
+    // INTRA modes and throw lots of key frames.
+    // This penalty adds a cost matching that of a 0,0 mv to the intra case.
+    this_error += intrapenalty;
 
-      if (mb_col * 2 + 1 < cm->mi_cols) {
-        if (mb_row * 2 + 1 < cm->mi_rows) {
-          xd->mi_8x8[0]->mbmi.sb_type = BLOCK_16X16;
-        } else {
-          xd->mi_8x8[0]->mbmi.sb_type = BLOCK_16X8;
-        }
-      } else {
-        if (mb_row * 2 + 1 < cm->mi_rows) {
-          xd->mi_8x8[0]->mbmi.sb_type = BLOCK_8X16;
-        } else {
-          xd->mi_8x8[0]->mbmi.sb_type = BLOCK_8X8;
-        }
-      }
-      xd->mi_8x8[0]->mbmi.ref_frame[0] = INTRA_FRAME;
-      set_mi_row_col(xd, &tile,
-                     mb_row << 1,
-                     num_8x8_blocks_high_lookup[xd->mi_8x8[0]->mbmi.sb_type],
-                     mb_col << 1,
-                     num_8x8_blocks_wide_lookup[xd->mi_8x8[0]->mbmi.sb_type],
-                     cm->mi_rows, cm->mi_cols);
+    // Cumulative intra error total
+    row->intra_error += (int64_t)this_error;
 
-      if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
-        int energy = vp9_block_energy(cpi, x, xd->mi_8x8[0]->mbmi.sb_type);
-        error_weight = vp9_vaq_inv_q_ratio(energy);
-      }
+    // Set up limit values for motion vectors to prevent them extending
+    // outside the UMV borders.
+    x->mv_col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
+    x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16)
+                    + BORDER_MV_PIXELS_B16;
 
-      // do intra 16x16 prediction
-      this_error = vp9_encode_intra(x, use_dc_pred);
+    // Other than for the first frame do a motion search
+    if (cm->current_video_frame > 0) {
+      int tmp_err;
+      int motion_error = zz_motion_search(cpi, x, lst_yv12, recon_yoffset);
+      int_mv mv, tmp_mv;
+      // Simple 0,0 motion with no mv overhead
+      mv.as_int = tmp_mv.as_int = 0;
+
+      // Test last reference frame using the previous best mv as the
+      // starting point (best reference) for the search
+      first_pass_motion_search(cpi, x, &best_ref_mv.as_mv, &mv.as_mv,
+                               lst_yv12, &motion_error, recon_yoffset);
       if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
         vp9_clear_system_state();  // __asm emms;
-        this_error *= error_weight;
+        motion_error *= error_weight;
       }
 
-      // intrapenalty below deals with situations where the intra and inter
-      // error scores are very low (eg a plain black frame).
-      // We do not have special cases in first pass for 0,0 and nearest etc so
-      // all inter modes carry an overhead cost estimate for the mv.
-      // When the error score is very low this causes us to pick all or lots of
-      // INTRA modes and throw lots of key frames.
-      // This penalty adds a cost matching that of a 0,0 mv to the intra case.
-      this_error += intrapenalty;
-
-      // Cumulative intra error total
-      intra_error += (int64_t)this_error;
-
-      // Set up limit values for motion vectors to prevent them extending
-      // outside the UMV borders.
-      x->mv_col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
-      x->mv_col_max = ((cm->mb_cols - 1 - mb_col) * 16)
-                      + BORDER_MV_PIXELS_B16;
-
-      // Other than for the first frame do a motion search
-      if (cm->current_video_frame > 0) {
-        int tmp_err;
-        int motion_error = zz_motion_search(cpi, x, lst_yv12, recon_yoffset);
-        int_mv mv, tmp_mv;
+      // If the current best reference mv is not centered on 0,0 then do a 0,0
+      // based search as well.
+      if (best_ref_mv.as_int) {
+        tmp_err = INT_MAX;
+        first_pass_motion_search(cpi, x, &zero_ref_mv.as_mv, &tmp_mv.as_mv,
+                                 lst_yv12, &tmp_err, recon_yoffset);
+        if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
+          vp9_clear_system_state();  // __asm emms;
+          tmp_err *= error_weight;
+        }
+
+        if (tmp_err < motion_error) {
+          motion_error = tmp_err;
+          mv.as_int = tmp_mv.as_int;
+        }
+      }
+
+      // Experimental search in an older reference frame
+      if (cm->current_video_frame > 1) {
         // Simple 0,0 motion with no mv overhead
-        mv.as_int = tmp_mv.as_int = 0;
+        gf_motion_error = zz_motion_search(cpi, x, gld_yv12, recon_yoffset);
 
-        // Test last reference frame using the previous best mv as the
-        // starting point (best reference) for the search
-        first_pass_motion_search(cpi, x, &best_ref_mv.as_mv, &mv.as_mv,
-                                 lst_yv12, &motion_error, recon_yoffset);
+        first_pass_motion_search(cpi, x, &zero_ref_mv.as_mv, &tmp_mv.as_mv,
+                                 gld_yv12, &gf_motion_error, recon_yoffset);
         if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
           vp9_clear_system_state();  // __asm emms;
-          motion_error *= error_weight;
+          gf_motion_error *= error_weight;
         }
 
-        // If the current best reference mv is not centered on 0,0 then do a 0,0
-        // based search as well.
-        if (best_ref_mv.as_int) {
-          tmp_err = INT_MAX;
-          first_pass_motion_search(cpi, x, &zero_ref_mv.as_mv, &tmp_mv.as_mv,
-                                   lst_yv12, &tmp_err, recon_yoffset);
-          if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
-            vp9_clear_system_state();  // __asm emms;
-            tmp_err *= error_weight;
+        if ((gf_motion_error < motion_error) &&
+            (gf_motion_error < this_error)) {
+          row->second_ref_count++;
+        }
+
+        // Reset to last frame as reference buffer
+        xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
+        xd->plane[1].pre[0].buf = lst_yv12->u_buffer + recon_uvoffset;
+        xd->plane[2].pre[0].buf = lst_yv12->v_buffer + recon_uvoffset;
+
+        // In accumulating a score for the older reference frame
+        // take the best of the motion predicted score and
+        // the intra coded error (just as will be done for)
+        // accumulation of "coded_error" for the last frame.
+        if (gf_motion_error < this_error)
+          row->sr_coded_error += gf_motion_error;
+        else
+          row->sr_coded_error += this_error;
+      } else {
+        row->sr_coded_error += motion_error;
+      }
+      /* Intra assumed best */
+      best_ref_mv.as_int = 0;
+
+      if (motion_error <= this_error) {
+        // Keep a count of cases where the inter and intra were
+        // very close and very low. This helps with scene cut
+        // detection for example in cropped clips with black bars
+        // at the sides or top and bottom.
+        if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
+            this_error < 2 * intrapenalty)
+          row->neutral_count++;
+
+        mv.as_mv.row *= 8;
+        mv.as_mv.col *= 8;
+        this_error = motion_error;
+        vp9_set_mbmode_and_mvs(xd, NEWMV, &mv.as_mv);
+        xd->mi_8x8[0]->mbmi.tx_size = TX_4X4;
+        xd->mi_8x8[0]->mbmi.ref_frame[0] = LAST_FRAME;
+        xd->mi_8x8[0]->mbmi.ref_frame[1] = NONE;
+        vp9_build_inter_predictors_sby(xd, mb_row << 1, mb_col << 1,
+                                       xd->mi_8x8[0]->mbmi.sb_type);
+        vp9_encode_sby(x, xd->mi_8x8[0]->mbmi.sb_type);
+        row->sum_mvr += mv.as_mv.row;
+        row->sum_mvr_abs += abs(mv.as_mv.row);
+        row->sum_mvc += mv.as_mv.col;
+        row->sum_mvc_abs += abs(mv.as_mv.col);
+        row->sum_mvrs += mv.as_mv.row * mv.as_mv.row;
+        row->sum_mvcs += mv.as_mv.col * mv.as_mv.col;
+        row->intercount++;
+
+        best_ref_mv.as_int = mv.as_int;
+
+        // Was the vector non-zero
+        if (mv.as_int) {
+          row->mvcount++;
+
+          // Was it different from the last non zero vector
+          if (mv.as_int != lastmv_as_int)
+            row->new_mv_count++;
+          lastmv_as_int = mv.as_int;
+          if (!row->first_mv_as_int)
+            row->first_mv_as_int = mv.as_int;
+
+          // Does the Row vector point inwards or outwards
+          if (mb_row < cm->mb_rows / 2) {
+            if (mv.as_mv.row > 0)
+              row->sum_in_vectors--;
+            else if (mv.as_mv.row < 0)
+              row->sum_in_vectors++;
+          } else if (mb_row > cm->mb_rows / 2) {
+            if (mv.as_mv.row > 0)
+              row->sum_in_vectors++;
+            else if (mv.as_mv.row < 0)
+              row->sum_in_vectors--;
           }
 
-          if (tmp_err < motion_error) {
-            motion_error = tmp_err;
-            mv.as_int = tmp_mv.as_int;
+          // Does the Row vector point inwards or outwards
+          if (mb_col < cm->mb_cols / 2) {
+            if (mv.as_mv.col > 0)
+              row->sum_in_vectors--;
+            else if (mv.as_mv.col < 0)
+              row->sum_in_vectors++;
+          } else if (mb_col > cm->mb_cols / 2) {
+            if (mv.as_mv.col > 0)
+              row->sum_in_vectors++;
+            else if (mv.as_mv.col < 0)
+              row->sum_in_vectors--;
           }
         }
+      }
+    } else {
+      row->sr_coded_error += (int64_t)this_error;
+    }
+    row->coded_error += (int64_t)this_error;
 
-        // Experimental search in an older reference frame
-        if (cm->current_video_frame > 1) {
-          // Simple 0,0 motion with no mv overhead
-          gf_motion_error = zz_motion_search(cpi, x, gld_yv12, recon_yoffset);
+    // adjust to the next column of macroblocks
+    x->plane[0].src.buf += 16;
+    x->plane[1].src.buf += uv_mb_height;
+    x->plane[2].src.buf += uv_mb_height;
 
-          first_pass_motion_search(cpi, x, &zero_ref_mv.as_mv, &tmp_mv.as_mv,
-                                   gld_yv12, &gf_motion_error, recon_yoffset);
-          if (cpi->oxcf.aq_mode == VARIANCE_AQ) {
-            vp9_clear_system_state();  // __asm emms;
-            gf_motion_error *= error_weight;
-          }
+    recon_yoffset += 16;
+    recon_uvoffset += uv_mb_height;
 
-          if ((gf_motion_error < motion_error) &&
-              (gf_motion_error < this_error)) {
-            second_ref_count++;
-          }
+    if (mb_col == cm->mb_cols - 1)
+      vpx_memcpy(row->src_diff, x->plane[0].src_diff, sizeof(row->src_diff));
+    vp9_row_sync_write(&row->sync);
+  }
 
-          // Reset to last frame as reference buffer
-          xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
-          xd->plane[1].pre[0].buf = lst_yv12->u_buffer + recon_uvoffset;
-          xd->plane[2].pre[0].buf = lst_yv12->v_buffer + recon_uvoffset;
-
-          // In accumulating a score for the older reference frame
-          // take the best of the motion predicted score and
-          // the intra coded error (just as will be done for)
-          // accumulation of "coded_error" for the last frame.
-          if (gf_motion_error < this_error)
-            sr_coded_error += gf_motion_error;
-          else
-            sr_coded_error += this_error;
-        } else {
-          sr_coded_error += motion_error;
-        }
-        /* Intra assumed best */
-        best_ref_mv.as_int = 0;
-
-        if (motion_error <= this_error) {
-          // Keep a count of cases where the inter and intra were
-          // very close and very low. This helps with scene cut
-          // detection for example in cropped clips with black bars
-          // at the sides or top and bottom.
-          if (((this_error - intrapenalty) * 9 <= motion_error * 10) &&
-              this_error < 2 * intrapenalty)
-            neutral_count++;
-
-          mv.as_mv.row *= 8;
-          mv.as_mv.col *= 8;
-          this_error = motion_error;
-          vp9_set_mbmode_and_mvs(xd, NEWMV, &mv.as_mv);
-          xd->mi_8x8[0]->mbmi.tx_size = TX_4X4;
-          xd->mi_8x8[0]->mbmi.ref_frame[0] = LAST_FRAME;
-          xd->mi_8x8[0]->mbmi.ref_frame[1] = NONE;
-          vp9_build_inter_predictors_sby(xd, mb_row << 1, mb_col << 1,
-                                         xd->mi_8x8[0]->mbmi.sb_type);
-          vp9_encode_sby(x, xd->mi_8x8[0]->mbmi.sb_type);
-          sum_mvr += mv.as_mv.row;
-          sum_mvr_abs += abs(mv.as_mv.row);
-          sum_mvc += mv.as_mv.col;
-          sum_mvc_abs += abs(mv.as_mv.col);
-          sum_mvrs += mv.as_mv.row * mv.as_mv.row;
-          sum_mvcs += mv.as_mv.col * mv.as_mv.col;
-          intercount++;
-
-          best_ref_mv.as_int = mv.as_int;
-
-          // Was the vector non-zero
-          if (mv.as_int) {
-            mvcount++;
-
-            // Was it different from the last non zero vector
-            if (mv.as_int != lastmv_as_int)
-              new_mv_count++;
-            lastmv_as_int = mv.as_int;
-
-            // Does the Row vector point inwards or outwards
-            if (mb_row < cm->mb_rows / 2) {
-              if (mv.as_mv.row > 0)
-                sum_in_vectors--;
-              else if (mv.as_mv.row < 0)
-                sum_in_vectors++;
-            } else if (mb_row > cm->mb_rows / 2) {
-              if (mv.as_mv.row > 0)
-                sum_in_vectors++;
-              else if (mv.as_mv.row < 0)
-                sum_in_vectors--;
-            }
-
-            // Does the Row vector point inwards or outwards
-            if (mb_col < cm->mb_cols / 2) {
-              if (mv.as_mv.col > 0)
-                sum_in_vectors--;
-              else if (mv.as_mv.col < 0)
-                sum_in_vectors++;
-            } else if (mb_col > cm->mb_cols / 2) {
-              if (mv.as_mv.col > 0)
-                sum_in_vectors++;
-              else if (mv.as_mv.col < 0)
-                sum_in_vectors--;
-            }
-          }
-        }
-      } else {
-        sr_coded_error += (int64_t)this_error;
-      }
-      coded_error += (int64_t)this_error;
+  row->last_mv_as_int = lastmv_as_int;
 
-      // adjust to the next column of macroblocks
-      x->plane[0].src.buf += 16;
-      x->plane[1].src.buf += uv_mb_height;
-      x->plane[2].src.buf += uv_mb_height;
+  vp9_clear_system_state();  // __asm emms;
+}
 
-      recon_yoffset += 16;
-      recon_uvoffset += uv_mb_height;
-    }
+// Codes MB rows start, start + num_workers, ... of the first pass frame.
+static int first_pass_worker(void *arg1, void *arg2) {
+  EncWorkerData *const data = (EncWorkerData*)arg1;
+  VP9_COMP *const cpi = data->cpi;
+  MACROBLOCK *const x = &data->mb;
+  PICK_MODE_CONTEXT *const ctx = &x->sb64_context;
+  // Every MB sets the parts of the mode info it reads, so each worker can
+  // code its MBs with a copy of its own.
+  MODE_INFO mi = *cpi->common.mi;
+  MODE_INFO *mi_8x8 = &mi;
+  int mb_row, i;
+  (void)arg2;
+
+  vp9_init_worker_mb(cpi, x);
+  x->e_mbd.mi_8x8 = &mi_8x8;
 
-    // adjust to the next row of mbs
-    x->plane[0].src.buf += 16 * x->plane[0].src.stride - 16 * cm->mb_cols;
-    x->plane[1].src.buf += uv_mb_height * x->plane[1].src.stride -
-                           uv_mb_height * cm->mb_cols;
-    x->plane[2].src.buf += uv_mb_height * x->plane[1].src.stride -
-                           uv_mb_height * cm->mb_cols;
+  for (i = 0; i < MAX_MB_PLANE; ++i) {
+    x->plane[i].coeff = ctx->coeff_pbuf[i][1];
+    x->plane[i].qcoeff = ctx->qcoeff_pbuf[i][1];
+    x->e_mbd.plane[i].dqcoeff = ctx->dqcoeff_pbuf[i][1];
+    x->plane[i].eobs = ctx->eobs_pbuf[i][1];
+  }
+  x->skip_recode = 0;
 
-    vp9_clear_system_state();  // __asm emms;
+  for (mb_row = data->start; mb_row < cpi->common.mb_rows;
+       mb_row += data->num_workers)
+    first_pass_mb_row(cpi, x, mb_row);
+  return 1;
+}
+
+void vp9_first_pass(VP9_COMP *cpi) {
+  int mb_row;
+  MACROBLOCK *const x = &cpi->mb;
+  VP9_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  int num_workers;
+
+  YV12_BUFFER_CONFIG *const lst_yv12 = get_ref_frame_buffer(cpi, LAST_FRAME);
+  YV12_BUFFER_CONFIG *const gld_yv12 = get_ref_frame_buffer(cpi, GOLDEN_FRAME);
+  YV12_BUFFER_CONFIG *const new_yv12 = get_frame_new_buffer(cm);
+  int64_t intra_error = 0;
+  int64_t coded_error = 0;
+  int64_t sr_coded_error = 0;
+
+  int sum_mvr = 0, sum_mvc = 0;
+  int sum_mvr_abs = 0, sum_mvc_abs = 0;
+  int sum_mvrs = 0, sum_mvcs = 0;
+  int mvcount = 0;
+  int intercount = 0;
+  int second_ref_count = 0;
+  int neutral_count = 0;
+  int new_mv_count = 0;
+  int sum_in_vectors = 0;
+  uint32_t lastmv_as_int = 0;
+
+  vp9_clear_system_state();  // __asm emms;
+
+  vp9_setup_src_planes(x, cpi->Source, 0, 0);
+  setup_pre_planes(xd, 0, lst_yv12, 0, 0, NULL);
+  setup_dst_planes(xd, new_yv12, 0, 0);
+
+  xd->mi_8x8 = cm->mi_grid_visible;
+  // required for vp9_frame_init_quantizer
+  xd->mi_8x8[0] = cm->mi;
+
+  setup_block_dptrs(&x->e_mbd, cm->subsampling_x, cm->subsampling_y);
+
+  vp9_frame_init_quantizer(cpi);
+
+  // Initialise the MV cost table to the defaults
+  // if( cm->current_video_frame == 0)
+  // if ( 0 )
+  {
+    vp9_init_mv_probs(cm);
+    vp9_initialize_rd_consts(cpi);
+  }
+
+  // The MB rows are coded as a wavefront, each row two MBs behind the one
+  // above.
+  num_workers = vp9_get_num_enc_workers(cpi, MIN(cm->mb_rows,
+                                                 (cm->mb_cols + 1) >> 1));
+  alloc_first_pass_rows(cpi, cm->mb_rows);
+  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row)
+    cpi->fp_mb_rows[mb_row].sync.done = 0;
+
+  vp9_run_enc_workers(cpi, first_pass_worker, NULL, num_workers);
+
+  for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
+    const FIRSTPASS_MB_ROW *const row = &cpi->fp_mb_rows[mb_row];
+
+    intra_error += row->intra_error;
+    coded_error += row->coded_error;
+    sr_coded_error += row->sr_coded_error;
+    sum_mvr += row->sum_mvr;
+    sum_mvc += row->sum_mvc;
+    sum_mvr_abs += row->sum_mvr_abs;
+    sum_mvc_abs += row->sum_mvc_abs;
+    sum_mvrs += row->sum_mvrs;
+    sum_mvcs += row->sum_mvcs;
+    mvcount += row->mvcount;
+    intercount += row->intercount;
+    second_ref_count += row->second_ref_count;
+    neutral_count += row->neutral_count;
+    new_mv_count += row->new_mv_count;
+    sum_in_vectors += row->sum_in_vectors;
+
+    if (row->first_mv_as_int) {
+      if (row->first_mv_as_int == lastmv_as_int)
+        --new_mv_count;
+      lastmv_as_int = row->last_mv_as_int;
+    }
   }
 
   vp9_clear_system_state();  // __asm emms;
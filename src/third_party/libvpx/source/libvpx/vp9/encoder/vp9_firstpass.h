@@ -15,6 +15,7 @@
 void vp9_init_first_pass(VP9_COMP *cpi);
 void vp9_first_pass(VP9_COMP *cpi);
 void vp9_end_first_pass(VP9_COMP *cpi);
+void vp9_free_first_pass_rows(VP9_COMP *cpi);
 
 void vp9_init_second_pass(VP9_COMP *cpi);
 void vp9_get_second_pass_params(VP9_COMP *cpi);
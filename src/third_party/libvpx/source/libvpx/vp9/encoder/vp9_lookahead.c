@@ -11,11 +11,16 @@
 #include <stdlib.h>
 
 #include "./vpx_config.h"
+#include "vpx_mem/vpx_mem.h"
 #include "vp9/common/vp9_common.h"
 #include "vp9/encoder/vp9_extend.h"
 #include "vp9/encoder/vp9_lookahead.h"
 
 struct lookahead_ctx {
+  unsigned int width;          /* Size of the frames in the queue */
+  unsigned int height;
+  unsigned int subsampling_x;
+  unsigned int subsampling_y;
   unsigned int max_sz;         /* Absolute size of the queue */
   unsigned int sz;             /* Number of buffers currently in the queue */
   unsigned int read_idx;       /* Read index */
@@ -38,13 +43,24 @@ static struct lookahead_entry * pop(struct lookahead_ctx *ctx,
 }
 
 
+/* Hand a referenced source buffer back to its owner */
+static void release(struct lookahead_entry *buf) {
+  if (buf->release.release) {
+    buf->release.release(buf->release.cb_priv, buf->user_priv);
+    buf->release.release = NULL;
+  }
+}
+
+
 void vp9_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
     if (ctx->buf) {
       unsigned int i;
 
-      for (i = 0; i < ctx->max_sz; i++)
-        vp9_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        release(&ctx->buf[i]);
+        vp9_free_frame_buffer(&ctx->buf[i].copy);
+      }
       free(ctx->buf);
     }
     free(ctx);
@@ -63,18 +79,18 @@ struct lookahead_ctx * vp9_lookahead_init(unsigned int width,
   depth = clamp(depth, 1, MAX_LAG_BUFFERS);
 
   // Allocate the lookahead structures
+  // Frame buffers are allocated by the first push that copies into them, so
+  // a queue of referenced sources needs none.
   ctx = calloc(1, sizeof(*ctx));
   if (ctx) {
-    unsigned int i;
+    ctx->width = width;
+    ctx->height = height;
+    ctx->subsampling_x = subsampling_x;
+    ctx->subsampling_y = subsampling_y;
     ctx->max_sz = depth;
     ctx->buf = calloc(depth, sizeof(*ctx->buf));
     if (!ctx->buf)
       goto bail;
-    for (i = 0; i < depth; i++)
-      if (vp9_alloc_frame_buffer(&ctx->buf[i].img,
-                                 width, height, subsampling_x, subsampling_y,
-                                 VP9BORDERINPIXELS))
-        goto bail;
   }
   return ctx;
  bail:
@@ -96,8 +112,17 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG   *src,
 
   if (ctx->sz + 1 > ctx->max_sz)
     return 1;
+  buf = ctx->buf + ctx->write_idx;
+  if (!buf->copy.buffer_alloc &&
+      vp9_alloc_frame_buffer(&buf->copy, ctx->width, ctx->height,
+                             ctx->subsampling_x, ctx->subsampling_y,
+                             VP9BORDERINPIXELS))
+    return 1;
+  release(buf);
+  buf->img = buf->copy;
+  buf->extended = 1;
   ctx->sz++;
-  buf = pop(ctx, &ctx->write_idx);
+  pop(ctx, &ctx->write_idx);
 
 #if USE_PARTIAL_COPY
   // TODO(jkoleszar): This is disabled for now, as
@@ -157,9 +182,93 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG   *src,
 }
 
 
+int vp9_lookahead_can_ref(struct lookahead_ctx *ctx,
+                          const YV12_BUFFER_CONFIG *src) {
+#if CONFIG_ALPHA
+  (void)ctx;
+  (void)src;
+  return 0;
+#else
+  return src->y_width == (int)ctx->width &&
+         src->y_height == (int)ctx->height &&
+         src->uv_width ==
+             (int)((ctx->width + ctx->subsampling_x) >> ctx->subsampling_x) &&
+         src->uv_height ==
+             (int)((ctx->height + ctx->subsampling_y) >> ctx->subsampling_y) &&
+         !((uintptr_t)src->y_buffer & 31) &&
+         !((uintptr_t)src->u_buffer & 15) &&
+         !((uintptr_t)src->v_buffer & 15) &&
+         !(src->y_stride & 31) && !(src->uv_stride & 15) &&
+         vp9_source_frame_border_fits(src);
+#endif
+}
+
+
+int vp9_lookahead_push_ref(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
+                           int64_t ts_start, int64_t ts_end,
+                           unsigned int flags,
+                           const vpx_source_release_cb_t *release_cb,
+                           void *user_priv) {
+  const int aligned_width = (ctx->width + 7) & ~7;
+  const int aligned_height = (ctx->height + 7) & ~7;
+  struct lookahead_entry *buf;
+
+  assert(vp9_lookahead_can_ref(ctx, src));
+  if (ctx->sz + 1 > ctx->max_sz)
+    return 1;
+  ctx->sz++;
+  buf = pop(ctx, &ctx->write_idx);
+  release(buf);
+
+  // Describe src the way the copy would be, with the visible area padded to
+  // a multiple of 8 that the right and bottom extension fills.
+  vpx_memset(&buf->img, 0, sizeof(buf->img));
+  buf->img.y_crop_width = src->y_width;
+  buf->img.y_crop_height = src->y_height;
+  buf->img.y_width = aligned_width;
+  buf->img.y_height = aligned_height;
+  buf->img.y_stride = src->y_stride;
+  buf->img.uv_crop_width = src->uv_width;
+  buf->img.uv_crop_height = src->uv_height;
+  buf->img.uv_width = aligned_width >> ctx->subsampling_x;
+  buf->img.uv_height = aligned_height >> ctx->subsampling_y;
+  buf->img.uv_stride = src->uv_stride;
+  buf->img.y_buffer = src->y_buffer;
+  buf->img.u_buffer = src->u_buffer;
+  buf->img.v_buffer = src->v_buffer;
+  buf->img.border = src->border;
+  vp9_extend_source_frame(&buf->img, 0);
+  buf->extended = 0;
+  buf->release = *release_cb;
+  buf->user_priv = user_priv;
+
+  buf->ts_start = ts_start;
+  buf->ts_end = ts_end;
+  buf->flags = flags;
+  return 0;
+}
+
+
+void vp9_lookahead_extend_borders(struct lookahead_entry *buf) {
+  if (!buf->extended) {
+    vp9_extend_source_frame(&buf->img, 1);
+    buf->extended = 1;
+  }
+}
+
+
 struct lookahead_entry * vp9_lookahead_pop(struct lookahead_ctx *ctx,
                                            int drain) {
   struct lookahead_entry *buf = NULL;
+  unsigned int i;
+
+  // The buffers outside the queue have all been encoded.
+  for (i = ctx->sz; i < ctx->max_sz; i++) {
+    unsigned int index = ctx->write_idx + i - ctx->sz;
+    if (index >= ctx->max_sz)
+      index -= ctx->max_sz;
+    release(&ctx->buf[index]);
+  }
 
   if (ctx->sz && (drain || ctx->sz == ctx->max_sz)) {
     buf = pop(ctx, &ctx->read_idx);
@@ -12,6 +12,7 @@
 #define VP9_ENCODER_VP9_LOOKAHEAD_H_
 
 #include "vpx_scale/yv12config.h"
+#include "vpx/vp8cx.h"
 #include "vpx/vpx_integer.h"
 
 #define MAX_LAG_BUFFERS 25
@@ -21,6 +22,15 @@ struct lookahead_entry {
   int64_t             ts_start;
   int64_t             ts_end;
   unsigned int        flags;
+
+  // Frame buffer sources are copied into, allocated on first use. img is
+  // either this or a caller buffer referenced by vp9_lookahead_push_ref().
+  YV12_BUFFER_CONFIG  copy;
+  // Set while img references a caller buffer that still has to be released.
+  vpx_source_release_cb_t release;
+  void               *user_priv;
+  // Whether all edges of img have been extended, not just right and bottom.
+  int                 extended;
 };
 
 
@@ -63,8 +73,56 @@ int vp9_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
                        unsigned char *active_map);
 
 
+/**\brief Check if a source buffer can be enqueued without a copy
+ *
+ * The buffer must match the configured size and subsampling, have aligned
+ * planes and strides, and a border with room for the extension a copy gets.
+ *
+ * \param[in] ctx         Pointer to the lookahead context
+ * \param[in] src         Pointer to the image to check
+ */
+int vp9_lookahead_can_ref(struct lookahead_ctx *ctx,
+                          const YV12_BUFFER_CONFIG *src);
+
+
+/**\brief Enqueue a source buffer without copying it
+ *
+ * The queue references the planes of src, extending its right and bottom
+ * edges in place, until the encoder is done with the frame. The release
+ * callback is then called with user_priv. The caller keeps ownership of the
+ * image if the queue is full.
+ *
+ * \param[in] ctx         Pointer to the lookahead context
+ * \param[in] src         Pointer to the image to enqueue, see
+ *                        vp9_lookahead_can_ref()
+ * \param[in] ts_start    Timestamp for the start of this frame
+ * \param[in] ts_end      Timestamp for the end of this frame
+ * \param[in] flags       Flags set on this frame
+ * \param[in] release     Callback releasing src
+ * \param[in] user_priv   Passed to the callback
+ */
+int vp9_lookahead_push_ref(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
+                           int64_t ts_start, int64_t ts_end,
+                           unsigned int flags,
+                           const vpx_source_release_cb_t *release,
+                           void *user_priv);
+
+
+/**\brief Extend all edges of a queued source buffer
+ *
+ * Copied sources are extended on every edge when they are enqueued.
+ * Referenced ones only get the top and left extended here, for the alt-ref
+ * filter and the macroblock graph that search and predict from them.
+ *
+ * \param[in] buf       Pointer to the queued buffer
+ */
+void vp9_lookahead_extend_borders(struct lookahead_entry *buf);
+
+
 /**\brief Get the next source buffer to encode
  *
+ * The returned buffer stays valid until the next call. Referenced buffers
+ * popped by earlier calls are released.
  *
  * \param[in] ctx       Pointer to the lookahead context
  * \param[in] drain     Flag indicating the buffer should be drained
@@ -419,6 +419,8 @@ void vp9_update_mbgraph_stats(VP9_COMP *cpi) {
 
     assert(q_cur != NULL);
 
+    // The intra search predicts from the frame itself, left edge included.
+    vp9_lookahead_extend_borders(q_cur);
     update_mbgraph_frame_stats(cpi, frame_stats, &q_cur->img,
                                golden_ref, cpi->Source);
   }
@@ -25,7 +25,9 @@
 #include "vp9/common/vp9_systemdependent.h"
 #include "vp9/common/vp9_tile_common.h"
 
+#include "vp9/encoder/vp9_encodeframe.h"
 #include "vp9/encoder/vp9_encodemv.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_firstpass.h"
 #include "vp9/encoder/vp9_mbgraph.h"
 #include "vp9/encoder/vp9_onyx_int.h"
@@ -170,6 +172,8 @@ void vp9_initialize_enc() {
 }
 
 static void dealloc_compressor_data(VP9_COMP *cpi) {
+  int i;
+
   // Delete sementation map
   vpx_free(cpi->segmentation_map);
   cpi->segmentation_map = 0;
@@ -185,7 +189,8 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
 
   vp9_free_frame_buffers(&cpi->common);
 
-  vp9_free_frame_buffer(&cpi->last_frame_uf);
+  for (i = 0; i < MAX_LPF_CANDIDATES; ++i)
+    vp9_free_frame_buffer(&cpi->lpf_frames[i]);
   vp9_free_frame_buffer(&cpi->scaled_source);
   vp9_free_frame_buffer(&cpi->alt_ref_buffer);
   vp9_lookahead_destroy(cpi->lookahead);
@@ -193,6 +198,10 @@ static void dealloc_compressor_data(VP9_COMP *cpi) {
   vpx_free(cpi->tok);
   cpi->tok = 0;
 
+  vpx_free(cpi->tile_buffer);
+  cpi->tile_buffer = NULL;
+  cpi->tile_buffer_size = 0;
+
   // Activity mask based per mb zbin adjustments
   vpx_free(cpi->mb_activity_map);
   cpi->mb_activity_map = 0;
@@ -721,7 +730,7 @@ static void set_good_speed_feature(VP9_COMMON *cm,
   }
   if (speed == 5) {
     sf->comp_inter_joint_search_thresh = BLOCK_SIZES;
-    sf->use_one_partition_size_always = 1;
+    sf->partition_search_type = FIXED_PARTITION;
     sf->always_this_block_size = BLOCK_16X16;
     sf->tx_size_search_method = frame_is_intra_only(cm) ?
       USE_FULL_RD : USE_LARGESTALL;
@@ -850,6 +859,9 @@ static void set_rt_speed_feature(VP9_COMMON *cm,
       sf->intra_y_mode_mask[i] = INTRA_DC_H_V;
       sf->intra_uv_mode_mask[i] = INTRA_DC_ONLY;
     }
+    sf->partition_search_type = VAR_BASED_FIXED_PARTITION;
+    sf->always_this_block_size = BLOCK_16X16;
+    sf->use_pick_mode = 1;
   }
 }
 
@@ -885,7 +897,8 @@ void vp9_set_speed_features(VP9_COMP *cpi) {
   sf->adaptive_motion_search = 0;
   sf->adaptive_pred_filter_type = 0;
   sf->reference_masking = 0;
-  sf->use_one_partition_size_always = 0;
+  sf->partition_search_type = SEARCH_PARTITION;
+  sf->always_this_block_size = BLOCK_16X16;
   sf->less_rectangular_check = 0;
   sf->use_square_partition_only = 0;
   sf->auto_min_max_partition_size = 0;
@@ -904,10 +917,11 @@ void vp9_set_speed_features(VP9_COMP *cpi) {
   sf->use_rd_breakout = 0;
   sf->skip_encode_sb = 0;
   sf->use_uv_intra_rd_estimate = 0;
-  sf->use_fast_lpf_pick = 0;
+  sf->lpf_pick = LPF_PICK_FROM_FULL_IMAGE;
   sf->use_fast_coef_updates = 0;
   sf->using_small_partition_info = 0;
   sf->mode_skip_start = MAX_MODES;  // Mode index at which mode skip mask set
+  sf->use_pick_mode = 0;
 
   switch (mode) {
     case 0:  // This is the best quality mode.
@@ -980,13 +994,6 @@ void vp9_alloc_compressor_data(VP9_COMP *cpi) {
     vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
                        "Failed to allocate frame buffers");
 
-  if (vp9_alloc_frame_buffer(&cpi->last_frame_uf,
-                             cm->width, cm->height,
-                             cm->subsampling_x, cm->subsampling_y,
-                             VP9BORDERINPIXELS))
-    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
-                       "Failed to allocate last frame buffer");
-
   if (vp9_alloc_frame_buffer(&cpi->scaled_source,
                              cm->width, cm->height,
                              cm->subsampling_x, cm->subsampling_y,
@@ -1033,13 +1040,6 @@ static void update_frame_size(VP9_COMP *cpi) {
   vp9_update_frame_size(cm);
 
   // Update size of buffers local to this frame
-  if (vp9_realloc_frame_buffer(&cpi->last_frame_uf,
-                               cm->width, cm->height,
-                               cm->subsampling_x, cm->subsampling_y,
-                               VP9BORDERINPIXELS, NULL, NULL, NULL))
-    vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
-                       "Failed to reallocate last frame buffer");
-
   if (vp9_realloc_frame_buffer(&cpi->scaled_source,
                                cm->width, cm->height,
                                cm->subsampling_x, cm->subsampling_y,
@@ -1472,11 +1472,8 @@ static void free_mode_context(PICK_MODE_CONTEXT *ctx) {
   }
 }
 
-static void init_pick_mode_context(VP9_COMP *cpi) {
+void vp9_init_pick_mode_context(VP9_COMMON *cm, MACROBLOCK *x) {
   int i;
-  VP9_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x  = &cpi->mb;
-
 
   for (i = 0; i < BLOCK_SIZES; ++i) {
     const int num_4x4_w = num_4x4_blocks_wide_lookup[i];
@@ -1513,7 +1510,7 @@ static void init_pick_mode_context(VP9_COMP *cpi) {
   }
 }
 
-static void free_pick_mode_context(MACROBLOCK *x) {
+void vp9_free_pick_mode_context(MACROBLOCK *x) {
   int i;
 
   for (i = 0; i < BLOCK_SIZES; ++i) {
@@ -1549,7 +1546,7 @@ static void free_pick_mode_context(MACROBLOCK *x) {
 }
 
 VP9_PTR vp9_create_compressor(VP9_CONFIG *oxcf) {
-  int i, j;
+  int i;
   volatile union {
     VP9_COMP *cpi;
     VP9_PTR   ptr;
@@ -1584,7 +1581,7 @@ VP9_PTR vp9_create_compressor(VP9_CONFIG *oxcf) {
 
   init_config((VP9_PTR)cpi, oxcf);
 
-  init_pick_mode_context(cpi);
+  vp9_init_pick_mode_context(cm, &cpi->mb);
 
   cm->current_video_frame   = 0;
 
@@ -1756,14 +1753,6 @@ VP9_PTR vp9_create_compressor(VP9_CONFIG *oxcf) {
 
   vp9_set_speed_features(cpi);
 
-  // Default rd threshold factors for mode selection
-  for (i = 0; i < BLOCK_SIZES; ++i) {
-    for (j = 0; j < MAX_MODES; ++j)
-      cpi->rd_thresh_freq_fact[i][j] = 32;
-    for (j = 0; j < MAX_REFS; ++j)
-      cpi->rd_thresh_freq_sub8x8[i][j] = 32;
-  }
-
 #define BFP(BT, SDF, SDAF, VF, SVF, SVAF, SVFHH, SVFHV, SVFHHV, \
             SDX3F, SDX8F, SDX4DF)\
     cpi->fn_ptr[BT].sdf            = SDF; \
@@ -1999,7 +1988,10 @@ void vp9_remove_compressor(VP9_PTR *ptr) {
 #endif
   }
 
-  free_pick_mode_context(&cpi->mb);
+  vp9_free_enc_workers(cpi);
+  vp9_free_tile_coders(cpi);
+  vp9_free_first_pass_rows(cpi);
+  vp9_free_pick_mode_context(&cpi->mb);
   dealloc_compressor_data(cpi);
   vpx_free(cpi->mb.ss);
   vpx_free(cpi->tok);
@@ -2523,7 +2515,7 @@ static void loopfilter_frame(VP9_COMP *cpi, VP9_COMMON *cm) {
 
     vpx_usec_timer_start(&timer);
 
-    vp9_pick_filter_level(cpi->Source, cpi, cpi->sf.use_fast_lpf_pick);
+    vp9_pick_filter_level(cpi->Source, cpi, cpi->sf.lpf_pick);
 
     vpx_usec_timer_mark(&timer);
     cpi->time_pick_lpf += vpx_usec_timer_elapsed(&timer);
@@ -2924,6 +2916,8 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi,
   /* Scale the source buffer, if required. */
   if (cm->mi_cols * 8 != cpi->un_scaled_source->y_width ||
       cm->mi_rows * 8 != cpi->un_scaled_source->y_height) {
+    // The scaler filters across the top and left edges as well.
+    vp9_lookahead_extend_borders(cpi->source);
     scale_and_extend_frame(cpi->un_scaled_source, &cpi->scaled_source);
     cpi->Source = &cpi->scaled_source;
   } else {
@@ -2944,12 +2938,12 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi,
   }
 
   // Clear zbin over-quant value and mode boost values.
-  cpi->zbin_mode_boost = 0;
+  cpi->mb.zbin_mode_boost = 0;
 
   // Enable or disable mode based tweaking of the zbin.
   // For 2 pass only used where GF/ARF prediction quality
   // is above a threshold.
-  cpi->zbin_mode_boost = 0;
+  cpi->mb.zbin_mode_boost = 0;
   cpi->zbin_mode_boost_enabled = 0;
 
   // Current default encoder behavior for the altref sign bias.
@@ -3033,7 +3027,10 @@ static void encode_frame_to_data_rate(VP9_COMP *cpi,
   vp9_zero(cpi->rd_tx_select_threshes);
 
 #if CONFIG_VP9_POSTPROC
-  if (cpi->oxcf.noise_sensitivity > 0) {
+  // Sources queued without a copy, before the denoiser was turned on, are
+  // caller memory and left as they are.
+  if (cpi->oxcf.noise_sensitivity > 0 &&
+      !(cpi->Source == &cpi->source->img && cpi->source->release.release)) {
     int l = 0;
     switch (cpi->oxcf.noise_sensitivity) {
       case 1:
@@ -3294,19 +3291,34 @@ static void check_initial_width(VP9_COMP *cpi, YV12_BUFFER_CONFIG *sd) {
 
 int vp9_receive_raw_frame(VP9_PTR ptr, unsigned int frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time) {
+                          int64_t end_time, void *user_priv) {
   VP9_COMP              *cpi = (VP9_COMP *) ptr;
   struct vpx_usec_timer  timer;
   int                    res = 0;
+  int                    referenced = 0;
 
   check_initial_width(cpi, sd);
   vpx_usec_timer_start(&timer);
-  if (vp9_lookahead_push(cpi->lookahead, sd, time_stamp, end_time, frame_flags,
-                         cpi->active_map_enabled ? cpi->active_map : NULL))
+  // The denoiser filters the source in place, so it has to be a copy.
+  if (cpi->source_release.release && !cpi->oxcf.noise_sensitivity &&
+      vp9_lookahead_can_ref(cpi->lookahead, sd)) {
+    if (vp9_lookahead_push_ref(cpi->lookahead, sd, time_stamp, end_time,
+                               frame_flags, &cpi->source_release, user_priv))
+      res = -1;
+    else
+      referenced = 1;
+  } else if (vp9_lookahead_push(cpi->lookahead, sd, time_stamp, end_time,
+                                frame_flags,
+                                cpi->active_map_enabled ? cpi->active_map
+                                                        : NULL)) {
     res = -1;
+  }
   vpx_usec_timer_mark(&timer);
   cpi->time_receive_data += vpx_usec_timer_elapsed(&timer);
 
+  if (cpi->source_release.release && !referenced)
+    cpi->source_release.release(cpi->source_release.cb_priv, user_priv);
+
   return res;
 }
 
@@ -3836,6 +3848,12 @@ void vp9_set_svc(VP9_PTR comp, int use_svc) {
   return;
 }
 
+void vp9_set_source_release_cb(VP9_PTR comp,
+                               const vpx_source_release_cb_t *cb) {
+  VP9_COMP *cpi = (VP9_COMP *)comp;
+  cpi->source_release = *cb;
+}
+
 int vp9_calc_ss_err(YV12_BUFFER_CONFIG *source, YV12_BUFFER_CONFIG *dest) {
   int i, j;
   int total = 0;
@@ -18,6 +18,7 @@
 #include "vp9/encoder/vp9_treewriter.h"
 #include "vp9/encoder/vp9_tokenize.h"
 #include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/common/vp9_thread.h"
 #include "vp9/encoder/vp9_variance.h"
 #include "vp9/encoder/vp9_encodemb.h"
 #include "vp9/encoder/vp9_quantize.h"
@@ -42,9 +43,6 @@
 
 #define KEY_FRAME_CONTEXT 5
 
-#define MAX_MODES 30
-#define MAX_REFS  6
-
 #define MIN_THRESHMULT  32
 #define MAX_THRESHMULT  512
 
@@ -225,12 +223,38 @@ typedef enum {
 #define INTRA_DC_H_V ((1 << DC_PRED) | (1 << V_PRED) | (1 << H_PRED))
 #define INTRA_DC_TM_H_V (INTRA_DC_TM | (1 << V_PRED) | (1 << H_PRED))
 
+// Number of loop filter levels vp9_pick_filter_level() tries at a time.
+#define MAX_LPF_CANDIDATES 3
+
+// SB row step of LPF_PICK_FROM_SAMPLED_ROWS.
+#define LPF_SAMPLED_ROW_STEP 4
+
+typedef enum {
+  // Try the full image with different values.
+  LPF_PICK_FROM_FULL_IMAGE = 0,
+  // Try a band of SB rows in the middle of the image with different values.
+  LPF_PICK_FROM_SUBIMAGE = 1,
+  // Try every LPF_SAMPLED_ROW_STEP-th SB row with different values. This may
+  // pick another level than the full image, so no speed setting uses it.
+  LPF_PICK_FROM_SAMPLED_ROWS = 2
+} LPF_PICK_METHOD;
+
 typedef enum {
   LAST_FRAME_PARTITION_OFF = 0,
   LAST_FRAME_PARTITION_LOW_MOTION = 1,
   LAST_FRAME_PARTITION_ALL = 2
 } LAST_FRAME_PARTITION_METHOD;
 
+typedef enum {
+  // Search the partitions of every SB.
+  SEARCH_PARTITION = 0,
+  // Split every SB into blocks of always_this_block_size.
+  FIXED_PARTITION = 1,
+  // Split every SB into blocks of one size, picked from how much the SB
+  // differs from the last frame.
+  VAR_BASED_FIXED_PARTITION = 2
+} PARTITION_SEARCH_TYPE;
+
 typedef struct {
   // This flag refers to whether or not to perform rd optimization.
   int RD;
@@ -316,10 +340,8 @@ typedef struct {
   // precise but significantly faster than the non lp version.
   int use_lp32x32fdct;
 
-  // TODO(JBB): remove this as its no longer used.
-
-  // If set partition size will always be always_this_block_size.
-  int use_one_partition_size_always;
+  // How the partitions of an SB are chosen.
+  PARTITION_SEARCH_TYPE partition_search_type;
 
   // Skip rectangular partition test when partition type none gives better
   // rd than partition type split.
@@ -336,7 +358,8 @@ typedef struct {
   // TODO(JBB): Remove this.
   int reference_masking;
 
-  // Used in conjunction with use_one_partition_size_always.
+  // Block size of FIXED_PARTITION, and of VAR_BASED_FIXED_PARTITION in
+  // intra only frames.
   BLOCK_SIZE always_this_block_size;
 
   // Sets min and max partition sizes for this 64x64 region based on the
@@ -405,13 +428,18 @@ typedef struct {
   // final encode.
   int use_uv_intra_rd_estimate;
 
-  // This picks a loop filter strength by trying a small portion of the image
-  // with different values.
-  int use_fast_lpf_pick;
+  // This selects the part of the image on which loop filter strengths are
+  // tried to pick one.
+  LPF_PICK_METHOD lpf_pick;
 
   // This feature limits the number of coefficients updates we actually do
   // by only looking at counts from 1/2 the bands.
   int use_fast_coef_updates;  // 0: 2-loop, 1: 1-loop, 2: 1-loop reduced
+
+  // Picks the modes of inter frames with vp9_pick_inter_mode(), from the luma
+  // SSE of the prediction and the mode and motion vector rate, instead of a
+  // full rd search. Only used with a fixed partition type.
+  int use_pick_mode;
 } SPEED_FEATURES;
 
 typedef struct {
@@ -475,6 +503,62 @@ typedef struct {
   // int active_best_quality;
 } RATE_CONTROL;
 
+typedef struct {
+  int freq_fact[BLOCK_SIZES][MAX_MODES];
+  int freq_sub8x8[BLOCK_SIZES][MAX_REFS];
+} RD_THRESH_FACTS;
+
+// Progress of a row of blocks coded by one worker, which the worker coding
+// the row below waits on.
+typedef struct {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif
+  int done;  // Number of blocks of the row coded so far.
+} ROW_SYNC;
+
+// An SB row is encoded once the row above has finished the SB above and to
+// the right of the current one.
+typedef struct {
+  ROW_SYNC sync;
+
+  // Adaptive rd thresholds after the first SB, which the row below starts
+  // from.
+  RD_THRESH_FACTS rd_thresh;
+
+  // Fixed range of the token buffer the row writes to.
+  TOKENEXTRA *tok;
+  unsigned int tok_count;
+} SB_ROW_SYNC;
+
+// First pass statistics of an MB row, which the rows are summed from in
+// order so that they do not depend on the number of threads.
+typedef struct {
+  ROW_SYNC sync;
+  int64_t intra_error;
+  int64_t coded_error;
+  int64_t sr_coded_error;
+  int sum_mvr, sum_mvc;
+  int sum_mvr_abs, sum_mvc_abs;
+  int sum_mvrs, sum_mvcs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int neutral_count;
+  int new_mv_count;
+  int sum_in_vectors;
+
+  // First and last non-zero motion vectors of the row. new_mv_count counts
+  // the first one as new, which only holds if it differs from the last one of
+  // the rows above.
+  uint32_t first_mv_as_int;
+  uint32_t last_mv_as_int;
+
+  // Luma residual left behind by the last MB of the row.
+  int16_t src_diff[16 * 16];
+} FIRSTPASS_MB_ROW;
+
 typedef struct VP9_COMP {
   DECLARE_ALIGNED(16, int16_t, y_quant[QINDEX_RANGE][8]);
   DECLARE_ALIGNED(16, int16_t, y_quant_shift[QINDEX_RANGE][8]);
@@ -496,9 +580,10 @@ typedef struct VP9_COMP {
   MACROBLOCK mb;
   VP9_COMMON common;
   VP9_CONFIG oxcf;
-  struct rdcost_block_args rdcost_stack;
   struct lookahead_ctx    *lookahead;
   struct lookahead_entry  *source;
+  // Sources are referenced instead of copied when release is set.
+  vpx_source_release_cb_t  source_release;
 #if CONFIG_MULTIPLE_ARF
   struct lookahead_entry  *alt_ref_source[REF_FRAMES];
 #else
@@ -538,11 +623,18 @@ typedef struct VP9_COMP {
   int ext_refresh_frame_context_pending;
   int ext_refresh_frame_context;
 
-  YV12_BUFFER_CONFIG last_frame_uf;
+  // Scratch copies of the frame on which vp9_pick_filter_level() tries its
+  // filter levels, one per worker.
+  YV12_BUFFER_CONFIG lpf_frames[MAX_LPF_CANDIDATES];
 
   TOKENEXTRA *tok;
+  TOKENEXTRA *tile_tok[4][1 << 6];
   unsigned int tok_count[4][1 << 6];
 
+  // Scratch space the tiles are packed into, each at its own offset.
+  uint8_t *tile_buffer;
+  size_t tile_buffer_size;
+
 #if CONFIG_MULTIPLE_ARF
   // Position within a frame coding order (including any additional ARF frames).
   unsigned int sequence_number;
@@ -555,14 +647,9 @@ typedef struct VP9_COMP {
 
   unsigned int mode_chosen_counts[MAX_MODES];
   unsigned int sub8x8_mode_chosen_counts[MAX_REFS];
-  int64_t mode_skip_mask;
-  int ref_frame_mask;
-  int set_ref_frame_mask;
 
   int rd_threshes[MAX_SEGMENTS][BLOCK_SIZES][MAX_MODES];
-  int rd_thresh_freq_fact[BLOCK_SIZES][MAX_MODES];
   int rd_thresh_sub8x8[MAX_SEGMENTS][BLOCK_SIZES][MAX_REFS];
-  int rd_thresh_freq_sub8x8[BLOCK_SIZES][MAX_REFS];
 
   int64_t rd_comp_pred_diff[REFERENCE_MODES];
   int64_t rd_prediction_type_threshes[4][REFERENCE_MODES];
@@ -572,15 +659,12 @@ typedef struct VP9_COMP {
 
   int64_t rd_filter_diff[SWITCHABLE_FILTER_CONTEXTS];
   int64_t rd_filter_threshes[4][SWITCHABLE_FILTER_CONTEXTS];
-  int64_t rd_filter_cache[SWITCHABLE_FILTER_CONTEXTS];
-  int64_t mask_filter_rd;
 
   int RDMULT;
   int RDDIV;
 
   CODING_CONTEXT coding_context;
 
-  int zbin_mode_boost;
   int zbin_mode_boost_enabled;
   int active_arnr_frames;           // <= cpi->oxcf.arnr_max_frames
   int active_arnr_strength;         // <= cpi->oxcf.arnr_max_strength
@@ -609,7 +693,7 @@ typedef struct VP9_COMP {
   MBGRAPH_FRAME_STATS mbgraph_stats[MAX_LAG_BUFFERS];
   int mbgraph_n_frames;             // number of frames filled in the above
   int static_mb_pct;                // % forced skip mbs by segmentation
-  int seg0_progress, seg0_idx, seg0_cnt;
+  int seg0_idx, seg0_cnt;
 
   // for real time encoding
   int speed;
@@ -774,10 +858,27 @@ typedef struct VP9_COMP {
 
   // Y,U,V,(A)
   ENTROPY_CONTEXT *above_context[MAX_MB_PLANE];
-  ENTROPY_CONTEXT left_context[MAX_MB_PLANE][16];
-
   PARTITION_CONTEXT *above_seg_context;
-  PARTITION_CONTEXT left_seg_context[8];
+
+  // Adaptive rd thresholds the first SB row of each tile column starts the
+  // next frame with.
+  RD_THRESH_FACTS *tile_rd_thresh;
+  int num_tile_rd_thresh;
+
+  // Wavefront state of each SB row of each tile column, column by column.
+  SB_ROW_SYNC *sb_row_sync;
+  int num_sb_row_sync;
+
+  // Wavefront state and statistics of each MB row of the first pass.
+  FIRSTPASS_MB_ROW *fp_mb_rows;
+  int num_fp_mb_rows;
+
+  // Threads coding the SB rows of a frame, or the MB rows of the first pass.
+  // Each worker owns the MACROBLOCK it codes with; cpi->mb only serves as the
+  // template the workers start from in every frame. The last worker runs on
+  // the calling thread.
+  VP9Worker *enc_workers;
+  int num_enc_workers;
 } VP9_COMP;
 
 static int get_ref_frame_idx(VP9_COMP *cpi, MV_REFERENCE_FRAME ref_frame) {
@@ -819,6 +920,9 @@ int vp9_calc_ss_err(YV12_BUFFER_CONFIG *source, YV12_BUFFER_CONFIG *dest);
 
 void vp9_alloc_compressor_data(VP9_COMP *cpi);
 
+void vp9_init_pick_mode_context(VP9_COMMON *cm, MACROBLOCK *x);
+void vp9_free_pick_mode_context(MACROBLOCK *x);
+
 int vp9_compute_qdelta(const VP9_COMP *cpi, double qstart, double qtarget);
 
 static int get_token_alloc(int mb_rows, int mb_cols) {
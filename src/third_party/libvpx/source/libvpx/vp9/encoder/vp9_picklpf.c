@@ -11,6 +11,7 @@
 #include <assert.h>
 #include <limits.h>
 #include "vp9/common/vp9_onyxc_int.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_onyx_int.h"
 #include "vp9/encoder/vp9_picklpf.h"
 #include "vp9/encoder/vp9_quantize.h"
@@ -33,12 +34,180 @@ static int get_max_filter_level(VP9_COMP *cpi, int base_qindex) {
 void vp9_set_alt_lf_level(VP9_COMP *cpi, int filt_val) {
 }
 
-void vp9_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi, int partial) {
-  MACROBLOCKD *const xd = &cpi->mb.e_mbd;
+// A filter level tried on a scratch copy of the frame.
+struct lpf_candidate {
+  int filter_level;
+  loop_filter_info_n lfi;
+  int err;
+};
+
+struct lpf_search {
+  const YV12_BUFFER_CONFIG *sd;
+
+  // SB rows sb_row_start, sb_row_start + sb_row_step, ... below sb_row_end
+  // are filtered and measured.
+  int sb_row_start;
+  int sb_row_end;
+  int sb_row_step;
+
+  struct lpf_candidate candidates[MAX_LPF_CANDIDATES];
+  int num_candidates;
+
+  int tried[MAX_LOOP_FILTER + 1];
+  int ss_err[MAX_LOOP_FILTER + 1];
+};
+
+static void set_search_rows(const VP9_COMMON *cm, LPF_PICK_METHOD method,
+                            struct lpf_search *search) {
+  const int sb_rows = (cm->mi_rows + MI_BLOCK_SIZE - 1) >> MI_BLOCK_SIZE_LOG2;
+
+  search->sb_row_start = 0;
+  search->sb_row_end = sb_rows;
+  search->sb_row_step = 1;
+
+  if (method == LPF_PICK_FROM_SUBIMAGE && cm->mi_rows > MI_BLOCK_SIZE) {
+    const int start_mi_row = (cm->mi_rows >> 1) & ~(MI_BLOCK_SIZE - 1);
+    const int end_mi_row = start_mi_row + MAX(cm->mi_rows / 8, MI_BLOCK_SIZE);
+    search->sb_row_start = start_mi_row >> MI_BLOCK_SIZE_LOG2;
+    search->sb_row_end = MIN((end_mi_row + MI_BLOCK_SIZE - 1) >>
+                             MI_BLOCK_SIZE_LOG2, sb_rows);
+  } else if (method == LPF_PICK_FROM_SAMPLED_ROWS) {
+    search->sb_row_step = LPF_SAMPLED_ROW_STEP;
+  }
+}
+
+// Sum of squared errors of the Y rows [y_start, y_end) of sd and frame, in
+// 16x16 blocks as vp9_calc_ss_err() does.
+static int calc_ss_err_rows(const YV12_BUFFER_CONFIG *sd,
+                            const YV12_BUFFER_CONFIG *frame,
+                            int y_start, int y_end) {
+  const uint8_t *src = sd->y_buffer + y_start * sd->y_stride;
+  const uint8_t *dst = frame->y_buffer + y_start * frame->y_stride;
+  int total = 0;
+  int i, j;
+
+  for (i = y_start; i < y_end; i += 16) {
+    for (j = 0; j < sd->y_width; j += 16) {
+      unsigned int sse;
+      total += vp9_mse16x16(src + j, sd->y_stride, dst + j, frame->y_stride,
+                            &sse);
+    }
+
+    src += 16 * sd->y_stride;
+    dst += 16 * frame->y_stride;
+  }
+
+  return total;
+}
+
+// Filters the searched SB rows of a copy of the unfiltered frame in buf at
+// the level of the candidate, and returns their error.
+static int try_filter_level(VP9_COMP *cpi, const struct lpf_search *search,
+                            const struct lpf_candidate *candidate,
+                            YV12_BUFFER_CONFIG *buf, MACROBLOCKD *xd) {
+  VP9_COMMON *const cm = &cpi->common;
+  const YV12_BUFFER_CONFIG *const src = cm->frame_to_show;
+  // The error is measured over whole 16x16 blocks.
+  const int width = (search->sd->y_width + 15) & ~15;
+  const int height = (search->sd->y_height + 15) & ~15;
+  int sb_row, y;
+  int err = 0;
+
+  // Copy the rows and the ones above that filtering them changes.
+  for (sb_row = search->sb_row_start; sb_row < search->sb_row_end;
+       sb_row += search->sb_row_step) {
+    const int y_end = MIN((sb_row + 1) * 64, height);
+    for (y = MAX(sb_row * 64 - 8, 0); y < y_end; ++y)
+      vpx_memcpy(buf->y_buffer + y * buf->y_stride,
+                 src->y_buffer + y * src->y_stride, width);
+  }
+
+  if (candidate->filter_level) {
+    for (sb_row = search->sb_row_start; sb_row < search->sb_row_end;
+         sb_row += search->sb_row_step) {
+      const int mi_row = sb_row * MI_BLOCK_SIZE;
+      vp9_loop_filter_rows_lfi(buf, cm, &candidate->lfi, xd,
+                               mi_row, mi_row + MI_BLOCK_SIZE, 1);
+    }
+  }
+
+  // Filtering a row changes the bottom of the one above, so the error is
+  // only measured once all of them are filtered.
+  for (sb_row = search->sb_row_start; sb_row < search->sb_row_end;
+       sb_row += search->sb_row_step)
+    err += calc_ss_err_rows(search->sd, buf, sb_row * 64,
+                            MIN((sb_row + 1) * 64, height));
+
+  return err;
+}
+
+// Worker trying candidates start, start + num_workers, ... on its own copy
+// of the frame.
+static int lpf_search_worker(void *arg1, void *arg2) {
+  EncWorkerData *const data = (EncWorkerData*)arg1;
+  struct lpf_search *const search = (struct lpf_search*)arg2;
+  VP9_COMP *const cpi = data->cpi;
+  YV12_BUFFER_CONFIG *const buf = &cpi->lpf_frames[data->start];
+  MACROBLOCKD *const xd = &data->mb.e_mbd;
+  int i;
+
+  *xd = cpi->mb.e_mbd;
+  for (i = data->start; i < search->num_candidates; i += data->num_workers) {
+    struct lpf_candidate *const candidate = &search->candidates[i];
+    candidate->err = try_filter_level(cpi, search, candidate, buf, xd);
+  }
+  return 1;
+}
+
+// Measures the error of the levels that have not been tried yet, all at
+// once.
+static void try_filter_levels(VP9_COMP *cpi, struct lpf_search *search,
+                              const int *levels, int num_levels) {
+  VP9_COMMON *const cm = &cpi->common;
+  int num_workers;
+  int i;
+
+  search->num_candidates = 0;
+  for (i = 0; i < num_levels; ++i) {
+    const int level = levels[i];
+    struct lpf_candidate *candidate;
+    if (search->tried[level])
+      continue;
+    search->tried[level] = 1;
+
+    assert(search->num_candidates < MAX_LPF_CANDIDATES);
+    candidate = &search->candidates[search->num_candidates++];
+    candidate->filter_level = level;
+    vp9_loop_filter_frame_init(cm, level);
+    candidate->lfi = cm->lf_info;
+  }
+  if (search->num_candidates == 0)
+    return;
+
+  num_workers = vp9_get_num_enc_workers(cpi, search->num_candidates);
+  for (i = 0; i < num_workers; ++i) {
+    if (vp9_realloc_frame_buffer(&cpi->lpf_frames[i],
+                                 cm->width, cm->height,
+                                 cm->subsampling_x, cm->subsampling_y,
+                                 VP9BORDERINPIXELS, NULL, NULL, NULL))
+      vpx_internal_error(&cm->error, VPX_CODEC_MEM_ERROR,
+                         "Failed to allocate loop filter search buffer");
+  }
+
+  vp9_run_enc_workers(cpi, lpf_search_worker, search, num_workers);
+
+  for (i = 0; i < search->num_candidates; ++i)
+    search->ss_err[search->candidates[i].filter_level] =
+        search->candidates[i].err;
+}
+
+void vp9_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi,
+                           LPF_PICK_METHOD method) {
   VP9_COMMON *const cm = &cpi->common;
   struct loopfilter *const lf = &cm->lf;
   const int min_filter_level = get_min_filter_level(cpi, cm->base_qindex);
   const int max_filter_level = get_max_filter_level(cpi, cm->base_qindex);
+  struct lpf_search search;
   int best_err = 0;
   int filt_err = 0;
   int filt_best;
@@ -51,22 +220,29 @@ void vp9_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi, int partial) {
   lf->sharpness_level = cm->frame_type == KEY_FRAME ? 0
                                                     : cpi->oxcf.sharpness;
 
-  //  Make a copy of the unfiltered / processed recon buffer
-  vpx_yv12_copy_y(cm->frame_to_show, &cpi->last_frame_uf);
+  search.sd = sd;
+  set_search_rows(cm, method, &search);
+  vp9_zero(search.tried);
 
-  // Get baseline error score
-  vp9_set_alt_lf_level(cpi, filt_mid);
-  vp9_loop_filter_frame(cm, xd, filt_mid, 1, partial);
+  // The baseline error score and both levels of the first step do not depend
+  // on each other, so they are measured together.
+  {
+    const int levels[MAX_LPF_CANDIDATES] = {
+      filt_mid,
+      MAX(filt_mid - filter_step, min_filter_level),
+      MIN(filt_mid + filter_step, max_filter_level)
+    };
+    try_filter_levels(cpi, &search, levels, MAX_LPF_CANDIDATES);
+  }
 
-  best_err = vp9_calc_ss_err(sd, cm->frame_to_show);
+  best_err = search.ss_err[filt_mid];
   filt_best = filt_mid;
 
-  //  Re-instate the unfiltered frame
-  vpx_yv12_copy_y(&cpi->last_frame_uf, cm->frame_to_show);
-
   while (filter_step > 0) {
     const int filt_high = MIN(filt_mid + filter_step, max_filter_level);
     const int filt_low = MAX(filt_mid - filter_step, min_filter_level);
+    const int try_low = filt_direction <= 0 && filt_low != filt_mid;
+    const int try_high = filt_direction >= 0 && filt_high != filt_mid;
 
     // Bias against raising loop filter in favor of lowering it.
     int bias = (best_err >> (15 - (filt_mid / 8))) * filter_step;
@@ -78,15 +254,19 @@ void vp9_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi, int partial) {
     if (cm->tx_mode != ONLY_4X4)
       bias >>= 1;
 
-    if (filt_direction <= 0 && filt_low != filt_mid) {
-      // Get Low filter error score
-      vp9_set_alt_lf_level(cpi, filt_low);
-      vp9_loop_filter_frame(cm, xd, filt_low, 1, partial);
-
-      filt_err = vp9_calc_ss_err(sd, cm->frame_to_show);
+    {
+      int levels[2];
+      int num_levels = 0;
+      if (try_low)
+        levels[num_levels++] = filt_low;
+      if (try_high)
+        levels[num_levels++] = filt_high;
+      try_filter_levels(cpi, &search, levels, num_levels);
+    }
 
-      // Re-instate the unfiltered frame
-      vpx_yv12_copy_y(&cpi->last_frame_uf, cm->frame_to_show);
+    if (try_low) {
+      // Get Low filter error score
+      filt_err = search.ss_err[filt_low];
 
       // If value is close to the best so far then bias towards a lower loop
       // filter value.
@@ -100,14 +280,8 @@ void vp9_pick_filter_level(YV12_BUFFER_CONFIG *sd, VP9_COMP *cpi, int partial) {
     }
 
     // Now look at filt_high
-    if (filt_direction >= 0 && filt_high != filt_mid) {
-      vp9_set_alt_lf_level(cpi, filt_high);
-      vp9_loop_filter_frame(cm, xd, filt_high, 1, partial);
-
-      filt_err = vp9_calc_ss_err(sd, cm->frame_to_show);
-
-      //  Re-instate the unfiltered frame
-      vpx_yv12_copy_y(&cpi->last_frame_uf, cm->frame_to_show);
+    if (try_high) {
+      filt_err = search.ss_err[filt_high];
 
       // Was it better than the previous best?
       if (filt_err < (best_err - bias)) {
@@ -12,11 +12,10 @@
 #ifndef VP9_ENCODER_VP9_PICKLPF_H_
 #define VP9_ENCODER_VP9_PICKLPF_H_
 
-struct yv12_buffer_config;
-struct VP9_COMP;
+#include "vp9/encoder/vp9_onyx_int.h"
 
 void vp9_set_alt_lf_level(struct VP9_COMP *cpi, int filt_val);
 
 void vp9_pick_filter_level(struct yv12_buffer_config *sd,
-                           struct VP9_COMP *cpi, int partial);
+                           struct VP9_COMP *cpi, LPF_PICK_METHOD method);
 #endif  // VP9_ENCODER_VP9_PICKLPF_H_
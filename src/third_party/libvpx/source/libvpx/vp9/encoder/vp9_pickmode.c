@@ -135,8 +135,55 @@ static int full_pixel_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
   return bestsme;
 }
 
-// TODO(jingning) placeholder for inter-frame non-RD mode decision.
-// this needs various further optimizations. to be continued..
+static void sub_pixel_motion_search(VP9_COMP *cpi, MACROBLOCK *x,
+                                    BLOCK_SIZE bsize, int mi_row, int mi_col,
+                                    MV *tmp_mv) {
+  MACROBLOCKD *xd = &x->e_mbd;
+  MB_MODE_INFO *mbmi = &xd->mi_8x8[0]->mbmi;
+  struct buf_2d backup_yv12[MAX_MB_PLANE] = {{0}};
+  int ref = mbmi->ref_frame[0];
+  MV ref_mv = mbmi->ref_mvs[ref][0].as_mv;
+  int dis;
+
+  YV12_BUFFER_CONFIG *scaled_ref_frame = vp9_get_scaled_ref_frame(cpi, ref);
+
+  if (scaled_ref_frame) {
+    int i;
+    // Swap out the reference frame for a version that's been scaled to
+    // match the resolution of the current frame, allowing the existing
+    // motion search code to be used without additional modifications.
+    for (i = 0; i < MAX_MB_PLANE; i++)
+      backup_yv12[i] = xd->plane[i].pre[0];
+
+    setup_pre_planes(xd, 0, scaled_ref_frame, mi_row, mi_col, NULL);
+  }
+
+  // The sub-pixel search starts from a full pixel motion vector.
+  tmp_mv->row >>= 3;
+  tmp_mv->col >>= 3;
+
+  cpi->find_fractional_mv_step(x, tmp_mv, &ref_mv,
+                               cpi->common.allow_high_precision_mv,
+                               x->errorperbit,
+                               &cpi->fn_ptr[bsize],
+                               0, cpi->sf.subpel_iters_per_step,
+                               x->nmvjointcost, x->mvcost,
+                               &dis, &x->pred_sse[ref]);
+
+  if (scaled_ref_frame) {
+    int i;
+    for (i = 0; i < MAX_MB_PLANE; i++)
+      xd->plane[i].pre[0] = backup_yv12[i];
+  }
+}
+
+// Non-RD inter mode decision. Each of NEARESTMV, NEARMV, ZEROMV and NEWMV
+// is tried on every enabled reference frame, and the one with the lowest
+// RD cost of the luma prediction error and the mode and motion vector rate
+// is picked. No transform or entropy coding is done, so the cost is only an
+// estimate.
+// TODO(jingning) intra prediction search, if the best SSE is above a certain
+// threshold.
 int64_t vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x,
                             const TileInfo *const tile,
                             int mi_row, int mi_col,
@@ -144,17 +191,37 @@ int64_t vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x,
                             int64_t *returndistortion,
                             BLOCK_SIZE bsize,
                             PICK_MODE_CONTEXT *ctx) {
+  VP9_COMMON *const cm = &cpi->common;
   MACROBLOCKD *xd = &x->e_mbd;
   MB_MODE_INFO *mbmi = &xd->mi_8x8[0]->mbmi;
+  struct macroblock_plane *const p = &x->plane[0];
+  struct macroblockd_plane *const pd = &xd->plane[0];
   const BLOCK_SIZE block_size = get_plane_block_size(bsize, &xd->plane[0]);
-  MB_PREDICTION_MODE this_mode;
-  MV_REFERENCE_FRAME ref_frame;
+  MB_PREDICTION_MODE this_mode, best_mode = ZEROMV;
+  MV_REFERENCE_FRAME ref_frame, best_ref_frame = LAST_FRAME;
   int_mv frame_mv[MB_MODE_COUNT][MAX_REF_FRAMES];
   struct buf_2d yv12_mb[4][MAX_MB_PLANE];
   static const int flag_list[4] = { 0, VP9_LAST_FLAG, VP9_GOLD_FLAG,
                                     VP9_ALT_FLAG };
+  static const THR_MODES mode_idx[MAX_REF_FRAMES][INTER_MODES] = {
+    { THR_DC, THR_DC, THR_DC, THR_DC },
+    { THR_NEARESTMV, THR_NEARMV, THR_ZEROMV, THR_NEWMV },
+    { THR_NEARESTG, THR_NEARG, THR_ZEROG, THR_NEWG },
+    { THR_NEARESTA, THR_NEARA, THR_ZEROA, THR_NEWA },
+  };
+  const int only_zero_mv =
+      vp9_segfeature_active(&cm->seg, mbmi->segment_id, SEG_LVL_SKIP);
+  int ref_frame_flags = cpi->ref_frame_flags &
+                        (VP9_LAST_FLAG | VP9_GOLD_FLAG | VP9_ALT_FLAG);
   int64_t best_rd = INT64_MAX;
-  int64_t this_rd;
+  int best_rate = INT_MAX;
+  int64_t best_dist = INT64_MAX;
+  int_mv best_mv;
+  int i;
+
+  // Inter frames always have a last frame to fall back on.
+  if (!ref_frame_flags)
+    ref_frame_flags = VP9_LAST_FLAG;
 
   x->skip_encode = cpi->sf.skip_encode_frame && x->q_index < QIDX_SKIP_THRESH;
 
@@ -163,17 +230,20 @@ int64_t vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x,
     x->skip = 1;
 
   // initialize mode decisions
-  *returnrate = INT_MAX;
-  vpx_memset(mbmi, 0, sizeof(MB_MODE_INFO));
   mbmi->sb_type = bsize;
   mbmi->ref_frame[0] = NONE;
   mbmi->ref_frame[1] = NONE;
+  mbmi->uv_mode = DC_PRED;
   mbmi->tx_size = MIN(max_txsize_lookup[bsize],
-                      tx_mode_to_biggest_tx_size[cpi->common.tx_mode]);
+                      tx_mode_to_biggest_tx_size[cm->tx_mode]);
+  mbmi->interp_filter = cm->mcomp_filter_type == SWITCHABLE ?
+                        EIGHTTAP : cm->mcomp_filter_type;
+  vp9_setup_interp_filters(xd, mbmi->interp_filter, cm);
+  best_mv.as_int = 0;
 
   for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
     x->pred_mv_sad[ref_frame] = INT_MAX;
-    if (cpi->ref_frame_flags & flag_list[ref_frame]) {
+    if (ref_frame_flags & flag_list[ref_frame]) {
       vp9_setup_buffer_inter(cpi, x, tile, get_ref_frame_idx(cpi, ref_frame),
                              ref_frame, block_size, mi_row, mi_col,
                              frame_mv[NEARESTMV], frame_mv[NEARMV], yv12_mb);
@@ -183,21 +253,14 @@ int64_t vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x,
   }
 
   for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
-    int rate_mv = 0;
-
-    if (!(cpi->ref_frame_flags & flag_list[ref_frame]))
+    if (!(ref_frame_flags & flag_list[ref_frame]))
       continue;
 
     // Select prediction reference frames.
-    xd->plane[0].pre[0] = yv12_mb[ref_frame][0];
-
-
-    x->mode_sad[ref_frame][INTER_OFFSET(NEWMV)] =
-        full_pixel_motion_search(cpi, x, tile, bsize, mi_row, mi_col,
-                                 &frame_mv[NEWMV][ref_frame], &rate_mv);
-
-    if (frame_mv[NEWMV][ref_frame].as_int == INVALID_MV)
-      continue;
+    mbmi->ref_frame[0] = ref_frame;
+    set_scale_factors(cm, xd, ref_frame - 1, -1);
+    for (i = 0; i < MAX_MB_PLANE; i++)
+      xd->plane[i].pre[0] = yv12_mb[ref_frame][i];
 
     clamp_mv2(&frame_mv[NEARESTMV][ref_frame].as_mv, xd);
     clamp_mv2(&frame_mv[NEARMV][ref_frame].as_mv, xd);
@@ -205,26 +268,74 @@ int64_t vp9_pick_inter_mode(VP9_COMP *cpi, MACROBLOCK *x,
     for (this_mode = NEARESTMV; this_mode <= NEWMV; ++this_mode) {
       int rate = x->inter_mode_cost[mbmi->mode_context[ref_frame]]
                                    [INTER_OFFSET(this_mode)];
-      int64_t dist = x->mode_sad[ref_frame][INTER_OFFSET(this_mode)] *
-                      x->mode_sad[ref_frame][INTER_OFFSET(this_mode)];
+      int64_t dist;
+      int64_t this_rd;
+      unsigned int sse;
+
+      if (only_zero_mv || x->skip) {
+        if (this_mode != ZEROMV)
+          continue;
+      } else if (this_mode == NEARMV &&
+                 frame_mv[NEARMV][ref_frame].as_int ==
+                     frame_mv[NEARESTMV][ref_frame].as_int) {
+        continue;
+      }
+
+      if (this_mode == NEWMV) {
+        int rate_mv = 0;
+
+        x->mode_sad[ref_frame][INTER_OFFSET(NEWMV)] =
+            full_pixel_motion_search(cpi, x, tile, bsize, mi_row, mi_col,
+                                     &frame_mv[NEWMV][ref_frame], &rate_mv);
+
+        if (frame_mv[NEWMV][ref_frame].as_int == INVALID_MV)
+          continue;
+
+        sub_pixel_motion_search(cpi, x, bsize, mi_row, mi_col,
+                                &frame_mv[NEWMV][ref_frame].as_mv);
+        rate += vp9_mv_bit_cost(&frame_mv[NEWMV][ref_frame].as_mv,
+                                &mbmi->ref_mvs[ref_frame][0].as_mv,
+                                x->nmvjointcost, x->mvcost, MV_COST_WEIGHT);
+      }
+
+      mbmi->mode = this_mode;
+      mbmi->mv[0].as_int = frame_mv[this_mode][ref_frame].as_int;
+      vp9_build_inter_predictors_sby(xd, mi_row, mi_col, bsize);
+      cpi->fn_ptr[bsize].vf(p->src.buf, p->src.stride,
+                            pd->dst.buf, pd->dst.stride, &sse);
+      dist = (int64_t)sse << 4;
       this_rd = RDCOST(x->rdmult, x->rddiv, rate, dist);
 
       if (this_rd < best_rd) {
         best_rd = this_rd;
-        mbmi->mode = this_mode;
-        mbmi->ref_frame[0] = ref_frame;
-        mbmi->mv[0].as_int = frame_mv[this_mode][ref_frame].as_int;
+        best_rate = rate;
+        best_dist = dist;
+        best_mode = this_mode;
+        best_ref_frame = ref_frame;
+        best_mv.as_int = mbmi->mv[0].as_int;
       }
     }
   }
 
-  // TODO(jingning) sub-pixel motion search, if NEWMV is chosen
-
-  // TODO(jingning) intra prediction search, if the best SAD is above a certain
-  // threshold.
-
   // store mode decisions
-  ctx->mic = *xd->mi_8x8[0];
+  mbmi->mode = best_mode;
+  mbmi->ref_frame[0] = best_ref_frame;
+  mbmi->mv[0].as_int = best_mv.as_int;
+  set_scale_factors(cm, xd, best_ref_frame - 1, -1);
 
-  return INT64_MAX;
+  ctx->skip = x->skip;
+  ctx->best_mode_index = mode_idx[best_ref_frame][INTER_OFFSET(best_mode)];
+  ctx->mic = *xd->mi_8x8[0];
+  ctx->best_ref_mv[0].as_int = mbmi->ref_mvs[best_ref_frame][0].as_int;
+  ctx->best_ref_mv[1].as_int = 0;
+  ctx->single_pred_diff = 0;
+  ctx->comp_pred_diff = 0;
+  ctx->hybrid_pred_diff = 0;
+  vp9_zero(ctx->tx_rd_diff);
+  vp9_zero(ctx->best_filter_diff);
+  vpx_memset(ctx->zcoeff_blk, 0, sizeof(uint8_t) * ctx->num_4x4_blk);
+
+  *returnrate = best_rate;
+  *returndistortion = best_dist;
+  return best_rd;
 }
@@ -16,6 +16,7 @@
 #include "vp9/common/vp9_quant_common.h"
 #include "vp9/common/vp9_reconinter.h"
 #include "vp9/common/vp9_systemdependent.h"
+#include "vp9/encoder/vp9_ethread.h"
 #include "vp9/encoder/vp9_extend.h"
 #include "vp9/encoder/vp9_firstpass.h"
 #include "vp9/encoder/vp9_mcomp.h"
@@ -90,6 +91,7 @@ void vp9_temporal_filter_apply_c(uint8_t *frame1,
   unsigned int i, j, k;
   int modifier;
   int byte = 0;
+  const int rounding = strength > 0 ? 1 << (strength - 1) : 0;
 
   for (i = 0, k = 0; i < block_size; i++) {
     for (j = 0; j < block_size; j++, k++) {
@@ -102,7 +104,7 @@ void vp9_temporal_filter_apply_c(uint8_t *frame1,
       // modifier =  (int)roundf(coeff > 16 ? 0 : 16-coeff);
       modifier  *= modifier;
       modifier  *= 3;
-      modifier  += 1 << (strength - 1);
+      modifier  += rounding;
       modifier >>= strength;
 
       if (modifier > 16)
@@ -124,11 +126,11 @@ void vp9_temporal_filter_apply_c(uint8_t *frame1,
 #if ALT_REF_MC_ENABLED
 
 static int temporal_filter_find_matching_mb_c(VP9_COMP *cpi,
+                                              MACROBLOCK *x,
                                               uint8_t *arf_frame_buf,
                                               uint8_t *frame_ptr_buf,
                                               int stride,
                                               int error_thresh) {
-  MACROBLOCK *x = &cpi->mb;
   MACROBLOCKD* const xd = &x->e_mbd;
   int step_param;
   int sadpb = x->sadperbit16;
@@ -193,186 +195,220 @@ static int temporal_filter_find_matching_mb_c(VP9_COMP *cpi,
 }
 #endif
 
-static void temporal_filter_iterate_c(VP9_COMP *cpi,
-                                      int frame_count,
-                                      int alt_ref_index,
-                                      int strength,
-                                      struct scale_factors *scale) {
+// Filtering of the ARF, shared by the workers.
+struct temporal_filter_args {
+  int frame_count;
+  int alt_ref_index;
+  int strength;
+  struct scale_factors *scale;
+};
+
+static void temporal_filter_mb_row(VP9_COMP *cpi, MACROBLOCK *x,
+                                   const struct temporal_filter_args *args,
+                                   int mb_row) {
   int byte;
   int frame;
-  int mb_col, mb_row;
+  int mb_col;
   unsigned int filter_weight;
   int mb_cols = cpi->common.mb_cols;
-  int mb_rows = cpi->common.mb_rows;
-  int mb_y_offset = 0;
-  int mb_uv_offset = 0;
   DECLARE_ALIGNED_ARRAY(16, unsigned int, accumulator, 16 * 16 * 3);
   DECLARE_ALIGNED_ARRAY(16, uint16_t, count, 16 * 16 * 3);
-  MACROBLOCKD *mbd = &cpi->mb.e_mbd;
-  YV12_BUFFER_CONFIG *f = cpi->frames[alt_ref_index];
+  MACROBLOCKD *mbd = &x->e_mbd;
+  YV12_BUFFER_CONFIG *f = cpi->frames[args->alt_ref_index];
   uint8_t *dst1, *dst2;
   DECLARE_ALIGNED_ARRAY(16, uint8_t,  predictor, 16 * 16 * 3);
   const int mb_uv_height = 16 >> mbd->plane[1].subsampling_y;
+  int mb_y_offset = mb_row * 16 * f->y_stride;
+  int mb_uv_offset = mb_row * mb_uv_height * f->uv_stride;
+  // The source frames need not have the stride of the filtered frame.
+  int mb_y_dst_offset = mb_row * 16 * cpi->alt_ref_buffer.y_stride;
+  int mb_uv_dst_offset = mb_row * mb_uv_height * cpi->alt_ref_buffer.uv_stride;
 
-  // Save input state
-  uint8_t* input_buffer[MAX_MB_PLANE];
-  int i;
-
-  // TODO(aconverse): Add 4:2:2 support
-  assert(mbd->plane[1].subsampling_x == mbd->plane[1].subsampling_y);
-
-  for (i = 0; i < MAX_MB_PLANE; i++)
-    input_buffer[i] = mbd->plane[i].pre[0].buf;
-
-  for (mb_row = 0; mb_row < mb_rows; mb_row++) {
 #if ALT_REF_MC_ENABLED
-    // Source frames are extended to 16 pixels.  This is different than
-    //  L/A/G reference frames that have a border of 32 (VP9BORDERINPIXELS)
-    // A 6/8 tap filter is used for motion search.  This requires 2 pixels
-    //  before and 3 pixels after.  So the largest Y mv on a border would
-    //  then be 16 - VP9_INTERP_EXTEND. The UV blocks are half the size of the
-    //  Y and therefore only extended by 8.  The largest mv that a UV block
-    //  can support is 8 - VP9_INTERP_EXTEND.  A UV mv is half of a Y mv.
-    //  (16 - VP9_INTERP_EXTEND) >> 1 which is greater than
-    //  8 - VP9_INTERP_EXTEND.
-    // To keep the mv in play for both Y and UV planes the max that it
-    //  can be on a border is therefore 16 - (2*VP9_INTERP_EXTEND+1).
-    cpi->mb.mv_row_min = -((mb_row * 16) + (17 - 2 * VP9_INTERP_EXTEND));
-    cpi->mb.mv_row_max = ((cpi->common.mb_rows - 1 - mb_row) * 16)
-                         + (17 - 2 * VP9_INTERP_EXTEND);
+  // Source frames are extended to 16 pixels.  This is different than
+  //  L/A/G reference frames that have a border of 32 (VP9BORDERINPIXELS)
+  // A 6/8 tap filter is used for motion search.  This requires 2 pixels
+  //  before and 3 pixels after.  So the largest Y mv on a border would
+  //  then be 16 - VP9_INTERP_EXTEND. The UV blocks are half the size of the
+  //  Y and therefore only extended by 8.  The largest mv that a UV block
+  //  can support is 8 - VP9_INTERP_EXTEND.  A UV mv is half of a Y mv.
+  //  (16 - VP9_INTERP_EXTEND) >> 1 which is greater than
+  //  8 - VP9_INTERP_EXTEND.
+  // To keep the mv in play for both Y and UV planes the max that it
+  //  can be on a border is therefore 16 - (2*VP9_INTERP_EXTEND+1).
+  x->mv_row_min = -((mb_row * 16) + (17 - 2 * VP9_INTERP_EXTEND));
+  x->mv_row_max = ((cpi->common.mb_rows - 1 - mb_row) * 16)
+                  + (17 - 2 * VP9_INTERP_EXTEND);
 #endif
 
-    for (mb_col = 0; mb_col < mb_cols; mb_col++) {
-      int i, j, k;
-      int stride;
+  for (mb_col = 0; mb_col < mb_cols; mb_col++) {
+    int i, j, k;
+    int stride;
 
-      vpx_memset(accumulator, 0, 16 * 16 * 3 * sizeof(accumulator[0]));
-      vpx_memset(count, 0, 16 * 16 * 3 * sizeof(count[0]));
+    vpx_memset(accumulator, 0, 16 * 16 * 3 * sizeof(accumulator[0]));
+    vpx_memset(count, 0, 16 * 16 * 3 * sizeof(count[0]));
 
 #if ALT_REF_MC_ENABLED
-      cpi->mb.mv_col_min = -((mb_col * 16) + (17 - 2 * VP9_INTERP_EXTEND));
-      cpi->mb.mv_col_max = ((cpi->common.mb_cols - 1 - mb_col) * 16)
-                           + (17 - 2 * VP9_INTERP_EXTEND);
+    x->mv_col_min = -((mb_col * 16) + (17 - 2 * VP9_INTERP_EXTEND));
+    x->mv_col_max = ((cpi->common.mb_cols - 1 - mb_col) * 16)
+                    + (17 - 2 * VP9_INTERP_EXTEND);
 #endif
 
-      for (frame = 0; frame < frame_count; frame++) {
-        if (cpi->frames[frame] == NULL)
-          continue;
+    for (frame = 0; frame < args->frame_count; frame++) {
+      if (cpi->frames[frame] == NULL)
+        continue;
 
-        mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.row = 0;
-        mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.col = 0;
+      mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.row = 0;
+      mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.col = 0;
 
-        if (frame == alt_ref_index) {
-          filter_weight = 2;
-        } else {
-          int err = 0;
+      if (frame == args->alt_ref_index) {
+        filter_weight = 2;
+      } else {
+        int err = 0;
 #if ALT_REF_MC_ENABLED
 #define THRESH_LOW   10000
 #define THRESH_HIGH  20000
 
-          // Find best match in this frame by MC
-          err = temporal_filter_find_matching_mb_c
-                (cpi,
-                 cpi->frames[alt_ref_index]->y_buffer + mb_y_offset,
-                 cpi->frames[frame]->y_buffer + mb_y_offset,
-                 cpi->frames[frame]->y_stride,
-                 THRESH_LOW);
+        // Find best match in this frame by MC
+        err = temporal_filter_find_matching_mb_c
+              (cpi, x,
+               cpi->frames[args->alt_ref_index]->y_buffer + mb_y_offset,
+               cpi->frames[frame]->y_buffer + mb_y_offset,
+               cpi->frames[frame]->y_stride,
+               THRESH_LOW);
 #endif
-          // Assign higher weight to matching MB if it's error
-          // score is lower. If not applying MC default behavior
-          // is to weight all MBs equal.
-          filter_weight = err < THRESH_LOW
-                          ? 2 : err < THRESH_HIGH ? 1 : 0;
-        }
-
-        if (filter_weight != 0) {
-          // Construct the predictors
-          temporal_filter_predictors_mb_c
-          (mbd,
-           cpi->frames[frame]->y_buffer + mb_y_offset,
-           cpi->frames[frame]->u_buffer + mb_uv_offset,
-           cpi->frames[frame]->v_buffer + mb_uv_offset,
-           cpi->frames[frame]->y_stride,
-           mb_uv_height,
-           mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.row,
-           mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.col,
-           predictor, scale,
-           mb_col * 16, mb_row * 16);
-
-          // Apply the filter (YUV)
-          vp9_temporal_filter_apply(f->y_buffer + mb_y_offset, f->y_stride,
-                                    predictor, 16, strength, filter_weight,
-                                    accumulator, count);
-
-          vp9_temporal_filter_apply(f->u_buffer + mb_uv_offset, f->uv_stride,
-                                    predictor + 256, mb_uv_height, strength,
-                                    filter_weight, accumulator + 256,
-                                    count + 256);
-
-          vp9_temporal_filter_apply(f->v_buffer + mb_uv_offset, f->uv_stride,
-                                    predictor + 512, mb_uv_height, strength,
-                                    filter_weight, accumulator + 512,
-                                    count + 512);
-        }
+        // Assign higher weight to matching MB if it's error
+        // score is lower. If not applying MC default behavior
+        // is to weight all MBs equal.
+        filter_weight = err < THRESH_LOW
+                        ? 2 : err < THRESH_HIGH ? 1 : 0;
       }
 
-      // Normalize filter output to produce AltRef frame
-      dst1 = cpi->alt_ref_buffer.y_buffer;
-      stride = cpi->alt_ref_buffer.y_stride;
-      byte = mb_y_offset;
-      for (i = 0, k = 0; i < 16; i++) {
-        for (j = 0; j < 16; j++, k++) {
-          unsigned int pval = accumulator[k] + (count[k] >> 1);
-          pval *= cpi->fixed_divide[count[k]];
-          pval >>= 19;
+      if (filter_weight != 0) {
+        // Construct the predictors
+        temporal_filter_predictors_mb_c
+        (mbd,
+         cpi->frames[frame]->y_buffer + mb_y_offset,
+         cpi->frames[frame]->u_buffer + mb_uv_offset,
+         cpi->frames[frame]->v_buffer + mb_uv_offset,
+         cpi->frames[frame]->y_stride,
+         mb_uv_height,
+         mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.row,
+         mbd->mi_8x8[0]->bmi[0].as_mv[0].as_mv.col,
+         predictor, args->scale,
+         mb_col * 16, mb_row * 16);
+
+        // Apply the filter (YUV)
+        vp9_temporal_filter_apply(f->y_buffer + mb_y_offset, f->y_stride,
+                                  predictor, 16, args->strength,
+                                  filter_weight, accumulator, count);
+
+        vp9_temporal_filter_apply(f->u_buffer + mb_uv_offset, f->uv_stride,
+                                  predictor + 256, mb_uv_height,
+                                  args->strength, filter_weight,
+                                  accumulator + 256, count + 256);
+
+        vp9_temporal_filter_apply(f->v_buffer + mb_uv_offset, f->uv_stride,
+                                  predictor + 512, mb_uv_height,
+                                  args->strength, filter_weight,
+                                  accumulator + 512, count + 512);
+      }
+    }
 
-          dst1[byte] = (uint8_t)pval;
+    // Normalize filter output to produce AltRef frame
+    dst1 = cpi->alt_ref_buffer.y_buffer;
+    stride = cpi->alt_ref_buffer.y_stride;
+    byte = mb_y_dst_offset;
+    for (i = 0, k = 0; i < 16; i++) {
+      for (j = 0; j < 16; j++, k++) {
+        unsigned int pval = accumulator[k] + (count[k] >> 1);
+        pval *= cpi->fixed_divide[count[k]];
+        pval >>= 19;
 
-          // move to next pixel
-          byte++;
-        }
+        dst1[byte] = (uint8_t)pval;
 
-        byte += stride - 16;
+        // move to next pixel
+        byte++;
       }
 
-      dst1 = cpi->alt_ref_buffer.u_buffer;
-      dst2 = cpi->alt_ref_buffer.v_buffer;
-      stride = cpi->alt_ref_buffer.uv_stride;
-      byte = mb_uv_offset;
-      for (i = 0, k = 256; i < mb_uv_height; i++) {
-        for (j = 0; j < mb_uv_height; j++, k++) {
-          int m = k + 256;
-
-          // U
-          unsigned int pval = accumulator[k] + (count[k] >> 1);
-          pval *= cpi->fixed_divide[count[k]];
-          pval >>= 19;
-          dst1[byte] = (uint8_t)pval;
-
-          // V
-          pval = accumulator[m] + (count[m] >> 1);
-          pval *= cpi->fixed_divide[count[m]];
-          pval >>= 19;
-          dst2[byte] = (uint8_t)pval;
-
-          // move to next pixel
-          byte++;
-        }
-
-        byte += stride - mb_uv_height;
+      byte += stride - 16;
+    }
+
+    dst1 = cpi->alt_ref_buffer.u_buffer;
+    dst2 = cpi->alt_ref_buffer.v_buffer;
+    stride = cpi->alt_ref_buffer.uv_stride;
+    byte = mb_uv_dst_offset;
+    for (i = 0, k = 256; i < mb_uv_height; i++) {
+      for (j = 0; j < mb_uv_height; j++, k++) {
+        int m = k + 256;
+
+        // U
+        unsigned int pval = accumulator[k] + (count[k] >> 1);
+        pval *= cpi->fixed_divide[count[k]];
+        pval >>= 19;
+        dst1[byte] = (uint8_t)pval;
+
+        // V
+        pval = accumulator[m] + (count[m] >> 1);
+        pval *= cpi->fixed_divide[count[m]];
+        pval >>= 19;
+        dst2[byte] = (uint8_t)pval;
+
+        // move to next pixel
+        byte++;
       }
 
-      mb_y_offset += 16;
-      mb_uv_offset += mb_uv_height;
+      byte += stride - mb_uv_height;
     }
 
-    mb_y_offset += 16 * (f->y_stride - mb_cols);
-    mb_uv_offset += mb_uv_height * (f->uv_stride - mb_cols);
+    mb_y_offset += 16;
+    mb_uv_offset += mb_uv_height;
+    mb_y_dst_offset += 16;
+    mb_uv_dst_offset += mb_uv_height;
   }
+}
 
-  // Restore input state
-  for (i = 0; i < MAX_MB_PLANE; i++)
-    mbd->plane[i].pre[0].buf = input_buffer[i];
+// Filters MB rows start, start + num_workers, ... of the ARF.
+static int temporal_filter_worker(void *arg1, void *arg2) {
+  EncWorkerData *const data = (EncWorkerData*)arg1;
+  const struct temporal_filter_args *const args =
+      (const struct temporal_filter_args*)arg2;
+  VP9_COMP *const cpi = data->cpi;
+  MACROBLOCK *const x = &data->mb;
+  int mb_row;
+
+  // The motion search returns its vector in the mode info, so each worker
+  // searches with one of its own.
+  vp9_init_worker_mb(cpi, x);
+  data->mi = *cpi->mb.e_mbd.mi_8x8[0];
+  data->mi_8x8 = &data->mi;
+  x->e_mbd.mi_8x8 = &data->mi_8x8;
+
+  for (mb_row = data->start; mb_row < cpi->common.mb_rows;
+       mb_row += data->num_workers)
+    temporal_filter_mb_row(cpi, x, args, mb_row);
+  return 1;
+}
+
+static void temporal_filter_iterate_c(VP9_COMP *cpi,
+                                      int frame_count,
+                                      int alt_ref_index,
+                                      int strength,
+                                      struct scale_factors *scale) {
+  struct temporal_filter_args args;
+
+  // TODO(aconverse): Add 4:2:2 support
+  assert(cpi->mb.e_mbd.plane[1].subsampling_x ==
+         cpi->mb.e_mbd.plane[1].subsampling_y);
+
+  args.frame_count = frame_count;
+  args.alt_ref_index = alt_ref_index;
+  args.strength = strength;
+  args.scale = scale;
+
+  // Every MB is filtered on its own, so the workers can take any rows.
+  vp9_run_enc_workers(cpi, temporal_filter_worker, &args,
+                      vp9_get_num_enc_workers(cpi, cpi->common.mb_rows));
 }
 
 void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance) {
@@ -464,6 +500,7 @@ void vp9_temporal_filter_prepare(VP9_COMP *cpi, int distance) {
     int which_buffer = start_frame - frame;
     struct lookahead_entry *buf = vp9_lookahead_peek(cpi->lookahead,
                                                      which_buffer);
+    vp9_lookahead_extend_borders(buf);
     cpi->frames[frames_to_blur - 1 - frame] = &buf->img;
   }
 
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <assert.h>
+#include <immintrin.h>  // AVX2
+
+#include "./vp9_rtcd.h"
+#include "vpx/vpx_integer.h"
+
+void vp9_temporal_filter_apply_avx2(uint8_t *frame1,
+                                    unsigned int stride,
+                                    uint8_t *frame2,
+                                    unsigned int block_size,
+                                    int strength,
+                                    int filter_weight,
+                                    unsigned int *accumulator,
+                                    uint16_t *count) {
+  const __m256i rounding = _mm256_set1_epi16(strength > 0 ?
+                                             1 << (strength - 1) : 0);
+  const __m128i shift = _mm_cvtsi32_si128(strength);
+  const __m256i weight = _mm256_set1_epi16(filter_weight);
+  const __m256i sixteen = _mm256_set1_epi16(16);
+  const unsigned int num_pixels = block_size * block_size;
+  unsigned int k;
+
+  assert(block_size == 8 || block_size == 16);
+
+  // 16 pixels, one row of a 16x16 block or two rows of an 8x8 one, at a time.
+  for (k = 0; k < num_pixels; k += 16) {
+    __m128i src8;
+    __m256i src, pred, modifier, pred_modifier;
+
+    if (block_size == 16) {
+      src8 = _mm_loadu_si128((const __m128i *)frame1);
+      frame1 += stride;
+    } else {
+      src8 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)frame1),
+                                _mm_loadl_epi64((const __m128i *)
+                                                (frame1 + stride)));
+      frame1 += 2 * stride;
+    }
+    src = _mm256_cvtepu8_epi16(src8);
+    pred = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)frame2));
+    frame2 += 16;
+
+    // modifier = 16 - min(16, (3 * (src - pred)^2 + rounding) >> strength).
+    // (src - pred)^2 fits in an unsigned word, 3 times that does not for
+    // |src - pred| > 147. Saturating there keeps the result above 16.
+    modifier = _mm256_sub_epi16(src, pred);
+    modifier = _mm256_mullo_epi16(modifier, modifier);
+    modifier = _mm256_adds_epu16(_mm256_adds_epu16(modifier, modifier),
+                                 modifier);
+    modifier = _mm256_adds_epu16(modifier, rounding);
+    modifier = _mm256_srl_epi16(modifier, shift);
+    modifier = _mm256_subs_epu16(sixteen, modifier);
+    modifier = _mm256_mullo_epi16(modifier, weight);
+
+    _mm256_storeu_si256((__m256i *)(count + k),
+                        _mm256_add_epi16(_mm256_loadu_si256(
+                                             (const __m256i *)(count + k)),
+                                         modifier));
+
+    // modifier * pred is at most 32 * 255, so it is widened after the
+    // multiplication.
+    pred_modifier = _mm256_mullo_epi16(modifier, pred);
+    _mm256_storeu_si256(
+        (__m256i *)(accumulator + k),
+        _mm256_add_epi32(
+            _mm256_loadu_si256((const __m256i *)(accumulator + k)),
+            _mm256_cvtepu16_epi32(_mm256_castsi256_si128(pred_modifier))));
+    _mm256_storeu_si256(
+        (__m256i *)(accumulator + k + 8),
+        _mm256_add_epi32(
+            _mm256_loadu_si256((const __m256i *)(accumulator + k + 8)),
+            _mm256_cvtepu16_epi32(_mm256_extracti128_si256(pred_modifier,
+                                                           1))));
+  }
+}
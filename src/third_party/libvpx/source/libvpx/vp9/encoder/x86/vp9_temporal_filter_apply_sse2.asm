@@ -105,12 +105,18 @@ sym(vp9_temporal_filter_apply_sse2):
         pmullw      xmm1,           xmm1   ; modifer[ 8-15]^2
 
         ; modifier *= 3
-        pmullw      xmm0,           [GLOBAL(_const_3w)]
-        pmullw      xmm1,           [GLOBAL(_const_3w)]
+        ; saturating, as 3 * modifier^2 does not fit in a word for
+        ; |src - pred| > 147; any saturated value still ends up above 16
+        movdqa      xmm2,           xmm0
+        movdqa      xmm3,           xmm1
+        paddusw     xmm0,           xmm0
+        paddusw     xmm1,           xmm1
+        paddusw     xmm0,           xmm2
+        paddusw     xmm1,           xmm3
 
         ; modifer += 0x8000 >> (16 - strength)
-        paddw       xmm0,           [rsp + rounding_bit]
-        paddw       xmm1,           [rsp + rounding_bit]
+        paddusw     xmm0,           [rsp + rounding_bit]
+        paddusw     xmm1,           [rsp + rounding_bit]
 
         ; modifier >>= strength
         psrlw       xmm0,           [rsp + strength]
@@ -197,9 +203,6 @@ sym(vp9_temporal_filter_apply_sse2):
 
 SECTION_RODATA
 align 16
-_const_3w:
-    times 8 dw 3
-align 16
 _const_top_bit:
     times 8 dw 1<<15
 align 16
@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include "vpx_mem/vpx_mem.h"
+#include "vpx_ports/vpx_timer.h"
 #include "vp9/sched/thread.h"
 #include "vp9/sched/sched.h"
 #include "vp9/sched/device.h"
@@ -107,14 +108,51 @@ static void sched_sub_tasks(struct task *tsk, struct device *dev, int count) {
   }
 }
 
-static void process_task(struct task *tsk, struct device *dev) {
+static void thread_stats_add_step(struct thread_stats *stats,
+                                  const struct task_step *step,
+                                  int64_t usecs) {
+  int i;
+
+  for (i = 0; i < stats->steps_count; i++) {
+    if (stats->steps[i].step == step)
+      break;
+  }
+
+  if (i == stats->steps_count) {
+    if (i == MAX_THREAD_STEP_STATS)
+      return;
+    stats->steps[i].step = step;
+    stats->steps_count++;
+  }
+
+  stats->steps[i].usecs += usecs;
+  stats->steps[i].runs++;
+}
+
+// stats is NULL when the task runs on a thread the device does not own.
+static void process_task(struct task *tsk, struct device *dev,
+                         struct thread_stats *stats) {
   int rv;
   struct task_step *step;
+  struct vpx_usec_timer timer;
 
   step = TASK_TO_STEP(tsk, tsk->curr_step);
+  vpx_usec_timer_start(&timer);
   rv = step->process(tsk, step, dev->type);
+  vpx_usec_timer_mark(&timer);
   assert(rv >= 0);
 
+  // Accounted before the step is finished, which may complete the frame,
+  // so a reader waiting on the frame sees the time of each of its steps.
+  if (stats) {
+    const int64_t usecs = vpx_usec_timer_elapsed(&timer);
+
+    pthread_mutex_lock(&stats->lock);
+    thread_stats_add_step(stats, step, usecs);
+    stats->busy_usecs += usecs;
+    pthread_mutex_unlock(&stats->lock);
+  }
+
   task_finish_step(tsk, step->step_nr);
   if (rv > 0) {  // multiple sub-tasks
     sched_sub_tasks(tsk, dev, rv);
@@ -137,7 +175,7 @@ static THREADFN thread_fn(void *arg) {
     n = queue_pop(dev->q);
     if (n) {
       struct task *tsk = list_entry(n, struct task, entry);
-      process_task(tsk, dev);
+      process_task(tsk, dev, &thr->stats);
     } else {
       return THREAD_RETURN(NULL);
     }
@@ -178,6 +216,7 @@ static int device_common_init(struct device *dev) {
 
   for (i = 0; i < dev->threads_count; i++) {
     dev->threads[i].dev = dev;
+    pthread_mutex_init(&dev->threads[i].stats.lock, NULL);
   }
 
   rv = device_start_threads(dev);
@@ -207,6 +246,7 @@ static int device_common_fini(struct device *dev) {
   for (i = 0; i < dev->threads_count; i++) {
     queue_stop(dev->q);
     pthread_join(dev->threads[i].thread_id, NULL);
+    pthread_mutex_destroy(&dev->threads[i].stats.lock);
   }
 
   queue_delete(dev->q);
@@ -257,8 +297,37 @@ int cpu_device_exec(struct device *dev) {
 
   while ((n = queue_try_pop(dev->q))) {
     struct task *tsk = list_entry(n, struct task, entry);
-    process_task(tsk, dev);
+    process_task(tsk, dev, NULL);
   }
 
   return 0;
 }
+
+void device_get_step_stats(struct device *dev, const struct task_step *step,
+                           int64_t *usecs, int *runs) {
+  int i, j;
+
+  for (i = 0; i < dev->threads_count; i++) {
+    struct thread_stats *const stats = &dev->threads[i].stats;
+
+    pthread_mutex_lock(&stats->lock);
+    for (j = 0; j < stats->steps_count; j++) {
+      if (stats->steps[j].step == step) {
+        *usecs += stats->steps[j].usecs;
+        *runs += stats->steps[j].runs;
+        break;
+      }
+    }
+    pthread_mutex_unlock(&stats->lock);
+  }
+}
+
+int64_t device_get_thread_busy_usecs(struct device *dev, int nr) {
+  struct thread_stats *const stats = &dev->threads[nr].stats;
+  int64_t usecs;
+
+  pthread_mutex_lock(&stats->lock);
+  usecs = stats->busy_usecs;
+  pthread_mutex_unlock(&stats->lock);
+  return usecs;
+}
@@ -11,6 +11,7 @@
 #ifndef SCHED_DEVICDE_H_
 #define SCHED_DEVICDE_H_
 
+#include "vpx/vpx_integer.h"
 #include "vp9/sched/task.h"
 #include "vp9/sched/queue.h"
 #include "vp9/sched/atomic.h"
@@ -28,11 +29,31 @@ enum DevStatus {
   DEV_STAT_DISABLED = (1 << 1),
 };
 
+// Upper bound on the distinct steps one thread keeps times for, enough for
+// every step of the decoder's steps pools.
+#define MAX_THREAD_STEP_STATS 32
+
+struct step_stats {
+  const struct task_step *step;
+  int64_t usecs;
+  int runs;
+};
+
+// Accumulated by the owning thread alone, so the lock is only ever contended
+// by a reader merging the stats of all threads.
+struct thread_stats {
+  pthread_mutex_t lock;
+  int64_t busy_usecs;
+  int steps_count;
+  struct step_stats steps[MAX_THREAD_STEP_STATS];
+};
+
 struct thread {
   pthread_t thread_id;
   struct device *dev;
   int nr;
   int line;
+  struct thread_stats stats;
 };
 
 struct device {
@@ -82,4 +103,11 @@ int device_push_task(struct device *dev, struct task *tsk);
 
 int cpu_device_exec(struct device *dev);
 
+// Adds the time the device's threads spent in step to *usecs and the number
+// of times they ran it to *runs.
+void device_get_step_stats(struct device *dev, const struct task_step *step,
+                           int64_t *usecs, int *runs);
+
+int64_t device_get_thread_busy_usecs(struct device *dev, int nr);
+
 #endif // SCHED_DEVICDE_H_
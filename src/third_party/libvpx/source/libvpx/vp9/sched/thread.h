@@ -16,7 +16,7 @@
 #ifndef SCHED_THREAD_H_
 #define SCHED_THREAD_H_
 
-#include "vp9/decoder/vp9_thread.h"
+#include "vp9/common/vp9_thread.h"
 
 #if defined(_WIN32)
 
@@ -337,6 +337,8 @@ static vpx_codec_err_t set_vp9e_config(VP9_CONFIG *oxcf,
   oxcf->tile_columns = vp8_cfg.tile_columns;
   oxcf->tile_rows    = vp8_cfg.tile_rows;
 
+  oxcf->max_threads = cfg.g_threads;
+
   oxcf->lossless = vp8_cfg.lossless;
 
   oxcf->error_resilient_mode         = cfg.g_error_resilient;
@@ -625,6 +627,40 @@ static int write_superframe_index(vpx_codec_alg_priv_t *ctx) {
   return index_sz;
 }
 
+// Returns the padding, in luma pixels, that the planes of img have on every
+// side of the visible area, or 0 if they are not laid out the way
+// vpx_img_set_rect() leaves an I420 image.
+static int get_image_padding(const vpx_image_t *img) {
+  const int y_stride = img->stride[VPX_PLANE_Y];
+  const int uv_stride = img->stride[VPX_PLANE_U];
+  const unsigned char *u_plane, *v_plane;
+  int x, y, padding;
+
+  if (img->fmt != VPX_IMG_FMT_I420 || img->img_data == NULL ||
+      y_stride <= 0 || uv_stride != y_stride >> 1 ||
+      img->stride[VPX_PLANE_V] != uv_stride ||
+      img->planes[VPX_PLANE_Y] < img->img_data)
+    return 0;
+
+  x = (int)((img->planes[VPX_PLANE_Y] - img->img_data) % y_stride);
+  y = (int)((img->planes[VPX_PLANE_Y] - img->img_data) / y_stride);
+  u_plane = img->img_data + img->h * y_stride;
+  v_plane = u_plane + (img->h >> 1) * uv_stride;
+  if ((x & 1) || (y & 1) ||
+      img->planes[VPX_PLANE_U] != u_plane + (y >> 1) * uv_stride + (x >> 1) ||
+      img->planes[VPX_PLANE_V] != v_plane + (y >> 1) * uv_stride + (x >> 1))
+    return 0;
+
+  padding = MIN(x, y);
+  padding = MIN(padding, y_stride - x - (int)img->d_w);
+  padding = MIN(padding, (int)img->h - y - (int)img->d_h);
+  // Chroma rows and columns are padded by half as much, rounded down.
+  padding = MIN(padding, 2 * (uv_stride - (x >> 1) - (int)(img->d_w + 1) / 2));
+  padding = MIN(padding,
+                2 * ((int)(img->h >> 1) - (y >> 1) - (int)(img->d_h + 1) / 2));
+  return MAX(padding, 0);
+}
+
 static vpx_codec_err_t vp9e_encode(vpx_codec_alg_priv_t  *ctx,
                                    const vpx_image_t     *img,
                                    vpx_codec_pts_t        pts,
@@ -718,9 +754,11 @@ static vpx_codec_err_t vp9e_encode(vpx_codec_alg_priv_t  *ctx,
 
     if (img != NULL) {
       res = image2yuvconfig(img, &sd);
+      sd.border = get_image_padding(img);
 
       if (vp9_receive_raw_frame(ctx->cpi, lib_flags,
-                                &sd, dst_time_stamp, dst_end_time_stamp)) {
+                                &sd, dst_time_stamp, dst_end_time_stamp,
+                                img->user_priv)) {
         VP9_COMP *cpi = (VP9_COMP *)ctx->cpi;
         res = update_error_state(ctx, &cpi->common.error);
       }
@@ -1013,6 +1051,17 @@ static vpx_codec_err_t vp9e_set_svc(vpx_codec_alg_priv_t *ctx, int ctr_id,
   return VPX_CODEC_OK;
 }
 
+static vpx_codec_err_t vp9e_set_source_release_cb(vpx_codec_alg_priv_t *ctx,
+                                                   int ctr_id, va_list args) {
+  vpx_source_release_cb_t *data = va_arg(args, vpx_source_release_cb_t *);
+
+  if (data == NULL)
+    return VPX_CODEC_INVALID_PARAM;
+
+  vp9_set_source_release_cb(ctx->cpi, data);
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_err_t vp9e_set_svc_parameters(vpx_codec_alg_priv_t *ctx,
                                                int ctr_id, va_list args) {
   vpx_svc_parameters_t *data = va_arg(args, vpx_svc_parameters_t *);
@@ -1074,6 +1123,7 @@ static vpx_codec_ctrl_fn_map_t vp9e_ctf_maps[] = {
   {VP9_GET_REFERENCE,                 get_reference},
   {VP9E_SET_SVC,                      vp9e_set_svc},
   {VP9E_SET_SVC_PARAMETERS,           vp9e_set_svc_parameters},
+  {VP9E_SET_SOURCE_RELEASE_CB,        vp9e_set_source_release_cb},
   { -1, NULL},
 };
 
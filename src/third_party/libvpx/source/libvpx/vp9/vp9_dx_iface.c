@@ -20,13 +20,13 @@
 #include "vp9/decoder/vp9_read_bit_buffer.h"
 #include "vp9/vp9_iface_common.h"
 #include "vp9/common/inter_ocl/vp9_inter_ocl_init.h"
+#include "vp9/common/inter_ocl/vp9_inter_ocl_param.h"
 #include "vp9/decoder/vp9_copy_mip_ocl.h"
 #include "vp9/common/inter_ocl/vp9_yuv2rgba.h"
 #include "vpx_ports/vpx_timer.h"
 
 #define VP9_CAP_POSTPROC (CONFIG_VP9_POSTPROC ? VPX_CODEC_CAP_POSTPROC : 0)
 typedef vpx_codec_stream_info_t  vp9_stream_info_t;
-extern int CpuFlag;
 
 /* Structures for handling memory allocations */
 typedef enum {
@@ -66,12 +66,16 @@ struct vpx_codec_alg_priv {
   int                     img_avail;
   int                     invert_tile_order;
   int                     fb_lru;
+  int                     skipped_first_count;
 
   /* External buffer info to save for VP9 common. */
   vpx_codec_frame_buffer_t *fb_list;  // External frame buffers
   int fb_count;  // Total number of frame buffers
   vpx_realloc_frame_buffer_cb_fn_t realloc_fb_cb;
   void *user_priv;  // Private data associated with the external frame buffers.
+
+  INTER_OCL_OBJ          *inter_ocl;
+  int                     interop;
 };
 
 static unsigned long priv_sz(const vpx_codec_dec_cfg_t *si,
@@ -133,6 +137,39 @@ static void vp9_finalize_mmaps(vpx_codec_alg_priv_t *ctx) {
   /* nothing to clean up */
 }
 
+#if USE_INTER_PREDICT_OCL
+static vpx_codec_err_t init_inter_ocl(vpx_codec_alg_priv_t *ctx,
+                                      void *interop_context) {
+  int status;
+
+  ctx->inter_ocl = vpx_calloc(1, sizeof(*ctx->inter_ocl));
+  if (ctx->inter_ocl == NULL)
+    return VPX_CODEC_MEM_ERROR;
+
+  if (interop_context != NULL)
+    status = vp9_init_ocl_ex(ctx->inter_ocl, interop_context);
+  else
+    status = vp9_init_ocl(ctx->inter_ocl);
+  if (status < 0) {
+    vpx_free(ctx->inter_ocl);
+    ctx->inter_ocl = NULL;
+    return VPX_CODEC_ERROR;
+  }
+
+  if (interop_context != NULL) {
+    // Only the first decoder can create the interop context, so there is
+    // never more than one instance using the global yuv2rgba state.
+    ctx->interop = 1;
+    yuv2rgba_ocl_obj.use_ex_flag = 1;
+    if (init_yuv2rgba_ocl_obj() < 0)
+      return VPX_CODEC_ERROR;
+    vp9_yuv2rgba_log_open();
+  }
+
+  return VPX_CODEC_OK;
+}
+#endif  // USE_INTER_PREDICT_OCL
+
 static vpx_codec_err_t vp9_init(vpx_codec_ctx_t *ctx,
                                 vpx_codec_priv_enc_mr_cfg_t *data) {
   vpx_codec_err_t res = VPX_CODEC_OK;
@@ -158,7 +195,8 @@ static vpx_codec_err_t vp9_init(vpx_codec_ctx_t *ctx,
 
 #if USE_INTER_PREDICT_OCL
   // Initialize opencl for vp9
-  vp9_init_ocl();
+  if (!res && ctx->priv->alg_priv->inter_ocl == NULL)
+    res = init_inter_ocl(ctx->priv->alg_priv, NULL);
 #if COPY_MIP_GPU
   create_cpy_mip_kernel(&ocl_cpy_mip_obj);
 #endif
@@ -192,14 +230,8 @@ static vpx_codec_err_t vp9_init_ex(vpx_codec_ctx_t_ex *ctx,
 
 #if USE_INTER_PREDICT_OCL
   // Initialize opencl for vp9
-  if (interOp_context != NULL) {
-    vp9_init_ocl_ex(interOp_context);
-    yuv2rgba_ocl_obj.use_ex_flag = 1;
-    init_yuv2rgba_ocl_obj();
-  } else {
-    vp9_init_ocl();
-    yuv2rgba_ocl_obj.use_ex_flag = 0;
-  }
+  if (!res && ctx->priv->alg_priv->inter_ocl == NULL)
+    res = init_inter_ocl(ctx->priv->alg_priv, interOp_context);
 #endif // USE_INTER_PREDICT_OCL
 
   return res;
@@ -211,6 +243,29 @@ static vpx_codec_err_t vp9_destroy(vpx_codec_alg_priv_t *ctx) {
   // vp9_remove_decompressor(ctx->pbi);
   vp9_remove_decompressor_recon(ctx->pbi, ctx->storage_pbi);
 
+#if USE_INTER_PREDICT_OCL
+  if (ctx->interop) {
+    release_yuv2rgba_ocl_obj();
+    vp9_yuv2rgba_log_close();
+  }
+  if (ctx->inter_ocl != NULL) {
+#if DO_PROFILING
+    printf("\n***********kernels avg time**************\n");
+    printf("index_param_kernel_time : %f ms\n",
+           ctx->inter_ocl->param_index_kernel_time /
+           ctx->inter_ocl->index_run_times);
+    printf("inter_pred_kernel_time : %f ms\n",
+           ctx->inter_ocl->inter_pred_kernel_time /
+           ctx->inter_ocl->inter_pred_run_tmes);
+    printf("cpy_mip_kernel_time : %f ms\n",
+           ocl_cpy_mip_obj.cpy_mip_kernel_time /
+           ocl_cpy_mip_obj.cpy_mip_run_times);
+#endif
+    vp9_release_ocl(ctx->inter_ocl);
+    vpx_free(ctx->inter_ocl);
+  }
+#endif  // USE_INTER_PREDICT_OCL
+
   for (i = NELEMENTS(ctx->mmaps) - 1; i >= 0; i--) {
     if (ctx->mmaps[i].dtor)
       ctx->mmaps[i].dtor(&ctx->mmaps[i]);
@@ -451,7 +506,6 @@ static vpx_codec_err_t decode_one_recon(vpx_codec_alg_priv_t *ctx,
 
   VP9D_COMP *pbi;
   VP9D_COMP *pbi_storage;
-  static int flag = 0;
   int i_is_last_frame = 0;
   int ret = -1;
 
@@ -549,11 +603,14 @@ static vpx_codec_err_t decode_one_recon(vpx_codec_alg_priv_t *ctx,
           cm->fb_count = ctx->fb_count;
           cm->realloc_fb_cb = ctx->realloc_fb_cb;
           cm->user_priv = ctx->user_priv;
-          CpuFlag = 1;
+          ctx->inter_ocl->cpu_flag = 1;
         } else {
-          CpuFlag = 0;
+          ctx->inter_ocl->cpu_flag = 0;
           cm->fb_count = FRAME_BUFFERS;
         }
+        cm->inter_ocl = ctx->inter_ocl;
+        cm0->inter_ocl = ctx->inter_ocl;
+        cm1->inter_ocl = ctx->inter_ocl;
         cm->fb_lru = ctx->fb_lru;
         CHECK_MEM_ERROR(cm, cm->yv12_fb,
                         vpx_calloc(cm->fb_count, sizeof(*cm->yv12_fb)));
@@ -685,10 +742,11 @@ static vpx_codec_err_t decode_one_recon(vpx_codec_alg_priv_t *ctx,
         
     pbi = (VP9D_COMP *)ctx->pbi;
     if (pbi->common.show_frame) {
-      if (flag || (pbi->common.current_video_frame != 1))
+      if (ctx->skipped_first_count ||
+          (pbi->common.current_video_frame != 1))
         pbi->common.current_video_frame++;
       else
-        flag = 1;
+        ctx->skipped_first_count = 1;
     }
     
     if (data_sz == 0) {
@@ -708,7 +766,6 @@ static vpx_codec_err_t decode_one_recon_ex(vpx_codec_alg_priv_t *ctx,
   VP9D_COMP *pbi;
   VP9D_COMP *pbi_storage;
   VP9D_COMP *my_pbi;
-  static int flag = 0;
   int i_is_last_frame = 0;
   int ret = -1;
 
@@ -810,11 +867,14 @@ static vpx_codec_err_t decode_one_recon_ex(vpx_codec_alg_priv_t *ctx,
           cm->fb_count = ctx->fb_count;
           cm->realloc_fb_cb = ctx->realloc_fb_cb;
           cm->user_priv = ctx->user_priv;
-          CpuFlag = 1;
+          ctx->inter_ocl->cpu_flag = 1;
         } else {
-          CpuFlag = 0;
+          ctx->inter_ocl->cpu_flag = 0;
           cm->fb_count = FRAME_BUFFERS;
         }
+        cm->inter_ocl = ctx->inter_ocl;
+        cm0->inter_ocl = ctx->inter_ocl;
+        cm1->inter_ocl = ctx->inter_ocl;
         cm->fb_lru = ctx->fb_lru;
         CHECK_MEM_ERROR(cm, cm->yv12_fb,
                         vpx_calloc(cm->fb_count, sizeof(*cm->yv12_fb)));
@@ -940,11 +1000,11 @@ static vpx_codec_err_t decode_one_recon_ex(vpx_codec_alg_priv_t *ctx,
           //for render
           my_pbi = (VP9D_COMP *)(ctx->storage_pbi[pbi->l_bufpool_flag_output & 1]);
           yuv2rgba_ocl_obj.y_plane_offset = my_pbi->common.frame_to_show->y_buffer - 
-                                                inter_ocl_obj.buffer_pool_map_ptr;
+                                                ctx->inter_ocl->buffer_pool_map_ptr;
           yuv2rgba_ocl_obj.u_plane_offset = my_pbi->common.frame_to_show->u_buffer - 
-                                                inter_ocl_obj.buffer_pool_map_ptr;
+                                                ctx->inter_ocl->buffer_pool_map_ptr;
           yuv2rgba_ocl_obj.v_plane_offset = my_pbi->common.frame_to_show->v_buffer - 
-                                                inter_ocl_obj.buffer_pool_map_ptr;
+                                                ctx->inter_ocl->buffer_pool_map_ptr;
  
           yuv2rgba_ocl_obj.Y_stride =  my_pbi->common.frame_to_show->y_stride;
           yuv2rgba_ocl_obj.UV_stride =  my_pbi->common.frame_to_show->uv_stride;
@@ -952,11 +1012,12 @@ static vpx_codec_err_t decode_one_recon_ex(vpx_codec_alg_priv_t *ctx,
           yuv2rgba_ocl_obj.globalThreads[1] =  my_pbi->common.height >> 1;
  
 		  vpx_usec_timer_start(&timer);
-          vp9_yuv2rgba(&yuv2rgba_ocl_obj, texture);
+          vp9_yuv2rgba(&yuv2rgba_ocl_obj, ctx->inter_ocl, texture);
 		  vpx_usec_timer_mark(&timer);
           yuv2rgb_time = (unsigned int)vpx_usec_timer_elapsed(&timer);
-	      fprintf(pLog, "decode one frame time(without YUV to RGB): %lu us\n"
-			            "the whole time of YUV to RGB:  %lu us\n", decode_time, yuv2rgb_time);
+          yuv2rgba_ocl_obj.decode_time = decode_time;
+          yuv2rgba_ocl_obj.yuv2rgb_time = yuv2rgb_time;
+          yuv2rgba_ocl_obj.log_pending = 1;
           // for render end
           yuvconfig2image(&ctx->img, &sd, user_priv);
           ctx->img_avail = 1;
@@ -969,10 +1030,11 @@ static vpx_codec_err_t decode_one_recon_ex(vpx_codec_alg_priv_t *ctx,
         
     pbi = (VP9D_COMP *)ctx->pbi;
     if (pbi->common.show_frame) {
-      if (flag || (pbi->common.current_video_frame != 1))
+      if (ctx->skipped_first_count ||
+          (pbi->common.current_video_frame != 1))
         pbi->common.current_video_frame++;
       else
-        flag = 1;
+        ctx->skipped_first_count = 1;
     }
     
     if (data_sz == 0) {
@@ -1447,6 +1509,52 @@ static vpx_codec_err_t set_frame_buffer_lru_cache(vpx_codec_alg_priv_t *ctx,
   return VPX_CODEC_OK;
 }
 
+static void add_pool_stats(vp9_decode_stats *stats, struct scheduler *sched,
+                           struct task_steps_pool *pool) {
+  struct device *dev;
+  int i;
+
+  if (!pool)
+    return;
+
+  for (i = 0; i < pool->steps_count &&
+              stats->step_count < VP9_DECODE_STATS_MAX_STEPS; i++) {
+    const struct task_step *const step = &pool->steps[i];
+    stats->step_name[stats->step_count] = step->name;
+    sched_for_each_dev(dev, sched) {
+      device_get_step_stats(dev, step, &stats->step_usecs[stats->step_count],
+                            &stats->step_runs[stats->step_count]);
+    }
+    stats->step_count++;
+  }
+}
+
+static vpx_codec_err_t get_decode_stats(vpx_codec_alg_priv_t *ctx,
+                                        int ctrl_id, va_list args) {
+  vp9_decode_stats *const stats = va_arg(args, vp9_decode_stats *);
+  VP9D_COMP *const pbi = (VP9D_COMP*)ctx->pbi;
+  struct device *dev;
+  int i;
+
+  if (!stats)
+    return VPX_CODEC_INVALID_PARAM;
+  if (!pbi || !pbi->sched)
+    return VPX_CODEC_ERROR;
+
+  memset(stats, 0, sizeof(*stats));
+  add_pool_stats(stats, pbi->sched, pbi->steps_pool);
+  add_pool_stats(stats, pbi->sched, pbi->entropy_steps_pool);
+  add_pool_stats(stats, pbi->sched, pbi->lf_steps_pool);
+
+  sched_for_each_dev(dev, pbi->sched) {
+    for (i = 0; i < dev->threads_count &&
+                stats->thread_count < VP9_DECODE_STATS_MAX_THREADS; i++)
+      stats->thread_busy_usecs[stats->thread_count++] =
+          device_get_thread_busy_usecs(dev, i);
+  }
+  return VPX_CODEC_OK;
+}
+
 static vpx_codec_ctrl_fn_map_t ctf_maps[] = {
   {VP8_SET_REFERENCE,             set_reference},
   {VP8_COPY_REFERENCE,            copy_reference},
@@ -1462,6 +1570,7 @@ static vpx_codec_ctrl_fn_map_t ctf_maps[] = {
   {VP9D_GET_DISPLAY_SIZE,         get_display_size},
   {VP9_INVERT_TILE_DECODE_ORDER,  set_invert_tile_order},
   {VP9D_SET_FRAME_BUFFER_LRU_CACHE, set_frame_buffer_lru_cache},
+  {VP9D_GET_DECODE_STATS,         get_decode_stats},
   { -1, NULL},
 };
 
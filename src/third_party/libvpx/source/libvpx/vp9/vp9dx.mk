@@ -27,8 +27,6 @@ VP9_DX_SRCS-yes += decoder/vp9_decodemv.h
 VP9_DX_SRCS-yes += decoder/vp9_detokenize.h
 VP9_DX_SRCS-yes += decoder/vp9_onyxd.h
 VP9_DX_SRCS-yes += decoder/vp9_onyxd_int.h
-VP9_DX_SRCS-yes += decoder/vp9_thread.c
-VP9_DX_SRCS-yes += decoder/vp9_thread.h
 VP9_DX_SRCS-yes += decoder/vp9_onyxd_if.c
 VP9_DX_SRCS-yes += decoder/vp9_dsubexp.c
 VP9_DX_SRCS-yes += decoder/vp9_dsubexp.h
@@ -46,7 +44,6 @@ VP9_DX_SRCS-yes += decoder/vp9_detokenize_recon.c
 VP9_DX_SRCS-yes += decoder/vp9_detokenize_recon.h
 
 P9_DX_SRCS-yes += sched/list.h
-VP9_DX_SRCS-yes += sched/thread.h
 VP9_DX_SRCS-yes += sched/queue.h
 VP9_DX_SRCS-yes += sched/queue.c
 VP9_DX_SRCS-yes += sched/task.h
@@ -19,7 +19,6 @@
 #include "vpx/internal/vpx_codec_internal.h"
 #include "vpx_version.h"
 
-#include "vp9/common/inter_ocl/vp9_yuv2rgba.h"
 
 #define SAVE_STATUS(ctx,var) (ctx?(ctx->err = var):var)
 
@@ -115,7 +114,6 @@ vpx_codec_err_t vpx_codec_destroy(vpx_codec_ctx_t *ctx) {
     ctx->priv = NULL;
     res = VPX_CODEC_OK;
   }
-  fclose(pLog);
   return SAVE_STATUS(ctx, res);
 }
 
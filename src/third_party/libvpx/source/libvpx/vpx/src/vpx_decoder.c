@@ -108,8 +108,6 @@ vpx_codec_err_t vpx_codec_dec_init_ver_ex(vpx_codec_ctx_t_ex     *ctx,
     ctx->config.dec = cfg;
     res = VPX_CODEC_OK;
 
-	pLog = fopen("Interop_log.txt", "w"); 
-
     if (!(flags & VPX_CODEC_USE_XMA)) {
       res = ctx->iface->init(ctx, NULL, id3d9_device);
 
@@ -248,8 +246,7 @@ vpx_codec_err_t vpx_codec_decode_ex(vpx_codec_ctx_t_ex    *ctx,
                                  user_priv, deadline, texture);
 	vpx_usec_timer_mark(&timer);
     dx_time = (unsigned int)vpx_usec_timer_elapsed(&timer);
-	fprintf(pLog, "the whole time of decode one frame: %lu us\n"
-		    "------------------------------------------\n", dx_time);
+    vp9_yuv2rgba_log_frame(dx_time);
   }
 
   return SAVE_STATUS(ctx, res);
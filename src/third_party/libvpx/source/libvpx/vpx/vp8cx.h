@@ -194,7 +194,21 @@ enum vp8e_enc_control_id {
   VP9E_SET_AQ_MODE,
 
   VP9E_SET_SVC,
-  VP9E_SET_SVC_PARAMETERS
+  VP9E_SET_SVC_PARAMETERS,
+
+  /*!\brief control function to let the encoder reference source images
+   *
+   * Takes a #vpx_source_release_cb_t. While its release function is set,
+   * the encoder may queue an I420 image for encoding without copying it,
+   * provided the image was set up with vpx_img_wrap() or vpx_img_alloc() and
+   * vpx_img_set_rect() leaving at least 16 pixels, or up to the next multiple
+   * of 64 if that is further, of padding around the visible area. The
+   * encoder writes the padding, and the image data must stay valid and
+   * unmodified until release is called with the image's user_priv. Every
+   * image passed to vpx_codec_encode() is released exactly once, right away
+   * if it had to be copied, and at the latest by vpx_codec_destroy().
+   */
+  VP9E_SET_SOURCE_RELEASE_CB
 };
 
 /*!\brief vpx 1-D scaling mode
@@ -295,6 +309,23 @@ typedef struct vpx_svc_parameters {
   int alt_fb_idx;             /**< alt reference frame frame buffer index */
 } vpx_svc_parameters_t;
 
+/*!\brief Source image release callback
+ *
+ * Called with the user_priv of an image passed to vpx_codec_encode() once
+ * the encoder no longer reads it.
+ */
+typedef void (*vpx_release_source_cb_fn_t)(void *cb_priv, void *user_priv);
+
+/*!\brief  vp9 source image release callback
+ *
+ * This defines the data structure for #VP9E_SET_SOURCE_RELEASE_CB.
+ *
+ */
+typedef struct vpx_source_release_cb {
+  vpx_release_source_cb_fn_t release;  /**< NULL to always copy sources */
+  void *cb_priv;                       /**< first argument to release */
+} vpx_source_release_cb_t;
+
 /*!\brief VP8 encoder control function parameter type
  *
  * Defines the data types that VP8E control functions take. Note that
@@ -316,6 +347,7 @@ VPX_CTRL_USE_TYPE(VP8E_SET_SCALEMODE,          vpx_scaling_mode_t *)
 
 VPX_CTRL_USE_TYPE(VP9E_SET_SVC,                int)
 VPX_CTRL_USE_TYPE(VP9E_SET_SVC_PARAMETERS,     vpx_svc_parameters_t *)
+VPX_CTRL_USE_TYPE(VP9E_SET_SOURCE_RELEASE_CB,  vpx_source_release_cb_t *)
 
 VPX_CTRL_USE_TYPE(VP8E_SET_CPUUSED,            int)
 VPX_CTRL_USE_TYPE(VP8E_SET_ENABLEAUTOALTREF,   unsigned int)
@@ -86,6 +86,12 @@ enum vp8_dec_control_id {
    * on lru cache.*/
   VP9D_SET_FRAME_BUFFER_LRU_CACHE,
 
+  /** control function to get the per-step timing and thread utilization
+   * collected by the staged vp9 decoder since it was created. Takes a
+   * vp9_decode_stats pointer.
+   */
+  VP9D_GET_DECODE_STATS,
+
   VP8_DECODER_CTRL_ID_MAX
 };
 
@@ -103,6 +109,27 @@ typedef struct vp8_decrypt_init {
     void *decrypt_state;
 } vp8_decrypt_init;
 
+#define VP9_DECODE_STATS_MAX_STEPS   16
+#define VP9_DECODE_STATS_MAX_THREADS 16
+
+/*!\brief Staged decoder statistics
+ *
+ * Filled in by VP9D_GET_DECODE_STATS. Times are accumulated wall-clock
+ * microseconds. A step's time is summed over every task that ran it, so
+ * steps split across tiles can exceed the elapsed decode time.
+ */
+typedef struct vp9_decode_stats {
+  /** Number of valid entries in step_name/step_usecs/step_runs. */
+  int step_count;
+  const char *step_name[VP9_DECODE_STATS_MAX_STEPS];
+  int64_t step_usecs[VP9_DECODE_STATS_MAX_STEPS];
+  int step_runs[VP9_DECODE_STATS_MAX_STEPS];
+
+  /** Number of valid entries in thread_busy_usecs. */
+  int thread_count;
+  int64_t thread_busy_usecs[VP9_DECODE_STATS_MAX_THREADS];
+} vp9_decode_stats;
+
 /*!\brief VP8 decoder control function parameter type
  *
  * Defines the data types that VP8D control functions take. Note that
@@ -118,6 +145,7 @@ VPX_CTRL_USE_TYPE(VP8D_SET_DECRYPTOR,          vp8_decrypt_init *)
 VPX_CTRL_USE_TYPE(VP9D_GET_DISPLAY_SIZE,       int *)
 VPX_CTRL_USE_TYPE(VP9_INVERT_TILE_DECODE_ORDER, int)
 VPX_CTRL_USE_TYPE(VP9D_SET_FRAME_BUFFER_LRU_CACHE, int)
+VPX_CTRL_USE_TYPE(VP9D_GET_DECODE_STATS,       vp9_decode_stats *)
 
 /*! @} - end defgroup vp8_decoder */
 
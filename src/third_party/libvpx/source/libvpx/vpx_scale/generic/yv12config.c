@@ -26,7 +26,7 @@
 #define yv12_align_addr(addr, align) \
   (void*)(((size_t)(addr) + ((align) - 1)) & (size_t)-(align))
 
-int vp9_free_frame_buffer_ocl(int fb_index);
+int vp9_free_frame_buffer_ocl(INTER_OCL_OBJ *inter_ocl, int fb_index);
 int vp8_yv12_de_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
   if (ybf) {
     // If libvpx is using external frame buffers then buffer_alloc_sz must
@@ -266,18 +266,19 @@ int vp9_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf,
 }
 
 #if USE_INTER_PREDICT_OCL
-int vp9_free_frame_buffer_ocl(int fb_index) {
-  vpx_memset(inter_ocl_obj.buffer_pool_map_ptr + fb_index *
-             (inter_ocl_obj.buffer_size ), 0, (inter_ocl_obj.buffer_size ));
+int vp9_free_frame_buffer_ocl(INTER_OCL_OBJ *inter_ocl, int fb_index) {
+  vpx_memset(inter_ocl->buffer_pool_map_ptr + fb_index *
+             (inter_ocl->buffer_size ), 0, (inter_ocl->buffer_size ));
   return 0;
 }
 
 
-void *vpx_memalign_ocl(size_t align, size_t size, YV12_BUFFER_CONFIG *ybf) {
+void *vpx_memalign_ocl(INTER_OCL_OBJ *inter_ocl, size_t align, size_t size,
+                       YV12_BUFFER_CONFIG *ybf) {
   uint8_t * addr = NULL;
   int status;
-  if(inter_ocl_obj.buffer_pool_flag == 0) {
-    inter_ocl_obj.buffer_pool_kernel = clCreateBuffer(
+  if(inter_ocl->buffer_pool_flag == 0) {
+    inter_ocl->buffer_pool_kernel = clCreateBuffer(
                                          ocl_context.context,
                                          CL_MEM_ALLOC_HOST_PTR |
                                          CL_MEM_WRITE_ONLY,
@@ -288,7 +289,7 @@ void *vpx_memalign_ocl(size_t align, size_t size, YV12_BUFFER_CONFIG *ybf) {
       return NULL;
     }
 
-    inter_ocl_obj.buffer_pool_read_only_kernel = clCreateBuffer(
+    inter_ocl->buffer_pool_read_only_kernel = clCreateBuffer(
                                                      ocl_context.context,
                                                      CL_MEM_READ_ONLY,
                                                      size * FRAME_BUFFERS,
@@ -300,9 +301,9 @@ void *vpx_memalign_ocl(size_t align, size_t size, YV12_BUFFER_CONFIG *ybf) {
     }
 
     //map buffer pool ptr
-    inter_ocl_obj.buffer_pool_map_ptr= (uint8_t *) clEnqueueMapBuffer(
+    inter_ocl->buffer_pool_map_ptr= (uint8_t *) clEnqueueMapBuffer(
                                                 ocl_context.command_queue,
-                                                inter_ocl_obj.buffer_pool_kernel,
+                                                inter_ocl->buffer_pool_kernel,
                                                 CL_TRUE, CL_MAP_WRITE, 0,
                                                 size * FRAME_BUFFERS,
                                                 0, NULL, NULL, &status);
@@ -311,11 +312,11 @@ void *vpx_memalign_ocl(size_t align, size_t size, YV12_BUFFER_CONFIG *ybf) {
       return NULL;
     }
 
-   inter_ocl_obj.buffer_pool_flag = 1;
+   inter_ocl->buffer_pool_flag = 1;
  }
 
-  assert(inter_ocl_obj.buffer_pool_map_ptr != NULL);
-  addr = inter_ocl_obj.buffer_pool_map_ptr +
+  assert(inter_ocl->buffer_pool_map_ptr != NULL);
+  addr = inter_ocl->buffer_pool_map_ptr +
          (ybf->nFrameNum *  size );
 
   return (void*)addr;
@@ -326,7 +327,8 @@ int vp9_realloc_frame_buffer_ocl(YV12_BUFFER_CONFIG *ybf,
                              int ss_x, int ss_y, int border,
                              vpx_codec_frame_buffer_t *ext_fb,
                              vpx_realloc_frame_buffer_cb_fn_t cb,
-                             void *user_priv, int new_fb_idx) {
+                             void *user_priv, int new_fb_idx,
+                             struct inter_ocl_obj *inter_ocl) {
   if (ybf) {
     const int aligned_width = (width + 7) & ~7;
     const int aligned_height = (height + 7) & ~7;
@@ -377,11 +379,12 @@ int vp9_realloc_frame_buffer_ocl(YV12_BUFFER_CONFIG *ybf,
         // Allocation to hold larger frame, or first allocation.
         if (ybf->buffer_alloc) {
 #if USE_INTER_PREDICT_OCL
-          vp9_free_frame_buffer_ocl(new_fb_idx);
+          vp9_free_frame_buffer_ocl(inter_ocl, new_fb_idx);
 #endif
         }
         ybf->nFrameNum =  new_fb_idx;
-        ybf->buffer_alloc = (uint8_t *)vpx_memalign_ocl(32, frame_size, ybf);
+        ybf->buffer_alloc = (uint8_t *)vpx_memalign_ocl(inter_ocl, 32,
+                                                        frame_size, ybf);
         if (!ybf->buffer_alloc)
           return -1;
 
@@ -25,6 +25,8 @@ extern "C" {
 #define VP9BORDERINPIXELS      160
 #define VP9_INTERP_EXTEND        4
 
+  struct inter_ocl_obj;
+
   typedef struct yv12_buffer_config {
     int   y_width;
     int   y_height;
@@ -91,7 +93,8 @@ extern "C" {
                                int ss_x, int ss_y, int border,
                                vpx_codec_frame_buffer_t *ext_fb,
                                vpx_realloc_frame_buffer_cb_fn_t cb,
-                               void *user_priv, int new_fb_idx);
+                               void *user_priv, int new_fb_idx,
+                               struct inter_ocl_obj *inter_ocl);
 
 #ifdef __cplusplus
 }
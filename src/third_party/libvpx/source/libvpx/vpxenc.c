@@ -110,14 +110,27 @@ static void warn_or_exit_on_error(vpx_codec_ctx_t *ctx, int fatal,
   va_end(ap);
 }
 
+/* Returns how far into the input file reading has progressed. A mapped
+ * input is consumed from memory, leaving the FILE position untouched.
+ */
+static off_t input_position(struct VpxInputContext *input_ctx) {
+  if (input_ctx->map.data)
+    return (off_t)input_ctx->map.pos;
+  return ftello(input_ctx->file);
+}
+
 int read_frame(struct VpxInputContext *input_ctx, vpx_image_t *img) {
   FILE *f = input_ctx->file;
   y4m_input *y4m = &input_ctx->y4m;
   int shortread = 0;
 
   if (input_ctx->file_type == FILE_TYPE_Y4M) {
-    if (y4m_input_fetch_frame(y4m, f, img) < 1)
+    if (input_ctx->map.data) {
+      if (y4m_input_fetch_frame_mapped(y4m, &input_ctx->map, img) < 1)
+        return 0;
+    } else if (y4m_input_fetch_frame(y4m, f, img) < 1) {
       return 0;
+    }
   } else {
     shortread = read_yuv_frame(input_ctx, img);
   }
@@ -1057,6 +1070,10 @@ void open_input_file(struct VpxInputContext *input) {
       input->framerate.numerator = input->y4m.fps_n;
       input->framerate.denominator = input->y4m.fps_d;
       input->use_i420 = 0;
+      /* Regular files are read through a mapping from here on, which lets
+       * 4:2:0 input be handed to the encoder without an intermediate copy.
+       */
+      map_input_file(&input->map, input->file);
     } else
       fatal("Unsupported Y4M stream.");
   } else if (input->detect.buf_read == 4 && fourcc_is_ivf(input->detect.buf)) {
@@ -1068,6 +1085,7 @@ void open_input_file(struct VpxInputContext *input) {
 
 
 static void close_input_file(struct VpxInputContext *input) {
+  unmap_input_file(&input->map);
   fclose(input->file);
   if (input->file_type == FILE_TYPE_Y4M)
     y4m_input_close(&input->y4m);
@@ -1941,7 +1959,7 @@ int main(int argc, const char **argv_) {
         FOREACH_STREAM(get_cx_data(stream, &global, &got_data));
 
         if (!got_data && input.length && !streams->frames_out) {
-          lagged_count = global.limit ? seen_frames : ftello(input.file);
+          lagged_count = global.limit ? seen_frames : input_position(&input);
         } else if (input.length) {
           int64_t remaining;
           int64_t rate;
@@ -1953,7 +1971,7 @@ int main(int argc, const char **argv_) {
             remaining = 1000 * (global.limit - global.skip_frames
                                 - seen_frames + lagged_count);
           } else {
-            off_t input_pos = ftello(input.file);
+            off_t input_pos = input_position(&input);
             off_t input_pos_lagged = input_pos - lagged_count;
             int64_t limit = input.length;
 
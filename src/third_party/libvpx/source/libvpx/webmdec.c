@@ -11,6 +11,7 @@
 #include "./webmdec.h"
 
 #include <stdarg.h>
+#include <string.h>
 
 #include "nestegg/include/nestegg/nestegg.h"
 
@@ -45,6 +46,37 @@ static int64_t nestegg_tell_cb(void *userdata) {
   return ftell((FILE*)userdata);
 }
 
+static int nestegg_map_read_cb(void *buffer, size_t length, void *userdata) {
+  struct VpxInputMap *map = (struct VpxInputMap *)userdata;
+
+  if (map->size - map->pos < length)
+    return 0;
+  memcpy(buffer, map->data + map->pos, length);
+  map->pos += length;
+  return 1;
+}
+
+static int nestegg_map_seek_cb(int64_t offset, int whence, void *userdata) {
+  struct VpxInputMap *map = (struct VpxInputMap *)userdata;
+
+  switch (whence) {
+    case NESTEGG_SEEK_CUR:
+      offset += map->pos;
+      break;
+    case NESTEGG_SEEK_END:
+      offset += map->size;
+      break;
+  };
+  if (offset < 0 || (uint64_t)offset > map->size)
+    return -1;
+  map->pos = (size_t)offset;
+  return 0;
+}
+
+static int64_t nestegg_map_tell_cb(void *userdata) {
+  return ((struct VpxInputMap *)userdata)->pos;
+}
+
 static void nestegg_log_cb(nestegg *context,
                            unsigned int severity,
                            char const *format, ...) {
@@ -65,6 +97,14 @@ int file_is_webm(struct WebmInputContext *webm_ctx,
   nestegg_video_params params;
 
   io.userdata = vpx_ctx->file;
+  if (vpx_ctx->map.data) {
+    // Parse straight out of the mapped file. nestegg still copies each
+    // packet into its own allocation, but the stdio layer is bypassed.
+    io.read = nestegg_map_read_cb;
+    io.seek = nestegg_map_seek_cb;
+    io.tell = nestegg_map_tell_cb;
+    io.userdata = &vpx_ctx->map;
+  }
   if (nestegg_init(&webm_ctx->nestegg_ctx, io, NULL))
     goto fail;
 
@@ -104,6 +144,7 @@ int file_is_webm(struct WebmInputContext *webm_ctx,
  fail:
   webm_ctx->nestegg_ctx = NULL;
   rewind(vpx_ctx->file);
+  vpx_ctx->map.pos = 0;
 
   return 0;
 }
@@ -128,7 +169,8 @@ int webm_read_frame(struct WebmInputContext *webm_ctx,
       }
     } while (track != webm_ctx->video_track);
 
-    if (nestegg_packet_count(webm_ctx->pkt, &webm_ctx->chunks))
+    if (nestegg_packet_count(webm_ctx->pkt, &webm_ctx->chunks) ||
+        nestegg_packet_tstamp(webm_ctx->pkt, &webm_ctx->timestamp_ns))
       return 1;
 
     webm_ctx->chunk = 0;
@@ -143,6 +185,53 @@ int webm_read_frame(struct WebmInputContext *webm_ctx,
   return 0;
 }
 
+int webm_seek(struct WebmInputContext *webm_ctx,
+              struct VpxInputContext *vpx_ctx,
+              uint64_t timestamp_ns, uint32_t chunk) {
+  if (webm_ctx->pkt) {
+    nestegg_free_packet(webm_ctx->pkt);
+    webm_ctx->pkt = NULL;
+  }
+  webm_ctx->chunk = webm_ctx->chunks = 0;
+
+  if (nestegg_track_seek(webm_ctx->nestegg_ctx, webm_ctx->video_track,
+                         timestamp_ns)) {
+    /* No Cues: start over and let the loop below walk to the packet. */
+    const struct VpxRational framerate = vpx_ctx->framerate;
+
+    nestegg_destroy(webm_ctx->nestegg_ctx);
+    webm_ctx->nestegg_ctx = NULL;
+    rewind(vpx_ctx->file);
+    vpx_ctx->map.pos = 0;
+    if (!file_is_webm(webm_ctx, vpx_ctx))
+      return 1;
+    vpx_ctx->framerate = framerate;
+  }
+
+  /* The cue point may sit at the start of an earlier cluster. */
+  for (;;) {
+    uint32_t track;
+
+    if (webm_ctx->pkt) {
+      nestegg_free_packet(webm_ctx->pkt);
+      webm_ctx->pkt = NULL;
+    }
+    if (nestegg_read_packet(webm_ctx->nestegg_ctx, &webm_ctx->pkt) <= 0 ||
+        nestegg_packet_track(webm_ctx->pkt, &track) ||
+        nestegg_packet_tstamp(webm_ctx->pkt, &webm_ctx->timestamp_ns))
+      return 1;
+    if (track == webm_ctx->video_track &&
+        webm_ctx->timestamp_ns >= timestamp_ns)
+      break;
+  }
+
+  if (nestegg_packet_count(webm_ctx->pkt, &webm_ctx->chunks) ||
+      chunk >= webm_ctx->chunks)
+    return 1;
+  webm_ctx->chunk = chunk;
+  return 0;
+}
+
 int webm_guess_framerate(struct WebmInputContext *webm_ctx,
                          struct VpxInputContext *vpx_ctx) {
   uint32_t i;
@@ -186,6 +275,7 @@ int webm_guess_framerate(struct WebmInputContext *webm_ctx,
   nestegg_destroy(webm_ctx->nestegg_ctx);
   webm_ctx->nestegg_ctx = NULL;
   rewind(vpx_ctx->file);
+  vpx_ctx->map.pos = 0;
   return 1;
 }
 
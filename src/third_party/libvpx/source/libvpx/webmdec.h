@@ -22,6 +22,8 @@ struct WebmInputContext {
   uint32_t video_track;
   struct nestegg *nestegg_ctx;
   struct nestegg_packet *pkt;
+  /* Timestamp of pkt in nanoseconds. */
+  uint64_t timestamp_ns;
 };
 
 int file_is_webm(struct WebmInputContext *webm_ctx,
@@ -32,6 +34,15 @@ int webm_read_frame(struct WebmInputContext *webm_ctx,
                     size_t *bytes_in_buffer,
                     size_t *buffer_size);
 
+/* Repositions the reader so that the next webm_read_frame() returns frame
+ * chunk of the first video packet stamped timestamp_ns. The Cues element is
+ * used to jump straight to the right cluster; files without one are
+ * re-parsed from the start.
+ */
+int webm_seek(struct WebmInputContext *webm_ctx,
+              struct VpxInputContext *vpx_ctx,
+              uint64_t timestamp_ns, uint32_t chunk);
+
 int webm_guess_framerate(struct WebmInputContext *webm_ctx,
                          struct VpxInputContext *vpx_ctx);
 
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include "./xxhash_utils.h"
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static uint64_t read_le64(const unsigned char *p) {
+  return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+         ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32) |
+         ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) |
+         ((uint64_t)p[7] << 56);
+}
+
+static uint32_t read_le32(const unsigned char *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+  acc += input * PRIME64_2;
+  acc = ROTL64(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static uint64_t xxh64_merge_round(uint64_t acc, uint64_t val) {
+  acc ^= xxh64_round(0, val);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+void XXH64Init(struct XXH64Context *ctx) {
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->v[0] = PRIME64_1 + PRIME64_2;
+  ctx->v[1] = PRIME64_2;
+  ctx->v[2] = 0;
+  ctx->v[3] = 0 - PRIME64_1;
+}
+
+void XXH64Update(struct XXH64Context *ctx, const unsigned char *buf,
+                 size_t len) {
+  const unsigned char *const end = buf + len;
+
+  ctx->total_len += len;
+
+  if (ctx->mem_size + len < 32) {
+    memcpy(ctx->mem + ctx->mem_size, buf, len);
+    ctx->mem_size += (unsigned int)len;
+    return;
+  }
+
+  if (ctx->mem_size) {
+    const size_t fill = 32 - ctx->mem_size;
+    memcpy(ctx->mem + ctx->mem_size, buf, fill);
+    ctx->v[0] = xxh64_round(ctx->v[0], read_le64(ctx->mem));
+    ctx->v[1] = xxh64_round(ctx->v[1], read_le64(ctx->mem + 8));
+    ctx->v[2] = xxh64_round(ctx->v[2], read_le64(ctx->mem + 16));
+    ctx->v[3] = xxh64_round(ctx->v[3], read_le64(ctx->mem + 24));
+    buf += fill;
+    ctx->mem_size = 0;
+  }
+
+  if (end - buf >= 32) {
+    uint64_t v0 = ctx->v[0], v1 = ctx->v[1], v2 = ctx->v[2], v3 = ctx->v[3];
+    do {
+      v0 = xxh64_round(v0, read_le64(buf));
+      v1 = xxh64_round(v1, read_le64(buf + 8));
+      v2 = xxh64_round(v2, read_le64(buf + 16));
+      v3 = xxh64_round(v3, read_le64(buf + 24));
+      buf += 32;
+    } while (end - buf >= 32);
+    ctx->v[0] = v0;
+    ctx->v[1] = v1;
+    ctx->v[2] = v2;
+    ctx->v[3] = v3;
+  }
+
+  if (buf < end) {
+    memcpy(ctx->mem, buf, end - buf);
+    ctx->mem_size = (unsigned int)(end - buf);
+  }
+}
+
+uint64_t XXH64Final(const struct XXH64Context *ctx) {
+  const unsigned char *p = ctx->mem;
+  const unsigned char *const end = ctx->mem + ctx->mem_size;
+  uint64_t h;
+
+  if (ctx->total_len >= 32) {
+    h = ROTL64(ctx->v[0], 1) + ROTL64(ctx->v[1], 7) +
+        ROTL64(ctx->v[2], 12) + ROTL64(ctx->v[3], 18);
+    h = xxh64_merge_round(h, ctx->v[0]);
+    h = xxh64_merge_round(h, ctx->v[1]);
+    h = xxh64_merge_round(h, ctx->v[2]);
+    h = xxh64_merge_round(h, ctx->v[3]);
+  } else {
+    h = ctx->v[2] + PRIME64_5;
+  }
+  h += ctx->total_len;
+
+  for (; p + 8 <= end; p += 8) {
+    h ^= xxh64_round(0, read_le64(p));
+    h = ROTL64(h, 27) * PRIME64_1 + PRIME64_4;
+  }
+  if (p + 4 <= end) {
+    h ^= (uint64_t)read_le32(p) * PRIME64_1;
+    h = ROTL64(h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= (uint64_t)*p * PRIME64_5;
+    h = ROTL64(h, 11) * PRIME64_1;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
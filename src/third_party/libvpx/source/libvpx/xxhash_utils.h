@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2014 The WebM project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * Streaming implementation of the 64-bit xxHash (XXH64) checksum by Yann
+ * Collet, seed 0. It is not cryptographic, but is several times faster than
+ * MD5 and good enough to detect mismatching decoder output.
+ *
+ * Usage mirrors md5_utils.h: XXH64Init, XXH64Update as often as needed,
+ * then XXH64Final to obtain the digest.
+ */
+
+#ifndef XXHASH_UTILS_H_
+#define XXHASH_UTILS_H_
+
+#include <stddef.h>
+
+#include "vpx/vpx_integer.h"
+
+typedef struct XXH64Context XXH64Context;
+struct XXH64Context {
+  uint64_t v[4];
+  uint64_t total_len;
+  unsigned char mem[32];
+  unsigned int mem_size;
+};
+
+void XXH64Init(struct XXH64Context *context);
+void XXH64Update(struct XXH64Context *context, const unsigned char *buf,
+                 size_t len);
+uint64_t XXH64Final(const struct XXH64Context *context);
+
+#endif  // XXHASH_UTILS_H_
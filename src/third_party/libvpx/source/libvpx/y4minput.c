@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "y4minput.h"
+#include "./tools_common.h"
 
 static int y4m_parse_tags(y4m_input *_y4m, char *_tags) {
   int   got_w;
@@ -847,12 +848,39 @@ void y4m_input_close(y4m_input *_y4m) {
   free(_y4m->aux_buf);
 }
 
-int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, vpx_image_t *_img) {
-  char frame[6];
+static void y4m_input_fill_image(y4m_input *_y4m, vpx_image_t *_img,
+                                 unsigned char *_buf) {
   int  pic_sz;
   int  c_w;
   int  c_h;
   int  c_sz;
+  /*Fill in the frame buffer pointers.
+    We don't use vpx_img_wrap() because it forces padding for odd picture
+     sizes, which would require a separate fread call for every row.*/
+  memset(_img, 0, sizeof(*_img));
+  /*Y4M has the planes in Y'CbCr order, which libvpx calls Y, U, and V.*/
+  _img->fmt = _y4m->vpx_fmt;
+  _img->w = _img->d_w = _y4m->pic_w;
+  _img->h = _img->d_h = _y4m->pic_h;
+  _img->x_chroma_shift = _y4m->dst_c_dec_h >> 1;
+  _img->y_chroma_shift = _y4m->dst_c_dec_v >> 1;
+  _img->bps = _y4m->vpx_bps;
+
+  /*Set up the buffer pointers.*/
+  pic_sz = _y4m->pic_w * _y4m->pic_h;
+  c_w = (_y4m->pic_w + _y4m->dst_c_dec_h - 1) / _y4m->dst_c_dec_h;
+  c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
+  c_sz = c_w * c_h;
+  _img->stride[PLANE_Y] = _img->stride[PLANE_ALPHA] = _y4m->pic_w;
+  _img->stride[PLANE_U] = _img->stride[PLANE_V] = c_w;
+  _img->planes[PLANE_Y] = _buf;
+  _img->planes[PLANE_U] = _buf + pic_sz;
+  _img->planes[PLANE_V] = _buf + pic_sz + c_sz;
+  _img->planes[PLANE_ALPHA] = _buf + pic_sz + 2 * c_sz;
+}
+
+int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, vpx_image_t *_img) {
+  char frame[6];
   int  ret;
   /*Read and skip the frame header.*/
   ret = (int)fread(frame, 1, 6, _fin);
@@ -882,28 +910,46 @@ int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, vpx_image_t *_img) {
   }
   /*Now convert the just read frame.*/
   (*_y4m->convert)(_y4m, _y4m->dst_buf, _y4m->aux_buf);
-  /*Fill in the frame buffer pointers.
-    We don't use vpx_img_wrap() because it forces padding for odd picture
-     sizes, which would require a separate fread call for every row.*/
-  memset(_img, 0, sizeof(*_img));
-  /*Y4M has the planes in Y'CbCr order, which libvpx calls Y, U, and V.*/
-  _img->fmt = _y4m->vpx_fmt;
-  _img->w = _img->d_w = _y4m->pic_w;
-  _img->h = _img->d_h = _y4m->pic_h;
-  _img->x_chroma_shift = _y4m->dst_c_dec_h >> 1;
-  _img->y_chroma_shift = _y4m->dst_c_dec_v >> 1;
-  _img->bps = _y4m->vpx_bps;
+  y4m_input_fill_image(_y4m, _img, _y4m->dst_buf);
+  return 1;
+}
 
-  /*Set up the buffer pointers.*/
-  pic_sz = _y4m->pic_w * _y4m->pic_h;
-  c_w = (_y4m->pic_w + _y4m->dst_c_dec_h - 1) / _y4m->dst_c_dec_h;
-  c_h = (_y4m->pic_h + _y4m->dst_c_dec_v - 1) / _y4m->dst_c_dec_v;
-  c_sz = c_w * c_h;
-  _img->stride[PLANE_Y] = _img->stride[PLANE_ALPHA] = _y4m->pic_w;
-  _img->stride[PLANE_U] = _img->stride[PLANE_V] = c_w;
-  _img->planes[PLANE_Y] = _y4m->dst_buf;
-  _img->planes[PLANE_U] = _y4m->dst_buf + pic_sz;
-  _img->planes[PLANE_V] = _y4m->dst_buf + pic_sz + c_sz;
-  _img->planes[PLANE_ALPHA] = _y4m->dst_buf + pic_sz + 2 * c_sz;
+int y4m_input_fetch_frame_mapped(y4m_input *_y4m, struct VpxInputMap *_map,
+                                 vpx_image_t *_img) {
+  const unsigned char *frame;
+  size_t               left;
+  size_t               hdr_sz;
+  left = _map->size - _map->pos;
+  if (left < 6)return 0;
+  frame = _map->data + _map->pos;
+  if (memcmp(frame, "FRAME", 5)) {
+    fprintf(stderr, "Loss of framing in Y4M input data\n");
+    return -1;
+  }
+  /*Skip the frame header, with the same 79 byte limit on parameters.*/
+  for (hdr_sz = 5; hdr_sz < left && hdr_sz < 85 && frame[hdr_sz] != '\n';
+       hdr_sz++);
+  if (hdr_sz >= left || frame[hdr_sz] != '\n') {
+    fprintf(stderr, "Error parsing Y4M frame header\n");
+    return -1;
+  }
+  hdr_sz++;
+  if (left - hdr_sz < _y4m->dst_buf_read_sz + _y4m->aux_buf_read_sz) {
+    fprintf(stderr, "Error reading Y4M frame data.\n");
+    return -1;
+  }
+  frame += hdr_sz;
+  _map->pos += hdr_sz + _y4m->dst_buf_read_sz + _y4m->aux_buf_read_sz;
+  if (_y4m->convert == y4m_convert_null) {
+    /*The file already holds the planes in the output layout, so hand out
+       pointers into the mapping; the encoder only reads from them.*/
+    y4m_input_fill_image(_y4m, _img,
+                         (unsigned char *)_map->base + (frame - _map->data));
+    return 1;
+  }
+  memcpy(_y4m->dst_buf, frame, _y4m->dst_buf_read_sz);
+  memcpy(_y4m->aux_buf, frame + _y4m->dst_buf_read_sz, _y4m->aux_buf_read_sz);
+  (*_y4m->convert)(_y4m, _y4m->dst_buf, _y4m->aux_buf);
+  y4m_input_fill_image(_y4m, _img, _y4m->dst_buf);
   return 1;
 }
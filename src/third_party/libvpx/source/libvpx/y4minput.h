@@ -20,6 +20,7 @@
 
 
 typedef struct y4m_input y4m_input;
+struct VpxInputMap;
 
 
 
@@ -61,5 +62,9 @@ int y4m_input_open(y4m_input *_y4m, FILE *_fin, char *_skip, int _nskip,
                    int only_420);
 void y4m_input_close(y4m_input *_y4m);
 int y4m_input_fetch_frame(y4m_input *_y4m, FILE *_fin, vpx_image_t *img);
+/*Like y4m_input_fetch_frame(), but consumes a memory-mapped file. When no
+   chroma conversion is needed img points straight into the mapping.*/
+int y4m_input_fetch_frame_mapped(y4m_input *_y4m, struct VpxInputMap *_map,
+                                 vpx_image_t *img);
 
 #endif  // Y4MINPUT_H_